@@ -103,93 +103,64 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
 
 // ****************************************************************************
 
-void CreateAndBlitBitmap(HDC hWinDC)
+void DrawFrame(HDC hWinDC)
 {
-    BOOL RetBlit;
-    HBITMAP OldBitmap;
-    UINT32 Frame_X = 0;
-    UINT32 Frame_Y = 0;
-    UINT32 TofValue = 0;
-    unsigned char TofColorLow = 0;
-    unsigned char TofColorHigh = 0;
-
-
-    BITMAPINFO info;
-    ZeroMemory(&info, sizeof(BITMAPINFO));
-    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    info.bmiHeader.biBitCount = 24;
-    info.bmiHeader.biPlanes = 1;
-    info.bmiHeader.biCompression = BI_RGB;
-    info.bmiHeader.biWidth = X_DIM;
-    info.bmiHeader.biHeight = Y_DIM;
-
-    HDC memDC = CreateCompatibleDC(hWinDC);
-    HBITMAP memBM = CreateCompatibleBitmap(hWinDC, X_DIM, Y_DIM);
-
-    for (int Line = 0; Line < LINES_VIRTUAL; Line++)
-    {
-        for (int Row = 0; Row < PULSES_VIRTUAL; Row++)
-        {
-            // "Line * PULSES_VIRTUAL" points to the beginning of the line.
-            // " + Row" points to the particular pixel value on that line.
-
-            if (gWhichData == TIME_DATA)
-            {
-                TofValue = gTimeFrameBuffer[Line * PULSES_VIRTUAL + Row];
-            }
-            else
-            {
-                TofValue = gAmplitudeFrameBuffer[Line * PULSES_VIRTUAL + Row];
-            }
+    const UINT32* pPlane;
+    const TofSurface* pSurface = gRenderer.GetSurface();
+    TofPaletteE Palette;
 
-            // determine the x and y for the pixel to be displayed
-            Frame_X = (Row * (NUM_PULSES * N_LINES_COMBINE)) / PULSES_VIRTUAL;
 
-            // offset from the edge of the window
-            Frame_X += 80;
+    // Time data is drawn in grey, amplitude data in yellow
+    Palette = (gWhichData == TIME_DATA) ? eTOF_PALETTE_GRAY : eTOF_PALETTE_YELLOW;
 
-            // 3 colors - RGB
-            Frame_X *= 3;
-            Frame_Y = ((LINES_VIRTUAL - Line) * 180) / LINES_VIRTUAL;
+    if (Palette != gPalette)
+    {
+        gColorizer.SetPalette(Palette);
+        gPalette = Palette;
+    }
 
-            // convert to 8 bits to use for painting
-            TofColorLow = (char)(TofValue & 0x000000ff);
-            TofColorHigh = (char)((TofValue & 0x0000ff00) >> 8);
+    pPlane = (gWhichData == TIME_DATA) ? gImageView.pTime : gImageView.pAmplitude;
 
-            if (gWhichData == TIME_DATA)
-            {
-                // blue
-                gWindowsFrameData[Frame_Y][Frame_X++] = TofColorLow;
-                // green
-                gWindowsFrameData[Frame_Y][Frame_X++] = TofColorLow;
-                // red
-                gWindowsFrameData[Frame_Y][Frame_X++] = TofColorLow;
-            }
-            else
-            {
-                // blue
-                gWindowsFrameData[Frame_Y][Frame_X++] = 0;
-                // green
-                gWindowsFrameData[Frame_Y][Frame_X++] = TofColorLow;
-                // red
-                gWindowsFrameData[Frame_Y][Frame_X++] = TofColorLow;
-            }
+    // Nothing to draw until the first frame arrives
+    if ((pPlane != NULL) && (pSurface->pPixels != NULL))
+    {
+        // Stretch the range actually present in the data over the 256 levels
+        if (gWhichData == TIME_DATA)
+        {
+            gTimeNormalizer.Normalize8(pPlane, &gDisplayPlane[0], (UINT32)gDisplayPlane.size());
+        }
+        else
+        {
+            gAmplitudeNormalizer.Normalize8(pPlane, &gDisplayPlane[0], (UINT32)gDisplayPlane.size());
         }
-    }
 
-    SetDIBits(memDC, memBM, 0, Y_DIM, (void*)gWindowsFrameData, &info, DIB_RGB_COLORS);
-    OldBitmap = (HBITMAP)SelectObject(memDC, memBM);
-    RetBlit = BitBlt(hWinDC, 0, 0, X_DIM, Y_DIM, memDC, 0, 0, SRCCOPY);
+        // Drawn straight into the bitmap that gets blitted
+        gColorizer.ColorizeNarrowed(&gDisplayPlane[0], pSurface->pPixels);
+    }
 
-    if (RetBlit == false)
+    if ( ! gRenderer.Present(hWinDC, 0, 0))
     {
         MessageBox(NULL, "Blit Failed", "Error", MB_OK);
+    }
+}
+
+// ****************************************************************************
+//  Called on the acquisition thread for every frame read from the device
+// ****************************************************************************
+
+void OnTofFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    HWND hWnd = (HWND)pContext;
+
+
+    if (pFrame->Result != eSUCCESS)
+    {
+        ::PostMessage(hWnd, WM_TOF_ERROR, (WPARAM)pFrame->Result, 0);
         return;
     }
 
-    SelectObject(memDC, OldBitmap);
-    DeleteDC(memDC);
-    DeleteObject(memBM);
+    // The frame is already in gFrameRing, just get it painted
+    ::InvalidateRect(hWnd, 0, false);
 }
 
 // ****************************************************************************
@@ -202,7 +173,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 	HDC Hdc;
     PicoP_SensingStateE SensingState;
     PicoP_TofPulsingConfig PulsingConfig;
-    UINT32 FrameSize = 0;
+    const TofRingSlot* pSlot;
     char Buffer[MESSAGE_BUFFER_SIZE];
 
 
@@ -226,6 +197,17 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         PostMessage(ghWndTimeData, BM_SETCHECK, BST_CHECKED, 0);
         gWhichData = TIME_DATA;
 
+        // The bitmap the frames are drawn into lives as long as the window
+        PicopRc = gRenderer.Create(X_DIM, Y_DIM);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofGdiRenderer::Create() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
         // connect to the DLL
         PicopRc = PicoP_TLC_OpenLibrary(&LibraryHandle);
 
@@ -311,8 +293,81 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             break;
         }
 
-        // Set a timer to start getting 3D data
-        ::SetTimer(hWnd, ID_TIMER, 250, 0);
+        // Everything downstream is sized from the frames the device will actually send
+        PicopRc = TofQueryFrameGeometry(ConnectionHandle, &gGeometry);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofQueryFrameGeometry() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
+        // Time and amplitude are read from wherever the data format puts them
+        PicopRc = gDecoder.Create(&gGeometry, eTOF_DETECTOR_FUSED);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofFrameDecoder::Create() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
+        // Line and frame phases are merged into one image as the frames arrive,
+        // without waiting for a full set of frame phases
+        PicopRc = gPhaseAssembler.Create(&gGeometry, eTOF_PHASE_ROLLING);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofPhaseAssembler::Create() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
+        gDisplayPlane.assign((size_t)gPhaseAssembler.GetWidth() * gPhaseAssembler.GetHeight(), 0);
+
+        // Work out once where each line and pulse is drawn in the window,
+        // wider images are squeezed to fit
+        PicopRc = gColorizer.Create(gPhaseAssembler.GetWidth(), gPhaseAssembler.GetHeight(),
+                                    X_DIM, Y_DIM, gRenderer.GetSurface()->Stride, IMAGE_X_OFFSET,
+                                    (gPhaseAssembler.GetWidth() < IMAGE_MAX_WIDTH) ? gPhaseAssembler.GetWidth() : IMAGE_MAX_WIDTH,
+                                    IMAGE_HEIGHT);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofColorizer::Create() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
+        PicopRc = gFrameRing.Create(gGeometry.FrameBytes, FRAME_RING_SLOTS);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofFrameRing::Create() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
+        // Start getting 3D data as soon as the device reports frames. Only the
+        // newest frame is shown, so stale frames are drained in bulk.
+        gAcquisition.SetFrameRing(&gFrameRing);
+        gAcquisition.SetMode(eTOF_ACQUIRE_LATEST_ONLY);
+        PicopRc = gAcquisition.Start(ConnectionHandle, OnTofFrame, (void*)hWnd);
+
+        if (PicopRc != eSUCCESS)
+        {
+            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+            sprintf_s(Buffer, "TofAcquisition::Start() failed:  %d", PicopRc);
+            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+            break;
+        }
+
         break;
 
     case WM_COMMAND:
@@ -360,62 +415,56 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
 		break;
 
-    case WM_TIMER:
-        ::KillTimer(hWnd, ID_TIMER);
+    case WM_TOF_ERROR:
+        memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
+        sprintf_s(Buffer, "ToF frame acquisition failed:  %d", (int)wParam);
+        MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
+        break;
 
-        // See if there are frames buffered
-        PicopRc = PicoP_TLC_GetTofFrameCount(ConnectionHandle, &gCount);
+    case WM_PAINT:
+		Hdc = BeginPaint(hWnd, &PaintStruct);
 
-        if (PicopRc != eSUCCESS)
-        {
-            memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
-            sprintf_s(Buffer, "PicoP_TLC_GetTofFrameCount() failed:  %d", PicopRc);
-            MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
-            break;
-        }
+        // Pick up the newest frame, the ring keeps it reserved until the next one.
+        // A repaint without a new frame gets the same slot back; merging it again
+        // would count it twice.
+        pSlot = gFrameRing.ReadLatest();
 
-        // If there are no frames available wait a little longer
-        if (gCount == 0)
+        if ((pSlot != NULL) && ( ! gFrameMerged || (pSlot->SequenceNumber != gMergedSequence)))
         {
-            ::SetTimer(hWnd, ID_TIMER, 250, 0);
-            break;
+            gFrameMerged = TRUE;
+            gMergedSequence = pSlot->SequenceNumber;
+
+            // Read the 3D data where it was acquired instead of copying it out,
+            // unless the format sends both detectors and they must be combined
+            gDecoder.GetView(pSlot->pData, pSlot->FrameWords, &gFrameView);
+
+            // The device runs through the frame phases in order; count every
+            // frame it sent, not only the ones that reached the display
+            gPhaseAssembler.Add(&gFrameView, pSlot->DeviceFrame % gGeometry.FramePhases, NULL);
+            gPhaseAssembler.GetView(&gImageView);
         }
 
-        // If so, drain the cache until there is just one left
-        while (gCount != 1)
-        {
-            // Get the 3D data
-            PicopRc = PicoP_TLC_AcquireTofFrame(ConnectionHandle, 1, &gDataBuffer[0], &gRetFrame);
+        DrawFrame(Hdc);
+		EndPaint(hWnd, &PaintStruct);
+        break;
 
-            if (PicopRc != eSUCCESS)
-            {
-                memset((void*)Buffer, 0, MESSAGE_BUFFER_SIZE);
-                sprintf_s(Buffer, "PicoP_TLC_AcquireTofFrame() failed:  %d", PicopRc);
-                MessageBox(NULL, Buffer, "Error", MB_ICONEXCLAMATION);
-                break;
-            }
+	case WM_DESTROY:
+        gAcquisition.Stop();
 
-            gCount--;
+        // Acquisition no longer uses the connection
+        if (ConnectionHandle != NULL)
+        {
+            PicoP_TLC_CloseConnection(ConnectionHandle);
+            ConnectionHandle = NULL;
         }
 
-        // Store the 3D data in an array for later use
-        for (UINT32 i = 0; i < (NUM_PULSES * NUM_LINES); i++)
+        if (LibraryHandle != NULL)
         {
-            gTimeFrameBuffer[i] = gDataBuffer[i];
-            gAmplitudeFrameBuffer[i] = gDataBuffer[i + NUM_PULSES * NUM_LINES];
+            PicoP_TLC_CloseLibrary(LibraryHandle);
+            LibraryHandle = NULL;
         }
 
-        ::InvalidateRect(hWnd, 0, false);
-        ::SetTimer(hWnd, ID_TIMER, USER_TIMER_MINIMUM, 0);
-        break;
-
-    case WM_PAINT:
-		Hdc = BeginPaint(hWnd, &PaintStruct);
-        CreateAndBlitBitmap(Hdc);
-		EndPaint(hWnd, &PaintStruct);
-        break;
-
-	case WM_DESTROY:
+        gRenderer.Destroy();
 		PostQuitMessage(0);
 		break;
 	default:
@@ -17,30 +17,30 @@
 
 #include "resource.h"
 #include <windows.h>
+#include <vector>
 #include "PicoP_TLC_Api.h"
+#include "TofCore.h"
+#include "TofGdiRenderer.h"
 
 // ****************************************************************************
 
 #define MAX_LOADSTRING 50
 #define MESSAGE_BUFFER_SIZE     128
-#define ID_TIMER    1
+
+// Posted from the acquisition thread when reading frames fails, wParam is the PICOP_RC
+#define WM_TOF_ERROR    (WM_APP + 1)
 
 // Dimensions of the Window to display in
 #define X_DIM           520
-#define X_DIM_W_COLORS  (X_DIM * 3)
 #define Y_DIM           200
 
-#define NUM_PULSES 120
-#define NUM_LINES 720
-
-#define PIXEL_DATA_SIZE 2         // two pieces of data per pixel - time and amplitude
-#define FRAME_SIZE (NUM_PULSES * NUM_LINES * PIXEL_DATA_SIZE)
+// Where the 3D image is drawn in the window
+#define IMAGE_X_OFFSET  80
+#define IMAGE_HEIGHT    180
+#define IMAGE_MAX_WIDTH (X_DIM - IMAGE_X_OFFSET)
 
-//1, 2, 4 number of lines to combine due to phase/interleave
-#define N_LINES_COMBINE		1 
-
-#define PULSES_VIRTUAL  (NUM_PULSES * N_LINES_COMBINE)
-#define LINES_VIRTUAL   (NUM_LINES / N_LINES_COMBINE)
+// Frames buffered between the acquisition thread and the display
+#define FRAME_RING_SLOTS    4
 
 #define IDC_TIME_DATA	        101
 #define IDC_AMPLITUDE_DATA      102
@@ -60,8 +60,6 @@ HWND ghWndAmplitudeData;
 HGDIOBJ ghDefaultFont;
 LRESULT gTimeData;
 LRESULT gAmplitudeData;
-UINT32 gRetFrame = 0;
-UINT32 gCount = 0;
 BOOL gWhichData = TIME_DATA;
 
 PicoP_HANDLE LibraryHandle;
@@ -69,10 +67,22 @@ PICOP_RC PicopRc;
 PicoP_HANDLE ConnectionHandle;
 PicoP_USBInfo USB_Info = { 4, "1234" };
 
-unsigned char gWindowsFrameData[Y_DIM][X_DIM_W_COLORS];
-
-UINT32 gDataBuffer[FRAME_SIZE];
-UINT32 gTimeFrameBuffer[NUM_PULSES * NUM_LINES];
-UINT32 gAmplitudeFrameBuffer[NUM_PULSES * NUM_LINES];
+TofGdiRenderer gRenderer;
+TofColorizer gColorizer;
+TofPaletteE gPalette = eTOF_PALETTE_GRAY;
+TofNormalizer gTimeNormalizer;
+TofNormalizer gAmplitudeNormalizer;
+std::vector<UINT8> gDisplayPlane;               // Normalized copy of the plane being shown
+
+TofFrameGeometry gGeometry;                     // Read from the device once sensing is enabled
+
+TofFrameRing gFrameRing;
+TofAcquisition gAcquisition;
+TofFrameDecoder gDecoder;                       // Finds the time and amplitude planes in any data format
+TofFrameView gFrameView;                        // Newest frame, read in place from gFrameRing
+TofPhaseAssembler gPhaseAssembler;              // Merges phased frames into the full resolution image
+TofFrameView gImageView;                        // The image drawn, from gPhaseAssembler
+BOOL gFrameMerged = FALSE;                      // gPhaseAssembler holds at least one frame
+UINT32 gMergedSequence;                         // SequenceNumber of the last frame merged
 
 // ****************************************************************************
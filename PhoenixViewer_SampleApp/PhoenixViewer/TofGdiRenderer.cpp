@@ -0,0 +1,125 @@
+// ****************************************************************************
+//  TofGdiRenderer.cpp
+//
+// Windows backend for TofRenderer: a DIB section kept for the life of the window
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "stdafx.h"
+#include "TofGdiRenderer.h"
+
+// ****************************************************************************
+
+TofGdiRenderer::TofGdiRenderer()
+    : mMemDC(NULL),
+      mBitmap(NULL),
+      mOldBitmap(NULL)
+{
+}
+
+TofGdiRenderer::~TofGdiRenderer()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Creates the DIB section and selects it into a memory DC for good
+// ****************************************************************************
+
+PICOP_RC TofGdiRenderer::Create(UINT32 Width, UINT32 Height)
+{
+    BITMAPINFO info;
+    void* pPixels = NULL;
+
+
+    if ((Width == 0) || (Height == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    ZeroMemory(&info, sizeof(BITMAPINFO));
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biBitCount = 24;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biCompression = BI_RGB;
+    info.bmiHeader.biWidth = Width;
+    info.bmiHeader.biHeight = Height;       // Positive height, bottom-up rows
+
+    mMemDC = CreateCompatibleDC(NULL);
+
+    if (mMemDC == NULL)
+    {
+        return eFAILURE;
+    }
+
+    mBitmap = CreateDIBSection(mMemDC, &info, DIB_RGB_COLORS, &pPixels, NULL, 0);
+
+    if ((mBitmap == NULL) || (pPixels == NULL))
+    {
+        Destroy();
+        return eFAILURE;
+    }
+
+    mOldBitmap = SelectObject(mMemDC, mBitmap);
+    mStats.Allocations += 2;
+
+    mSurface.pPixels = (UINT8*)pPixels;
+    mSurface.Width = Width;
+    mSurface.Height = Height;
+    mSurface.Stride = TOF_SURFACE_STRIDE(Width);
+    ZeroMemory(mSurface.pPixels, (SIZE_T)mSurface.Stride * Height);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofGdiRenderer::Destroy()
+{
+    if (mMemDC != NULL)
+    {
+        if (mOldBitmap != NULL)
+        {
+            SelectObject(mMemDC, mOldBitmap);
+            mOldBitmap = NULL;
+        }
+
+        DeleteDC(mMemDC);
+        mMemDC = NULL;
+    }
+
+    if (mBitmap != NULL)
+    {
+        DeleteObject(mBitmap);
+        mBitmap = NULL;
+    }
+
+    ZeroMemory(&mSurface, sizeof(mSurface));
+}
+
+// ****************************************************************************
+//  Copies the back buffer to the window
+// ****************************************************************************
+
+BOOL TofGdiRenderer::Present(HDC hWinDC, int X, int Y)
+{
+    if (mMemDC == NULL)
+    {
+        return FALSE;
+    }
+
+    mStats.FramesPresented++;
+
+    return BitBlt(hWinDC, X, Y, mSurface.Width, mSurface.Height, mMemDC, 0, 0, SRCCOPY);
+}
+
+// ****************************************************************************
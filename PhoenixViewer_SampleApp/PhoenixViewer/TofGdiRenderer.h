@@ -0,0 +1,42 @@
+// ****************************************************************************
+//  TofGdiRenderer.h
+//
+// Windows backend for TofRenderer: a DIB section kept for the life of the window
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <windows.h>
+#include "TofRenderer.h"
+
+// ****************************************************************************
+// The DIB section and the memory DC it is selected into are created once, so
+// presenting a frame is a single BitBlt with no GDI allocation or SetDIBits copy.
+// ****************************************************************************
+
+class TofGdiRenderer : public TofRenderer
+{
+public:
+    TofGdiRenderer();
+    virtual ~TofGdiRenderer();
+
+    virtual PICOP_RC Create(UINT32 Width, UINT32 Height);
+    virtual void Destroy();
+
+    BOOL Present(HDC hWinDC, int X, int Y);
+
+private:
+    HDC mMemDC;
+    HBITMAP mBitmap;
+    HGDIOBJ mOldBitmap;
+};
+
+// ****************************************************************************
@@ -0,0 +1,134 @@
+// ****************************************************************************
+//  TofAcquisitionBench.cpp
+//
+// Event to consumer latency of TofAcquisition on the simulated device
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofBench.h"
+#include "TofSim.h"
+
+// ****************************************************************************
+// The simulated device signals eEVENT_TOF_DATA_FRAMES_RECEIVED the moment a
+// frame becomes readable. The latency measured is from that event to the
+// consumer holding the frame, which covers waking the acquisition thread,
+// reading the frame and handing it over. With a ring the consumer takes the
+// frame out of the ring, as the display thread would.
+// ****************************************************************************
+
+typedef struct
+{
+    std::mutex Lock;
+    std::vector<double> Samples;
+    TofFrameRing* pRing;
+} TofBenchConsumer;
+
+static void TofBenchOnFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofBenchConsumer* pConsumer = (TofBenchConsumer*)pContext;
+    const TofRingSlot* pSlot;
+    double Latency;
+
+
+    if (pFrame->Result != eSUCCESS)
+    {
+        return;
+    }
+
+    if (pConsumer->pRing != NULL)
+    {
+        pSlot = pConsumer->pRing->BeginRead();
+
+        if (pSlot == NULL)
+        {
+            return;
+        }
+
+        Latency = TofBenchMicroseconds(pSlot->EventTime, TofClock::now());
+        pConsumer->pRing->EndRead();
+    }
+    else
+    {
+        Latency = TofBenchMicroseconds(pFrame->EventTime, TofClock::now());
+    }
+
+    std::lock_guard<std::mutex> Lock(pConsumer->Lock);
+    pConsumer->Samples.push_back(Latency);
+}
+
+static void TofBenchLatency(const char* pName, PicoP_HANDLE Connection, TofAcquireModeE Mode,
+                            TofFrameRing* pRing, UINT32 Frames, UINT32 FrameRate)
+{
+    TofAcquisition Acquisition;
+    TofBenchConsumer Consumer;
+    TofBenchSummary Summary;
+
+
+    Consumer.pRing = pRing;
+    Acquisition.SetMode(Mode);
+    Acquisition.SetFrameRing(pRing);
+
+    if (Acquisition.Start(Connection, TofBenchOnFrame, &Consumer) != eSUCCESS)
+    {
+        printf("%s: Start failed\n", pName);
+        return;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds((Frames * 1000) / FrameRate + 100));
+    Acquisition.Stop();
+
+    TofBenchSummarize(&Consumer.Samples, &Summary);
+    printf("%-24s %5u frames  p50 %7.1f us  p99 %7.1f us  max %7.1f us\n",
+           pName, Summary.Count, Summary.P50, Summary.P99, Summary.Max);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Frames = TofBenchQuick(argc, argv) ? 20 : 2000;
+    UINT32 FrameRate = 100;
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofSimConfig Config;
+    TofFrameRing Ring;
+    UINT32 FrameBytes = 0;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.FrameRate = FrameRate;
+    TofSimSetConfig(&Config);
+
+    if ((PicoP_TLC_OpenLibrary(&Library) != eSUCCESS) ||
+        (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) != eSUCCESS) ||
+        (PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes) != eSUCCESS) ||
+        (Ring.Create(FrameBytes, 4) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    printf("%u fps, %u byte frames, event to consumer\n", FrameRate, FrameBytes);
+
+    TofBenchLatency("all frames", Connection, eTOF_ACQUIRE_ALL_FRAMES, NULL, Frames, FrameRate);
+    TofBenchLatency("latest only", Connection, eTOF_ACQUIRE_LATEST_ONLY, NULL, Frames, FrameRate);
+    TofBenchLatency("all frames into ring", Connection, eTOF_ACQUIRE_ALL_FRAMES, &Ring, Frames, FrameRate);
+
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+
+    return 0;
+}
+
+// ****************************************************************************
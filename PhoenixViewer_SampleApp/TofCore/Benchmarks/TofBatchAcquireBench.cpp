@@ -0,0 +1,150 @@
+// ****************************************************************************
+//  TofBatchAcquireBench.cpp
+//
+// Single frame, batched and latest-only draining of the device cache compared
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofBench.h"
+#include "TofSim.h"
+
+// ****************************************************************************
+//  The simulated device captures at 240 fps while the host drains its cache
+//  every 16 ms, as the viewer's WM_TIMER did, so about four frames are
+//  waiting at each drain. The three strategies are:
+//    single     one PicoP_TLC_AcquireTofFrame call per cached frame
+//    batch      TofAcquireBatch, up to TOF_ACQUISITION_MAX_BATCH per call
+//    latest     TofSkipFrames over the stale frames, then read the newest
+//  Calls per frame are PicoP_TLC_AcquireTofFrame calls per frame read off
+//  the device, each of which is a USB transaction on the real device.
+// ****************************************************************************
+
+#define TOF_BENCH_FRAME_RATE    240
+#define TOF_BENCH_POLL_MS       16
+
+typedef enum
+{
+    eTOF_BENCH_SINGLE = 0,
+    eTOF_BENCH_BATCH,
+    eTOF_BENCH_LATEST
+} TofBenchStrategyE;
+
+static void TofBenchDrain(const char* pName, PicoP_HANDLE Connection, UINT32 FrameWords,
+                          TofBenchStrategyE Strategy, UINT32 Polls)
+{
+    std::vector<UINT32> Arena((size_t)FrameWords * TOF_ACQUISITION_MAX_BATCH);
+    std::vector<double> Samples;
+    TofBenchSummary Summary;
+    TofClock::time_point Start;
+    TofClock::time_point PollStart;
+    UINT32 Count = 0;
+    UINT32 RetFrame = 0;
+    UINT32 Skipped = 0;
+    UINT32 Calls = 0;
+    UINT32 FramesRead = 0;
+    UINT32 FramesDelivered = 0;
+    UINT32 TotalCalls = 0;
+    double Seconds;
+
+
+    // Start every strategy from an empty cache
+    PicoP_TLC_GetTofFrameCount(Connection, &Count);
+    TofSkipFrames(Connection, FrameWords, Count, &Arena[0], (UINT32)Arena.size(), &Skipped, &Calls);
+
+    Start = TofClock::now();
+
+    for (UINT32 Poll = 0; Poll < Polls; Poll++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TOF_BENCH_POLL_MS));
+
+        PollStart = TofClock::now();
+
+        if (PicoP_TLC_GetTofFrameCount(Connection, &Count) != eSUCCESS)
+        {
+            break;
+        }
+
+        if ((Strategy == eTOF_BENCH_LATEST) && (Count > 1))
+        {
+            TofSkipFrames(Connection, FrameWords, Count - 1, &Arena[0], (UINT32)Arena.size(), &Skipped, &Calls);
+            FramesRead += Skipped;
+            TotalCalls += Calls;
+            Count = (Skipped < Count) ? (Count - Skipped) : 0;
+        }
+
+        while (Count != 0)
+        {
+            TofAcquireBatch(Connection, FrameWords, (Strategy == eTOF_BENCH_BATCH) ? Count : 1,
+                            &Arena[0], (UINT32)Arena.size(), &RetFrame);
+            TotalCalls++;
+
+            if (RetFrame == 0)
+            {
+                break;
+            }
+
+            FramesRead += RetFrame;
+            FramesDelivered += RetFrame;
+            Count = (RetFrame < Count) ? (Count - RetFrame) : 0;
+        }
+
+        Samples.push_back(TofBenchMicroseconds(PollStart, TofClock::now()));
+    }
+
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    TofBenchSummarize(&Samples, &Summary);
+
+    printf("%-8s read %5u  delivered %5u  %6.1f frames/s delivered  %4.2f calls/frame  drain p50 %7.1f us  p99 %7.1f us\n",
+           pName, FramesRead, FramesDelivered, FramesDelivered / Seconds,
+           (FramesRead != 0) ? ((double)TotalCalls / FramesRead) : 0.0, Summary.P50, Summary.P99);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Polls = TofBenchQuick(argc, argv) ? 10 : 300;
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofSimConfig Config;
+    UINT32 FrameBytes = 0;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.FrameRate = TOF_BENCH_FRAME_RATE;
+    Config.LatencyUs = 1000;
+    Config.JitterUs = 0;
+    TofSimSetConfig(&Config);
+
+    if ((PicoP_TLC_OpenLibrary(&Library) != eSUCCESS) ||
+        (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) != eSUCCESS) ||
+        (PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    printf("%u fps, %u byte frames, drained every %u ms, %u drains\n",
+           TOF_BENCH_FRAME_RATE, FrameBytes, TOF_BENCH_POLL_MS, Polls);
+
+    TofBenchDrain("single", Connection, FrameBytes / sizeof(UINT32), eTOF_BENCH_SINGLE, Polls);
+    TofBenchDrain("batch", Connection, FrameBytes / sizeof(UINT32), eTOF_BENCH_BATCH, Polls);
+    TofBenchDrain("latest", Connection, FrameBytes / sizeof(UINT32), eTOF_BENCH_LATEST, Polls);
+
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,130 @@
+// ****************************************************************************
+//  TofBench.h
+//
+// Timing helpers shared by the TofCore benchmarks
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFrameRing.h"
+
+// ****************************************************************************
+// Every benchmark is a plain executable printing one line per measurement.
+// ctest runs them with --quick, which cuts the iteration counts so the run
+// only shows that they still work; the figures worth quoting come from a
+// full run of a Release build.
+// ****************************************************************************
+
+typedef struct
+{
+    double Mean;
+    double Min;
+    double P50;
+    double P99;
+    double Max;
+    UINT32 Count;
+} TofBenchSummary;
+
+// ****************************************************************************
+
+inline BOOL TofBenchQuick(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+inline double TofBenchMicroseconds(TofClock::time_point Start, TofClock::time_point End)
+{
+    return std::chrono::duration<double, std::micro>(End - Start).count();
+}
+
+// Sorts the samples
+inline void TofBenchSummarize(std::vector<double>* pSamples, TofBenchSummary* pSummary)
+{
+    std::vector<double>& Samples = *pSamples;
+    double Sum = 0.0;
+
+
+    memset(pSummary, 0, sizeof(TofBenchSummary));
+
+    if (Samples.empty())
+    {
+        return;
+    }
+
+    std::sort(Samples.begin(), Samples.end());
+
+    for (size_t i = 0; i < Samples.size(); i++)
+    {
+        Sum += Samples[i];
+    }
+
+    pSummary->Count = (UINT32)Samples.size();
+    pSummary->Mean = Sum / Samples.size();
+    pSummary->Min = Samples.front();
+    pSummary->Max = Samples.back();
+    pSummary->P50 = Samples[(Samples.size() - 1) / 2];
+    pSummary->P99 = Samples[((Samples.size() - 1) * 99) / 100];
+}
+
+// Times Iterations calls of Function, in microseconds, after a short warm up
+template <typename FunctionT>
+inline void TofBenchRun(UINT32 Iterations, FunctionT Function, TofBenchSummary* pSummary)
+{
+    std::vector<double> Samples;
+    TofClock::time_point Start;
+
+
+    for (UINT32 i = 0; i < ((Iterations < 3) ? Iterations : 3); i++)
+    {
+        Function();
+    }
+
+    Samples.reserve(Iterations);
+
+    for (UINT32 i = 0; i < Iterations; i++)
+    {
+        Start = TofClock::now();
+        Function();
+        Samples.push_back(TofBenchMicroseconds(Start, TofClock::now()));
+    }
+
+    TofBenchSummarize(&Samples, pSummary);
+}
+
+inline void TofBenchPrint(const char* pName, const TofBenchSummary* pSummary, const char* pUnit)
+{
+    printf("%-44s mean %10.2f  p50 %10.2f  p99 %10.2f  min %10.2f  %s\n",
+           pName, pSummary->Mean, pSummary->P50, pSummary->P99, pSummary->Min, pUnit);
+}
+
+// Keeps the compiler from dropping work whose result is never used
+inline void TofBenchKeep(UINT32 Value)
+{
+    static volatile UINT32 sSink;
+
+    sSink = sSink + Value;
+}
+
+// ****************************************************************************
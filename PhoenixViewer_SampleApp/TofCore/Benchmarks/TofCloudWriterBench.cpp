@@ -0,0 +1,115 @@
+// ****************************************************************************
+//  TofCloudWriterBench.cpp
+//
+// Continuous export rate of the PCD and PLY writer
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "TofBench.h"
+#include "TofCloudWriter.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Feeds 120 x 720 (86,400 point) frames to the writer back to back, as an
+// acquisition thread with no frame rate limit would, for each file format.
+// A frame the writer has no buffer for is retried after a short sleep, so
+// the rates are what the disk and the writer thread sustain. MB/s is of
+// bytes written to disk. The valid only run uses the median amplitude as
+// its threshold, so at least half the points are kept. The files are
+// removed afterwards.
+// ****************************************************************************
+
+#define TOF_BENCH_PREFIX        "TofCloudWriterBench_"
+
+int main(int argc, char** argv)
+{
+    static const TofCloudFileFormatE sFormats[] = { eTOF_CLOUD_PCD_BINARY, eTOF_CLOUD_PCD_BINARY_COMPRESSED,
+                                                    eTOF_CLOUD_PLY, eTOF_CLOUD_PCD_BINARY };
+    static const char* sNames[] = { "pcd binary", "pcd binary_compressed", "ply", "pcd binary, valid only" };
+    UINT32 Frames = TofBenchQuick(argc, argv) ? 8 : 500;
+    TofFrameGeometry Geometry;
+    TofScanGeometry Scan;
+    std::vector<UINT32> Data[4];
+    std::vector<UINT32> Amplitudes;
+    TofFrameView Views[4];
+    TofCloudWriter Writer;
+    TofCloudWriterStats Stats;
+    TofClock::time_point Start;
+    UINT32 Median;
+    UINT32 Retries;
+    double Seconds;
+    char FileName[64];
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < 4; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Data[i]);
+        TofMakeFrameView(&Data[i][0], (UINT32)Data[i].size(), 120, 720, eTOF_DATA_FUSED, &Views[i]);
+    }
+
+    Amplitudes.assign(Views[0].pAmplitude, Views[0].pAmplitude + (120 * 720));
+    std::nth_element(Amplitudes.begin(), Amplitudes.begin() + Amplitudes.size() / 2, Amplitudes.end());
+    Median = Amplitudes[Amplitudes.size() / 2];
+
+    TofDefaultScanGeometry(&Scan);
+    printf("%u frames of 120 x 720 points per format\n", Frames);
+
+    for (UINT32 f = 0; f < sizeof(sFormats) / sizeof(sFormats[0]); f++)
+    {
+        Writer.SetMinAmplitude((f == 3) ? Median : 0);
+
+        if (Writer.Open(TOF_BENCH_PREFIX, sFormats[f], &Scan, 120, 720) != eSUCCESS)
+        {
+            printf("%s: open failed\n", sNames[f]);
+            return 1;
+        }
+
+        Retries = 0;
+        Start = TofClock::now();
+
+        for (UINT32 i = 0; i < Frames; i++)
+        {
+            while (Writer.Write(&Views[i % 4], i) == eBUSY)
+            {
+                Retries++;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+
+        Writer.Close();
+        Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+        Writer.GetStats(&Stats);
+
+        printf("%-24s %7.1f files/s  %7.1f MB/s  %6.2f MB/file  %u failed  %u busy retries\n",
+               sNames[f], Stats.FilesWritten / Seconds, Stats.BytesWritten / (1024.0 * 1024.0) / Seconds,
+               Stats.BytesWritten / (1024.0 * 1024.0) / ((Stats.FilesWritten != 0) ? Stats.FilesWritten : 1),
+               Stats.FilesFailed, Retries);
+
+        for (UINT32 i = 0; i < Frames; i++)
+        {
+            snprintf(FileName, sizeof(FileName), TOF_BENCH_PREFIX "%08u%s", i,
+                     (sFormats[f] == eTOF_CLOUD_PLY) ? ".ply" : ".pcd");
+            remove(FileName);
+        }
+    }
+
+    return 0;
+}
+
+// ****************************************************************************
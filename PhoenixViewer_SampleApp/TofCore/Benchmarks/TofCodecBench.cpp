@@ -0,0 +1,207 @@
+// ****************************************************************************
+//  TofCodecBench.cpp
+//
+// Compression ratio and throughput of the frame codec
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "TofBench.h"
+#include "TofCodec.h"
+#include "TofRecording.h"
+#include "TofSim.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Runs the codec over the same frames twice: frames rendered directly, and
+// frames captured from the simulated device into a recording and replayed
+// from it, as an offline recompression would see them. Encode and decode
+// are timed across frames at 1, 2 and 4 threads, one key frame in every
+// TOF_BENCH_KEY_INTERVAL. MB/s are of raw frame data.
+// ****************************************************************************
+
+#define TOF_BENCH_KEY_INTERVAL  8
+#define TOF_BENCH_FILE_NAME     "TofCodecBench.tofrec"
+
+static void TofBenchCodec(const char* pName, const std::vector<UINT32>* pFrames, UINT32 FrameCount,
+                          UINT32 FrameWords, UINT32 LineWords)
+{
+    static const UINT32 sThreads[] = { 1, 2, 4 };
+    std::vector<std::vector<UINT8> > Encoded;
+    std::vector<UINT32> Decoded(pFrames->size());
+    TofClock::time_point Start;
+    double EncodeSeconds;
+    double DecodeSeconds;
+    double MegaBytes = (double)pFrames->size() * sizeof(UINT32) / (1024.0 * 1024.0);
+    size_t EncodedBytes;
+
+
+    // Untimed, so the first row does not pay for the first touch of the buffers
+    TofEncodeFrames(&(*pFrames)[0], FrameCount, FrameWords, LineWords, TOF_BENCH_KEY_INTERVAL, 1, &Encoded);
+
+    for (UINT32 i = 0; i < sizeof(sThreads) / sizeof(sThreads[0]); i++)
+    {
+        Start = TofClock::now();
+
+        if (TofEncodeFrames(&(*pFrames)[0], FrameCount, FrameWords, LineWords, TOF_BENCH_KEY_INTERVAL,
+                            sThreads[i], &Encoded) != eSUCCESS)
+        {
+            printf("%s: encode failed\n", pName);
+            return;
+        }
+
+        EncodeSeconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+        Start = TofClock::now();
+
+        if (TofDecodeFrames(Encoded, TOF_BENCH_KEY_INTERVAL, sThreads[i], &Decoded[0], FrameWords) != eSUCCESS)
+        {
+            printf("%s: decode failed\n", pName);
+            return;
+        }
+
+        DecodeSeconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+        EncodedBytes = 0;
+
+        for (size_t j = 0; j < Encoded.size(); j++)
+        {
+            EncodedBytes += Encoded[j].size();
+        }
+
+        printf("%-10s %u thread%s  ratio %5.2f:1  encode %7.1f MB/s  decode %7.1f MB/s%s\n",
+               pName, sThreads[i], (sThreads[i] == 1) ? " " : "s",
+               (double)pFrames->size() * sizeof(UINT32) / EncodedBytes,
+               MegaBytes / EncodeSeconds, MegaBytes / DecodeSeconds,
+               (Decoded == *pFrames) ? "" : "  MISMATCH");
+    }
+}
+
+// ****************************************************************************
+//  Records FrameCount frames from the simulated device, then reads them back
+//  from the file
+// ****************************************************************************
+
+static BOOL TofBenchReplay(UINT32 FrameCount, TofFrameGeometry* pGeometry, std::vector<UINT32>* pFrames)
+{
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    PicoP_TofPulsingConfig Config;
+    TofSimConfig SimConfig;
+    TofRecorder Recorder;
+    TofRecordingReader Reader;
+    TofRecordedFrame Recorded;
+    std::vector<UINT32> Frame;
+    TofClock::time_point Now;
+    UINT32 Captured = 0;
+    UINT32 Count;
+    BOOL Result = FALSE;
+
+
+    TofSimDefaultConfig(&SimConfig);
+    SimConfig.FrameRate = 1000;
+    SimConfig.QueueDepth = FrameCount;
+    TofSimSetConfig(&SimConfig);
+
+    if ((PicoP_TLC_OpenLibrary(&Library) != eSUCCESS) ||
+        (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) != eSUCCESS) ||
+        (TofQueryFrameGeometry(Connection, pGeometry) != eSUCCESS) ||
+        (PicoP_TLC_GetTofPulsingConfig(Connection, &Config, eCURRENT_VALUE) != eSUCCESS) ||
+        (Recorder.Open(TOF_BENCH_FILE_NAME, &Config, pGeometry->Format, pGeometry->FrameBytes) != eSUCCESS))
+    {
+        PicoP_TLC_CloseConnection(Connection);
+        PicoP_TLC_CloseLibrary(Library);
+        return FALSE;
+    }
+
+    Frame.resize(pGeometry->FrameWords);
+
+    while (Captured < FrameCount)
+    {
+        if ((PicoP_TLC_AcquireTofFrame(Connection, 1, &Frame[0], &Count) != eSUCCESS) || (Count == 0))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        Now = TofClock::now();
+
+        while (Recorder.Write(&Frame[0], Captured, Now, Now) == eBUSY)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        Captured++;
+    }
+
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+
+    if ((Recorder.Close() == eSUCCESS) && (Reader.Open(TOF_BENCH_FILE_NAME) == eSUCCESS))
+    {
+        pFrames->clear();
+
+        for (UINT32 i = 0; i < Reader.GetFrameCount(); i++)
+        {
+            if (Reader.GetFrame(i, &Recorded) == eSUCCESS)
+            {
+                pFrames->insert(pFrames->end(), Recorded.pData, Recorded.pData + Recorded.FrameWords);
+            }
+        }
+
+        Result = (pFrames->size() == (size_t)FrameCount * pGeometry->FrameWords);
+        Reader.Close();
+    }
+
+    remove(TOF_BENCH_FILE_NAME);
+
+    return Result;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 FrameCount = TofBenchQuick(argc, argv) ? 16 : 240;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Frames;
+    std::vector<UINT32> Frame;
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < FrameCount; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Frame);
+        Frames.insert(Frames.end(), Frame.begin(), Frame.end());
+    }
+
+    printf("%u frames of %u bytes, key frame every %u, %u hardware threads\n", FrameCount,
+           Geometry.FrameBytes, TOF_BENCH_KEY_INTERVAL, std::thread::hardware_concurrency());
+
+    TofBenchCodec("synthetic", &Frames, FrameCount, Geometry.FrameWords, Geometry.NumPulses);
+
+    if ( ! TofBenchReplay(FrameCount, &Geometry, &Frames))
+    {
+        printf("replayed: recording failed\n");
+        return 1;
+    }
+
+    TofBenchCodec("replayed", &Frames, FrameCount, Geometry.FrameWords, Geometry.NumPulses);
+
+    return 0;
+}
+
+// ****************************************************************************
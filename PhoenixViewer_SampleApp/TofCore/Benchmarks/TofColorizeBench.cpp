@@ -0,0 +1,110 @@
+// ****************************************************************************
+//  TofColorizeBench.cpp
+//
+// Scalar against SIMD paths of the depth to bitmap conversion
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofBench.h"
+#include "TofColorize.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  A simulated 120 x 720 time plane drawn into the viewer's 520 x 200 bitmap.
+//  The per-pixel loop is the viewer's original CreateAndBlitBitmap body; the
+//  narrowing step is timed with the scalar and the vector code; the last
+//  lines are the whole TofColorizer draw, which narrows with the vector code.
+// ****************************************************************************
+
+#define TOF_BENCH_BITMAP_WIDTH  520
+#define TOF_BENCH_BITMAP_HEIGHT 200
+#define TOF_BENCH_BITMAP_STRIDE (TOF_BENCH_BITMAP_WIDTH * TOF_BYTES_PER_PIXEL)
+
+static void TofBenchPerPixel(const UINT32* pPlane, UINT32 NumPulses, UINT32 NumLines, UINT8* pBitmap)
+{
+    UINT32 X;
+    UINT32 Y;
+    UINT8 Value;
+
+
+    for (UINT32 Line = 0; Line < NumLines; Line++)
+    {
+        for (UINT32 Pulse = 0; Pulse < NumPulses; Pulse++)
+        {
+            Value = (UINT8)(pPlane[Line * NumPulses + Pulse] & 0x000000ff);
+            X = (((Pulse * NumPulses) / NumPulses) + 80) * 3;
+            Y = ((NumLines - Line) * 180) / NumLines;
+
+            pBitmap[Y * TOF_BENCH_BITMAP_STRIDE + X + 0] = Value;
+            pBitmap[Y * TOF_BENCH_BITMAP_STRIDE + X + 1] = Value;
+            pBitmap[Y * TOF_BENCH_BITMAP_STRIDE + X + 2] = Value;
+        }
+    }
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 20 : 2000;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Narrowed;
+    std::vector<UINT8> Bitmap(TOF_BENCH_BITMAP_STRIDE * TOF_BENCH_BITMAP_HEIGHT);
+    TofColorizer Colorizer;
+    TofBenchSummary Summary;
+
+
+    if ((TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS) ||
+        (Colorizer.Create(Geometry.NumPulses, Geometry.NumLines, TOF_BENCH_BITMAP_WIDTH, TOF_BENCH_BITMAP_HEIGHT,
+                          TOF_BENCH_BITMAP_STRIDE, 80, Geometry.NumPulses, 180) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+    Narrowed.resize(Geometry.PlaneWords);
+
+#if defined(TOF_SIMD_AVX2)
+    printf("%u x %u plane, AVX2 build, %u iterations, times in us per frame\n",
+           Geometry.NumPulses, Geometry.NumLines, Iterations);
+#else
+    printf("%u x %u plane, %u iterations, times in us per frame\n",
+           Geometry.NumPulses, Geometry.NumLines, Iterations);
+#endif
+
+    TofBenchRun(Iterations, [&]() { TofBenchPerPixel(&Data[0], Geometry.NumPulses, Geometry.NumLines, &Bitmap[0]); },
+                &Summary);
+    TofBenchPrint("per-pixel loop", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]() { TofNarrowLowByteScalar(&Data[0], &Narrowed[0], Geometry.PlaneWords); }, &Summary);
+    TofBenchPrint("TofNarrowLowByteScalar, whole plane", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]() { TofNarrowLowByte(&Data[0], &Narrowed[0], Geometry.PlaneWords); }, &Summary);
+    TofBenchPrint("TofNarrowLowByte, whole plane", &Summary, "us");
+
+    Colorizer.SetPalette(eTOF_PALETTE_GRAY);
+    TofBenchRun(Iterations, [&]() { Colorizer.Colorize(&Data[0], &Bitmap[0]); }, &Summary);
+    TofBenchPrint("TofColorizer::Colorize, gray", &Summary, "us");
+
+    Colorizer.SetPalette(eTOF_PALETTE_FALSE_COLOR);
+    TofBenchRun(Iterations, [&]() { Colorizer.Colorize(&Data[0], &Bitmap[0]); }, &Summary);
+    TofBenchPrint("TofColorizer::Colorize, false color", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]() { Colorizer.ColorizeNarrowed(&Narrowed[0], &Bitmap[0]); }, &Summary);
+    TofBenchPrint("TofColorizer::ColorizeNarrowed", &Summary, "us");
+
+    TofBenchKeep(Bitmap[TOF_BENCH_BITMAP_STRIDE * 90 + 300] + Narrowed[1000]);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,255 @@
+// ****************************************************************************
+//  TofDOutBGovernorBench.cpp
+//
+// Sweeps the simulated device's readout and link rates under the TDC B scale governor
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofBench.h"
+#include "TofDOutBGovernor.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+
+// ****************************************************************************
+// The simulated device captures the room at 30 fps in eTOF_DATA_ALL, 120 x
+// 720. A frame is 1.38 MB on the link at any TDC B scale. Reading it out of
+// the detectors takes 0.69 MB of TDC A plus up to 0.69 MB of TDC B,
+// depending on the scale. Each point of a sweep runs twice on a fresh
+// connection, once at full scale and once under the governor:
+//
+//   readout   TdcBytesPerSecond stepped down, link unlimited. At full scale
+//             frames need 41.5 MB/s of readout, so the scale should fall
+//             just far enough to hold 30 fps.
+//   link      LinkBytesPerSecond stepped down, readout unlimited. The scale
+//             cannot help; the governor should see its step down fail and
+//             hold the scale at full.
+//
+// Every frame goes through MeasureFrame() on the acquisition thread. The
+// figures are the mean and sd of the frame rate over 500 ms windows, after
+// the first half of the run, and the scale at the end. --quick runs one
+// point of each sweep with shorter windows.
+// ****************************************************************************
+
+#define TOF_BENCH_WINDOW_MS     500
+#define TOF_BENCH_MB            1000000u
+
+typedef struct
+{
+    std::atomic<UINT32> Frames;
+    TofDOutBGovernor* pGovernor;
+} TofBenchConsumer;
+
+typedef struct
+{
+    FP32 Mean;
+    FP32 Sd;
+    UINT32 Scale;
+    BOOL Held;
+} TofBenchResult;
+
+static void TofBenchOnFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofBenchConsumer* pConsumer = (TofBenchConsumer*)pContext;
+
+
+    if (pFrame->Result != eSUCCESS)
+    {
+        return;
+    }
+
+    if (pConsumer->pGovernor != NULL)
+    {
+        pConsumer->pGovernor->MeasureFrame(pFrame->pData, pFrame->FrameWords);
+    }
+
+    pConsumer->Frames++;
+}
+
+// ****************************************************************************
+//  One run of RunMs, governed when Params is given
+// ****************************************************************************
+
+static BOOL TofBenchDrive(PicoP_HANDLE Connection, const TofDOutBGovernorParams* pParams, UINT32 RunMs,
+                          TofBenchResult* pResult)
+{
+    TofFrameGeometry Geometry;
+    TofAcquisition Acquisition;
+    TofDOutBGovernor Governor;
+    TofDOutBGovernorStats Stats;
+    TofBenchConsumer Consumer;
+    TofClock::time_point Start;
+    TofClock::time_point WindowStart;
+    TofClock::time_point Now;
+    std::vector<FP32> Fps;
+    UINT32 WindowFrames = 0;
+    FP32 Seconds;
+    double Sum = 0.0;
+    double SumSquares = 0.0;
+    size_t First;
+
+
+    Consumer.Frames = 0;
+    Consumer.pGovernor = (pParams != NULL) ? &Governor : NULL;
+
+    if ((TofQueryFrameGeometry(Connection, &Geometry) != eSUCCESS) ||
+        ((pParams != NULL) && (Governor.Create(pParams, &Geometry, DOUTB_SCALE_MAX) != eSUCCESS)) ||
+        (Acquisition.Start(Connection, TofBenchOnFrame, &Consumer) != eSUCCESS))
+    {
+        return FALSE;
+    }
+
+    Start = TofClock::now();
+    WindowStart = Start;
+
+    for (Now = Start; Now < (Start + std::chrono::milliseconds(RunMs)); )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Now = TofClock::now();
+
+        if ((pParams != NULL) && Governor.Update(Now, Consumer.Frames))
+        {
+            Governor.Apply(Connection);
+        }
+
+        Seconds = std::chrono::duration<FP32>(Now - WindowStart).count();
+
+        if (Seconds >= (TOF_BENCH_WINDOW_MS / 1000.0f))
+        {
+            Fps.push_back((Consumer.Frames - WindowFrames) / Seconds);
+            WindowStart = Now;
+            WindowFrames = Consumer.Frames;
+        }
+    }
+
+    Acquisition.Stop();
+
+    First = Fps.size() / 2;
+
+    for (size_t i = First; i < Fps.size(); i++)
+    {
+        Sum += Fps[i];
+        SumSquares += (double)Fps[i] * Fps[i];
+    }
+
+    pResult->Mean = (Fps.size() > First) ? (FP32)(Sum / (Fps.size() - First)) : 0.0f;
+    pResult->Sd = (Fps.size() > First) ?
+                  (FP32)sqrt(fmax(0.0, (SumSquares / (Fps.size() - First)) - ((double)pResult->Mean * pResult->Mean))) :
+                  0.0f;
+    pResult->Scale = DOUTB_SCALE_MAX;
+    pResult->Held = FALSE;
+
+    if (pParams != NULL)
+    {
+        Governor.GetStats(&Stats);
+        pResult->Scale = Governor.GetScale();
+        pResult->Held = Stats.Held;
+    }
+
+    return TRUE;
+}
+
+// A fresh connection in eTOF_DATA_ALL at full scale for every run
+static BOOL TofBenchPhase(UINT32 TdcBytesPerSecond, UINT32 LinkBytesPerSecond, const TofDOutBGovernorParams* pParams,
+                          UINT32 RunMs, TofBenchResult* pResult)
+{
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofSimConfig Config;
+    BOOL Result = FALSE;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.TdcBytesPerSecond = TdcBytesPerSecond;
+    Config.LinkBytesPerSecond = LinkBytesPerSecond;
+    TofSimSetConfig(&Config);
+
+    if ((PicoP_TLC_OpenLibrary(&Library) == eSUCCESS) &&
+        (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) == eSUCCESS))
+    {
+        PicoP_TLC_SetSensingState(Connection, eSENSING_DISABLED, FALSE);
+        PicoP_TLC_SetTofDataFormat(Connection, eTOF_DATA_ALL, FALSE);
+        PicoP_TLC_SetDOutBScale(Connection, DOUTB_SCALE_MAX, FALSE);
+        PicoP_TLC_SetSensingState(Connection, eSENSING_ENABLED, FALSE);
+
+        Result = TofBenchDrive(Connection, pParams, RunMs, pResult);
+        PicoP_TLC_CloseConnection(Connection);
+    }
+
+    PicoP_TLC_CloseLibrary(Library);
+
+    return Result;
+}
+
+// ****************************************************************************
+
+static BOOL TofBenchSweep(const char* pName, const UINT32* pRates, UINT32 Count, BOOL Readout,
+                          const TofDOutBGovernorParams* pParams, UINT32 RunMs)
+{
+    TofBenchResult Fixed;
+    TofBenchResult Governed;
+    UINT32 Tdc;
+    UINT32 Link;
+
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        Tdc = Readout ? (pRates[i] * TOF_BENCH_MB) : 0;
+        Link = Readout ? 0 : (pRates[i] * TOF_BENCH_MB);
+
+        if (( ! TofBenchPhase(Tdc, Link, NULL, RunMs, &Fixed)) || ( ! TofBenchPhase(Tdc, Link, pParams, RunMs, &Governed)))
+        {
+            printf("%s %u MB/s: the simulated device failed\n", pName, pRates[i]);
+            return FALSE;
+        }
+
+        printf("%-7s %3u MB/s  fixed %5.1f fps (sd %4.2f)  governed %5.1f fps (sd %4.2f)  scale %4.2f%s\n",
+               pName, pRates[i], Fixed.Mean, Fixed.Sd, Governed.Mean, Governed.Sd,
+               (FP32)Governed.Scale / DOUTB_SCALE_MAX, Governed.Held ? "  held" : "");
+    }
+
+    return TRUE;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const UINT32 sReadoutRates[] = { 48, 40, 36, 32, 28, 24 };
+    static const UINT32 sLinkRates[] = { 48, 40, 32, 24 };
+    BOOL Quick = TofBenchQuick(argc, argv);
+    UINT32 RunMs = Quick ? 3000 : 16000;
+    TofDOutBGovernorParams Params;
+
+
+    TofDefaultDOutBGovernorParams(&Params);
+    Params.WindowMs = Quick ? 250 : Params.WindowMs;
+
+    printf("30 fps, eTOF_DATA_ALL 120 x 720, %u ms a run, %u ms governor windows\n", RunMs, Params.WindowMs);
+
+    if (( ! TofBenchSweep("readout", Quick ? &sReadoutRates[2] : sReadoutRates,
+                          Quick ? 1 : (UINT32)(sizeof(sReadoutRates) / sizeof(sReadoutRates[0])), TRUE, &Params, RunMs)) ||
+        ( ! TofBenchSweep("link", Quick ? &sLinkRates[2] : sLinkRates,
+                          Quick ? 1 : (UINT32)(sizeof(sLinkRates) / sizeof(sLinkRates[0])), FALSE, &Params, RunMs)))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+// ****************************************************************************
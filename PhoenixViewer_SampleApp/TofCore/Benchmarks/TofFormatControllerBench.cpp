@@ -0,0 +1,259 @@
+// ****************************************************************************
+//  TofFormatControllerBench.cpp
+//
+// Sweeps the simulated device's link and readout rates under the format controller
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofBench.h"
+#include "TofFormatController.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+
+// ****************************************************************************
+// The simulated device captures the room at 30 fps, 120 x 720. At that rate
+// ALL frames need about 41 MB/s of the link and fused ones 21 MB/s; reading
+// an ALL frame out of the detectors takes 41 MB/s with TDC B in full and
+// 31 MB/s at half scale. Each point of a sweep runs twice on a fresh
+// connection in eTOF_DATA_ALL at full scale, once left there and once under
+// the controller with the default ladder:
+//
+//   link      LinkBytesPerSecond stepped down, readout unlimited. Half scale
+//             sends as many bytes, so the controller should pass it and
+//             settle on fused once the link is below ALL.
+//   readout   TdcBytesPerSecond stepped down, link unlimited. The controller
+//             should stop at half scale and keep both detectors while that
+//             is enough.
+//
+// The figures are the mean and sd of the frame rate over 500 ms windows in
+// the last SteadyMs of the run, the level at the end and the switches made.
+// Probing the level above is held off for the run so the steady rate is not
+// disturbed by it. --quick runs one point of each sweep, for less time.
+// ****************************************************************************
+
+#define TOF_BENCH_WINDOW_MS     500
+#define TOF_BENCH_MB            1000000u
+
+typedef struct
+{
+    std::atomic<UINT32> Frames;
+} TofBenchConsumer;
+
+typedef struct
+{
+    FP32 Mean;
+    FP32 Sd;
+    UINT32 Level;
+    UINT32 Switches;
+} TofBenchResult;
+
+static void TofBenchOnFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofBenchConsumer* pConsumer = (TofBenchConsumer*)pContext;
+
+
+    if (pFrame->Result == eSUCCESS)
+    {
+        pConsumer->Frames++;
+    }
+}
+
+// ****************************************************************************
+//  One run of RunMs, controlled when Params is given, driving the
+//  controller every 20 ms
+// ****************************************************************************
+
+static BOOL TofBenchDrive(PicoP_HANDLE Connection, const TofFormatControlParams* pParams, UINT32 RunMs,
+                          UINT32 SteadyMs, TofBenchResult* pResult)
+{
+    TofFrameGeometry Geometry;
+    TofAcquisition Acquisition;
+    TofFormatController Controller;
+    TofFormatControlStats Stats;
+    TofBenchConsumer Consumer;
+    TofClock::time_point Start;
+    TofClock::time_point WindowStart;
+    TofClock::time_point Now;
+    std::vector<FP32> Fps;
+    UINT32 WindowFrames = 0;
+    UINT32 Depth;
+    FP32 Seconds;
+    double Sum = 0.0;
+    double SumSquares = 0.0;
+    size_t First;
+
+
+    Consumer.Frames = 0;
+
+    if ((TofQueryFrameGeometry(Connection, &Geometry) != eSUCCESS) ||
+        ((pParams != NULL) && (Controller.Create(pParams, &Geometry, DOUTB_SCALE_MAX) != eSUCCESS)) ||
+        (Acquisition.Start(Connection, TofBenchOnFrame, &Consumer) != eSUCCESS))
+    {
+        return FALSE;
+    }
+
+    Start = TofClock::now();
+    WindowStart = Start;
+
+    for (Now = Start; Now < (Start + std::chrono::milliseconds(RunMs)); )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Now = TofClock::now();
+
+        if (pParams != NULL)
+        {
+            Depth = 0;
+            PicoP_TLC_GetTofFrameCount(Connection, &Depth);
+
+            if (Controller.Update(Now, Consumer.Frames, Depth))
+            {
+                Controller.Apply(Connection, &Acquisition);
+            }
+        }
+
+        Seconds = std::chrono::duration<FP32>(Now - WindowStart).count();
+
+        if (Seconds >= (TOF_BENCH_WINDOW_MS / 1000.0f))
+        {
+            Fps.push_back((Consumer.Frames - WindowFrames) / Seconds);
+            WindowStart = Now;
+            WindowFrames = Consumer.Frames;
+        }
+    }
+
+    Acquisition.Stop();
+
+    First = Fps.size() - std::min(Fps.size(), (size_t)(SteadyMs / TOF_BENCH_WINDOW_MS));
+
+    for (size_t i = First; i < Fps.size(); i++)
+    {
+        Sum += Fps[i];
+        SumSquares += (double)Fps[i] * Fps[i];
+    }
+
+    pResult->Mean = (Fps.size() > First) ? (FP32)(Sum / (Fps.size() - First)) : 0.0f;
+    pResult->Sd = (Fps.size() > First) ?
+                  (FP32)sqrt(fmax(0.0, (SumSquares / (Fps.size() - First)) - ((double)pResult->Mean * pResult->Mean))) :
+                  0.0f;
+    pResult->Level = 0;
+    pResult->Switches = 0;
+
+    if (pParams != NULL)
+    {
+        Controller.GetStats(&Stats);
+        pResult->Level = Controller.GetLevel();
+        pResult->Switches = (UINT32)Stats.Switches;
+    }
+
+    return TRUE;
+}
+
+// A fresh connection in eTOF_DATA_ALL at full scale for every run
+static BOOL TofBenchPhase(UINT32 TdcBytesPerSecond, UINT32 LinkBytesPerSecond, const TofFormatControlParams* pParams,
+                          UINT32 RunMs, UINT32 SteadyMs, TofBenchResult* pResult)
+{
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofSimConfig Config;
+    BOOL Result = FALSE;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.TdcBytesPerSecond = TdcBytesPerSecond;
+    Config.LinkBytesPerSecond = LinkBytesPerSecond;
+    TofSimSetConfig(&Config);
+
+    if ((PicoP_TLC_OpenLibrary(&Library) == eSUCCESS) &&
+        (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) == eSUCCESS))
+    {
+        PicoP_TLC_SetSensingState(Connection, eSENSING_DISABLED, FALSE);
+        PicoP_TLC_SetTofDataFormat(Connection, eTOF_DATA_ALL, FALSE);
+        PicoP_TLC_SetDOutBScale(Connection, DOUTB_SCALE_MAX, FALSE);
+        PicoP_TLC_SetSensingState(Connection, eSENSING_ENABLED, FALSE);
+
+        Result = TofBenchDrive(Connection, pParams, RunMs, SteadyMs, pResult);
+        PicoP_TLC_CloseConnection(Connection);
+    }
+
+    PicoP_TLC_CloseLibrary(Library);
+
+    return Result;
+}
+
+// ****************************************************************************
+
+static BOOL TofBenchSweep(const char* pName, const UINT32* pRates, UINT32 Count, BOOL Readout,
+                          const TofFormatControlParams* pParams, UINT32 RunMs, UINT32 SteadyMs)
+{
+    TofBenchResult Fixed;
+    TofBenchResult Controlled;
+    UINT32 Tdc;
+    UINT32 Link;
+
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        Tdc = Readout ? (pRates[i] * TOF_BENCH_MB) : 0;
+        Link = Readout ? 0 : (pRates[i] * TOF_BENCH_MB);
+
+        if (( ! TofBenchPhase(Tdc, Link, NULL, RunMs, SteadyMs, &Fixed)) ||
+            ( ! TofBenchPhase(Tdc, Link, pParams, RunMs, SteadyMs, &Controlled)))
+        {
+            printf("%s %u MB/s: the simulated device failed\n", pName, pRates[i]);
+            return FALSE;
+        }
+
+        printf("%-7s %3u MB/s  fixed ALL %5.1f fps (sd %4.2f)  controlled %5.1f fps (sd %4.2f)  level %u after %u switches\n",
+               pName, pRates[i], Fixed.Mean, Fixed.Sd, Controlled.Mean, Controlled.Sd,
+               Controlled.Level, Controlled.Switches);
+    }
+
+    return TRUE;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const UINT32 sLinkRates[] = { 48, 40, 34, 28, 24 };
+    static const UINT32 sReadoutRates[] = { 48, 40, 34, 28 };
+    BOOL Quick = TofBenchQuick(argc, argv);
+    UINT32 RunMs = Quick ? 4000 : 10000;
+    UINT32 SteadyMs = Quick ? 1500 : 3000;
+    TofFormatControlParams Params;
+
+
+    TofDefaultFormatControlParams(&Params);
+    Params.UpWindows = Params.MaxUpWindows;
+    Params.WindowMs = Quick ? 250 : Params.WindowMs;
+    Params.SettleMs = Quick ? 250 : Params.SettleMs;
+
+    printf("30 fps, eTOF_DATA_ALL 120 x 720, %u ms a run, %u ms controller windows\n", RunMs, Params.WindowMs);
+
+    if (( ! TofBenchSweep("link", Quick ? &sLinkRates[3] : sLinkRates,
+                          Quick ? 1 : (UINT32)(sizeof(sLinkRates) / sizeof(sLinkRates[0])), FALSE, &Params, RunMs, SteadyMs)) ||
+        ( ! TofBenchSweep("readout", Quick ? &sReadoutRates[2] : sReadoutRates,
+                          Quick ? 1 : (UINT32)(sizeof(sReadoutRates) / sizeof(sReadoutRates[0])), TRUE, &Params, RunMs, SteadyMs)))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,72 @@
+// ****************************************************************************
+//  TofFrameBench.cpp
+//
+// Per frame cost of the core frame handling: copy, normalize, point cloud
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofBench.h"
+#include "TofFrame.h"
+#include "TofNormalize.h"
+#include "TofPointCloud.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  The steps the viewer runs on every frame, each timed on its own over a
+//  simulated 120 x 720 fused frame
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 20 : 500;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Display;
+    std::vector<PicoP_Pcd_Data> Points;
+    TofFrameView View;
+    TofFrame Frame;
+    TofNormalizer Normalizer;
+    TofScanGeometry ScanGeometry;
+    TofBenchSummary Summary;
+    UINT32 NumPoints = 0;
+
+
+    if ((TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS) ||
+        (Frame.Create(Geometry.NumPulses, Geometry.NumLines) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+    TofMakeFrameView(&Data[0], Geometry.FrameWords, Geometry.NumPulses, Geometry.NumLines, Geometry.Format, &View);
+    TofDefaultScanGeometry(&ScanGeometry);
+    Display.resize(Geometry.PlaneWords);
+    Points.resize(Geometry.PlaneWords);
+
+    printf("%u x %u fused frame, %u iterations, times in us per frame\n",
+           Geometry.NumPulses, Geometry.NumLines, Iterations);
+
+    TofBenchRun(Iterations, [&]() { Frame.Deinterleave(&Data[0], Geometry.FrameWords, Geometry.Format); }, &Summary);
+    TofBenchPrint("TofFrame::Deinterleave", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]() { Normalizer.Normalize8(View.pTime, &Display[0], Geometry.PlaneWords); }, &Summary);
+    TofBenchPrint("TofNormalizer::Normalize8", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]() { TofFrameToPointCloud(&View, &ScanGeometry, &Points[0], Geometry.PlaneWords, &NumPoints); },
+                &Summary);
+    TofBenchPrint("TofFrameToPointCloud", &Summary, "us");
+
+    TofBenchKeep(Display[Geometry.PlaneWords / 2] + NumPoints);
+
+    return 0;
+}
+
+// ****************************************************************************
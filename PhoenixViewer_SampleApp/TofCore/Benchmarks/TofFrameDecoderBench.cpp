@@ -0,0 +1,94 @@
+// ****************************************************************************
+//  TofFrameDecoderBench.cpp
+//
+// Cost of decoding each data format and detector
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <vector>
+#include "TofBench.h"
+#include "TofFrameDecoder.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// A 120 x 720 frame of the simulated room is rendered in every data format
+// and decoded for every detector the format carries. Decode() always fills
+// a frame: a copy per channel, a zeroed channel where the format lacks one,
+// or the dropout masked mean of both detectors for the fused detector of a
+// two detector format. GetView() costs next to nothing where the planes are
+// used in place (zero copy) and a Decode() otherwise.
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const PicoP_ToFDataFormatE sFormats[] =
+    {
+        eTOF_DATA_FUSED, eTOF_DATA_LEFT_SENSOR_ONLY, eTOF_DATA_RIGHT_SENSOR_ONLY,
+        eTOF_DATA_DEPTH_ONLY, eTOF_DATA_AMPLITUDE_ONLY, eTOF_DATA_ALL
+    };
+    static const char* sFormatNames[] = { "fused", "left only", "right only", "depth only", "amplitude only", "all" };
+    static const char* sDetectorNames[] = { "fused", "left", "right" };
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 5 : 1000;
+    TofFrameGeometry Geometry;
+    TofFrameDecoder Decoder;
+    TofFrame Frame;
+    TofFrameView View;
+    std::vector<UINT32> Data;
+    TofBenchSummary DecodeSummary;
+    TofBenchSummary ViewSummary;
+
+
+    if (Frame.Create(120, 720) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    printf("120 x 720 frame, p50 / p99 microseconds\n");
+
+    for (UINT32 f = 0; f < sizeof(sFormats) / sizeof(sFormats[0]); f++)
+    {
+        if (TofTestGeometry(sFormats[f], 120, 720, 1, 1, &Geometry) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+
+        for (UINT32 d = 0; d < eTOF_NUM_DETECTORS; d++)
+        {
+            // Not every format carries every detector
+            if (Decoder.Create(&Geometry, (TofDetectorE)d) != eSUCCESS)
+            {
+                continue;
+            }
+
+            TofBenchRun(Iterations, [&]()
+            {
+                Decoder.Decode(&Data[0], Geometry.FrameWords, &Frame);
+            }, &DecodeSummary);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                Decoder.GetView(&Data[0], Geometry.FrameWords, &View);
+            }, &ViewSummary);
+
+            printf("%-15s %-6s decode %6.1f / %6.1f  view %6.1f / %6.1f%s\n", sFormatNames[f], sDetectorNames[d],
+                   DecodeSummary.P50, DecodeSummary.P99, ViewSummary.P50, ViewSummary.P99,
+                   Decoder.IsZeroCopy() ? "  zero copy" : "");
+        }
+    }
+
+    TofBenchKeep(Frame.GetTime()[1000] + View.pTime[1000]);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,272 @@
+// ****************************************************************************
+//  TofFramePoolBench.cpp
+//
+// Heap allocations of a running pooled frame stream
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofBench.h"
+#include "TofFramePool.h"
+#include "TofPipeline.h"
+#include "TofSim.h"
+#include "TofTemporalFilter.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Streams 120 x 720 fused frames through decode -> temporal -> project ->
+// sink at 120 fps and counts heap allocations once the stream has settled.
+// Global operator new is replaced below, so every allocation in the process
+// is counted, not only those made through TofMemory.h.
+//
+// The frames come from a pacing thread that fills pooled frames itself, and
+// then from the simulated device through TofAcquisition with a frame pool.
+// The simulator runs in the same process, so the second count covers its
+// device model as well.
+// ****************************************************************************
+
+static std::atomic<uint64_t> sNewCalls(0);
+
+void* operator new(size_t Size)
+{
+    void* pMemory = malloc((Size != 0) ? Size : 1);
+
+
+    if (pMemory == NULL)
+    {
+        throw std::bad_alloc();
+    }
+
+    sNewCalls.fetch_add(1, std::memory_order_relaxed);
+
+    return pMemory;
+}
+
+void operator delete(void* pMemory) noexcept
+{
+    free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+    free(pMemory);
+}
+
+// ****************************************************************************
+
+#define TOF_BENCH_FRAME_RATE    120
+
+typedef struct
+{
+    uint64_t NewCalls;
+    uint64_t TofAllocations;
+    uint64_t Completed;
+} TofBenchCounts;
+
+static void TofBenchOnFrame(void* pContext, const TofPipelineFrame* pFrame)
+{
+    *(UINT32*)pContext += pFrame->NumPoints;
+}
+
+static void TofBenchCount(TofPipeline* pPipeline, TofBenchCounts* pCounts)
+{
+    TofMemoryStats Memory;
+    TofPipelineMetrics Metrics;
+
+
+    TofGetMemoryStats(&Memory);
+    pPipeline->GetMetrics(&Metrics);
+    pCounts->NewCalls = sNewCalls.load();
+    pCounts->TofAllocations = Memory.Allocations;
+    pCounts->Completed = Metrics.FramesCompleted;
+}
+
+static void TofBenchReport(const char* pName, const TofBenchCounts* pBefore, const TofBenchCounts* pAfter,
+                           TofFramePool* pPool, double Seconds)
+{
+    TofFramePoolStats Stats;
+
+
+    pPool->GetStats(&Stats);
+    printf("%-18s %5.1f fps over %.1f s  operator new %llu  TofMemory %llu  pool misses %llu  max in use %u of %u\n",
+           pName, (pAfter->Completed - pBefore->Completed) / Seconds, Seconds,
+           (unsigned long long)(pAfter->NewCalls - pBefore->NewCalls),
+           (unsigned long long)(pAfter->TofAllocations - pBefore->TofAllocations),
+           (unsigned long long)Stats.FramesExhausted, Stats.MaxFramesInUse, Stats.FrameCount);
+}
+
+// ****************************************************************************
+//  Builds the four stage pipeline; the stages must outlive it
+// ****************************************************************************
+
+typedef struct
+{
+    TofScanGeometry Scan;
+    TofTemporalParams Temporal;
+    UINT32 Points;
+} TofBenchSetup;
+
+static PICOP_RC TofBenchStart(TofPipeline* pPipeline, TofPipelineStage** ppStages, const TofFrameGeometry* pGeometry)
+{
+    pPipeline->AddStage(ppStages[0], 1, 2, eTOF_QUEUE_BLOCK);
+    pPipeline->AddStage(ppStages[1], 1, 2, eTOF_QUEUE_BLOCK);
+    pPipeline->AddStage(ppStages[2], 1, 2, eTOF_QUEUE_DROP_OLDEST);
+    pPipeline->AddStage(ppStages[3], 1, 2, eTOF_QUEUE_DROP_OLDEST);
+
+    return pPipeline->Start(pGeometry);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    BOOL Quick = TofBenchQuick(argc, argv);
+    UINT32 WarmupMs = Quick ? 100 : 1000;
+    UINT32 MeasureMs = Quick ? 200 : 5000;
+    TofBenchSetup Setup;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Source;
+    TofBenchCounts Before;
+    TofBenchCounts After;
+    TofClock::time_point Start;
+    TofClock::time_point Next;
+    std::atomic<BOOL> Stop(FALSE);
+    std::thread Producer;
+
+
+    Setup.Points = 0;
+    TofDefaultScanGeometry(&Setup.Scan);
+    TofDefaultTemporalParams(&Setup.Temporal);
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Source);
+
+    // Pooled frames from a pacing thread
+    {
+        TofDecodeStage Decode;
+        TofTemporalFilterStage Temporal(&Setup.Temporal);
+        TofProjectStage Project(&Setup.Scan, 1);
+        TofSinkStage Sink(TofBenchOnFrame, &Setup.Points);
+        TofPipelineStage* pStages[4] = { &Decode, &Temporal, &Project, &Sink };
+        TofPipeline Pipeline;
+        TofFramePool Pool;
+
+
+        if ((Pool.Create(Geometry.FrameBytes, 4, TOF_POOL_LARGE_PAGES) != eSUCCESS) ||
+            (TofBenchStart(&Pipeline, pStages, &Geometry) != eSUCCESS))
+        {
+            return 1;
+        }
+
+        Producer = std::thread([&]()
+        {
+            TofPooledFrame* pFrame;
+            UINT32 Sequence = 0;
+
+
+            Next = TofClock::now();
+
+            while ( ! Stop)
+            {
+                Next += std::chrono::microseconds(1000000 / TOF_BENCH_FRAME_RATE);
+                std::this_thread::sleep_until(Next);
+
+                if ((pFrame = Pool.Acquire()) == NULL)
+                {
+                    continue;
+                }
+
+                memcpy(pFrame->pData, &Source[0], Geometry.FrameBytes);
+                pFrame->FrameWords = Geometry.FrameWords;
+                pFrame->SequenceNumber = Sequence++;
+                pFrame->AcquireTime = TofClock::now();
+                Pipeline.SubmitFrame(pFrame);
+                TofFrameRelease(pFrame);
+            }
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(WarmupMs));
+        TofBenchCount(&Pipeline, &Before);
+        Start = TofClock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(MeasureMs));
+        TofBenchCount(&Pipeline, &After);
+        TofBenchReport("paced producer", &Before, &After, &Pool,
+                       TofBenchMicroseconds(Start, TofClock::now()) / 1e6);
+
+        Stop = TRUE;
+        Producer.join();
+        Pipeline.Stop();
+    }
+
+    // The simulated device, read straight into pooled frames
+    {
+        PicoP_HANDLE Library = NULL;
+        PicoP_HANDLE Connection = NULL;
+        PicoP_USBInfo Usb = { 4, "1234" };
+        TofSimConfig Config;
+        TofDecodeStage Decode;
+        TofTemporalFilterStage Temporal(&Setup.Temporal);
+        TofProjectStage Project(&Setup.Scan, 1);
+        TofSinkStage Sink(TofBenchOnFrame, &Setup.Points);
+        TofPipelineStage* pStages[4] = { &Decode, &Temporal, &Project, &Sink };
+        TofPipeline Pipeline;
+        TofFramePool Pool;
+        TofAcquisition Acquisition;
+
+
+        TofSimDefaultConfig(&Config);
+        Config.FrameRate = TOF_BENCH_FRAME_RATE;
+        TofSimSetConfig(&Config);
+
+        if ((PicoP_TLC_OpenLibrary(&Library) != eSUCCESS) ||
+            (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) != eSUCCESS) ||
+            (TofQueryFrameGeometry(Connection, &Geometry) != eSUCCESS) ||
+            (Pool.CreateForDevice(Connection, 4, TOF_POOL_LARGE_PAGES) != eSUCCESS) ||
+            (TofBenchStart(&Pipeline, pStages, &Geometry) != eSUCCESS))
+        {
+            return 1;
+        }
+
+        Acquisition.SetFramePool(&Pool);
+
+        if (Acquisition.Start(Connection, TofPipeline::OnAcquiredFrame, &Pipeline) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(WarmupMs));
+        TofBenchCount(&Pipeline, &Before);
+        Start = TofClock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(MeasureMs));
+        TofBenchCount(&Pipeline, &After);
+        TofBenchReport("simulated device", &Before, &After, &Pool,
+                       TofBenchMicroseconds(Start, TofClock::now()) / 1e6);
+
+        Acquisition.Stop();
+        Pipeline.Stop();
+        PicoP_TLC_CloseConnection(Connection);
+        PicoP_TLC_CloseLibrary(Library);
+    }
+
+    TofBenchKeep(Setup.Points);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,139 @@
+// ****************************************************************************
+//  TofFrameRingBench.cpp
+//
+// Throughput and drop counts of the frame ring under a stress load
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <atomic>
+#include <thread>
+#include "TofBench.h"
+#include "TofFrameRing.h"
+
+// ****************************************************************************
+// Pushes 120 x 720 x 2 word frames through a ring as fast as the producer
+// can fill them. The producer stamps the sequence number into every 4 KB of
+// each frame rather than writing all 691200 bytes, so the figures are for
+// the ring itself. The consumer checks the stamps, so a torn frame would be
+// counted. A waiting producer gives the hand-off rate through the ring; a
+// producer that never waits, like the device, gives the drop counts when
+// reading every frame in order and when jumping to the newest frame, as the
+// display does. For the waiting producer the dropped count is the number of
+// times it found the ring full and retried.
+// ****************************************************************************
+
+#define TOF_BENCH_FRAME_BYTES   (120 * 720 * 2 * sizeof(UINT32))
+#define TOF_BENCH_STAMP_STRIDE  1024
+
+static void TofBenchStress(const char* pName, UINT32 Frames, UINT32 Slots, BOOL Wait, BOOL Latest)
+{
+    TofFrameRing Ring;
+    TofRingStats Stats;
+    TofClock::time_point Start;
+    std::atomic<BOOL> Done(FALSE);
+    UINT32 Torn = 0;
+    UINT32 Read = 0;
+    UINT32 Last = 0;
+    double Seconds;
+
+
+    if (Ring.Create(TOF_BENCH_FRAME_BYTES, Slots) != eSUCCESS)
+    {
+        return;
+    }
+
+    Start = TofClock::now();
+
+    std::thread Producer([&]()
+    {
+        TofRingSlot* pSlot;
+
+        for (UINT32 i = 1; i <= Frames; i++)
+        {
+            while (((pSlot = Ring.BeginWrite()) == NULL) && Wait)
+            {
+                std::this_thread::yield();
+            }
+
+            if (pSlot == NULL)
+            {
+                continue;
+            }
+
+            for (UINT32 w = 0; w < pSlot->FrameWords; w += TOF_BENCH_STAMP_STRIDE)
+            {
+                pSlot->pData[w] = i;
+            }
+
+            pSlot->SequenceNumber = i;
+            Ring.EndWrite();
+        }
+
+        Done = TRUE;
+    });
+
+    for (;;)
+    {
+        BOOL Finished = Done;
+        const TofRingSlot* pSlot = Latest ? Ring.ReadLatest() : Ring.BeginRead();
+
+        if ((pSlot == NULL) || (pSlot->SequenceNumber == Last))
+        {
+            if (Finished)
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (UINT32 w = 0; w < pSlot->FrameWords; w += TOF_BENCH_STAMP_STRIDE)
+        {
+            Torn += (pSlot->pData[w] != pSlot->SequenceNumber) ? 1 : 0;
+        }
+
+        Last = pSlot->SequenceNumber;
+        Read++;
+
+        if ( ! Latest)
+        {
+            Ring.EndRead();
+        }
+    }
+
+    Producer.join();
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    Ring.GetStats(&Stats);
+
+    printf("%-24s %2u slots  %10.0f frames/s offered  %8.0f frames/s read  published %u  dropped %u  skipped %u  torn %u\n",
+           pName, Ring.GetSlotCount(), Frames / Seconds, Read / Seconds, Stats.Published, Stats.Dropped,
+           Stats.Skipped, Torn);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Frames = TofBenchQuick(argc, argv) ? 20000 : 2000000;
+
+
+    printf("%u frames of %u bytes\n", Frames, (UINT32)TOF_BENCH_FRAME_BYTES);
+
+    TofBenchStress("waiting, in order", Frames, 4, TRUE, FALSE);
+    TofBenchStress("waiting, in order", Frames, 16, TRUE, FALSE);
+    TofBenchStress("free running, in order", Frames, 4, FALSE, FALSE);
+    TofBenchStress("free running, in order", Frames, 16, FALSE, FALSE);
+    TofBenchStress("free running, latest", Frames, 4, FALSE, TRUE);
+
+    return 0;
+}
+
+// ****************************************************************************
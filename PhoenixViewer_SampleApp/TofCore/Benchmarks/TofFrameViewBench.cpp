@@ -0,0 +1,115 @@
+// ****************************************************************************
+//  TofFrameViewBench.cpp
+//
+// Cost of copying the planes out of an acquired frame against viewing them in place
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include <vector>
+#include "TofBench.h"
+#include "TofFrame.h"
+#include "TofFrameView.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  A synthetic source cycles through a set of simulated 120 x 720 frames, so
+//  each acquired buffer is cold as it would be coming off the device. Each
+//  iteration then reads both planes once, the least any downstream stage
+//  does. The first two cases copy the planes out before reading them: the
+//  element loop the sample used, then TofFrame::Deinterleave. The last one
+//  makes a TofFrameView and reads the acquired buffer in place.
+// ****************************************************************************
+
+#define TOF_BENCH_SOURCE_FRAMES     16
+
+static UINT32 TofBenchConsume(const UINT32* pTime, const UINT32* pAmplitude, UINT32 PlaneWords)
+{
+    UINT32 Sum = 0;
+
+
+    for (UINT32 i = 0; i < PlaneWords; i++)
+    {
+        Sum += pTime[i] ^ pAmplitude[i];
+    }
+
+    return Sum;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 20 : 2000;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Source[TOF_BENCH_SOURCE_FRAMES];
+    std::vector<UINT32> TimeBuffer;
+    std::vector<UINT32> AmplitudeBuffer;
+    TofFrame Frame;
+    TofFrameView View;
+    TofBenchSummary Summary;
+    UINT32 Next = 0;
+    UINT32 Keep = 0;
+
+
+    if ((TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS) ||
+        (Frame.Create(Geometry.NumPulses, Geometry.NumLines) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < TOF_BENCH_SOURCE_FRAMES; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Source[i]);
+    }
+
+    TimeBuffer.resize(Geometry.PlaneWords);
+    AmplitudeBuffer.resize(Geometry.PlaneWords);
+
+    printf("%u x %u fused frame, %u source frames, %u iterations, times in us per frame\n",
+           Geometry.NumPulses, Geometry.NumLines, TOF_BENCH_SOURCE_FRAMES, Iterations);
+
+    TofBenchRun(Iterations, [&]()
+    {
+        const UINT32* pData = &Source[Next++ % TOF_BENCH_SOURCE_FRAMES][0];
+
+        for (UINT32 i = 0; i < Geometry.PlaneWords; i++)
+        {
+            TimeBuffer[i] = pData[i];
+            AmplitudeBuffer[i] = pData[Geometry.PlaneWords + i];
+        }
+
+        Keep += TofBenchConsume(&TimeBuffer[0], &AmplitudeBuffer[0], Geometry.PlaneWords);
+    }, &Summary);
+    TofBenchPrint("element copy loop + read", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]()
+    {
+        Frame.Deinterleave(&Source[Next++ % TOF_BENCH_SOURCE_FRAMES][0], Geometry.FrameWords, Geometry.Format);
+        Keep += TofBenchConsume(Frame.GetTime(), Frame.GetAmplitude(), Geometry.PlaneWords);
+    }, &Summary);
+    TofBenchPrint("TofFrame::Deinterleave + read", &Summary, "us");
+
+    TofBenchRun(Iterations, [&]()
+    {
+        TofMakeFrameView(&Source[Next++ % TOF_BENCH_SOURCE_FRAMES][0], Geometry.FrameWords,
+                         Geometry.NumPulses, Geometry.NumLines, Geometry.Format, &View);
+        Keep += TofBenchConsume(View.pTime, View.pAmplitude, Geometry.PlaneWords);
+    }, &Summary);
+    TofBenchPrint("TofMakeFrameView + read in place", &Summary, "us");
+
+    printf("bytes copied per frame: copy %u, view 0\n", Geometry.PlaneWords * 2 * (UINT32)sizeof(UINT32));
+
+    TofBenchKeep(Keep);
+
+    return 0;
+}
+
+// ****************************************************************************
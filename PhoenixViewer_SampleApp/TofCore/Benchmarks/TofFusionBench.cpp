@@ -0,0 +1,253 @@
+// ****************************************************************************
+//  TofFusionBench.cpp
+//
+// Cost of host fusion and its output against the firmware fused format
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "TofBench.h"
+#include "TofFusion.h"
+#include "TofRecording.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// The simulated room is rendered twice per frame number from the same seed,
+// once as eTOF_DATA_ALL and once as eTOF_DATA_FUSED, so both formats carry
+// the same detector samples. Each sequence is written to a recording and
+// replayed from it, as an offline comparison of captured data would be.
+//
+// Every policy fuses the replayed ALL frames; the output is compared pixel
+// by pixel with the firmware's FUSED frame of the same number:
+//
+//   same       time and amplitude both equal to the firmware's
+//   |dt|       mean time difference where both have a return
+//   returns    pixels with a return (time not 0), per frame
+//   halved     pixels where one detector dropped out and the time is under
+//              3/4 of the other's: a dropout averaged in, a range error
+//
+// The cost is of one Fuse() call per frame at 120 and 240 pulses by 720
+// lines, on one thread and on one per processor.
+// ****************************************************************************
+
+#define TOF_BENCH_FILE_ALL      "TofFusionBenchAll.tofrec"
+#define TOF_BENCH_FILE_FUSED    "TofFusionBenchFused.tofrec"
+
+static const char* sPolicyNames[] = { "mean", "amplitude weighted", "max confidence", "reject disagreement" };
+
+// Renders FrameCount frames in Format, records them and replays them into pFrames
+static BOOL TofBenchReplay(PicoP_ToFDataFormatE Format, UINT32 NumPulses, UINT32 FrameCount, const char* pFileName,
+                           std::vector<UINT32>* pFrames)
+{
+    PicoP_TofPulsingConfig Config;
+    TofFrameGeometry Geometry;
+    TofRecorder Recorder;
+    TofRecordingReader Reader;
+    TofRecordedFrame Recorded;
+    std::vector<UINT32> Frame;
+    TofClock::time_point Now = TofClock::now();
+    BOOL Result = FALSE;
+
+
+    memset(&Config, 0, sizeof(Config));
+    Config.pulsingMode = eTOF_PULSING_EQUAL_ANGLE;
+    Config.nrPulsesPerLine = (UINT16)NumPulses;
+
+    if ((TofTestGeometry(Format, NumPulses, TOF_SIM_LINES, 1, 1, &Geometry) != eSUCCESS) ||
+        (Recorder.Open(pFileName, &Config, Format, Geometry.FrameBytes) != eSUCCESS))
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < FrameCount; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Frame);
+
+        while (Recorder.Write(&Frame[0], i, Now, Now) == eBUSY)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    if ((Recorder.Close() == eSUCCESS) && (Reader.Open(pFileName) == eSUCCESS))
+    {
+        pFrames->clear();
+
+        for (UINT32 i = 0; i < Reader.GetFrameCount(); i++)
+        {
+            if (Reader.GetFrame(i, &Recorded) == eSUCCESS)
+            {
+                pFrames->insert(pFrames->end(), Recorded.pData, Recorded.pData + Recorded.FrameWords);
+            }
+        }
+
+        Result = (pFrames->size() == (size_t)FrameCount * Geometry.FrameWords);
+        Reader.Close();
+    }
+
+    remove(pFileName);
+
+    return Result;
+}
+
+// ****************************************************************************
+
+static void TofBenchCompare(UINT32 FrameCount, UINT32 PlaneWords, const std::vector<UINT32>& All,
+                            const std::vector<UINT32>& Fused)
+{
+    TofFusionParams Params;
+    TofFuser Fuser;
+    std::vector<UINT32> Time(PlaneWords);
+    std::vector<UINT32> Amplitude(PlaneWords);
+    const UINT32* pAll;
+    const UINT32* pFused;
+    UINT32 LeftTime;
+    UINT32 RightTime;
+    uint64_t Same;
+    uint64_t Both;
+    uint64_t Returns;
+    uint64_t Halved;
+    double Difference;
+
+
+    printf("\nagainst the firmware fused format, %u replayed frames of %u pixels\n", FrameCount, PlaneWords);
+    printf("%-20s %8s %8s %9s %8s\n", "policy", "same", "|dt|", "returns", "halved");
+
+    for (UINT32 Policy = eTOF_FUSE_MEAN; Policy <= eTOF_FUSE_REJECT_DISAGREEMENT; Policy++)
+    {
+        TofDefaultFusionParams(&Params);
+        Params.Policy = (TofFusionPolicyE)Policy;
+
+        if (Fuser.Create(PlaneWords / TOF_SIM_LINES, TOF_SIM_LINES, &Params, 1) != eSUCCESS)
+        {
+            return;
+        }
+
+        Same = 0;
+        Both = 0;
+        Returns = 0;
+        Halved = 0;
+        Difference = 0.0;
+
+        for (UINT32 f = 0; f < FrameCount; f++)
+        {
+            pAll = &All[(size_t)f * PlaneWords * 4];
+            pFused = &Fused[(size_t)f * PlaneWords * 2];
+            Fuser.Fuse(pAll, PlaneWords * 4, &Time[0], &Amplitude[0]);
+
+            for (UINT32 i = 0; i < PlaneWords; i++)
+            {
+                LeftTime = pAll[i];
+                RightTime = pAll[(2 * PlaneWords) + i];
+                Same += ((Time[i] == pFused[i]) && (Amplitude[i] == pFused[PlaneWords + i])) ? 1 : 0;
+                Returns += (Time[i] != 0) ? 1 : 0;
+
+                if ((Time[i] != 0) && (pFused[i] != 0))
+                {
+                    Difference += abs((INT32)Time[i] - (INT32)pFused[i]);
+                    Both++;
+                }
+
+                if (((LeftTime == 0) != (RightTime == 0)) && (Time[i] != 0) &&
+                    ((Time[i] * 4) < ((LeftTime + RightTime) * 3)))
+                {
+                    Halved++;
+                }
+            }
+        }
+
+        printf("%-20s %7.2f%% %8.2f %9.0f %8.0f\n", sPolicyNames[Policy], (Same * 100.0) / ((double)FrameCount * PlaneWords),
+               Difference / ((Both != 0) ? Both : 1), (double)Returns / FrameCount, (double)Halved / FrameCount);
+    }
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const UINT32 sPulses[] = { 120, 240 };
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 5 : 300;
+    UINT32 FrameCount = TofBenchQuick(argc, argv) ? 4 : 60;
+    UINT32 Processors = std::thread::hardware_concurrency();
+    UINT32 Threads[2];
+    TofFrameGeometry Geometry;
+    TofFusionParams Params;
+    TofFuser Fuser;
+    std::vector<UINT32> All;
+    std::vector<UINT32> Fused;
+    std::vector<UINT32> Frame;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    TofBenchSummary Summary;
+
+
+    Threads[0] = 1;
+    Threads[1] = (Processors != 0) ? Processors : 1;
+
+    printf("per frame fusion cost of an ALL frame of the room\n");
+
+    for (UINT32 p = 0; p < sizeof(sPulses) / sizeof(sPulses[0]); p++)
+    {
+        if (TofTestGeometry(eTOF_DATA_ALL, sPulses[p], TOF_SIM_LINES, 1, 1, &Geometry) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Frame);
+        Time.resize(Geometry.PlaneWords);
+        Amplitude.resize(Geometry.PlaneWords);
+
+        for (UINT32 Policy = eTOF_FUSE_MEAN; Policy <= eTOF_FUSE_REJECT_DISAGREEMENT; Policy++)
+        {
+            for (UINT32 t = 0; t < 2; t++)
+            {
+                if ((t == 1) && (Threads[1] == 1))
+                {
+                    continue;
+                }
+
+                TofDefaultFusionParams(&Params);
+                Params.Policy = (TofFusionPolicyE)Policy;
+
+                if (Fuser.Create(sPulses[p], TOF_SIM_LINES, &Params, Threads[t]) != eSUCCESS)
+                {
+                    return 1;
+                }
+
+                TofBenchRun(Iterations, [&]()
+                {
+                    Fuser.Fuse(&Frame[0], Geometry.FrameWords, &Time[0], &Amplitude[0]);
+                }, &Summary);
+
+                printf("%4u x %u %-20s %2u thread(s)  p50 %7.1f us  p99 %7.1f us\n", sPulses[p], TOF_SIM_LINES,
+                       sPolicyNames[Policy], Fuser.GetThreadCount(), Summary.P50, Summary.P99);
+            }
+        }
+    }
+
+    TofBenchKeep(Time[Time.size() / 2]);
+
+    if (( ! TofBenchReplay(eTOF_DATA_ALL, TOF_SIM_DEFAULT_PULSES, FrameCount, TOF_BENCH_FILE_ALL, &All)) ||
+        ( ! TofBenchReplay(eTOF_DATA_FUSED, TOF_SIM_DEFAULT_PULSES, FrameCount, TOF_BENCH_FILE_FUSED, &Fused)))
+    {
+        printf("replay: recording failed\n");
+        return 1;
+    }
+
+    TofBenchCompare(FrameCount, TOF_SIM_DEFAULT_PULSES * TOF_SIM_LINES, All, Fused);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,88 @@
+// ****************************************************************************
+//  TofGeometryBench.cpp
+//
+// Colorize cost at several negotiated geometries against the old hard-coded 120 x 720
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofBench.h"
+#include "TofColorize.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  Every geometry holds the same 86400 words, laid out as 120 pulses x 720
+//  lines (the old hard-coded build), 240 x 360 and 480 x 180 (two and four
+//  line phases) and 200 x 432. Each is drawn 180 rows high into a 520 x 200
+//  bitmap through the expander Create() picks for it. The cost per drawn
+//  pixel, against the 120 pulse line, shows whether a geometry read at run
+//  time keeps the speed of the compile time one.
+// ****************************************************************************
+
+#define TOF_BENCH_BITMAP_WIDTH  520
+#define TOF_BENCH_BITMAP_HEIGHT 200
+#define TOF_BENCH_BITMAP_STRIDE (TOF_BENCH_BITMAP_WIDTH * TOF_BYTES_PER_PIXEL)
+#define TOF_BENCH_IMAGE_HEIGHT  180
+
+// Returns the p50 cost per drawn pixel in ns, 0 if the geometry is refused
+static double TofBenchWidth(UINT32 NumPulses, UINT32 LinePhases, UINT32 Iterations, double Baseline)
+{
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Bitmap(TOF_BENCH_BITMAP_STRIDE * TOF_BENCH_BITMAP_HEIGHT);
+    TofColorizer Colorizer;
+    TofBenchSummary Summary;
+    double PerPixel;
+
+
+    // The colorizer draws the phased image, ImagePulses wide
+    if (TofTestGeometry(eTOF_DATA_FUSED, NumPulses / LinePhases, (86400 / NumPulses) * LinePhases,
+                        LinePhases, 1, &Geometry) != eSUCCESS)
+    {
+        return 0.0;
+    }
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+
+    Colorizer.Create(Geometry.ImagePulses, Geometry.ImageLines, TOF_BENCH_BITMAP_WIDTH, TOF_BENCH_BITMAP_HEIGHT,
+                     TOF_BENCH_BITMAP_STRIDE, 0, Geometry.ImagePulses, TOF_BENCH_IMAGE_HEIGHT);
+
+    TofBenchRun(Iterations, [&]() { Colorizer.Colorize(&Data[0], &Bitmap[0]); }, &Summary);
+
+    PerPixel = Summary.P50 * 1000.0 / ((TOF_BENCH_IMAGE_HEIGHT + 1) * Geometry.ImagePulses);
+    Baseline = (Baseline > 0.0) ? Baseline : PerPixel;
+
+    printf("%4u x %3u (%u line phases)  %7.2f us  %5.2f ns/pixel  %5.2fx the 120 pulse line\n",
+           Geometry.ImagePulses, Geometry.ImageLines, LinePhases, Summary.P50, PerPixel, PerPixel / Baseline);
+
+    TofBenchKeep(Bitmap[TOF_BENCH_BITMAP_STRIDE * 90 + 60]);
+
+    return PerPixel;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 20 : 5000;
+    double Baseline;
+
+
+    printf("%u iterations, p50 per frame\n", Iterations);
+
+    Baseline = TofBenchWidth(120, 1, Iterations, 0.0);
+    TofBenchWidth(240, 2, Iterations, Baseline);
+    TofBenchWidth(480, 4, Iterations, Baseline);
+    TofBenchWidth(200, 1, Iterations, Baseline);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,67 @@
+// ****************************************************************************
+//  TofNormalizeBench.cpp
+//
+// Per-frame cost of the percentile normalizer
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofBench.h"
+#include "TofNormalize.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  Normalizes the time plane of a simulated 120 x 720 frame, from the room
+//  scene and from the noise free ramp, to 8 and to 16 bits
+// ****************************************************************************
+
+static void TofBenchScene(const char* pName, TofSimSceneE Scene, UINT32 Iterations)
+{
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Output8;
+    std::vector<UINT16> Output16;
+    TofNormalizer Normalizer;
+    TofBenchSummary Summary;
+    char Name[64];
+
+
+    TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry);
+    TofTestRender(&Geometry, Scene, 0, &Data);
+    Output8.resize(Geometry.PlaneWords);
+    Output16.resize(Geometry.PlaneWords);
+
+    snprintf(Name, sizeof(Name), "%s, Normalize8", pName);
+    TofBenchRun(Iterations, [&]() { Normalizer.Normalize8(&Data[0], &Output8[0], Geometry.PlaneWords); }, &Summary);
+    TofBenchPrint(Name, &Summary, "us");
+
+    snprintf(Name, sizeof(Name), "%s, Normalize16", pName);
+    TofBenchRun(Iterations, [&]() { Normalizer.Normalize16(&Data[0], &Output16[0], Geometry.PlaneWords); }, &Summary);
+    TofBenchPrint(Name, &Summary, "us");
+
+    TofBenchKeep(Output8[Geometry.PlaneWords / 2] + Output16[Geometry.PlaneWords / 3]);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 20 : 2000;
+
+
+    printf("120 x 720 time plane, %u iterations, times in us per frame\n", Iterations);
+
+    TofBenchScene("room", eTOF_SIM_SCENE_ROOM, Iterations);
+    TofBenchScene("ramp", eTOF_SIM_SCENE_RAMP, Iterations);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,86 @@
+// ****************************************************************************
+//  TofPhaseAssemblerBench.cpp
+//
+// Cost per sub-frame of line and frame phase reassembly
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <vector>
+#include "TofBench.h"
+#include "TofPhaseAssembler.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Each combination of line and frame phases sends 120 pulse x 720 line
+// sub-frames of the simulated room, one per frame phase in turn. The figure
+// is one TofPhaseAssembler::Add(), so the cost a consumer pays per frame the
+// device sends, in both modes; complete mode also swaps grids once a set.
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const UINT32 sLinePhases[] = { 1, 2, 4 };
+    static const UINT32 sFramePhases[] = { 1, 2, 3, 4 };
+    static const char* sModes[] = { "rolling", "complete" };
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 8 : 1000;
+    TofFrameGeometry Geometry;
+    TofPhaseAssembler Assembler;
+    std::vector<UINT32> Data[4];
+    TofFrameView Views[4];
+    TofBenchSummary Summary;
+    UINT32 Next = 0;
+    BOOL Updated = FALSE;
+
+
+    printf("120 pulses x 720 lines per sub-frame, per Add()\n");
+
+    for (UINT32 lp = 0; lp < sizeof(sLinePhases) / sizeof(sLinePhases[0]); lp++)
+    {
+        for (UINT32 fp = 0; fp < sizeof(sFramePhases) / sizeof(sFramePhases[0]); fp++)
+        {
+            if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, sLinePhases[lp], sFramePhases[fp], &Geometry) != eSUCCESS)
+            {
+                return 1;
+            }
+
+            for (UINT32 f = 0; f < sFramePhases[fp]; f++)
+            {
+                TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, f, &Data[f]);
+                TofMakeFrameView(&Data[f][0], Geometry.FrameWords, 120, 720, eTOF_DATA_FUSED, &Views[f]);
+            }
+
+            for (UINT32 Mode = eTOF_PHASE_ROLLING; Mode <= eTOF_PHASE_COMPLETE; Mode++)
+            {
+                if (Assembler.Create(&Geometry, (TofPhaseModeE)Mode) != eSUCCESS)
+                {
+                    return 1;
+                }
+
+                Next = 0;
+                TofBenchRun(Iterations, [&]()
+                {
+                    Assembler.Add(&Views[Next], Next, &Updated);
+                    Next = (Next + 1) % sFramePhases[fp];
+                }, &Summary);
+
+                printf("line phases %u, frame phases %u, %-8s -> %4u x %4u  p50 %7.1f us  p99 %7.1f us\n",
+                       sLinePhases[lp], sFramePhases[fp], sModes[Mode], Assembler.GetWidth(), Assembler.GetHeight(),
+                       Summary.P50, Summary.P99);
+            }
+        }
+    }
+
+    TofBenchKeep(Updated ? 1 : 0);
+
+    return 0;
+}
+
+// ****************************************************************************
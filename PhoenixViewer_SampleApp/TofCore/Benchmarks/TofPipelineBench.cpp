@@ -0,0 +1,185 @@
+// ****************************************************************************
+//  TofPipelineBench.cpp
+//
+// End to end throughput of the frame pipeline
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofBench.h"
+#include "TofPipeline.h"
+#include "TofSim.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Runs decode -> project -> sink on 120 x 720 fused frames, fed two ways:
+// Submit() called back to back from one thread, which measures what the
+// pipeline itself sustains, and the simulated TLC device pushing frames
+// through TofAcquisition, as the viewer would. Per-stage metrics follow each
+// run: frames processed and dropped, the deepest the input queue got, and
+// the mean time a frame waited for and spent in the stage.
+// ****************************************************************************
+
+static void TofBenchOnPoints(void* pContext, const TofPipelineFrame* pFrame)
+{
+    *(UINT32*)pContext += pFrame->NumPoints;
+}
+
+static void TofBenchPrintMetrics(const char* pName, TofPipeline* pPipeline, double Seconds)
+{
+    TofPipelineMetrics Metrics;
+    TofStageMetrics Stage;
+    uint64_t Processed;
+
+
+    pPipeline->GetMetrics(&Metrics);
+    printf("%s: %llu of %llu frames through, %.0f frames/s, latency mean %.0f us max %llu us\n", pName,
+           (unsigned long long)Metrics.FramesCompleted, (unsigned long long)Metrics.FramesSubmitted,
+           Metrics.FramesCompleted / Seconds,
+           (Metrics.FramesCompleted != 0) ? (double)Metrics.TotalLatencyUs / Metrics.FramesCompleted : 0.0,
+           (unsigned long long)Metrics.MaxLatencyUs);
+
+    for (UINT32 i = 0; i < pPipeline->GetStageCount(); i++)
+    {
+        pPipeline->GetStageMetrics(i, &Stage);
+        Processed = (Stage.FramesProcessed != 0) ? Stage.FramesProcessed : 1;
+
+        printf("  %-8s %6llu done %5llu dropped  depth max %u  wait %7.1f us  process %7.1f us (max %llu)\n",
+               Stage.pName, (unsigned long long)Stage.FramesProcessed, (unsigned long long)Stage.FramesDropped,
+               Stage.MaxQueueDepth, (double)Stage.TotalWaitUs / Processed,
+               (double)Stage.TotalProcessUs / Processed, (unsigned long long)Stage.MaxProcessUs);
+    }
+}
+
+// Submits Frames frames back to back with Policy on the stages after decode
+static void TofBenchSubmit(const char* pName, const TofFrameGeometry* pGeometry, TofQueuePolicyE Policy,
+                           UINT32 Frames)
+{
+    TofScanGeometry Scan;
+    TofPipeline Pipeline;
+    TofDecodeStage Decode;
+    std::vector<UINT32> Data;
+    TofClock::time_point Start;
+    UINT32 Points = 0;
+    double Seconds;
+
+
+    TofDefaultScanGeometry(&Scan);
+    TofProjectStage Project(&Scan, 1);
+    TofSinkStage Sink(TofBenchOnPoints, &Points);
+
+    Pipeline.AddStage(&Decode, 1, 4, eTOF_QUEUE_BLOCK);
+    Pipeline.AddStage(&Project, 1, 4, Policy);
+    Pipeline.AddStage(&Sink, 1, 4, Policy);
+
+    if (Pipeline.Start(pGeometry) != eSUCCESS)
+    {
+        printf("%s: Start failed\n", pName);
+        return;
+    }
+
+    TofTestRender(pGeometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+    Start = TofClock::now();
+
+    for (UINT32 i = 0; i < Frames; i++)
+    {
+        Pipeline.Submit(&Data[0], i, TofClock::now());
+    }
+
+    Pipeline.Stop();
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    TofBenchPrintMetrics(pName, &Pipeline, Seconds);
+    TofBenchKeep(Points);
+}
+
+// Runs the simulated device at FrameRate for Milliseconds into the pipeline
+static void TofBenchDevice(UINT32 FrameRate, UINT32 Milliseconds)
+{
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofSimConfig Config;
+    TofSimStats Stats;
+    TofFrameGeometry Geometry;
+    TofScanGeometry Scan;
+    TofAcquisition Acquisition;
+    TofPipeline Pipeline;
+    TofDecodeStage Decode;
+    UINT32 Points = 0;
+    char Name[64];
+
+
+    TofSimDefaultConfig(&Config);
+    Config.FrameRate = FrameRate;
+    TofSimSetConfig(&Config);
+    TofDefaultScanGeometry(&Scan);
+    TofProjectStage Project(&Scan, 1);
+    TofSinkStage Sink(TofBenchOnPoints, &Points);
+
+    Pipeline.AddStage(&Decode, 1, 4, eTOF_QUEUE_BLOCK);
+    Pipeline.AddStage(&Project, 1, 4, eTOF_QUEUE_DROP_OLDEST);
+    Pipeline.AddStage(&Sink, 1, 4, eTOF_QUEUE_DROP_OLDEST);
+
+    if ((PicoP_TLC_OpenLibrary(&Library) != eSUCCESS) ||
+        (PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) != eSUCCESS) ||
+        (TofQueryFrameGeometry(Connection, &Geometry) != eSUCCESS) ||
+        (Pipeline.Start(&Geometry) != eSUCCESS) ||
+        (Acquisition.Start(Connection, TofPipeline::OnAcquiredFrame, &Pipeline) != eSUCCESS))
+    {
+        printf("simulated device: start failed\n");
+        PicoP_TLC_CloseConnection(Connection);
+        PicoP_TLC_CloseLibrary(Library);
+        return;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
+    Acquisition.Stop();
+    Pipeline.Stop();
+    TofSimGetStats(&Stats);
+
+    snprintf(Name, sizeof(Name), "simulated device at %u fps", FrameRate);
+    TofBenchPrintMetrics(Name, &Pipeline, Milliseconds / 1000.0);
+    printf("  device generated %u, overran %u\n", Stats.FramesGenerated, Stats.FramesOverrun);
+
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+    TofBenchKeep(Points);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    BOOL Quick = TofBenchQuick(argc, argv);
+    UINT32 Frames = Quick ? 20 : 3000;
+    UINT32 Milliseconds = Quick ? 100 : 3000;
+    TofFrameGeometry Geometry;
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    printf("decode -> project -> sink, 120 x 720 fused frames, %u hardware threads\n",
+           std::thread::hardware_concurrency());
+
+    TofBenchSubmit("submit, blocking", &Geometry, eTOF_QUEUE_BLOCK, Frames);
+    TofBenchSubmit("submit, drop oldest", &Geometry, eTOF_QUEUE_DROP_OLDEST, Frames);
+    TofBenchDevice(240, Milliseconds);
+    TofBenchDevice(2000, Milliseconds);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,119 @@
+// ****************************************************************************
+//  TofPointCloudBench.cpp
+//
+// Points per second of the point cloud converters
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "TofBench.h"
+#include "TofPointCloud.h"
+#include "TofProjector.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Converts a 120 x 720 simulated room frame with the per-point trig
+// reference, with the ray table on the calling thread, and through
+// TofProjector at several thread counts into records and into the SoA
+// cloud. Rates are of points written, dropouts included.
+// ****************************************************************************
+
+static void TofBenchPrintRate(const char* pName, const TofBenchSummary* pSummary, UINT32 Points)
+{
+    printf("%-24s p50 %8.1f us  p99 %8.1f us  %7.1f Mpoints/s\n",
+           pName, pSummary->P50, pSummary->P99, Points / pSummary->P50);
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const UINT32 sThreads[] = { 1, 2, 4 };
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 5 : 300;
+    TofFrameGeometry Geometry;
+    TofScanGeometry Scan;
+    std::vector<UINT32> Data;
+    std::vector<PicoP_Pcd_Data> Points;
+    TofFrameView View;
+    TofRayTable Table;
+    TofProjector Projector;
+    TofPointCloudSoA SoA;
+    TofBenchSummary Summary;
+    UINT32 NumPoints = 0;
+    char Name[64];
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+    TofMakeFrameView(&Data[0], (UINT32)Data.size(), 120, 720, eTOF_DATA_FUSED, &View);
+    TofDefaultScanGeometry(&Scan);
+    Points.resize(120 * 720);
+
+    if ((Table.Create(&Scan, 120, 720) != eSUCCESS) || (SoA.Create((UINT32)Points.size()) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    printf("120 x 720 frame, %u hardware threads\n", std::thread::hardware_concurrency());
+
+    TofBenchRun(Iterations, [&]()
+    {
+        TofFrameToPointCloudScalar(&View, &Scan, &Points[0], (UINT32)Points.size(), &NumPoints);
+    }, &Summary);
+    TofBenchPrintRate("scalar reference", &Summary, NumPoints);
+
+    TofBenchRun(Iterations, [&]()
+    {
+        TofProjectLines(&Table, &View, 0, 720, &Points[0]);
+    }, &Summary);
+    TofBenchPrintRate("ray table, 1 thread", &Summary, NumPoints);
+
+    TofBenchRun(Iterations, [&]()
+    {
+        TofProjectLinesSoA(&Table, &View, 0, 720, &SoA);
+    }, &Summary);
+    TofBenchPrintRate("ray table SoA, 1 thread", &Summary, NumPoints);
+
+    for (UINT32 i = 0; i < sizeof(sThreads) / sizeof(sThreads[0]); i++)
+    {
+        if (Projector.Create(&Scan, 120, 720, sThreads[i]) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        TofBenchRun(Iterations, [&]()
+        {
+            Projector.Project(&View, &Points[0], (UINT32)Points.size(), &NumPoints);
+        }, &Summary);
+        snprintf(Name, sizeof(Name), "projector, %u thread%s", sThreads[i], (sThreads[i] == 1) ? "" : "s");
+        TofBenchPrintRate(Name, &Summary, NumPoints);
+
+        TofBenchRun(Iterations, [&]()
+        {
+            Projector.ProjectSoA(&View, &SoA);
+        }, &Summary);
+        snprintf(Name, sizeof(Name), "projector SoA, %u thread%s", sThreads[i], (sThreads[i] == 1) ? "" : "s");
+        TofBenchPrintRate(Name, &Summary, NumPoints);
+
+        Projector.Destroy();
+    }
+
+    TofBenchKeep(Points[1000].z + (UINT32)SoA.GetZ()[1000]);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,105 @@
+// ****************************************************************************
+//  TofRayTableBench.cpp
+//
+// Per frame projection cost with and without a ray table
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <vector>
+#include "TofBench.h"
+#include "TofPointCloud.h"
+#include "TofRayTableCache.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Per frame cost of turning a simulated room frame into a point cloud for
+// each pulsing mode: trig per point, a ray table rebuilt for every frame,
+// and a table looked up in the shared cache. The last column is the cost of
+// building the table alone, which the cache saves on every frame.
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const PicoP_ToFPulsingModeE sModes[] = { eTOF_PULSING_EQUAL_ANGLE, eTOF_PULSING_EQUAL_TIME,
+                                                     eTOF_PULSING_POLYNOMIAL };
+    static const char* sModeNames[] = { "equal angle", "equal time", "polynomial" };
+    static const UINT32 sPulses[] = { 120, 240 };
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 5 : 200;
+    TofFrameGeometry Geometry;
+    TofScanGeometry Scan;
+    std::vector<UINT32> Data;
+    std::vector<PicoP_Pcd_Data> Points;
+    TofFrameView View;
+    TofBenchSummary Trig;
+    TofBenchSummary Rebuilt;
+    TofBenchSummary Cached;
+    TofBenchSummary Build;
+    UINT32 NumPoints = 0;
+
+
+    printf("per frame p50: trig per point, table rebuilt, cached table; table build alone\n");
+
+    for (UINT32 p = 0; p < sizeof(sPulses) / sizeof(sPulses[0]); p++)
+    {
+        if (TofTestGeometry(eTOF_DATA_FUSED, sPulses[p], 720, 1, 1, &Geometry) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+        TofMakeFrameView(&Data[0], (UINT32)Data.size(), sPulses[p], 720, eTOF_DATA_FUSED, &View);
+        Points.resize(sPulses[p] * 720);
+
+        for (UINT32 m = 0; m < sizeof(sModes) / sizeof(sModes[0]); m++)
+        {
+            TofDefaultScanGeometry(&Scan);
+            Scan.PulsingMode = sModes[m];
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofFrameToPointCloudScalar(&View, &Scan, &Points[0], (UINT32)Points.size(), &NumPoints);
+            }, &Trig);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofRayTable Table;
+
+                Table.Create(&Scan, View.NumPulses, View.NumLines);
+                TofProjectLines(&Table, &View, 0, View.NumLines, &Points[0]);
+            }, &Rebuilt);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofRayTablePtr Table;
+
+                TofSharedRayTables()->Get(&Scan, View.NumPulses, View.NumLines, &Table);
+                TofProjectLines(Table.get(), &View, 0, View.NumLines, &Points[0]);
+            }, &Cached);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofRayTable Table;
+
+                Table.Create(&Scan, View.NumPulses, View.NumLines);
+                TofBenchKeep(Table.GetNumLines());
+            }, &Build);
+
+            printf("%3u x 720 %-12s %8.1f us  %7.1f us  %7.1f us  %6.1f us\n",
+                   sPulses[p], sModeNames[m], Trig.P50, Rebuilt.P50, Cached.P50, Build.P50);
+        }
+    }
+
+    TofBenchKeep(NumPoints + Points[100].z);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,175 @@
+// ****************************************************************************
+//  TofRecordingBench.cpp
+//
+// Sustained recording write rate and replay rate on a large recording
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "TofBench.h"
+#include "TofRecording.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  Records simulated 120 x 720 fused frames (691200 bytes each) as fast as
+//  TofRecorder::Write() accepts them, then reads the recording back: every
+//  frame in order with each word touched, frames in a random order, and
+//  through TofPlayer at full speed. Write() never waits on the disk; here a
+//  frame it turns away is offered again until it is taken, so the write rate
+//  is what the disk sustains and the busy count how often it was the limit,
+//  each retry being a frame a live stream would have lost. The file goes
+//  to the working directory and is removed afterwards; a full run writes
+//  about 1.4 GB, which on most machines is more than the page cache holds
+//  back.
+// ****************************************************************************
+
+#define TOF_BENCH_FILE_NAME     "TofRecordingBench.tofrec"
+#define TOF_BENCH_SOURCE_FRAMES 8
+
+static void TofBenchOnPlayed(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    std::atomic<UINT32>* pSum = (std::atomic<UINT32>*)pContext;
+
+
+    *pSum += pFrame->pData[pFrame->FrameWords / 2];
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    UINT32 Frames = TofBenchQuick(argc, argv) ? 32 : 2000;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Source[TOF_BENCH_SOURCE_FRAMES];
+    PicoP_TofPulsingConfig Config;
+    TofRecorder Recorder;
+    TofRecorderStats Stats;
+    TofRecordingReader Reader;
+    TofRecordedFrame Frame;
+    TofPlayer Player;
+    TofClock::time_point Start;
+    TofClock::time_point Now;
+    std::atomic<UINT32> PlayedSum(0);
+    UINT32 Busy = 0;
+    UINT32 Sum = 0;
+    double Seconds;
+    double MegaBytes;
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < TOF_BENCH_SOURCE_FRAMES; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Source[i]);
+    }
+
+    memset(&Config, 0, sizeof(Config));
+    Config.nrPulsesPerLine = (UINT16)Geometry.NumPulses;
+
+    if (Recorder.Open(TOF_BENCH_FILE_NAME, &Config, Geometry.Format, Geometry.FrameBytes) != eSUCCESS)
+    {
+        printf("Cannot create %s\n", TOF_BENCH_FILE_NAME);
+        return 1;
+    }
+
+    // Write
+    Start = TofClock::now();
+
+    for (UINT32 i = 0; i < Frames; i++)
+    {
+        Now = TofClock::now();
+
+        while (Recorder.Write(&Source[i % TOF_BENCH_SOURCE_FRAMES][0], i, Now, Now) == eBUSY)
+        {
+            Busy++;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    Recorder.Close();
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    Recorder.GetStats(&Stats);
+    MegaBytes = Stats.BytesWritten / 1e6;
+
+    printf("write     %5u frames, %5u busy retries  %8.1f MB in %6.2f s  %8.1f MB/s  %8.1f frames/s\n",
+           Stats.FramesWritten, Busy, MegaBytes, Seconds, MegaBytes / Seconds, Stats.FramesWritten / Seconds);
+
+    if (Reader.Open(TOF_BENCH_FILE_NAME) != eSUCCESS)
+    {
+        printf("Cannot read %s back\n", TOF_BENCH_FILE_NAME);
+        remove(TOF_BENCH_FILE_NAME);
+        return 1;
+    }
+
+    // Replay in order, reading every word
+    Start = TofClock::now();
+
+    for (UINT32 i = 0; i < Reader.GetFrameCount(); i++)
+    {
+        Reader.GetFrame(i, &Frame);
+
+        for (UINT32 w = 0; w < Frame.FrameWords; w++)
+        {
+            Sum += Frame.pData[w];
+        }
+    }
+
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    printf("replay    %5u frames in order, every word read          %8.1f MB/s  %8.1f frames/s\n",
+           Reader.GetFrameCount(), Reader.GetFrameCount() * (Geometry.FrameBytes / 1e6) / Seconds,
+           Reader.GetFrameCount() / Seconds);
+
+    // Random seeks, one word per frame
+    srand(1);
+    Start = TofClock::now();
+
+    for (UINT32 i = 0; i < Reader.GetFrameCount(); i++)
+    {
+        Reader.GetFrame((UINT32)rand() % Reader.GetFrameCount(), &Frame);
+        Sum += Frame.pData[Frame.FrameWords / 2];
+    }
+
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    printf("seek      %5u random frames                              %8.1f frames/s\n",
+           Reader.GetFrameCount(), Reader.GetFrameCount() / Seconds);
+
+    // Through the player, as the viewer replays
+    Start = TofClock::now();
+
+    if (Player.Start(&Reader, 0.0f, 0, TofBenchOnPlayed, &PlayedSum) == eSUCCESS)
+    {
+        while (Player.IsRunning())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        Player.Stop();
+    }
+
+    Seconds = TofBenchMicroseconds(Start, TofClock::now()) / 1e6;
+    printf("player    %5u frames at speed 0                          %8.1f frames/s\n",
+           Player.GetFramesPlayed(), Player.GetFramesPlayed() / Seconds);
+
+    Reader.Close();
+    remove(TOF_BENCH_FILE_NAME);
+
+    TofBenchKeep(Sum + PlayedSum);
+
+    return 0;
+}
+
+// ****************************************************************************
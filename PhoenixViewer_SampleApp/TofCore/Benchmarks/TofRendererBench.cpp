@@ -0,0 +1,98 @@
+// ****************************************************************************
+//  TofRendererBench.cpp
+//
+// Per-frame allocations and time of the old and the persistent render paths
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "TofBench.h"
+#include "TofColorize.h"
+#include "TofRenderer.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+//  The old WM_PAINT drew into a static frame array, then created a memory DC
+//  and a compatible bitmap, copied the array in with SetDIBits and deleted
+//  both again. Headless, the DC and bitmap become two heap allocations and
+//  SetDIBits a copy of the bitmap. The new path colorizes straight into the
+//  renderer's persistent surface. Both draw the same simulated frame.
+// ****************************************************************************
+
+#define TOF_BENCH_WIDTH     520
+#define TOF_BENCH_HEIGHT    200
+#define TOF_BENCH_DC_BYTES  1024        // Stand-in for the memory DC
+
+int main(int argc, char** argv)
+{
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 20 : 2000;
+    UINT32 Stride = TOF_SURFACE_STRIDE(TOF_BENCH_WIDTH);
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> FrameData((size_t)Stride * TOF_BENCH_HEIGHT);
+    TofMemoryRenderer Renderer;
+    TofRendererStats Stats;
+    TofColorizer Colorizer;
+    TofBenchSummary Summary;
+    const TofSurface* pSurface = Renderer.GetSurface();
+    UINT32 OldAllocations = 0;
+    UINT32 Keep = 0;
+
+
+    if ((TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS) ||
+        (Renderer.Create(TOF_BENCH_WIDTH, TOF_BENCH_HEIGHT) != eSUCCESS) ||
+        (Colorizer.Create(Geometry.NumPulses, Geometry.NumLines, pSurface->Width, pSurface->Height,
+                          pSurface->Stride, 80, Geometry.NumPulses, 180) != eSUCCESS))
+    {
+        return 1;
+    }
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+
+    printf("%u x %u bitmap, %u iterations, times in us per frame\n", TOF_BENCH_WIDTH, TOF_BENCH_HEIGHT, Iterations);
+
+    TofBenchRun(Iterations, [&]()
+    {
+        Colorizer.Colorize(&Data[0], &FrameData[0]);
+
+        UINT8* pDc = (UINT8*)malloc(TOF_BENCH_DC_BYTES);
+        UINT8* pBitmap = (UINT8*)malloc(FrameData.size());
+        OldAllocations += 2;
+
+        memcpy(pBitmap, &FrameData[0], FrameData.size());
+        pDc[0] = pBitmap[Stride * 90 + 300];
+        Keep += pDc[0];
+
+        free(pBitmap);
+        free(pDc);
+    }, &Summary);
+    TofBenchPrint("old: draw, allocate, SetDIBits copy, free", &Summary, "us");
+
+    // The warm up runs are counted too
+    printf("old: %.2f allocations per frame\n", (double)OldAllocations / (Iterations + 3));
+
+    TofBenchRun(Iterations, [&]()
+    {
+        Colorizer.Colorize(&Data[0], pSurface->pPixels);
+        Renderer.Present();
+    }, &Summary);
+    TofBenchPrint("new: draw into the persistent surface", &Summary, "us");
+
+    Renderer.GetStats(&Stats);
+    printf("new: %u allocation in Create for %u frames presented\n", Stats.Allocations, Stats.FramesPresented);
+
+    TofBenchKeep(Keep + pSurface->pPixels[Stride * 90 + 300]);
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,120 @@
+// ****************************************************************************
+//  TofSpatialFilterBench.cpp
+//
+// Per frame cost of the spatial filters at several geometries
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "TofBench.h"
+#include "TofSpatialFilter.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Each filter runs in place on a copy of the rendered room at 120, 240 and
+// 1024 pulses by 720 lines, with one band and with one band per processor.
+// The copy is taken outside the timing; the figure is one call to Filter(),
+// including its own copy of the plane and the hand off to the band threads.
+// ****************************************************************************
+
+typedef struct
+{
+    const char* pName;
+    TofSpatialFilterE Filter;
+    UINT32 Radius;
+} TofBenchFilter;
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const TofBenchFilter sFilters[] =
+    {
+        { "median 3x3", eTOF_SPATIAL_MEDIAN_3X3, 1 },
+        { "median 5x5", eTOF_SPATIAL_MEDIAN_5X5, 2 },
+        { "bilateral r1", eTOF_SPATIAL_BILATERAL, 1 },
+        { "bilateral r2", eTOF_SPATIAL_BILATERAL, 2 },
+    };
+    static const UINT32 sPulses[] = { 120, 240, 1024 };
+    UINT32 Frames = TofBenchQuick(argc, argv) ? 3 : 200;
+    UINT32 Processors = std::thread::hardware_concurrency();
+    UINT32 Threads[2];
+    TofFrameGeometry Geometry;
+    TofSpatialParams Params;
+    TofSpatialFilter Filter;
+    std::vector<UINT32> Source;
+    std::vector<UINT32> Frame;
+    std::vector<double> Samples;
+    TofBenchSummary Summary;
+    TofClock::time_point Start;
+
+
+    Threads[0] = 1;
+    Threads[1] = (Processors != 0) ? Processors : 1;
+
+    printf("per frame cost p50 / p99\n");
+
+    for (UINT32 p = 0; p < sizeof(sPulses) / sizeof(sPulses[0]); p++)
+    {
+        if (TofTestGeometry(eTOF_DATA_FUSED, sPulses[p], 720, 1, 1, &Geometry) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Source);
+
+        for (UINT32 f = 0; f < sizeof(sFilters) / sizeof(sFilters[0]); f++)
+        {
+            for (UINT32 t = 0; t < 2; t++)
+            {
+                if ((t == 1) && (Threads[1] == 1))
+                {
+                    continue;
+                }
+
+                TofDefaultSpatialParams(&Params);
+                Params.Filter = sFilters[f].Filter;
+                Params.Radius = sFilters[f].Radius;
+
+                if (Filter.Create(Geometry.ImagePulses, Geometry.ImageLines, &Params, Threads[t]) != eSUCCESS)
+                {
+                    return 1;
+                }
+
+                Samples.clear();
+
+                for (UINT32 i = 0; i < Frames + 1; i++)
+                {
+                    Frame = Source;
+                    Start = TofClock::now();
+                    Filter.Filter(&Frame[0], &Frame[Geometry.PlaneWords]);
+
+                    // The first call warms the bands up
+                    if (i != 0)
+                    {
+                        Samples.push_back(TofBenchMicroseconds(Start, TofClock::now()));
+                    }
+                }
+
+                TofBenchKeep(Frame[Geometry.PlaneWords / 2]);
+                TofBenchSummarize(&Samples, &Summary);
+                printf("%4u x 720 %-13s %2u thread(s) %8.1f / %8.1f us  %7.1f Mpix/s\n", sPulses[p],
+                       sFilters[f].pName, Filter.GetThreadCount(), Summary.P50, Summary.P99,
+                       (double)Geometry.PlaneWords / Summary.P50);
+            }
+        }
+    }
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,179 @@
+// ****************************************************************************
+//  TofTemporalFilterBench.cpp
+//
+// Per frame cost and noise reduction of the temporal filter
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include "TofBench.h"
+#include "TofTemporalFilter.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// The noise free ramp scene is the truth. Each noisy frame adds Gaussian
+// noise to its time plane, 16 counts at full amplitude and more for weaker
+// returns, and drops one pixel in 512. The RMS error is taken over the
+// frames after the first 20, skipping dropped pixels in the raw figure, so
+// it shows what a consumer of the filtered plane would see. The cost is of
+// filtering one frame in place.
+// ****************************************************************************
+
+#define TOF_BENCH_NOISY_FRAMES      16          // Distinct noisy frames, cycled
+#define TOF_BENCH_SETTLE_FRAMES     20
+
+typedef struct
+{
+    const char* pName;
+    TofTemporalModeE Mode;
+    UINT32 MedianLength;
+} TofBenchFilter;
+
+static void TofBenchMakeNoisy(const std::vector<UINT32>& Truth, UINT32 PlaneWords, UINT32 Seed,
+                              std::vector<UINT32>* pFrame)
+{
+    std::mt19937 Random(Seed);
+    std::normal_distribution<FP32> Noise(0.0f, 16.0f);
+    const UINT32* pAmplitude = &Truth[PlaneWords];
+    FP32 Scale;
+    FP32 Value;
+
+
+    *pFrame = Truth;
+
+    for (UINT32 i = 0; i < PlaneWords; i++)
+    {
+        if ((Random() & 511) == 0)
+        {
+            (*pFrame)[i] = 0;
+            (*pFrame)[PlaneWords + i] = 0;
+            continue;
+        }
+
+        Scale = sqrtf(1024.0f / (FP32)((pAmplitude[i] > 64) ? pAmplitude[i] : 64));
+        Scale = (Scale > 1.0f) ? Scale : 1.0f;
+        Value = (FP32)Truth[i] + Noise(Random) * Scale;
+        (*pFrame)[i] = (Value > 1.0f) ? (UINT32)lrintf(Value) : 1;
+    }
+}
+
+static double TofBenchSquaredError(const UINT32* pTime, const UINT32* pTruth, UINT32 Count, UINT32* pCounted)
+{
+    double Sum = 0.0;
+    double Difference;
+
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        if (pTime[i] != 0)
+        {
+            Difference = (double)pTime[i] - pTruth[i];
+            Sum += Difference * Difference;
+            (*pCounted)++;
+        }
+    }
+
+    return Sum;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const TofBenchFilter sFilters[] =
+    {
+        { "ema", eTOF_TEMPORAL_EMA, 5 },
+        { "median of 3", eTOF_TEMPORAL_MEDIAN, 3 },
+        { "median of 5", eTOF_TEMPORAL_MEDIAN, 5 },
+        { "median of 7", eTOF_TEMPORAL_MEDIAN, 7 },
+    };
+    static const UINT32 sPulses[] = { 120, 240 };
+    UINT32 Frames = TofBenchQuick(argc, argv) ? 24 : 400;
+    TofFrameGeometry Geometry;
+    TofTemporalParams Params;
+    TofTemporalFilter Filter;
+    std::vector<UINT32> Truth;
+    std::vector<UINT32> Noisy[TOF_BENCH_NOISY_FRAMES];
+    std::vector<UINT32> Frame;
+    std::vector<double> Samples;
+    TofBenchSummary Summary;
+    TofClock::time_point Start;
+    double RawError;
+    double FilteredError;
+    UINT32 RawCount;
+    UINT32 FilteredCount;
+
+
+    printf("per frame cost p50 / p99, RMS time error in counts raw -> filtered\n");
+
+    for (UINT32 p = 0; p < sizeof(sPulses) / sizeof(sPulses[0]); p++)
+    {
+        if (TofTestGeometry(eTOF_DATA_FUSED, sPulses[p], 720, 1, 1, &Geometry) != eSUCCESS)
+        {
+            return 1;
+        }
+
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_RAMP, 0, &Truth);
+
+        for (UINT32 i = 0; i < TOF_BENCH_NOISY_FRAMES; i++)
+        {
+            TofBenchMakeNoisy(Truth, Geometry.PlaneWords, i + 1, &Noisy[i]);
+        }
+
+        for (UINT32 f = 0; f < sizeof(sFilters) / sizeof(sFilters[0]); f++)
+        {
+            TofDefaultTemporalParams(&Params);
+            Params.Mode = sFilters[f].Mode;
+            Params.MedianLength = sFilters[f].MedianLength;
+
+            if (Filter.Create(sPulses[p], 720, &Params) != eSUCCESS)
+            {
+                return 1;
+            }
+
+            Samples.clear();
+            RawError = 0.0;
+            FilteredError = 0.0;
+            RawCount = 0;
+            FilteredCount = 0;
+
+            for (UINT32 i = 0; i < Frames; i++)
+            {
+                Frame = Noisy[i % TOF_BENCH_NOISY_FRAMES];
+
+                if (i >= TOF_BENCH_SETTLE_FRAMES)
+                {
+                    RawError += TofBenchSquaredError(&Frame[0], &Truth[0], Geometry.PlaneWords, &RawCount);
+                }
+
+                Start = TofClock::now();
+                Filter.Filter(&Frame[0], &Frame[Geometry.PlaneWords], Geometry.PlaneWords);
+                Samples.push_back(TofBenchMicroseconds(Start, TofClock::now()));
+
+                if (i >= TOF_BENCH_SETTLE_FRAMES)
+                {
+                    FilteredError += TofBenchSquaredError(&Frame[0], &Truth[0], Geometry.PlaneWords, &FilteredCount);
+                }
+            }
+
+            TofBenchSummarize(&Samples, &Summary);
+            printf("%3u x 720 %-12s %7.1f / %7.1f us  %5.2f -> %5.2f\n", sPulses[p], sFilters[f].pName,
+                   Summary.P50, Summary.P99, sqrt(RawError / ((RawCount != 0) ? RawCount : 1)),
+                   sqrt(FilteredError / ((FilteredCount != 0) ? FilteredCount : 1)));
+        }
+    }
+
+    return 0;
+}
+
+// ****************************************************************************
@@ -0,0 +1,148 @@
+// ****************************************************************************
+//  TofValidMaskBench.cpp
+//
+// Cost of valid pixel masking and indexed projection at several valid ratios
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include "TofBench.h"
+#include "TofPointCloud.h"
+#include "TofTestFrames.h"
+#include "TofValidMask.h"
+
+// ****************************************************************************
+// The rendered 120 x 720 room has its amplitude plane rewritten so the
+// given share of pixels passes the threshold, either scattered at random
+// (the worst case for the gather in the indexed projection) or as one run
+// at the start of each line (objects in front of a far wall). Each row
+// times, on the calling thread:
+//
+//   full      TofProjectLines over the whole frame, the unmasked path
+//   compact   TofCompactValid
+//   indexed   TofProjectIndices over the compacted list
+//   mask      TofBuildValidMask
+//   mask->idx TofMaskToIndices
+//
+// so masked projection costs compact + indexed against full.
+// ****************************************************************************
+
+#define TOF_BENCH_MIN_AMPLITUDE     100
+
+static void TofBenchSetRatio(UINT32 NumPulses, UINT32 PlaneWords, UINT32 Percent, BOOL Scattered,
+                             std::vector<UINT32>* pData)
+{
+    std::mt19937 Random(Percent);
+    UINT32* pAmplitude = &(*pData)[PlaneWords];
+    BOOL Valid;
+
+
+    for (UINT32 i = 0; i < PlaneWords; i++)
+    {
+        Valid = Scattered ? ((Random() % 100) < Percent) : (((i % NumPulses) * 100) < (Percent * NumPulses));
+        pAmplitude[i] = Valid ? TOF_BENCH_MIN_AMPLITUDE + (Random() % 1000) : (Random() % TOF_BENCH_MIN_AMPLITUDE);
+
+        if ((*pData)[i] == 0)
+        {
+            (*pData)[i] = 1;
+        }
+    }
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    static const UINT32 sPercents[] = { 0, 10, 25, 50, 75, 90, 100 };
+    UINT32 Iterations = TofBenchQuick(argc, argv) ? 5 : 500;
+    TofFrameGeometry Geometry;
+    TofScanGeometry Scan;
+    TofRayTable Table;
+    TofFrameView View;
+    std::vector<UINT32> Data;
+    std::vector<UINT32> Indices;
+    std::vector<uint64_t> Mask;
+    std::vector<PicoP_Pcd_Data> Points;
+    TofBenchSummary Full;
+    TofBenchSummary Compact;
+    TofBenchSummary Indexed;
+    TofBenchSummary Masking;
+    TofBenchSummary ToIndices;
+    UINT32 Valid = 0;
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    TofDefaultScanGeometry(&Scan);
+
+    if (Table.Create(&Scan, 120, 720) != eSUCCESS)
+    {
+        return 1;
+    }
+
+    Indices.resize(Geometry.PlaneWords);
+    Mask.resize(TOF_MASK_WORDS(Geometry.PlaneWords));
+    Points.resize(Geometry.PlaneWords);
+
+    printf("120 x 720 frame, p50 microseconds per frame\n");
+    printf("valid  layout     full  compact  indexed   mask  mask->idx\n");
+
+    for (UINT32 Scattered = 0; Scattered < 2; Scattered++)
+    {
+        for (UINT32 p = 0; p < sizeof(sPercents) / sizeof(sPercents[0]); p++)
+        {
+            TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Data);
+            TofBenchSetRatio(120, Geometry.PlaneWords, sPercents[p], Scattered ? TRUE : FALSE, &Data);
+            TofMakeFrameView(&Data[0], (UINT32)Data.size(), 120, 720, eTOF_DATA_FUSED, &View);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofProjectLines(&Table, &View, 0, 720, &Points[0]);
+            }, &Full);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                Valid = TofCompactValid(View.pTime, View.pAmplitude, Geometry.PlaneWords, TOF_BENCH_MIN_AMPLITUDE,
+                                        &Indices[0]);
+            }, &Compact);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofProjectIndices(&Table, &View, &Indices[0], Valid, &Points[0]);
+            }, &Indexed);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                TofBuildValidMask(View.pTime, View.pAmplitude, Geometry.PlaneWords, TOF_BENCH_MIN_AMPLITUDE, &Mask[0]);
+            }, &Masking);
+
+            TofBenchRun(Iterations, [&]()
+            {
+                Valid = TofMaskToIndices(&Mask[0], Geometry.PlaneWords, &Indices[0]);
+            }, &ToIndices);
+
+            printf("%4.0f%%  %-9s %6.1f  %7.1f  %7.1f  %5.1f  %9.1f\n",
+                   (Valid * 100.0) / Geometry.PlaneWords, Scattered ? "scattered" : "runs",
+                   Full.P50, Compact.P50, Indexed.P50, Masking.P50, ToIndices.P50);
+        }
+    }
+
+    TofBenchKeep(Valid + Points[0].z);
+
+    return 0;
+}
+
+// ****************************************************************************
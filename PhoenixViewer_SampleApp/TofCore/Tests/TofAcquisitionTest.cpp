@@ -0,0 +1,381 @@
+// ****************************************************************************
+//  TofAcquisitionTest.cpp
+//
+// Tests of event driven acquisition against the simulated device
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "TofAcquisition.h"
+#include "TofSim.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+// Generous, for a loaded machine running the tests in parallel
+#define TOF_TEST_TIMEOUT_MS     5000
+
+typedef struct
+{
+    std::atomic<UINT32> Frames;
+    std::atomic<UINT32> Failures;
+    std::atomic<UINT32> OutOfOrder;
+    UINT32 NextSequence;
+    UINT32 FrameWords;
+} TofTestConsumer;
+
+static void TofTestOnFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofTestConsumer* pConsumer = (TofTestConsumer*)pContext;
+
+
+    if ((pFrame->Result != eSUCCESS) || (pFrame->pData == NULL) || (pFrame->FrameWords != pConsumer->FrameWords))
+    {
+        pConsumer->Failures++;
+        return;
+    }
+
+    pConsumer->OutOfOrder += (pFrame->SequenceNumber != pConsumer->NextSequence) ? 1 : 0;
+    pConsumer->NextSequence = pFrame->SequenceNumber + 1;
+    pConsumer->Frames++;
+}
+
+static void TofTestResetConsumer(TofTestConsumer* pConsumer, UINT32 FrameWords)
+{
+    pConsumer->Frames = 0;
+    pConsumer->Failures = 0;
+    pConsumer->OutOfOrder = 0;
+    pConsumer->NextSequence = 0;
+    pConsumer->FrameWords = FrameWords;
+}
+
+// Quick frames with little latency, so the tests run fast
+static TofSimConfig TofTestSimConfig(UINT32 FrameRate)
+{
+    TofSimConfig Config;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.FrameRate = FrameRate;
+    Config.LatencyUs = 1000;
+    Config.JitterUs = 500;
+
+    return Config;
+}
+
+// ****************************************************************************
+
+TOF_TEST(AcquisitionRejectsBadArguments)
+{
+    TofAcquisition Acquisition;
+    TofTestConsumer Consumer;
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, Acquisition.Start(NULL, TofTestOnFrame, &Consumer));
+    TOF_CHECK( ! Acquisition.IsRunning());
+}
+
+TOF_TEST(AcquisitionDeliversEveryFrameInOrder)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(200);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    TofAcquisition Acquisition;
+    TofAcquisitionStats Stats;
+    TofTestConsumer Consumer;
+    UINT32 FrameBytes = 0;
+    TofClock::time_point Deadline;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes);
+    TofTestResetConsumer(&Consumer, FrameBytes / sizeof(UINT32));
+
+    TOF_REQUIRE(Acquisition.Start(Connection, TofTestOnFrame, &Consumer) == eSUCCESS);
+    TOF_CHECK(Acquisition.IsRunning());
+    Deadline = TofClock::now() + std::chrono::milliseconds(TOF_TEST_TIMEOUT_MS);
+
+    while ((Consumer.Frames <= 10) && (TofClock::now() < Deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    Acquisition.Stop();
+    TOF_CHECK( ! Acquisition.IsRunning());
+
+    Acquisition.GetStats(&Stats);
+    TOF_CHECK(Consumer.Frames > 10);
+    TOF_CHECK_EQ(0u, Consumer.Failures.load());
+    TOF_CHECK_EQ(0u, Consumer.OutOfOrder.load());
+    TOF_CHECK_EQ(Consumer.Frames.load(), Stats.FramesDelivered);
+
+    TofTestDisconnect(Library, Connection);
+}
+
+TOF_TEST(AcquisitionIsSingleInstance)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(30);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    TofAcquisition First;
+    TofAcquisition Second;
+    TofTestConsumer Consumer;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    TofTestResetConsumer(&Consumer, 0);
+
+    TOF_REQUIRE(First.Start(Connection, TofTestOnFrame, &Consumer) == eSUCCESS);
+    TOF_CHECK_EQ(eALREADY_OPENED, First.Start(Connection, TofTestOnFrame, &Consumer));
+    TOF_CHECK_EQ(eBUSY, Second.Start(Connection, TofTestOnFrame, &Consumer));
+    First.Stop();
+
+    // Free again once the first has stopped
+    TOF_CHECK_EQ(eSUCCESS, Second.Start(Connection, TofTestOnFrame, &Consumer));
+    Second.Stop();
+
+    TofTestDisconnect(Library, Connection);
+}
+
+// ****************************************************************************
+//  In eTOF_ACQUIRE_LATEST_ONLY frames that queue up behind a slow consumer
+//  are skipped; DeviceFrame still counts every frame the device sent, which
+//  is what the frame phase is taken from. The first callback holds on until
+//  at least two frames are cached, so at least one is always skipped however
+//  fast or slow the host is.
+// ****************************************************************************
+
+typedef struct
+{
+    PicoP_HANDLE Connection;
+    std::atomic<UINT32> Frames;
+    std::atomic<UINT32> NotIncreasing;
+    std::atomic<UINT32> LastDeviceFrame;
+} TofTestDeviceFrames;
+
+static void TofTestOnDeviceFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofTestDeviceFrames* pFrames = (TofTestDeviceFrames*)pContext;
+    TofClock::time_point Deadline = TofClock::now() + std::chrono::milliseconds(TOF_TEST_TIMEOUT_MS);
+    UINT32 Count = 0;
+
+
+    if (pFrame->Result != eSUCCESS)
+    {
+        return;
+    }
+
+    pFrames->NotIncreasing += ((pFrames->Frames != 0) && (pFrame->DeviceFrame <= pFrames->LastDeviceFrame)) ? 1 : 0;
+    pFrames->LastDeviceFrame = pFrame->DeviceFrame;
+
+    while ((pFrames->Frames == 0) && (PicoP_TLC_GetTofFrameCount(pFrames->Connection, &Count) == eSUCCESS) &&
+           (Count < 2) && (TofClock::now() < Deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    pFrames->Frames++;
+}
+
+TOF_TEST(DeviceFrameCountsSkippedFrames)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(400);
+    PicoP_HANDLE Connection;
+    TofAcquisition Acquisition;
+    TofAcquisitionStats Stats;
+    TofTestDeviceFrames Frames;
+    TofSimStats Before;
+    TofSimStats After;
+    TofClock::time_point Deadline;
+
+
+    // Room for every frame of a reader descheduled on a loaded machine, so none are lost on the device
+    Config.QueueDepth = 64;
+    Connection = TofTestConnect(&Library, &Config);
+
+    TOF_REQUIRE(Connection != NULL);
+    Frames.Connection = Connection;
+    Frames.Frames = 0;
+    Frames.NotIncreasing = 0;
+    Frames.LastDeviceFrame = 0;
+
+    TofSimGetStats(&Before);
+    Acquisition.SetMode(eTOF_ACQUIRE_LATEST_ONLY);
+    TOF_REQUIRE(Acquisition.Start(Connection, TofTestOnDeviceFrame, &Frames) == eSUCCESS);
+    Deadline = TofClock::now() + std::chrono::milliseconds(TOF_TEST_TIMEOUT_MS);
+
+    do
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        Acquisition.GetStats(&Stats);
+    }
+    while (((Frames.Frames <= 5) || (Stats.FramesSkipped == 0)) && (TofClock::now() < Deadline));
+
+    Acquisition.Stop();
+    TofSimGetStats(&After);
+    Acquisition.GetStats(&Stats);
+
+    TOF_CHECK(Frames.Frames > 5);
+    TOF_CHECK(Stats.FramesSkipped > 0);
+    TOF_CHECK_EQ(0u, Frames.NotIncreasing.load());
+    TOF_CHECK_EQ(0u, After.FramesOverrun - Before.FramesOverrun);
+
+    // The last frame delivered is the last one read, so its number is the count of frames before it
+    TOF_CHECK_EQ(Stats.FramesDelivered + Stats.FramesSkipped, Frames.LastDeviceFrame + 1);
+    TOF_CHECK_EQ(After.FramesRead - Before.FramesRead, Frames.LastDeviceFrame + 1);
+
+    TofTestDisconnect(Library, Connection);
+}
+
+// ****************************************************************************
+//  Waits for the simulator to cache at least Frames frames, then stops it
+//  and waits for the frames still on the wire to land, so the count holds
+//  still. Polls rather than sleeping a fixed time, which a loaded machine
+//  running the tests in parallel can overrun.
+// ****************************************************************************
+
+#define TOF_TEST_FILL_TIMEOUT_MS    5000
+
+static UINT32 TofTestFillCache(PicoP_HANDLE Connection, UINT32 Frames)
+{
+    TofClock::time_point Deadline = TofClock::now() + std::chrono::milliseconds(TOF_TEST_FILL_TIMEOUT_MS);
+    TofSimConfig Config;
+    UINT32 Count = 0;
+    UINT32 Last;
+
+
+    while ((PicoP_TLC_GetTofFrameCount(Connection, &Count) == eSUCCESS) && (Count < Frames) &&
+           (TofClock::now() < Deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    TofSimGetConfig(&Config);
+    Config.FrameRate = 0;
+    TofSimSetConfig(&Config);
+
+    // Settled once the count has not moved for longer than the latency and jitter
+    do
+    {
+        Last = Count;
+        std::this_thread::sleep_for(std::chrono::microseconds(Config.LatencyUs + Config.JitterUs + 5000));
+        PicoP_TLC_GetTofFrameCount(Connection, &Count);
+    }
+    while ((Count != Last) && (TofClock::now() < Deadline));
+
+    return Count;
+}
+
+TOF_TEST(AcquireBatchReadsCachedFramesInOneCall)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(500);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    std::vector<UINT32> Arena;
+    UINT32 FrameBytes = 0;
+    UINT32 FrameWords;
+    UINT32 Count;
+    UINT32 RetFrame = 0;
+    TofSimStats Before;
+    TofSimStats After;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes);
+    FrameWords = FrameBytes / sizeof(UINT32);
+    Arena.resize((size_t)FrameWords * TOF_ACQUISITION_MAX_BATCH);
+
+    Count = TofTestFillCache(Connection, TOF_ACQUISITION_MAX_BATCH);
+    TOF_REQUIRE(Count >= TOF_ACQUISITION_MAX_BATCH);
+
+    TofSimGetStats(&Before);
+    TOF_CHECK_EQ(eSUCCESS, TofAcquireBatch(Connection, FrameWords, Count, &Arena[0], (UINT32)Arena.size(), &RetFrame));
+    TofSimGetStats(&After);
+
+    // Limited by the arena, all in the one call
+    TOF_CHECK_EQ((UINT32)TOF_ACQUISITION_MAX_BATCH, RetFrame);
+    TOF_CHECK_EQ((UINT32)TOF_ACQUISITION_MAX_BATCH, After.FramesRead - Before.FramesRead);
+
+    TOF_CHECK_EQ(eINVALID_ARG, TofAcquireBatch(Connection, FrameWords, 1, &Arena[0], FrameWords - 1, &RetFrame));
+    TOF_CHECK_EQ(0u, RetFrame);
+
+    TofTestDisconnect(Library, Connection);
+}
+
+TOF_TEST(SkipFramesReadsScratchSizedBatches)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(500);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    std::vector<UINT32> Scratch;
+    UINT32 FrameBytes = 0;
+    UINT32 FrameWords;
+    UINT32 Count;
+    UINT32 Left = 0;
+    UINT32 Skipped = 0;
+    UINT32 Calls = 0;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes);
+    FrameWords = FrameBytes / sizeof(UINT32);
+    Scratch.resize((size_t)FrameWords * 2);
+
+    Count = TofTestFillCache(Connection, 3);
+    TOF_REQUIRE(Count >= 3);
+
+    TOF_CHECK_EQ(eSUCCESS, TofSkipFrames(Connection, FrameWords, Count - 1, &Scratch[0], (UINT32)Scratch.size(),
+                                         &Skipped, &Calls));
+    TOF_CHECK_EQ(Count - 1, Skipped);
+    TOF_CHECK_EQ(Count / 2, Calls);
+
+    // The newest frame is left for the consumer
+    PicoP_TLC_GetTofFrameCount(Connection, &Left);
+    TOF_CHECK_EQ(1u, Left);
+
+    TofTestDisconnect(Library, Connection);
+}
+
+// ****************************************************************************
+//  Events keep arriving while instances are stopped and destroyed; a
+//  callback still running on a destroyed instance would show up here under
+//  AddressSanitizer or as a crash
+// ****************************************************************************
+
+TOF_TEST(AcquisitionStopsWhileEventsArrive)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(500);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    TofAcquisition* pAcquisition;
+    TofTestConsumer Consumer;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    TofTestResetConsumer(&Consumer, 0);
+
+    for (UINT32 i = 0; i < 40; i++)
+    {
+        pAcquisition = new TofAcquisition();
+        TOF_CHECK_EQ(eSUCCESS, pAcquisition->Start(Connection, TofTestOnFrame, &Consumer));
+        std::this_thread::sleep_for(std::chrono::milliseconds(i % 5));
+        pAcquisition->Stop();
+        delete pAcquisition;
+    }
+
+    TofTestDisconnect(Library, Connection);
+}
+
+// ****************************************************************************
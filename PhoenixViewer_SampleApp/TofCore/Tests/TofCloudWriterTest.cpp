@@ -0,0 +1,231 @@
+// ****************************************************************************
+//  TofCloudWriterTest.cpp
+//
+// Tests of the PCD and PLY point cloud exporter
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "TofCloudWriter.h"
+#include "TofLzf.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_PULSES     64
+#define TOF_TEST_LINES      24
+#define TOF_TEST_PREFIX     "TofCloudWriterTest_"
+
+static BOOL TofTestReadFile(const char* pFileName, std::vector<UINT8>* pContents)
+{
+    FILE* pFile = fopen(pFileName, "rb");
+    UINT8 Buffer[65536];
+    size_t Read;
+
+
+    if (pFile == NULL)
+    {
+        return FALSE;
+    }
+
+    pContents->clear();
+
+    while ((Read = fread(Buffer, 1, sizeof(Buffer), pFile)) > 0)
+    {
+        pContents->insert(pContents->end(), Buffer, Buffer + Read);
+    }
+
+    fclose(pFile);
+    remove(pFileName);
+
+    return TRUE;
+}
+
+// Splits a file into its text header, ending with the line that starts with
+// pLastLine, and the bytes after it
+static BOOL TofTestSplitFile(const std::vector<UINT8>& Contents, const char* pLastLine, std::string* pHeader,
+                             std::vector<UINT8>* pBody)
+{
+    std::string Text(Contents.begin(), Contents.end());
+    size_t Line = Text.find(pLastLine);
+    size_t End;
+
+
+    if ((Line == std::string::npos) || ((End = Text.find('\n', Line)) == std::string::npos))
+    {
+        return FALSE;
+    }
+
+    pHeader->assign(Text, 0, End + 1);
+    pBody->assign(Contents.begin() + End + 1, Contents.end());
+
+    return TRUE;
+}
+
+// Writes frame 3 of the room scene in Format and returns the reference cloud
+static BOOL TofTestExport(TofCloudFileFormatE Format, UINT32 MinAmplitude, std::vector<PicoP_Pcd_Data>* pExpected,
+                          std::vector<UINT32>* pData)
+{
+    TofFrameGeometry Geometry;
+    TofScanGeometry Scan;
+    TofFrameView View;
+    TofCloudWriter Writer;
+    UINT32 NumPoints = 0;
+
+
+    TofTestGeometry(eTOF_DATA_FUSED, TOF_TEST_PULSES, TOF_TEST_LINES, 1, 1, &Geometry);
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 3, pData);
+    TofMakeFrameView(&(*pData)[0], (UINT32)pData->size(), TOF_TEST_PULSES, TOF_TEST_LINES, eTOF_DATA_FUSED, &View);
+    TofDefaultScanGeometry(&Scan);
+
+    pExpected->resize(TOF_TEST_PULSES * TOF_TEST_LINES);
+    TofFrameToPointCloudScalar(&View, &Scan, &(*pExpected)[0], (UINT32)pExpected->size(), &NumPoints);
+
+    Writer.SetMinAmplitude(MinAmplitude);
+
+    return (Writer.Open(TOF_TEST_PREFIX, Format, &Scan, TOF_TEST_PULSES, TOF_TEST_LINES) == eSUCCESS) &&
+           (Writer.Write(&View, 7) == eSUCCESS) &&
+           (Writer.Close() == eSUCCESS);
+}
+
+// ****************************************************************************
+
+TOF_TEST(CloudWriterWritesBinaryPcd)
+{
+    std::vector<PicoP_Pcd_Data> Expected;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Contents;
+    std::vector<UINT8> Body;
+    std::string Header;
+
+
+    TOF_REQUIRE(TofTestExport(eTOF_CLOUD_PCD_BINARY, 0, &Expected, &Data));
+    TOF_REQUIRE(TofTestReadFile(TOF_TEST_PREFIX "00000007.pcd", &Contents));
+    TOF_REQUIRE(TofTestSplitFile(Contents, "DATA", &Header, &Body));
+
+    TOF_CHECK(Header.compare(0, 5, "# .PC") == 0);
+    TOF_CHECK(Header.find("WIDTH 64\nHEIGHT 24\n") != std::string::npos);
+    TOF_CHECK(Header.find("POINTS 1536\nDATA binary\n") != std::string::npos);
+    TOF_REQUIRE(Body.size() == Expected.size() * sizeof(PicoP_Pcd_Data));
+    TOF_CHECK(memcmp(&Body[0], &Expected[0], Body.size()) == 0);
+}
+
+TOF_TEST(CloudWriterWritesCompressedPcd)
+{
+    std::vector<PicoP_Pcd_Data> Expected;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Contents;
+    std::vector<UINT8> Body;
+    std::vector<INT32> Fields;
+    std::string Header;
+    UINT32 Sizes[2];
+    UINT32 Points;
+    UINT32 Bad = 0;
+
+
+    TOF_REQUIRE(TofTestExport(eTOF_CLOUD_PCD_BINARY_COMPRESSED, 0, &Expected, &Data));
+    TOF_REQUIRE(TofTestReadFile(TOF_TEST_PREFIX "00000007.pcd", &Contents));
+    TOF_REQUIRE(TofTestSplitFile(Contents, "DATA", &Header, &Body));
+    TOF_CHECK(Header.find("DATA binary_compressed\n") != std::string::npos);
+
+    TOF_REQUIRE(Body.size() > sizeof(Sizes));
+    memcpy(Sizes, &Body[0], sizeof(Sizes));
+    TOF_CHECK_EQ((UINT32)(Body.size() - sizeof(Sizes)), Sizes[0]);
+    TOF_REQUIRE(Sizes[1] == Expected.size() * sizeof(PicoP_Pcd_Data));
+    TOF_CHECK(Sizes[0] < Sizes[1]);
+
+    // x, y, z and intensity one array after the other
+    Fields.resize(Sizes[1] / sizeof(INT32));
+    TOF_REQUIRE(TofLzfDecompress(&Body[sizeof(Sizes)], Sizes[0], (UINT8*)&Fields[0], Sizes[1]) == Sizes[1]);
+    Points = (UINT32)Expected.size();
+
+    for (UINT32 i = 0; i < Points; i++)
+    {
+        Bad += ((Fields[i] != Expected[i].x) || (Fields[Points + i] != Expected[i].y) ||
+                (Fields[(2 * Points) + i] != Expected[i].z) ||
+                ((UINT32)Fields[(3 * Points) + i] != Expected[i].intensity)) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Bad);
+}
+
+TOF_TEST(CloudWriterWritesPly)
+{
+    std::vector<PicoP_Pcd_Data> Expected;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Contents;
+    std::vector<UINT8> Body;
+    std::string Header;
+
+
+    TOF_REQUIRE(TofTestExport(eTOF_CLOUD_PLY, 0, &Expected, &Data));
+    TOF_REQUIRE(TofTestReadFile(TOF_TEST_PREFIX "00000007.ply", &Contents));
+    TOF_REQUIRE(TofTestSplitFile(Contents, "end_header", &Header, &Body));
+
+    TOF_CHECK(Header.compare(0, 36, "ply\nformat binary_little_endian 1.0\n") == 0);
+    TOF_CHECK(Header.find("element vertex 1536\n") != std::string::npos);
+    TOF_REQUIRE(Body.size() == Expected.size() * sizeof(PicoP_Pcd_Data));
+    TOF_CHECK(memcmp(&Body[0], &Expected[0], Body.size()) == 0);
+}
+
+TOF_TEST(CloudWriterWritesOnlyValidPixels)
+{
+    std::vector<PicoP_Pcd_Data> Expected;
+    std::vector<PicoP_Pcd_Data> Valid;
+    std::vector<UINT32> Data;
+    std::vector<UINT8> Contents;
+    std::vector<UINT8> Body;
+    std::string Header;
+    char Line[64];
+    const UINT32* pAmplitude;
+
+
+    TOF_REQUIRE(TofTestExport(eTOF_CLOUD_PCD_BINARY, 100, &Expected, &Data));
+    pAmplitude = &Data[TOF_TEST_PULSES * TOF_TEST_LINES];
+
+    for (UINT32 i = 0; i < Expected.size(); i++)
+    {
+        if ((Data[i] != 0) && (pAmplitude[i] >= 100))
+        {
+            Valid.push_back(Expected[i]);
+        }
+    }
+
+    TOF_REQUIRE( ! Valid.empty());
+    TOF_REQUIRE(Valid.size() < Expected.size());
+    TOF_REQUIRE(TofTestReadFile(TOF_TEST_PREFIX "00000007.pcd", &Contents));
+    TOF_REQUIRE(TofTestSplitFile(Contents, "DATA", &Header, &Body));
+
+    snprintf(Line, sizeof(Line), "WIDTH %u\nHEIGHT 1\n", (UINT32)Valid.size());
+    TOF_CHECK(Header.find(Line) != std::string::npos);
+    TOF_REQUIRE(Body.size() == Valid.size() * sizeof(PicoP_Pcd_Data));
+    TOF_CHECK(memcmp(&Body[0], &Valid[0], Body.size()) == 0);
+}
+
+TOF_TEST(CloudWriterRejectsLongPrefix)
+{
+    std::string Prefix(TOF_CLOUD_WRITER_MAX_PATH - TOF_CLOUD_WRITER_MAX_SUFFIX, 'p');
+    TofScanGeometry Scan;
+    TofCloudWriter Writer;
+
+
+    TofDefaultScanGeometry(&Scan);
+
+    TOF_CHECK_EQ(eINVALID_ARG, Writer.Open(Prefix.c_str(), eTOF_CLOUD_PLY, &Scan, 8, 8));
+    Prefix.resize(Prefix.size() - 1);
+    TOF_CHECK_EQ(eSUCCESS, Writer.Open(Prefix.c_str(), eTOF_CLOUD_PLY, &Scan, 8, 8));
+    TOF_CHECK_EQ(eSUCCESS, Writer.Close());
+}
+
+// ****************************************************************************
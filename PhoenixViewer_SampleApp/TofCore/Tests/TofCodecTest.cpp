@@ -0,0 +1,225 @@
+// ****************************************************************************
+//  TofCodecTest.cpp
+//
+// Lossless round trip tests of the frame codec
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "TofCodec.h"
+#include "TofRecording.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+// Encodes and decodes one frame, returning the encoded size or 0 on a mismatch
+static size_t TofTestRoundTrip(const UINT32* pFrame, const UINT32* pReference, UINT32 Words, UINT32 LineWords)
+{
+    std::vector<UINT8> Encoded(TofCodecMaxBytes(Words, LineWords));
+    std::vector<UINT32> Decoded(Words, 0xdeadbeef);
+    size_t Bytes = 0;
+
+
+    if ((TofEncodeFrame(pFrame, pReference, Words, LineWords, &Encoded[0], Encoded.size(), &Bytes) != eSUCCESS) ||
+        (TofDecodeFrame(&Encoded[0], Bytes, pReference, &Decoded[0], Words) != eSUCCESS) ||
+        (memcmp(pFrame, &Decoded[0], Words * sizeof(UINT32)) != 0))
+    {
+        return 0;
+    }
+
+    return Bytes;
+}
+
+// ****************************************************************************
+
+TOF_TEST(CodecRoundTripsSimulatedFrames)
+{
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Previous;
+    std::vector<UINT32> Frame;
+    size_t Bytes;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 0, &Previous);
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 1, &Frame);
+
+    Bytes = TofTestRoundTrip(&Frame[0], NULL, Geometry.FrameWords, Geometry.NumPulses);
+    TOF_CHECK(Bytes != 0);
+    TOF_CHECK(Bytes < Geometry.FrameBytes / 2);
+
+    Bytes = TofTestRoundTrip(&Frame[0], &Previous[0], Geometry.FrameWords, Geometry.NumPulses);
+    TOF_CHECK(Bytes != 0);
+
+    // The noise free ramp is nearly all prediction
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_RAMP, 0, &Frame);
+    Bytes = TofTestRoundTrip(&Frame[0], NULL, Geometry.FrameWords, Geometry.NumPulses);
+    TOF_CHECK(Bytes != 0);
+    TOF_CHECK(Bytes < Geometry.FrameBytes / 8);
+}
+
+// ****************************************************************************
+//  Worst cases: full 32 bit noise, the largest residuals zigzag can make,
+//  and lengths that end partway through a block and a line
+// ****************************************************************************
+
+TOF_TEST(CodecRoundTripsExtremeWords)
+{
+    std::vector<UINT32> Frame(1000);
+    std::vector<UINT32> Reference(1000);
+    size_t Bytes;
+
+
+    srand(3);
+
+    for (size_t i = 0; i < Frame.size(); i++)
+    {
+        Frame[i] = ((UINT32)rand() << 17) ^ ((UINT32)rand() << 3) ^ (UINT32)rand();
+        Reference[i] = ~Frame[i];
+    }
+
+    Bytes = TofTestRoundTrip(&Frame[0], NULL, 1000, 100);
+    TOF_CHECK(Bytes != 0);
+    TOF_CHECK(Bytes <= TofCodecMaxBytes(1000, 100));
+    TOF_CHECK(TofTestRoundTrip(&Frame[0], &Reference[0], 1000, 100) != 0);
+
+    for (size_t i = 0; i < Frame.size(); i++)
+    {
+        Frame[i] = (i & 1) ? 0xffffffffu : 0;
+    }
+
+    TOF_CHECK(TofTestRoundTrip(&Frame[0], NULL, 1000, 100) != 0);
+    TOF_CHECK(TofTestRoundTrip(&Frame[0], NULL, 999, 37) != 0);
+    TOF_CHECK(TofTestRoundTrip(&Frame[0], NULL, 1, 1) != 0);
+
+    Frame.assign(Frame.size(), 0);
+    Bytes = TofTestRoundTrip(&Frame[0], NULL, 1000, 100);
+    TOF_CHECK(Bytes != 0);
+    TOF_CHECK(Bytes < 200);
+}
+
+// ****************************************************************************
+
+TOF_TEST(CodecRejectsBadInput)
+{
+    std::vector<UINT32> Frame(256, 7);
+    std::vector<UINT32> Decoded(256);
+    std::vector<UINT8> Encoded(TofCodecMaxBytes(256, 16));
+    size_t Bytes = 0;
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, TofEncodeFrame(&Frame[0], NULL, 256, 16, &Encoded[0], 16, &Bytes));
+    TOF_REQUIRE(TofEncodeFrame(&Frame[0], &Frame[0], 256, 16, &Encoded[0], Encoded.size(), &Bytes) == eSUCCESS);
+
+    // Inter frame without its reference, wrong size, truncated, bad magic
+    TOF_CHECK_EQ(eINVALID_ARG, TofDecodeFrame(&Encoded[0], Bytes, NULL, &Decoded[0], 256));
+    TOF_CHECK_EQ(eINVALID_ARG, TofDecodeFrame(&Encoded[0], Bytes, &Frame[0], &Decoded[0], 255));
+    TOF_CHECK(TofDecodeFrame(&Encoded[0], Bytes - 1, &Frame[0], &Decoded[0], 256) != eSUCCESS);
+    Encoded[0] ^= 0xff;
+    TOF_CHECK_EQ(eFRAME_ERROR, TofDecodeFrame(&Encoded[0], Bytes, &Frame[0], &Decoded[0], 256));
+}
+
+// ****************************************************************************
+
+TOF_TEST(CodecBatchMatchesSingleThread)
+{
+    const UINT32 FrameCount = 12;
+    const UINT32 KeyInterval = 4;
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Frames;
+    std::vector<UINT32> Frame;
+    std::vector<UINT32> Decoded;
+    std::vector<std::vector<UINT8> > One;
+    std::vector<std::vector<UINT8> > Three;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 64, 32, 1, 1, &Geometry) == eSUCCESS);
+
+    for (UINT32 i = 0; i < FrameCount; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Frame);
+        Frames.insert(Frames.end(), Frame.begin(), Frame.end());
+    }
+
+    TOF_REQUIRE(TofEncodeFrames(&Frames[0], FrameCount, Geometry.FrameWords, Geometry.NumPulses,
+                                KeyInterval, 1, &One) == eSUCCESS);
+    TOF_REQUIRE(TofEncodeFrames(&Frames[0], FrameCount, Geometry.FrameWords, Geometry.NumPulses,
+                                KeyInterval, 3, &Three) == eSUCCESS);
+    TOF_CHECK(One == Three);
+
+    Decoded.assign(Frames.size(), 0);
+    TOF_REQUIRE(TofDecodeFrames(Three, KeyInterval, 3, &Decoded[0], Geometry.FrameWords) == eSUCCESS);
+    TOF_CHECK(Decoded == Frames);
+}
+
+// ****************************************************************************
+//  A compressed recording reads back bit exact, in order and when seeking
+//  backwards across key frames
+// ****************************************************************************
+
+TOF_TEST(CodecCompressedRecordingRoundTrip)
+{
+    const char* pFileName = "TofCodecTest.tofrec";
+    const UINT32 FrameCount = 20;
+    TofFrameGeometry Geometry;
+    std::vector<std::vector<UINT32> > Frames(FrameCount);
+    PicoP_TofPulsingConfig Config;
+    TofRecorder Recorder;
+    TofRecordingReader Reader;
+    TofRecordedFrame Recorded;
+    TofClock::time_point Now = TofClock::now();
+    UINT32 Index;
+    UINT32 Bad = 0;
+    PICOP_RC PicopRc;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 120, 72, 1, 1, &Geometry) == eSUCCESS);
+    memset(&Config, 0, sizeof(Config));
+    Config.nrPulsesPerLine = (UINT16)Geometry.NumPulses;
+
+    TOF_REQUIRE(Recorder.Open(pFileName, &Config, Geometry.Format, Geometry.FrameBytes, TRUE) == eSUCCESS);
+
+    for (UINT32 i = 0; i < FrameCount; i++)
+    {
+        TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, i, &Frames[i]);
+
+        while ((PicopRc = Recorder.Write(&Frames[i][0], i, Now, Now)) == eBUSY)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        TOF_REQUIRE(PicopRc == eSUCCESS);
+    }
+
+    TOF_REQUIRE(Recorder.Close() == eSUCCESS);
+    TOF_REQUIRE(Reader.Open(pFileName) == eSUCCESS);
+    TOF_CHECK(Reader.IsCompressed());
+    TOF_CHECK_EQ(FrameCount, Reader.GetFrameCount());
+
+    for (UINT32 i = 0; i < FrameCount * 2; i++)
+    {
+        Index = (i < FrameCount) ? i : (FrameCount * 2 - 1 - i);
+
+        Bad += ((Reader.GetFrame(Index, &Recorded) != eSUCCESS) ||
+                (memcmp(Recorded.pData, &Frames[Index][0], Geometry.FrameBytes) != 0)) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Bad);
+
+    Reader.Close();
+    remove(pFileName);
+}
+
+// ****************************************************************************
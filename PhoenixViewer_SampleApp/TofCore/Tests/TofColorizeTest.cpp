@@ -0,0 +1,155 @@
+// ****************************************************************************
+//  TofColorizeTest.cpp
+//
+// Tests of the table driven colorizer against the per-pixel drawing loop
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include <vector>
+#include "TofColorize.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+//  The viewer's original drawing loop: a divide per pixel to place it, then
+//  the low byte written as gray, or as yellow (blue off)
+// ****************************************************************************
+
+#define TOF_TEST_BITMAP_WIDTH   520
+#define TOF_TEST_BITMAP_HEIGHT  200
+#define TOF_TEST_BITMAP_STRIDE  (TOF_TEST_BITMAP_WIDTH * TOF_BYTES_PER_PIXEL)
+
+static void TofTestReferenceDraw(const UINT32* pPlane, UINT32 NumPulses, UINT32 NumLines,
+                                 UINT32 OffsetX, UINT32 ImageWidth, UINT32 ImageHeight,
+                                 BOOL Yellow, UINT8* pBitmap)
+{
+    UINT32 X;
+    UINT32 Y;
+    UINT8 Value;
+
+
+    for (UINT32 Line = 0; Line < NumLines; Line++)
+    {
+        for (UINT32 Pulse = 0; Pulse < NumPulses; Pulse++)
+        {
+            Value = (UINT8)(pPlane[Line * NumPulses + Pulse] & 0x000000ff);
+            X = ((Pulse * ImageWidth) / NumPulses + OffsetX) * TOF_BYTES_PER_PIXEL;
+            Y = ((NumLines - Line) * ImageHeight) / NumLines;
+
+            pBitmap[Y * TOF_TEST_BITMAP_STRIDE + X + 0] = Yellow ? 0 : Value;
+            pBitmap[Y * TOF_TEST_BITMAP_STRIDE + X + 1] = Value;
+            pBitmap[Y * TOF_TEST_BITMAP_STRIDE + X + 2] = Value;
+        }
+    }
+}
+
+static void TofTestRandomPlane(std::vector<UINT32>* pPlane, UINT32 Words, UINT32 Seed)
+{
+    srand(Seed);
+    pPlane->resize(Words);
+
+    for (UINT32 i = 0; i < Words; i++)
+    {
+        (*pPlane)[i] = ((UINT32)rand() << 16) ^ (UINT32)rand();
+    }
+}
+
+// Both bitmaps start with the same fill, so untouched bytes must match too
+static UINT32 TofTestCompareDraw(UINT32 NumPulses, UINT32 NumLines, UINT32 OffsetX,
+                                 UINT32 ImageWidth, UINT32 ImageHeight, TofPaletteE Palette)
+{
+    std::vector<UINT32> Plane;
+    std::vector<UINT8> Expected(TOF_TEST_BITMAP_STRIDE * TOF_TEST_BITMAP_HEIGHT, 0x5a);
+    std::vector<UINT8> Actual(Expected);
+    TofColorizer Colorizer;
+    UINT32 Mismatches = 0;
+
+
+    TofTestRandomPlane(&Plane, NumPulses * NumLines, NumPulses + ImageWidth);
+
+    if (Colorizer.Create(NumPulses, NumLines, TOF_TEST_BITMAP_WIDTH, TOF_TEST_BITMAP_HEIGHT,
+                         TOF_TEST_BITMAP_STRIDE, OffsetX, ImageWidth, ImageHeight) != eSUCCESS)
+    {
+        return 0xffffffff;
+    }
+
+    Colorizer.SetPalette(Palette);
+    Colorizer.Colorize(&Plane[0], &Actual[0]);
+    TofTestReferenceDraw(&Plane[0], NumPulses, NumLines, OffsetX, ImageWidth, ImageHeight,
+                         (Palette == eTOF_PALETTE_YELLOW), &Expected[0]);
+
+    for (size_t i = 0; i < Expected.size(); i++)
+    {
+        Mismatches += (Expected[i] != Actual[i]) ? 1 : 0;
+    }
+
+    return Mismatches;
+}
+
+// ****************************************************************************
+
+TOF_TEST(NarrowLowByteMatchesScalar)
+{
+    std::vector<UINT32> Source;
+    std::vector<UINT8> Expected;
+    std::vector<UINT8> Actual;
+
+
+    TofTestRandomPlane(&Source, 200, 7);
+
+    // Every length around the 16 and 32 word vector steps
+    for (UINT32 Count = 0; Count <= 100; Count++)
+    {
+        Expected.assign(Count + 1, 0xee);
+        Actual.assign(Count + 1, 0xee);
+
+        TofNarrowLowByteScalar(&Source[1], &Expected[0], Count);
+        TofNarrowLowByte(&Source[1], &Actual[0], Count);
+
+        if (Expected != Actual)
+        {
+            TOF_CHECK_EQ(0u, Count);
+            break;
+        }
+    }
+}
+
+TOF_TEST(ColorizeMatchesPerPixelLoopGray)
+{
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(120, 720, 80, 120, 180, eTOF_PALETTE_GRAY));
+}
+
+TOF_TEST(ColorizeMatchesPerPixelLoopYellow)
+{
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(120, 720, 80, 120, 180, eTOF_PALETTE_YELLOW));
+}
+
+TOF_TEST(ColorizeMatchesPerPixelLoopOtherGeometries)
+{
+    // Line phases widen the line, and a different image width scatters the pulses
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(240, 360, 80, 240, 180, eTOF_PALETTE_GRAY));
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(480, 180, 0, 480, 180, eTOF_PALETTE_GRAY));
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(100, 720, 10, 100, 150, eTOF_PALETTE_GRAY));
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(120, 720, 20, 360, 199, eTOF_PALETTE_YELLOW));
+    TOF_CHECK_EQ(0u, TofTestCompareDraw(120, 90, 0, 60, 180, eTOF_PALETTE_GRAY));
+}
+
+TOF_TEST(ColorizeCreateRejectsBadLayout)
+{
+    TofColorizer Colorizer;
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, Colorizer.Create(0, 720, 520, 200, 1560, 80, 120, 180));
+    TOF_CHECK_EQ(eINVALID_ARG, Colorizer.Create(120, 720, 520, 200, 1560, 450, 120, 180));
+    TOF_CHECK_EQ(eINVALID_ARG, Colorizer.Create(120, 720, 520, 200, 1560, 80, 120, 200));
+    TOF_CHECK_EQ(eINVALID_ARG, Colorizer.Create(120, 720, 520, 200, 1559, 80, 120, 180));
+}
+
+// ****************************************************************************
@@ -0,0 +1,421 @@
+// ****************************************************************************
+//  TofDOutBGovernorTest.cpp
+//
+// Tests of the TDC B data scale governor
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <chrono>
+#include <vector>
+#include "TofCore.h"
+#include "TofSim.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+// Update() is driven with made up times, one window a second with as many
+// frames as the rate wanted. The simulated device only takes the scale.
+// ****************************************************************************
+
+typedef struct
+{
+    PicoP_HANDLE Library;
+    PicoP_HANDLE Connection;
+    TofDOutBGovernor Governor;
+    TofClock::time_point Now;
+    UINT32 Frames;
+    UINT32 WindowMs;
+} TofTestLoop;
+
+static PICOP_RC TofTestOpen(TofTestLoop* pLoop, PicoP_ToFDataFormatE Format, const TofDOutBGovernorParams* pParams)
+{
+    TofSimConfig Config;
+    TofFrameGeometry Geometry;
+
+
+    TofSimDefaultConfig(&Config);
+
+    pLoop->Library = NULL;
+    pLoop->Now = TofClock::now();
+    pLoop->Frames = 0;
+    pLoop->WindowMs = pParams->WindowMs;
+
+    pLoop->Connection = TofTestConnect(&pLoop->Library, &Config);
+    PicoP_TLC_SetDOutBScale(pLoop->Connection, DOUTB_SCALE_MAX, FALSE);
+    TofTestGeometry(Format, 120, 720, 1, 1, &Geometry);
+
+    return pLoop->Governor.Create(pParams, &Geometry, DOUTB_SCALE_MAX);
+}
+
+static void TofTestClose(TofTestLoop* pLoop)
+{
+    TofTestDisconnect(pLoop->Library, pLoop->Connection);
+}
+
+static void TofTestParams(TofDOutBGovernorParams* pParams)
+{
+    TofDefaultDOutBGovernorParams(pParams);
+    pParams->HoldWindows = 4;
+    pParams->MaxHoldWindows = 16;
+}
+
+// Starts a window, as after Create() or Apply()
+static void TofTestStart(TofTestLoop* pLoop)
+{
+    pLoop->Governor.Update(pLoop->Now, pLoop->Frames);
+}
+
+// Ends a window at Fps; TRUE when the scale should change
+static BOOL TofTestWindow(TofTestLoop* pLoop, UINT32 Fps)
+{
+    pLoop->Now += std::chrono::milliseconds(pLoop->WindowMs);
+    pLoop->Frames += Fps;
+
+    return pLoop->Governor.Update(pLoop->Now, pLoop->Frames);
+}
+
+static UINT32 TofTestApply(TofTestLoop* pLoop)
+{
+    UINT32 Scale = DOUTB_SCALE_MAX + 1;
+
+
+    pLoop->Governor.Apply(pLoop->Connection);
+    PicoP_TLC_GetDOutBScale(pLoop->Connection, &Scale, eCURRENT_VALUE);
+    TofTestStart(pLoop);
+
+    return Scale;
+}
+
+// Writable view of a plane TofMakeFramePlanes found in pFrame
+static UINT32* TofTestPlane(std::vector<UINT32>* pFrame, const UINT32* pPlane)
+{
+    return &(*pFrame)[pPlane - &(*pFrame)[0]];
+}
+
+// ****************************************************************************
+
+TOF_TEST(GovernorRefusesFormatsWithoutTdcB)
+{
+    TofDOutBGovernor Governor;
+    TofDOutBGovernorParams Params;
+    TofFrameGeometry Geometry;
+
+
+    TofDefaultDOutBGovernorParams(&Params);
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_LEFT_SENSOR_ONLY, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+    TOF_CHECK_EQ(eUNINITIALIZED, Governor.Apply(NULL));
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eINVALID_ARG, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX + 1));
+    Params.StepDown = 0;
+    TOF_CHECK_EQ(eINVALID_ARG, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+
+    TofDefaultDOutBGovernorParams(&Params);
+    TOF_CHECK_EQ(eSUCCESS, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_RIGHT_SENSOR_ONLY, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_DEPTH_ONLY, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, Governor.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+}
+
+// ****************************************************************************
+//  Through TofCore.h, as the viewer sees both: a format ladder that leaves
+//  the scale to the governor, started at whatever scale the governor chose
+// ****************************************************************************
+
+TOF_TEST(GovernorBesideNoScaleFormatLadder)
+{
+    TofDOutBGovernor Governor;
+    TofDOutBGovernorParams Params;
+    TofFormatController Controller;
+    TofFormatControlParams LadderParams;
+    TofFrameGeometry Geometry;
+    UINT32 Governed = DOUTB_SCALE_MAX * 5 / 16;
+
+
+    TOF_CHECK(TOF_DOUTB_NO_SCALE > DOUTB_SCALE_MAX);
+    TOF_CHECK(TOF_DOUTB_NO_SHORT_SCALE > DOUTB_SCALE_MAX);
+
+    TofDefaultDOutBGovernorParams(&Params);
+    TofDefaultFormatControlParams(&LadderParams);
+    LadderParams.NumLevels = 2;
+    LadderParams.Levels[0].DOutBScale = TOF_DOUTB_NO_SCALE;
+    LadderParams.Levels[1].Format = eTOF_DATA_FUSED;
+    LadderParams.Levels[1].DOutBScale = TOF_DOUTB_NO_SCALE;
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, Governor.Create(&Params, &Geometry, Governed));
+    TOF_CHECK_EQ(eSUCCESS, Controller.Create(&LadderParams, &Geometry, Governor.GetScale()));
+    TOF_CHECK_EQ(0u, Controller.GetLevel());
+    TOF_CHECK_EQ(TOF_DOUTB_NO_SCALE, Controller.GetLevelSettings(0)->DOutBScale);
+}
+
+// ****************************************************************************
+//  A readout bound device: every step down raises the frame rate, so the
+//  scale keeps falling until the target is met
+// ****************************************************************************
+
+TOF_TEST(GovernorStepsDownWhileTheFrameRateRises)
+{
+    TofTestLoop Loop;
+    TofDOutBGovernorParams Params;
+    TofDOutBGovernorStats Stats;
+    UINT32 First;
+    UINT32 Second;
+
+
+    TofTestParams(&Params);
+    TOF_REQUIRE(TofTestOpen(&Loop, eTOF_DATA_ALL, &Params) == eSUCCESS);
+    TofTestStart(&Loop);
+
+    // Proportional to the shortfall, and at least StepDown
+    TOF_REQUIRE(TofTestWindow(&Loop, 20));
+    First = TofTestApply(&Loop);
+    TOF_CHECK(First <= ((DOUTB_SCALE_MAX * 2) / 3));
+    TOF_CHECK_EQ(0u, First % TOF_DOUTB_SCALE_QUANTUM);
+
+    TOF_REQUIRE(TofTestWindow(&Loop, 27));
+    Second = TofTestApply(&Loop);
+    TOF_CHECK(Second < First);
+    TOF_CHECK(Second <= (First - Params.StepDown));
+
+    // On target the scale steps back up, but stops short of the scale that
+    // was too slow
+    TofTestWindow(&Loop, 30);
+    TOF_CHECK(Loop.Governor.GetScale() > Second);
+    TOF_CHECK(Loop.Governor.GetScale() < First);
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_EQ(2u, (UINT32)Stats.StepsDown);
+    TOF_CHECK_EQ(0u, (UINT32)Stats.FailedStepsDown);
+    TOF_CHECK_EQ(2u, (UINT32)Stats.Changes);
+    TOF_CHECK_EQ(First, Stats.ShortScale);
+    TOF_CHECK( ! Stats.Held);
+
+    TofTestClose(&Loop);
+}
+
+// ****************************************************************************
+//  A link bound device: a step down by a third does not raise the frame
+//  rate, so the scale goes back to full and stays there while the rate holds
+// ****************************************************************************
+
+TOF_TEST(GovernorHoldsTheScaleWhenTheLinkIsTheLimit)
+{
+    TofTestLoop Loop;
+    TofDOutBGovernorParams Params;
+    TofDOutBGovernorStats Stats;
+
+
+    TofTestParams(&Params);
+    TOF_REQUIRE(TofTestOpen(&Loop, eTOF_DATA_ALL, &Params) == eSUCCESS);
+    TofTestStart(&Loop);
+
+    TOF_REQUIRE(TofTestWindow(&Loop, 20));
+    TOF_CHECK(TofTestApply(&Loop) < DOUTB_SCALE_MAX);
+
+    TOF_REQUIRE(TofTestWindow(&Loop, 20));
+    TOF_CHECK_EQ(DOUTB_SCALE_MAX, TofTestApply(&Loop));
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.FailedStepsDown);
+    TOF_CHECK(Stats.Held);
+    TOF_CHECK_NEAR(20.0f * 1382400.0f, Stats.Throughput, 1.0f);
+
+    for (UINT32 i = 0; i < 5; i++)
+    {
+        TOF_CHECK( ! TofTestWindow(&Loop, 20));
+    }
+
+    // The link slowed down further: worth another try
+    TOF_CHECK(TofTestWindow(&Loop, 15));
+    TOF_CHECK(Loop.Governor.GetScale() < DOUTB_SCALE_MAX);
+
+    TofTestClose(&Loop);
+}
+
+// ****************************************************************************
+//  Steps too small to tell from noise one by one are judged together, once
+//  the scale is down by a third
+// ****************************************************************************
+
+TOF_TEST(GovernorJudgesSmallStepsTogether)
+{
+    TofTestLoop Loop;
+    TofDOutBGovernorParams Params;
+    TofDOutBGovernorStats Stats;
+    UINT32 Scale = DOUTB_SCALE_MAX;
+    UINT32 Steps;
+
+
+    TofTestParams(&Params);
+    TOF_REQUIRE(TofTestOpen(&Loop, eTOF_DATA_ALL, &Params) == eSUCCESS);
+    TofTestStart(&Loop);
+
+    for (Steps = 0; (Steps < 10) && TofTestWindow(&Loop, 27) && (Loop.Governor.GetScale() < Scale); Steps++)
+    {
+        Scale = TofTestApply(&Loop);
+    }
+
+    TOF_CHECK(Steps > 1);
+    TOF_CHECK_EQ(DOUTB_SCALE_MAX, Loop.Governor.GetScale());
+    TofTestApply(&Loop);
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.FailedStepsDown);
+    TOF_CHECK(Stats.Held);
+
+    // A frame either way is noise, the hold stays
+    TOF_CHECK( ! TofTestWindow(&Loop, 28));
+    TOF_CHECK( ! TofTestWindow(&Loop, 26));
+
+    TofTestClose(&Loop);
+}
+
+// ****************************************************************************
+//  After HoldWindows healthy windows the scale that fell short is tried
+//  again; when it falls short again the wait doubles
+// ****************************************************************************
+
+TOF_TEST(GovernorRetriesTheShortScaleAfterHolding)
+{
+    TofTestLoop Loop;
+    TofDOutBGovernorParams Params;
+    TofDOutBGovernorStats Stats;
+    UINT32 Windows;
+
+
+    TofTestParams(&Params);
+    TOF_REQUIRE(TofTestOpen(&Loop, eTOF_DATA_RIGHT_SENSOR_ONLY, &Params) == eSUCCESS);
+    TofTestStart(&Loop);
+
+    TOF_REQUIRE(TofTestWindow(&Loop, 27));
+    TofTestApply(&Loop);
+
+    for (Windows = 0; (Windows < 40) && (Loop.Governor.GetScale() < DOUTB_SCALE_MAX); Windows++)
+    {
+        if (TofTestWindow(&Loop, 30))
+        {
+            TofTestApply(&Loop);
+        }
+    }
+
+    TOF_CHECK_EQ(DOUTB_SCALE_MAX, Loop.Governor.GetScale());
+    TOF_CHECK(Windows >= Params.HoldWindows);
+    TofTestApply(&Loop);
+
+    // Short again at full scale, then count the windows to the next retry
+    TOF_REQUIRE(TofTestWindow(&Loop, 27));
+    TofTestApply(&Loop);
+
+    for (Windows = 0; (Windows < 40) && (Loop.Governor.GetScale() < DOUTB_SCALE_MAX); Windows++)
+    {
+        if (TofTestWindow(&Loop, 30))
+        {
+            TofTestApply(&Loop);
+        }
+    }
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_EQ(DOUTB_SCALE_MAX, Loop.Governor.GetScale());
+    TOF_CHECK(Windows >= (Params.HoldWindows * 2));
+    TOF_CHECK_EQ(TOF_DOUTB_NO_SHORT_SCALE, Stats.ShortScale);
+
+    TofTestClose(&Loop);
+}
+
+// ****************************************************************************
+
+TOF_TEST(GovernorKeepsTheReadoutInBudget)
+{
+    TofTestLoop Loop;
+    TofDOutBGovernorParams Params;
+    TofDOutBGovernorStats Stats;
+
+
+    TofTestParams(&Params);
+    Params.BudgetBytesPerSecond = (UINT32)(30.0f * TofTdcBReadBytes(120 * 720, DOUTB_SCALE_MAX) / 2);
+    TOF_REQUIRE(TofTestOpen(&Loop, eTOF_DATA_ALL, &Params) == eSUCCESS);
+    TofTestStart(&Loop);
+
+    TOF_CHECK(TofTestWindow(&Loop, 30));
+    TOF_CHECK_EQ(DOUTB_SCALE_MAX / 2, TofTestApply(&Loop));
+
+    for (UINT32 i = 0; i < 10; i++)
+    {
+        TOF_CHECK( ! TofTestWindow(&Loop, 30));
+    }
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_EQ(DOUTB_SCALE_MAX / 2, Stats.BudgetScale);
+
+    TofTestClose(&Loop);
+}
+
+// ****************************************************************************
+//  Right detector samples without a return are not worth their readout
+// ****************************************************************************
+
+TOF_TEST(GovernorMeasuresTdcBReturns)
+{
+    TofTestLoop Loop;
+    TofDOutBGovernorParams Params;
+    TofDOutBGovernorStats Stats;
+    TofFrameGeometry Geometry;
+    TofFramePlanes Planes;
+    std::vector<UINT32> Frame;
+
+
+    TofTestParams(&Params);
+    TOF_REQUIRE(TofTestOpen(&Loop, eTOF_DATA_ALL, &Params) == eSUCCESS);
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    Frame.assign(Geometry.FrameWords, 100);
+    TOF_REQUIRE(TofMakeFramePlanes(&Frame[0], Geometry.FrameWords, 120, 720, eTOF_DATA_ALL, &Planes) == eSUCCESS);
+    TofTestStart(&Loop);
+
+    // Both detectors return everywhere, but the left one only in the second
+    // half of the frame
+    for (UINT32 i = 0; i < (Geometry.PlaneWords / 2); i++)
+    {
+        TofTestPlane(&Frame, Planes.pPlane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_AMPLITUDE])[i] = 0;
+    }
+
+    TOF_CHECK_EQ(eSUCCESS, Loop.Governor.MeasureFrame(&Frame[0], Geometry.FrameWords));
+    TOF_CHECK_EQ(eFRAME_ERROR, Loop.Governor.MeasureFrame(&Frame[0], Geometry.FrameWords - 1));
+    TOF_CHECK( ! TofTestWindow(&Loop, 30));
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.FramesMeasured);
+    TOF_CHECK_NEAR(1.0f, Stats.Useful, 0.001f);
+    TOF_CHECK_NEAR(0.5f, Stats.FilledIn, 0.001f);
+
+    // No right returns: down to MinScale whatever the frame rate
+    Frame.assign(Geometry.FrameWords, 100);
+
+    for (UINT32 i = 0; i < Geometry.PlaneWords; i++)
+    {
+        TofTestPlane(&Frame, Planes.pPlane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_AMPLITUDE])[i] = 0;
+    }
+
+    Loop.Governor.MeasureFrame(&Frame[0], Geometry.FrameWords);
+    TOF_CHECK(TofTestWindow(&Loop, 30));
+    TOF_CHECK_EQ(Params.MinScale, TofTestApply(&Loop));
+
+    Loop.Governor.GetStats(&Stats);
+    TOF_CHECK_NEAR(0.0f, Stats.Useful, 0.001f);
+
+    TofTestClose(&Loop);
+}
+
+// ****************************************************************************
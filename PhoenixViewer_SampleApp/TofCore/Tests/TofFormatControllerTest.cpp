@@ -0,0 +1,390 @@
+// ****************************************************************************
+//  TofFormatControllerTest.cpp
+//
+// Tests of data format switching against a throttled simulated link
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "TofAcquisition.h"
+#include "TofFormatController.h"
+#include "TofFrameRing.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_TIMEOUT_MS     5000
+
+typedef struct
+{
+    std::atomic<UINT32> Frames;
+    std::atomic<UINT32> Failures;
+    std::atomic<UINT32> LastFrameWords;
+} TofTestConsumer;
+
+static void TofTestOnFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofTestConsumer* pConsumer = (TofTestConsumer*)pContext;
+
+
+    if ((pFrame->Result != eSUCCESS) || (pFrame->pData == NULL))
+    {
+        pConsumer->Failures++;
+        return;
+    }
+
+    pConsumer->LastFrameWords = pFrame->FrameWords;
+    pConsumer->Frames++;
+}
+
+static void TofTestResetConsumer(TofTestConsumer* pConsumer)
+{
+    pConsumer->Frames = 0;
+    pConsumer->Failures = 0;
+    pConsumer->LastFrameWords = 0;
+}
+
+// Link and detector readout limits in bytes per second, 0 for none
+static TofSimConfig TofTestSimConfig(UINT32 LinkBytesPerSecond, UINT32 TdcBytesPerSecond)
+{
+    TofSimConfig Config;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.LinkBytesPerSecond = LinkBytesPerSecond;
+    Config.TdcBytesPerSecond = TdcBytesPerSecond;
+
+    return Config;
+}
+
+static PICOP_RC TofTestSetFormat(PicoP_HANDLE Connection, PicoP_ToFDataFormatE Format)
+{
+    PICOP_RC Result;
+
+
+    Result = PicoP_TLC_SetSensingState(Connection, eSENSING_DISABLED, FALSE);
+
+    if (Result == eSUCCESS)
+    {
+        Result = PicoP_TLC_SetTofDataFormat(Connection, Format, FALSE);
+    }
+
+    if (Result == eSUCCESS)
+    {
+        Result = PicoP_TLC_SetSensingState(Connection, eSENSING_ENABLED, FALSE);
+    }
+
+    return Result;
+}
+
+static UINT32 TofTestDeviceFrameWords(PicoP_HANDLE Connection)
+{
+    UINT32 FrameBytes = 0;
+
+
+    PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes);
+
+    return FrameBytes / sizeof(UINT32);
+}
+
+// Quick windows that step up after one healthy window, for driving
+// Update() with made up times
+static void TofTestFastParams(TofFormatControlParams* pParams)
+{
+    TofDefaultFormatControlParams(pParams);
+    pParams->WindowMs = 100;
+    pParams->UpWindows = 1;
+    pParams->SettleMs = 0;
+}
+
+// ****************************************************************************
+
+TOF_TEST(FormatControllerRejectsBadParams)
+{
+    TofFormatController Controller;
+    TofFormatControlParams Params;
+    TofFrameGeometry Geometry;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+
+    TofDefaultFormatControlParams(&Params);
+    Params.NumLevels = 0;
+    TOF_CHECK_EQ(eINVALID_ARG, Controller.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+
+    TofDefaultFormatControlParams(&Params);
+    Params.Levels[1].DOutBScale = DOUTB_SCALE_MAX + 1;
+    TOF_CHECK_EQ(eINVALID_ARG, Controller.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+
+    TofDefaultFormatControlParams(&Params);
+    Params.TargetFps = 0.0f;
+    TOF_CHECK_EQ(eINVALID_ARG, Controller.Create(&Params, &Geometry, DOUTB_SCALE_MAX));
+    TOF_CHECK_EQ(eUNINITIALIZED, Controller.Apply(NULL));
+}
+
+// ****************************************************************************
+//  Levels that leave the scale alone, as beside a TofDOutBGovernor: the
+//  switch from ALL to fused keeps whatever scale the device had
+// ****************************************************************************
+
+TOF_TEST(ApplyLeavesScaleForNoScaleLevels)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(0, 0);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    TofFormatController Controller;
+    TofFormatControlParams Params;
+    TofFrameGeometry Geometry;
+    TofClock::time_point Now = TofClock::now();
+    UINT32 Governed = DOUTB_SCALE_MAX * 5 / 16;
+    UINT32 DOutBScale = 0;
+    UINT32 Frames = 0;
+
+
+    TofTestFastParams(&Params);
+    TOF_CHECK_EQ(TOF_DOUTB_NO_SCALE, Params.Levels[2].DOutBScale);
+    TOF_CHECK_EQ(TOF_DOUTB_NO_SCALE, Params.Levels[TOF_FORMAT_MAX_LEVELS - 1].DOutBScale);
+
+    Params.NumLevels = 2;
+    Params.Levels[0].DOutBScale = TOF_DOUTB_NO_SCALE;
+    Params.Levels[1].Format = eTOF_DATA_FUSED;
+    Params.Levels[1].DOutBScale = TOF_DOUTB_NO_SCALE;
+
+    TOF_REQUIRE(Connection != NULL);
+    TOF_REQUIRE(TofTestSetFormat(Connection, eTOF_DATA_ALL) == eSUCCESS);
+    TOF_REQUIRE(PicoP_TLC_SetDOutBScale(Connection, Governed, FALSE) == eSUCCESS);
+    TOF_REQUIRE(TofQueryFrameGeometry(Connection, &Geometry) == eSUCCESS);
+
+    // Matches level 0 whatever the scale
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, Governed) == eSUCCESS);
+    TOF_CHECK_EQ(0u, Controller.GetLevel());
+
+    Controller.Update(Now, Frames, 0);
+
+    for (UINT32 i = 0; i < Params.DownWindows; i++)
+    {
+        Now += std::chrono::milliseconds(100);
+        Frames += 1;
+        Controller.Update(Now, Frames, 0);
+    }
+
+    TOF_REQUIRE(Controller.GetTargetLevel() == 1);
+    TOF_CHECK_EQ(eSUCCESS, Controller.Apply(Connection));
+    TOF_CHECK_EQ(1u, Controller.GetLevel());
+    TOF_CHECK_EQ(Geometry.FrameWords / 2, TofTestDeviceFrameWords(Connection));
+    TOF_CHECK_EQ(eSUCCESS, PicoP_TLC_GetDOutBScale(Connection, &DOutBScale, eCURRENT_VALUE));
+    TOF_CHECK_EQ(Governed, DOutBScale);
+
+    TofTestDisconnect(Library, Connection);
+}
+
+TOF_TEST(FormatControllerStepsDownAndBackUp)
+{
+    TofFormatController Controller;
+    TofFormatControlParams Params;
+    TofFormatControlStats Stats;
+    TofFrameGeometry Geometry;
+    TofClock::time_point Now = TofClock::now();
+    UINT32 Frames = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TofTestFastParams(&Params);
+    Params.UpWindows = 4;
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, DOUTB_SCALE_MAX) == eSUCCESS);
+    TOF_CHECK_EQ(0u, Controller.GetLevel());
+    TOF_CHECK_EQ(TofPlanesPerFrame(eTOF_DATA_ALL) * Geometry.PlaneWords, Controller.GetMaxFrameWords());
+
+    // 20 fps: the first short window is not enough, the second is
+    TOF_CHECK( ! Controller.Update(Now, Frames, 0));
+    Now += std::chrono::milliseconds(100);
+    Frames += 2;
+    TOF_CHECK( ! Controller.Update(Now, Frames, 0));
+    Now += std::chrono::milliseconds(100);
+    Frames += 2;
+    TOF_CHECK(Controller.Update(Now, Frames, 0));
+    TOF_CHECK_EQ(0u, Controller.GetLevel());
+
+    // The half scale level sends as many bytes, so it is tried before fused
+    TOF_CHECK_EQ(1u, Controller.GetTargetLevel());
+
+    Controller.GetStats(&Stats);
+    TOF_CHECK_EQ(2u, (UINT32)Stats.ShortWindows);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.StepsDown);
+    TOF_CHECK(Stats.LinkEstimate > 0.0f);
+
+    // Still due until applied
+    TOF_CHECK(Controller.Update(Now, Frames, 0));
+
+    // A backlog is short even at the full rate
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, DOUTB_SCALE_MAX) == eSUCCESS);
+    Controller.Update(Now, Frames, 0);
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        Now += std::chrono::milliseconds(100);
+        Frames += 3;
+        Controller.Update(Now, Frames, Params.MaxQueueDepth + 1);
+    }
+
+    TOF_CHECK_EQ(1u, Controller.GetTargetLevel());
+
+    // Healthy windows from the bottom step up one level
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, DOUTB_SCALE_MAX) == eSUCCESS);
+    TOF_CHECK_EQ(Params.NumLevels - 1, Controller.GetLevel());
+    Controller.Update(Now, Frames, 0);
+
+    for (UINT32 i = 0; i < Params.UpWindows; i++)
+    {
+        TOF_CHECK_EQ(Params.NumLevels - 1, Controller.GetTargetLevel());
+        Now += std::chrono::milliseconds(100);
+        Frames += 3;
+        Controller.Update(Now, Frames, 0);
+    }
+
+    TOF_CHECK_EQ(Params.NumLevels - 2, Controller.GetTargetLevel());
+}
+
+// ****************************************************************************
+//  The half scale level sends as many bytes as full ALL. When the readout
+//  was the limit it holds the rate and is kept; when the link was, the rate
+//  stays short and the next step goes on to fused.
+// ****************************************************************************
+
+TOF_TEST(FormatControllerKeepsScaleLevelOnlyWhileItHelps)
+{
+    TofFormatController Controller;
+    TofFormatControlParams Params;
+    TofFrameGeometry Geometry;
+    TofClock::time_point Now = TofClock::now();
+    UINT32 Frames = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TofTestFastParams(&Params);
+    Params.UpWindows = 4;
+
+    // Starts on the half scale level, 30 fps
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, Params.Levels[1].DOutBScale) == eSUCCESS);
+    TOF_CHECK_EQ(1u, Controller.GetLevel());
+    Controller.Update(Now, Frames, 0);
+
+    for (UINT32 i = 0; i < (Params.UpWindows - 1); i++)
+    {
+        Now += std::chrono::milliseconds(100);
+        Frames += 3;
+        TOF_CHECK( ! Controller.Update(Now, Frames, 0));
+    }
+
+    TOF_CHECK_EQ(1u, Controller.GetTargetLevel());
+
+    // Still 20 fps there: the link is the limit
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, Params.Levels[1].DOutBScale) == eSUCCESS);
+    Controller.Update(Now, Frames, 0);
+
+    for (UINT32 i = 0; i < Params.DownWindows; i++)
+    {
+        Now += std::chrono::milliseconds(100);
+        Frames += 2;
+        Controller.Update(Now, Frames, 0);
+    }
+
+    TOF_CHECK_EQ(2u, Controller.GetTargetLevel());
+    TOF_CHECK_EQ(eTOF_DATA_FUSED, Controller.GetLevelSettings(2)->Format);
+}
+
+// ****************************************************************************
+//  Fused to ALL doubles the frame; Apply() restarts the acquisition for it
+// ****************************************************************************
+
+TOF_TEST(ApplyRestartsAcquisitionForNewFrameSize)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(0, 0);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    TofAcquisition Acquisition;
+    TofFormatController Controller;
+    TofFormatControlParams Params;
+    TofFrameGeometry Geometry;
+    TofTestConsumer Consumer;
+    TofFrameRing Ring;
+    TofClock::time_point Now = TofClock::now();
+    TofClock::time_point Deadline;
+    UINT32 DOutBScale = 0;
+    UINT32 Frames = 0;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    TOF_REQUIRE(TofTestSetFormat(Connection, eTOF_DATA_FUSED) == eSUCCESS);
+    TOF_REQUIRE(TofQueryFrameGeometry(Connection, &Geometry) == eSUCCESS);
+    TOF_REQUIRE(PicoP_TLC_GetDOutBScale(Connection, &DOutBScale, eCURRENT_VALUE) == eSUCCESS);
+    TofTestFastParams(&Params);
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, DOutBScale) == eSUCCESS);
+    TOF_REQUIRE(Controller.GetLevel() == (Params.NumLevels - 1));
+
+    TofTestResetConsumer(&Consumer);
+    TOF_REQUIRE(Acquisition.Start(Connection, TofTestOnFrame, &Consumer) == eSUCCESS);
+
+    Controller.Update(Now, Frames, 0);
+    Now += std::chrono::milliseconds(100);
+    Frames += 3;
+    TOF_REQUIRE(Controller.Update(Now, Frames, 0));
+
+    TOF_CHECK_EQ(eSUCCESS, Controller.Apply(Connection, &Acquisition));
+    TOF_CHECK_EQ(Params.NumLevels - 2, Controller.GetLevel());
+    TOF_CHECK(Acquisition.IsRunning());
+    TOF_CHECK_EQ(Geometry.FrameWords * 2, TofTestDeviceFrameWords(Connection));
+
+    TofTestResetConsumer(&Consumer);
+    Deadline = TofClock::now() + std::chrono::milliseconds(TOF_TEST_TIMEOUT_MS);
+
+    while ((Consumer.Frames <= 3) && (TofClock::now() < Deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    Acquisition.Stop();
+
+    TOF_CHECK(Consumer.Frames > 3);
+    TOF_CHECK_EQ(0u, Consumer.Failures.load());
+    TOF_CHECK_EQ(Geometry.FrameWords * 2, Consumer.LastFrameWords.load());
+
+    // A ring sized for fused frames cannot take ALL ones, so the restart is
+    // refused; one sized with GetMaxFrameWords() is fine
+    TOF_REQUIRE(TofTestSetFormat(Connection, eTOF_DATA_FUSED) == eSUCCESS);
+    TOF_REQUIRE(Controller.Create(&Params, &Geometry, DOutBScale) == eSUCCESS);
+    TOF_REQUIRE(Ring.Create(Geometry.FrameBytes, 4) == eSUCCESS);
+    Acquisition.SetFrameRing(&Ring);
+    TOF_REQUIRE(Acquisition.Start(Connection, TofTestOnFrame, &Consumer) == eSUCCESS);
+
+    Frames = 0;
+    Controller.Update(Now, Frames, 0);
+    Now += std::chrono::milliseconds(100);
+    Frames += 3;
+    TOF_REQUIRE(Controller.Update(Now, Frames, 0));
+
+    TOF_CHECK_EQ(eINVALID_ARG, Controller.Apply(Connection, &Acquisition));
+    TOF_CHECK( ! Acquisition.IsRunning());
+
+    TOF_REQUIRE(Ring.Create(Controller.GetMaxFrameWords() * sizeof(UINT32), 4) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, Acquisition.Restart());
+    TOF_CHECK(Acquisition.IsRunning());
+    Acquisition.Stop();
+
+    TofTestDisconnect(Library, Connection);
+}
+
+// ****************************************************************************
@@ -0,0 +1,419 @@
+// ****************************************************************************
+//  TofFrameDecoderTest.cpp
+//
+// Round trip tests of the frame decoder for every data format
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "TofFrameDecoder.h"
+#include "TofSim.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+typedef struct
+{
+    UINT32 NumPulses;
+    UINT32 NumLines;
+} TofTestSize;
+
+static const TofTestSize sSizes[] = { { 120, 720 }, { 37, 11 }, { 5, 1 } };
+
+static const PicoP_ToFDataFormatE sFormats[] =
+{
+    eTOF_DATA_FUSED,
+    eTOF_DATA_LEFT_SENSOR_ONLY,
+    eTOF_DATA_RIGHT_SENSOR_ONLY,
+    eTOF_DATA_DEPTH_ONLY,
+    eTOF_DATA_AMPLITUDE_ONLY,
+    eTOF_DATA_ALL
+};
+
+// What each detector sees, and what the firmware fused; indexed by
+// TofDetectorE then TofChannelE
+typedef struct
+{
+    std::vector<UINT32> Plane[eTOF_NUM_DETECTORS][eTOF_NUM_CHANNELS];
+} TofTestScene;
+
+// Returns, dropouts on one or both detectors, and words with the top bit
+// set, which a plain (a + b) / 2 would overflow on
+static void TofTestSceneMake(UINT32 PlaneWords, UINT32 Seed, TofTestScene* pScene)
+{
+    std::mt19937 Random(Seed);
+    UINT32 Value;
+
+
+    for (UINT32 d = 0; d < eTOF_NUM_DETECTORS; d++)
+    {
+        for (UINT32 c = 0; c < eTOF_NUM_CHANNELS; c++)
+        {
+            pScene->Plane[d][c].resize(PlaneWords);
+
+            for (UINT32 i = 0; i < PlaneWords; i++)
+            {
+                Value = 1 + (Random() % 60000);
+                pScene->Plane[d][c][i] = ((Random() % 9) == 0) ? (0x80000000u | Value) : Value;
+            }
+        }
+    }
+
+    for (UINT32 i = 0; i < PlaneWords; i++)
+    {
+        switch (Random() % 8)
+        {
+        case 0:
+            pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_TIME][i] = 0;
+            pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_AMPLITUDE][i] = 0;
+            break;
+
+        case 1:
+            pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_TIME][i] = 0;
+            pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_AMPLITUDE][i] = 0;
+            break;
+
+        case 2:
+            for (UINT32 d = eTOF_DETECTOR_LEFT; d <= eTOF_DETECTOR_RIGHT; d++)
+            {
+                pScene->Plane[d][eTOF_CHANNEL_TIME][i] = 0;
+                pScene->Plane[d][eTOF_CHANNEL_AMPLITUDE][i] = 0;
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+// ****************************************************************************
+//  The layouts as the header documents them, written out independently of
+//  the decoder's tables
+// ****************************************************************************
+
+static void TofTestEncode(const TofTestScene* pScene, PicoP_ToFDataFormatE Format, UINT32 PlaneWords,
+                          std::vector<UINT32>* pData)
+{
+    const std::vector<UINT32>* pPlanes[4] = { NULL, NULL, NULL, NULL };
+    UINT32 NumPlanes = 2;
+
+
+    switch (Format)
+    {
+    case eTOF_DATA_FUSED:
+        pPlanes[0] = &pScene->Plane[eTOF_DETECTOR_FUSED][eTOF_CHANNEL_TIME];
+        pPlanes[1] = &pScene->Plane[eTOF_DETECTOR_FUSED][eTOF_CHANNEL_AMPLITUDE];
+        break;
+
+    case eTOF_DATA_LEFT_SENSOR_ONLY:
+        pPlanes[0] = &pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_TIME];
+        pPlanes[1] = &pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_AMPLITUDE];
+        break;
+
+    case eTOF_DATA_RIGHT_SENSOR_ONLY:
+        pPlanes[0] = &pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_TIME];
+        pPlanes[1] = &pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_AMPLITUDE];
+        break;
+
+    case eTOF_DATA_DEPTH_ONLY:
+        pPlanes[0] = &pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_TIME];
+        pPlanes[1] = &pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_TIME];
+        break;
+
+    case eTOF_DATA_AMPLITUDE_ONLY:
+        pPlanes[0] = &pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_AMPLITUDE];
+        pPlanes[1] = &pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_AMPLITUDE];
+        break;
+
+    case eTOF_DATA_ALL:
+    default:
+        pPlanes[0] = &pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_TIME];
+        pPlanes[1] = &pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_AMPLITUDE];
+        pPlanes[2] = &pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_TIME];
+        pPlanes[3] = &pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_AMPLITUDE];
+        NumPlanes = 4;
+        break;
+    }
+
+    pData->clear();
+
+    for (UINT32 p = 0; p < NumPlanes; p++)
+    {
+        pData->insert(pData->end(), pPlanes[p]->begin(), pPlanes[p]->begin() + PlaneWords);
+    }
+}
+
+// A channel missing from the format reads 0
+static UINT32 TofTestCarried(const TofTestScene* pScene, PicoP_ToFDataFormatE Format, TofDetectorE Detector,
+                             TofChannelE Channel, UINT32 i)
+{
+    BOOL Time = (Channel == eTOF_CHANNEL_TIME);
+
+
+    if ((Format == eTOF_DATA_DEPTH_ONLY && ( ! Time)) || (Format == eTOF_DATA_AMPLITUDE_ONLY && Time))
+    {
+        return 0;
+    }
+
+    return pScene->Plane[Detector][Channel][i];
+}
+
+// Whether Format carries anything of Detector, and if so what it decodes to
+static BOOL TofTestExpected(const TofTestScene* pScene, PicoP_ToFDataFormatE Format, TofDetectorE Detector,
+                            TofChannelE Channel, UINT32 i, UINT32* pValue)
+{
+    BOOL HasTime = (Format != eTOF_DATA_AMPLITUDE_ONLY);
+    uint64_t Left;
+    uint64_t Right;
+    BOOL LeftReturned;
+    BOOL RightReturned;
+
+
+    switch (Format)
+    {
+    case eTOF_DATA_FUSED:
+        *pValue = pScene->Plane[eTOF_DETECTOR_FUSED][Channel][i];
+        return (Detector == eTOF_DETECTOR_FUSED);
+
+    case eTOF_DATA_LEFT_SENSOR_ONLY:
+        *pValue = pScene->Plane[eTOF_DETECTOR_LEFT][Channel][i];
+        return (Detector != eTOF_DETECTOR_RIGHT);
+
+    case eTOF_DATA_RIGHT_SENSOR_ONLY:
+        *pValue = pScene->Plane[eTOF_DETECTOR_RIGHT][Channel][i];
+        return (Detector != eTOF_DETECTOR_LEFT);
+
+    default:
+        break;
+    }
+
+    if (Detector != eTOF_DETECTOR_FUSED)
+    {
+        *pValue = TofTestCarried(pScene, Format, Detector, Channel, i);
+        return TRUE;
+    }
+
+    // Both detectors sent: the mean where both returned, else the one that did
+    Left = TofTestCarried(pScene, Format, eTOF_DETECTOR_LEFT, Channel, i);
+    Right = TofTestCarried(pScene, Format, eTOF_DETECTOR_RIGHT, Channel, i);
+    LeftReturned = (HasTime ? pScene->Plane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_TIME][i] : (UINT32)Left) != 0;
+    RightReturned = (HasTime ? pScene->Plane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_TIME][i] : (UINT32)Right) != 0;
+
+    *pValue = (LeftReturned && RightReturned) ? (UINT32)((Left + Right) / 2) :
+              LeftReturned ? (UINT32)Left : RightReturned ? (UINT32)Right : 0;
+
+    return TRUE;
+}
+
+// ****************************************************************************
+
+static UINT32 TofTestMismatches(const TofTestScene* pScene, PicoP_ToFDataFormatE Format, TofDetectorE Detector,
+                                const UINT32* pTime, const UINT32* pAmplitude, UINT32 PlaneWords)
+{
+    UINT32 Mismatches = 0;
+    UINT32 Time = 0;
+    UINT32 Amplitude = 0;
+
+
+    for (UINT32 i = 0; i < PlaneWords; i++)
+    {
+        TofTestExpected(pScene, Format, Detector, eTOF_CHANNEL_TIME, i, &Time);
+        TofTestExpected(pScene, Format, Detector, eTOF_CHANNEL_AMPLITUDE, i, &Amplitude);
+
+        if ((pTime[i] != Time) || (pAmplitude[i] != Amplitude))
+        {
+            if (Mismatches == 0)
+            {
+                printf("    format %d detector %d pixel %u: %08x %08x, expected %08x %08x\n",
+                       (int)Format, (int)Detector, i, pTime[i], pAmplitude[i], Time, Amplitude);
+            }
+
+            Mismatches++;
+        }
+    }
+
+    return Mismatches;
+}
+
+// ****************************************************************************
+
+TOF_TEST(EveryFormatAndDetectorRoundTrips)
+{
+    TofTestScene Scene;
+    TofFrameGeometry Geometry;
+    TofFrameDecoder Decoder;
+    TofFrame Frame;
+    TofFrameView View;
+    std::vector<UINT32> Data;
+    TofDetectorE Detector;
+    UINT32 PlaneWords;
+    UINT32 Unused;
+    BOOL Available;
+
+
+    for (UINT32 s = 0; s < sizeof(sSizes) / sizeof(sSizes[0]); s++)
+    {
+        PlaneWords = sSizes[s].NumPulses * sSizes[s].NumLines;
+        TofTestSceneMake(PlaneWords, s + 1, &Scene);
+        TOF_REQUIRE(Frame.Create(sSizes[s].NumPulses, sSizes[s].NumLines) == eSUCCESS);
+
+        for (UINT32 f = 0; f < sizeof(sFormats) / sizeof(sFormats[0]); f++)
+        {
+            TofTestEncode(&Scene, sFormats[f], PlaneWords, &Data);
+            TOF_REQUIRE(TofTestGeometry(sFormats[f], sSizes[s].NumPulses, sSizes[s].NumLines, 1, 1, &Geometry) == eSUCCESS);
+            TOF_REQUIRE(Geometry.FrameWords == Data.size());
+
+            for (UINT32 d = 0; d < eTOF_NUM_DETECTORS; d++)
+            {
+                Detector = (TofDetectorE)d;
+                Available = TofTestExpected(&Scene, sFormats[f], Detector, eTOF_CHANNEL_TIME, 0, &Unused);
+
+                if ( ! Available)
+                {
+                    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT, Decoder.Create(&Geometry, Detector));
+                    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT,
+                                 TofDecodeDetector(&Data[0], (UINT32)Data.size(), sFormats[f], Detector, &Frame));
+                    continue;
+                }
+
+                TOF_REQUIRE(TofDecodeDetector(&Data[0], (UINT32)Data.size(), sFormats[f], Detector, &Frame) == eSUCCESS);
+                TOF_CHECK_EQ(0u, TofTestMismatches(&Scene, sFormats[f], Detector, Frame.GetTime(),
+                                                   Frame.GetAmplitude(), PlaneWords));
+
+                TOF_REQUIRE(Decoder.Create(&Geometry, Detector) == eSUCCESS);
+                memset(Frame.GetTime(), 0xA5, PlaneWords * sizeof(UINT32));
+                memset(Frame.GetAmplitude(), 0xA5, PlaneWords * sizeof(UINT32));
+                TOF_REQUIRE(Decoder.Decode(&Data[0], (UINT32)Data.size(), &Frame) == eSUCCESS);
+                Frame.GetView(&View);
+                TOF_CHECK_EQ(sFormats[f], View.Format);
+                TOF_CHECK_EQ(0u, TofTestMismatches(&Scene, sFormats[f], Detector, Frame.GetTime(),
+                                                   Frame.GetAmplitude(), PlaneWords));
+
+                TOF_REQUIRE(Decoder.GetView(&Data[0], (UINT32)Data.size(), &View) == eSUCCESS);
+                TOF_CHECK_EQ(0u, TofTestMismatches(&Scene, sFormats[f], Detector, View.pTime, View.pAmplitude,
+                                                   PlaneWords));
+
+                // Zero copy views point into the frame itself
+                if (Decoder.IsZeroCopy() && (sFormats[f] != eTOF_DATA_AMPLITUDE_ONLY))
+                {
+                    TOF_CHECK((View.pTime >= &Data[0]) && (View.pTime < &Data[0] + Data.size()));
+                }
+            }
+        }
+    }
+}
+
+TOF_TEST(FramePlanesNameEveryCarriedPlane)
+{
+    TofTestScene Scene;
+    TofFramePlanes Planes;
+    std::vector<UINT32> Data;
+    const UINT32* pPlane;
+    BOOL Carried;
+
+
+    TofTestSceneMake(37 * 11, 7, &Scene);
+
+    for (UINT32 f = 0; f < sizeof(sFormats) / sizeof(sFormats[0]); f++)
+    {
+        TofTestEncode(&Scene, sFormats[f], 37 * 11, &Data);
+        TOF_REQUIRE(TofMakeFramePlanes(&Data[0], (UINT32)Data.size(), 37, 11, sFormats[f], &Planes) == eSUCCESS);
+
+        for (UINT32 d = 0; d < eTOF_NUM_DETECTORS; d++)
+        {
+            for (UINT32 c = 0; c < eTOF_NUM_CHANNELS; c++)
+            {
+                pPlane = Planes.pPlane[d][c];
+                Carried = (sFormats[f] == eTOF_DATA_FUSED) ? (d == eTOF_DETECTOR_FUSED) :
+                          (sFormats[f] == eTOF_DATA_LEFT_SENSOR_ONLY) ? (d == eTOF_DETECTOR_LEFT) :
+                          (sFormats[f] == eTOF_DATA_RIGHT_SENSOR_ONLY) ? (d == eTOF_DETECTOR_RIGHT) :
+                          (d == eTOF_DETECTOR_FUSED) ? FALSE :
+                          (sFormats[f] == eTOF_DATA_DEPTH_ONLY) ? (c == eTOF_CHANNEL_TIME) :
+                          (sFormats[f] == eTOF_DATA_AMPLITUDE_ONLY) ? (c == eTOF_CHANNEL_AMPLITUDE) : TRUE;
+
+                TOF_CHECK(Carried == (pPlane != NULL));
+
+                if ((pPlane != NULL) && (pPlane[5] != Scene.Plane[d][c][5]))
+                {
+                    TOF_CHECK_EQ(Scene.Plane[d][c][5], pPlane[5]);
+                }
+            }
+        }
+
+        TOF_CHECK_EQ(eFRAME_ERROR, TofMakeFramePlanes(&Data[0], (UINT32)Data.size() - 1, 37, 11, sFormats[f], &Planes));
+    }
+
+    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT,
+                 TofMakeFramePlanes(&Data[0], (UINT32)Data.size(), 37, 11, (PicoP_ToFDataFormatE)6, &Planes));
+}
+
+// ****************************************************************************
+//  Every format set on the simulated device is read back through
+//  PicoP_TLC_GetTofDataFormat and decodes the frames it then sends; the
+//  device drops the frames queued in the old layout
+// ****************************************************************************
+
+TOF_TEST(DecoderFollowsDeviceFormat)
+{
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofSimConfig Config;
+    TofFrameDecoder Decoder;
+    TofFrame Frame;
+    TofFrameView View;
+    std::vector<UINT32> Data;
+    UINT32 Count = 0;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.FrameRate = 200;
+    Config.LatencyUs = 1000;
+    TofSimSetConfig(&Config);
+    TOF_REQUIRE(PicoP_TLC_OpenLibrary(&Library) == eSUCCESS);
+    TOF_REQUIRE(PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) == eSUCCESS);
+
+    for (UINT32 f = 0; f < sizeof(sFormats) / sizeof(sFormats[0]); f++)
+    {
+        // The format only changes while sensing is off
+        TOF_REQUIRE(PicoP_TLC_SetSensingState(Connection, eSENSING_DISABLED, FALSE) == eSUCCESS);
+        TOF_REQUIRE(PicoP_TLC_SetTofDataFormat(Connection, sFormats[f], FALSE) == eSUCCESS);
+        TOF_REQUIRE(PicoP_TLC_SetSensingState(Connection, eSENSING_ENABLED, FALSE) == eSUCCESS);
+        TOF_REQUIRE(Decoder.CreateFromDevice(Connection, eTOF_DETECTOR_FUSED) == eSUCCESS);
+        TOF_CHECK_EQ(sFormats[f], Decoder.GetGeometry()->Format);
+        TOF_REQUIRE(Frame.Create(Decoder.GetGeometry()->NumPulses, Decoder.GetGeometry()->NumLines) == eSUCCESS);
+        Data.assign(Decoder.GetGeometry()->FrameWords, 0);
+
+        do
+        {
+            TOF_REQUIRE(PicoP_TLC_AcquireTofFrame(Connection, 1, &Data[0], &Count) == eSUCCESS);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        while (Count == 0);
+
+        TOF_CHECK_EQ(eSUCCESS, Decoder.Decode(&Data[0], (UINT32)Data.size(), &Frame));
+        Frame.GetView(&View);
+        TOF_CHECK_EQ(sFormats[f], View.Format);
+    }
+
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+}
+
+// ****************************************************************************
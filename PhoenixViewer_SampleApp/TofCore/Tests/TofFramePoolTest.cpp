@@ -0,0 +1,165 @@
+// ****************************************************************************
+//  TofFramePoolTest.cpp
+//
+// Tests of the reference counted frame pool
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <thread>
+#include <vector>
+#include "TofFramePool.h"
+#include "TofMemory.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+TOF_TEST(FramePoolHandsOutAlignedFramesUntilExhausted)
+{
+    TofFramePool Pool;
+    TofFramePoolStats Stats;
+    TofPooledFrame* pFrames[3];
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, Pool.Create(0, 3, 0));
+    TOF_CHECK_EQ(eINVALID_ARG, Pool.Create(1000, 0, 0));
+    TOF_REQUIRE(Pool.Create(1000, 3, 0) == eSUCCESS);
+    TOF_CHECK_EQ(250u, Pool.GetFrameWords());
+
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        pFrames[i] = Pool.Acquire();
+        TOF_REQUIRE(pFrames[i] != NULL);
+        TOF_CHECK_EQ(0u, (UINT32)((uintptr_t)pFrames[i]->pData % TOF_CACHE_LINE_SIZE));
+        TOF_CHECK_EQ(1u, pFrames[i]->RefCount.load());
+    }
+
+    TOF_CHECK(pFrames[1]->pData >= pFrames[0]->pData + 250);
+    TOF_CHECK(Pool.Acquire() == NULL);
+
+    Pool.GetStats(&Stats);
+    TOF_CHECK_EQ(3u, Stats.FramesInUse);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.FramesExhausted);
+    TOF_CHECK_EQ(1024u, Stats.FrameBytes);
+
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        TofFrameRelease(pFrames[i]);
+    }
+
+    Pool.GetStats(&Stats);
+    TOF_CHECK_EQ(0u, Stats.FramesInUse);
+    TOF_CHECK_EQ(3u, Stats.MaxFramesInUse);
+    TOF_CHECK_EQ(3u, (UINT32)Stats.FramesRecycled);
+}
+
+TOF_TEST(FramePoolRecyclesOnLastRelease)
+{
+    TofFramePool Pool;
+    TofFramePoolStats Stats;
+    TofPooledFrame* pFrame;
+
+
+    TOF_REQUIRE(Pool.Create(256, 1, 0) == eSUCCESS);
+    pFrame = Pool.Acquire();
+    TOF_REQUIRE(pFrame != NULL);
+
+    TofFrameAddRef(pFrame);
+    TofFrameRelease(pFrame);
+    TOF_CHECK(Pool.Acquire() == NULL);
+
+    // The most recently released frame comes straight back
+    TofFrameRelease(pFrame);
+    TOF_CHECK(Pool.Acquire() == pFrame);
+    TofFrameRelease(pFrame);
+
+    Pool.GetStats(&Stats);
+    TOF_CHECK_EQ(2u, (UINT32)Stats.FramesAcquired);
+    TOF_CHECK_EQ(2u, (UINT32)Stats.FramesRecycled);
+}
+
+// ****************************************************************************
+//  A producer hands every frame to a consumer thread that releases it, as
+//  acquisition and the pipeline do. No frame may be lost or handed out twice,
+//  and the heap is left alone once the pool exists.
+// ****************************************************************************
+
+TOF_TEST(FramePoolReleasesAcrossThreadsWithoutAllocating)
+{
+    const UINT32 Frames = 20000;
+    TofFramePool Pool;
+    TofFramePoolStats Stats;
+    TofMemoryStats Before;
+    TofMemoryStats After;
+    std::vector<TofPooledFrame*> Handoff(Frames, NULL);
+    std::atomic<UINT32> Produced(0);
+    std::atomic<UINT32> Reused(0);
+    std::thread Consumer;
+    TofPooledFrame* pFrame;
+
+
+    TOF_REQUIRE(Pool.Create(4096, 4, 0) == eSUCCESS);
+    TofGetMemoryStats(&Before);
+
+    Consumer = std::thread([&]()
+    {
+        for (UINT32 i = 0; i < Frames; i++)
+        {
+            while (Produced.load(std::memory_order_acquire) <= i)
+            {
+                std::this_thread::yield();
+            }
+
+            Reused += (Handoff[i]->SequenceNumber != i) ? 1 : 0;
+            TofFrameRelease(Handoff[i]);
+        }
+    });
+
+    for (UINT32 i = 0; i < Frames; i++)
+    {
+        while ((pFrame = Pool.Acquire()) == NULL)
+        {
+            std::this_thread::yield();
+        }
+
+        pFrame->SequenceNumber = i;
+        Handoff[i] = pFrame;
+        Produced.store(i + 1, std::memory_order_release);
+    }
+
+    Consumer.join();
+    TofGetMemoryStats(&After);
+    Pool.GetStats(&Stats);
+
+    TOF_CHECK_EQ(0u, Reused.load());
+    TOF_CHECK_EQ(0u, Stats.FramesInUse);
+    TOF_CHECK_EQ(Frames, (UINT32)Stats.FramesRecycled);
+    TOF_CHECK(Stats.MaxFramesInUse <= 4);
+    TOF_CHECK_EQ(Before.Allocations, After.Allocations);
+}
+
+TOF_TEST(FramePoolLargePagesFallBack)
+{
+    TofFramePool Pool;
+    TofFramePoolStats Stats;
+    TofPooledFrame* pFrame;
+
+
+    // Granted or not, the frames must be usable
+    TOF_REQUIRE(Pool.Create(691200, 3, TOF_POOL_LARGE_PAGES) == eSUCCESS);
+    Pool.GetStats(&Stats);
+    TOF_CHECK(Stats.StorageBytes >= 3ull * 691200);
+
+    pFrame = Pool.Acquire();
+    TOF_REQUIRE(pFrame != NULL);
+    pFrame->pData[(691200 / sizeof(UINT32)) - 1] = 1;
+    TofFrameRelease(pFrame);
+}
+
+// ****************************************************************************
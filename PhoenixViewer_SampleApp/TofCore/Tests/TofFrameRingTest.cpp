@@ -0,0 +1,192 @@
+// ****************************************************************************
+//  TofFrameRingTest.cpp
+//
+// Tests of the single producer, single consumer frame ring
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <atomic>
+#include <thread>
+#include "TofFrameRing.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_FRAME_BYTES    (120 * 720 * 2 * sizeof(UINT32))
+#define TOF_TEST_STAMP_STRIDE   1024        // Words between stamps, one per 4 KB
+
+// ****************************************************************************
+
+TOF_TEST(RingRoundsSlotsToPowerOfTwo)
+{
+    TofFrameRing Ring;
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, Ring.Create(0, 4));
+    TOF_CHECK_EQ(eINVALID_ARG, Ring.Create(64, TOF_RING_MAX_SLOTS + 1));
+    TOF_REQUIRE(Ring.Create(TOF_TEST_FRAME_BYTES, 3) == eSUCCESS);
+    TOF_CHECK_EQ(4u, Ring.GetSlotCount());
+    TOF_CHECK_EQ((UINT32)(TOF_TEST_FRAME_BYTES / sizeof(UINT32)), Ring.GetFrameWords());
+}
+
+TOF_TEST(RingDropsWhenFull)
+{
+    TofFrameRing Ring;
+    TofRingStats Stats;
+    TofRingSlot* pSlot;
+    const TofRingSlot* pRead;
+
+
+    TOF_REQUIRE(Ring.Create(256, 2) == eSUCCESS);
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        pSlot = Ring.BeginWrite();
+        TOF_REQUIRE(pSlot != NULL);
+        TOF_CHECK_EQ(0u, ((size_t)pSlot->pData) % TOF_CACHE_LINE_SIZE);
+        pSlot->SequenceNumber = i;
+        Ring.EndWrite();
+    }
+
+    TOF_CHECK(Ring.BeginWrite() == NULL);
+
+    pRead = Ring.BeginRead();
+    TOF_REQUIRE(pRead != NULL);
+    TOF_CHECK_EQ(0u, pRead->SequenceNumber);
+    Ring.EndRead();
+
+    TOF_CHECK(Ring.BeginWrite() != NULL);
+
+    Ring.GetStats(&Stats);
+    TOF_CHECK_EQ(2u, Stats.Published);
+    TOF_CHECK_EQ(1u, Stats.Dropped);
+}
+
+TOF_TEST(RingReadLatestSkipsAndHolds)
+{
+    TofFrameRing Ring;
+    TofRingStats Stats;
+    const TofRingSlot* pRead;
+
+
+    TOF_REQUIRE(Ring.Create(256, 4) == eSUCCESS);
+
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        Ring.BeginWrite()->SequenceNumber = i;
+        Ring.EndWrite();
+    }
+
+    pRead = Ring.ReadLatest();
+    TOF_REQUIRE(pRead != NULL);
+    TOF_CHECK_EQ(2u, pRead->SequenceNumber);
+
+    // Still held, so it can be redrawn
+    pRead = Ring.ReadLatest();
+    TOF_REQUIRE(pRead != NULL);
+    TOF_CHECK_EQ(2u, pRead->SequenceNumber);
+
+    // The held slot is not handed out again by BeginRead
+    TOF_CHECK(Ring.BeginRead() == NULL);
+
+    Ring.GetStats(&Stats);
+    TOF_CHECK_EQ(2u, Stats.Skipped);
+}
+
+// ****************************************************************************
+//  A producer and a consumer thread move full size frames through the ring.
+//  The producer stamps the sequence number into every 4 KB of the frame; the
+//  consumer checks that it never sees a frame with mixed stamps or out of
+//  order.
+// ****************************************************************************
+
+TOF_TEST(RingStressNoTornFrames)
+{
+    const UINT32 Frames = 200000;
+    TofFrameRing Ring;
+    TofRingStats Stats;
+    std::atomic<BOOL> Done(FALSE);
+    UINT32 Torn = 0;
+    UINT32 OutOfOrder = 0;
+    UINT32 Read = 0;
+    UINT32 Last = 0;
+
+
+    TOF_REQUIRE(Ring.Create(TOF_TEST_FRAME_BYTES, 8) == eSUCCESS);
+
+    std::thread Producer([&]()
+    {
+        TofRingSlot* pSlot;
+
+        for (UINT32 i = 1; i <= Frames; i++)
+        {
+            pSlot = Ring.BeginWrite();
+
+            if (pSlot == NULL)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (UINT32 w = 0; w < pSlot->FrameWords; w += TOF_TEST_STAMP_STRIDE)
+            {
+                pSlot->pData[w] = i;
+            }
+
+            pSlot->pData[pSlot->FrameWords - 1] = i;
+            pSlot->SequenceNumber = i;
+            Ring.EndWrite();
+        }
+
+        Done = TRUE;
+    });
+
+    for (;;)
+    {
+        const TofRingSlot* pSlot = Ring.BeginRead();
+
+        if (pSlot == NULL)
+        {
+            if (Done)
+            {
+                if ((pSlot = Ring.BeginRead()) == NULL)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                std::this_thread::yield();
+                continue;
+            }
+        }
+
+        for (UINT32 w = 0; w < pSlot->FrameWords; w += TOF_TEST_STAMP_STRIDE)
+        {
+            Torn += (pSlot->pData[w] != pSlot->SequenceNumber) ? 1 : 0;
+        }
+
+        Torn += (pSlot->pData[pSlot->FrameWords - 1] != pSlot->SequenceNumber) ? 1 : 0;
+        OutOfOrder += (pSlot->SequenceNumber <= Last) ? 1 : 0;
+        Last = pSlot->SequenceNumber;
+        Read++;
+        Ring.EndRead();
+    }
+
+    Producer.join();
+    Ring.GetStats(&Stats);
+
+    TOF_CHECK_EQ(0u, Torn);
+    TOF_CHECK_EQ(0u, OutOfOrder);
+    TOF_CHECK_EQ(Stats.Published, Read);
+    TOF_CHECK_EQ(Frames, Stats.Published + Stats.Dropped);
+}
+
+// ****************************************************************************
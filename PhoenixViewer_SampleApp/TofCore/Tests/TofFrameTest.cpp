@@ -0,0 +1,159 @@
+// ****************************************************************************
+//  TofFrameTest.cpp
+//
+// Tests of the frame container and frame geometry
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofFrame.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+TOF_TEST(FrameCreateRejectsEmptyPlanes)
+{
+    TofFrame Frame;
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, Frame.Create(0, 720));
+    TOF_CHECK_EQ(eINVALID_ARG, Frame.Create(120, 0));
+    TOF_CHECK(Frame.GetTime() == NULL);
+}
+
+TOF_TEST(FrameDeinterleavesFusedFrame)
+{
+    std::vector<UINT32> Data(120 * 720 * 2);
+    TofFrame Frame;
+    TofFrameView View;
+
+
+    for (UINT32 i = 0; i < 120 * 720; i++)
+    {
+        Data[i] = i;
+        Data[(120 * 720) + i] = 0x80000000u | i;
+    }
+
+    TOF_REQUIRE(Frame.Create(120, 720) == eSUCCESS);
+    TOF_REQUIRE(Frame.Deinterleave(&Data[0], (UINT32)Data.size(), eTOF_DATA_FUSED) == eSUCCESS);
+
+    Frame.GetView(&View);
+    TOF_CHECK_EQ(120u, View.NumPulses);
+    TOF_CHECK_EQ(720u, View.NumLines);
+    TOF_CHECK_EQ(eTOF_DATA_FUSED, View.Format);
+
+    for (UINT32 i = 0; i < 120 * 720; i++)
+    {
+        if ((View.pTime[i] != i) || (View.pAmplitude[i] != (0x80000000u | i)))
+        {
+            TOF_CHECK_EQ(i, View.pTime[i]);
+            break;
+        }
+    }
+
+    // A copy, not a view of the acquired buffer
+    TOF_CHECK(View.pTime != &Data[0]);
+}
+
+TOF_TEST(FrameViewPointsIntoBuffer)
+{
+    std::vector<UINT32> Data(120 * 720 * 2, 0);
+    TofFrameView View;
+
+
+    TOF_REQUIRE(TofMakeFrameView(&Data[0], (UINT32)Data.size(), 120, 720, eTOF_DATA_RIGHT_SENSOR_ONLY, &View) == eSUCCESS);
+    TOF_CHECK(View.pTime == &Data[0]);
+    TOF_CHECK(View.pAmplitude == &Data[120 * 720]);
+    TOF_CHECK(TofTimeLine(&View, 3) == &Data[3 * 120]);
+    TOF_CHECK(TofAmplitudeLine(&View, 719) == &Data[(120 * 720) + (719 * 120)]);
+
+    TOF_CHECK_EQ(eFRAME_ERROR, TofMakeFrameView(&Data[0], (UINT32)Data.size() - 1, 120, 720, eTOF_DATA_FUSED, &View));
+    TOF_CHECK(View.pTime == NULL);
+    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT,
+                 TofMakeFrameView(&Data[0], (UINT32)Data.size(), 120, 720, eTOF_DATA_ALL, &View));
+    TOF_CHECK_EQ(eINVALID_ARG, TofMakeFrameView(NULL, (UINT32)Data.size(), 120, 720, eTOF_DATA_FUSED, &View));
+}
+
+TOF_TEST(FrameRejectsShortFrame)
+{
+    std::vector<UINT32> Data(120 * 720 * 2 - 1, 0);
+    TofFrame Frame;
+
+
+    TOF_REQUIRE(Frame.Create(120, 720) == eSUCCESS);
+    TOF_CHECK(Frame.Deinterleave(&Data[0], (UINT32)Data.size(), eTOF_DATA_FUSED) != eSUCCESS);
+}
+
+TOF_TEST(FrameCopyOutlivesSource)
+{
+    std::vector<UINT32> Data(64 * 16 * 2);
+    TofFrameView Source;
+    TofFrame Frame;
+    TofFrame Other;
+
+
+    for (size_t i = 0; i < Data.size(); i++)
+    {
+        Data[i] = (UINT32)(i * 7);
+    }
+
+    TOF_REQUIRE(TofMakeFrameView(&Data[0], (UINT32)Data.size(), 64, 16, eTOF_DATA_FUSED, &Source) == eSUCCESS);
+    TOF_REQUIRE(Frame.Create(64, 16) == eSUCCESS);
+    TOF_REQUIRE(Frame.CopyFrom(&Source) == eSUCCESS);
+
+    Data.assign(Data.size(), 0);
+
+    TOF_CHECK_EQ(7u, Frame.GetTime()[1]);
+    TOF_CHECK_EQ(64u * 16u * 7u, Frame.GetAmplitude()[0]);
+
+    TOF_REQUIRE(Other.Create(32, 16) == eSUCCESS);
+    TOF_CHECK_EQ(eFRAME_ERROR, Other.CopyFrom(&Source));
+}
+
+// ****************************************************************************
+
+TOF_TEST(GeometryFromDefaultPulsing)
+{
+    TofFrameGeometry Geometry;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(691200u, Geometry.FrameBytes);
+    TOF_CHECK_EQ(720u, Geometry.NumLines);
+    TOF_CHECK_EQ(2u, Geometry.NumPlanes);
+    TOF_CHECK_EQ(86400u, Geometry.PlaneWords);
+    TOF_CHECK_EQ(120u, Geometry.ImagePulses);
+    TOF_CHECK_EQ(720u, Geometry.ImageLines);
+}
+
+TOF_TEST(GeometryQueriedFromSimulator)
+{
+    PicoP_HANDLE Library = NULL;
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    TofFrameGeometry Geometry;
+
+
+    TOF_REQUIRE(PicoP_TLC_OpenLibrary(&Library) == eSUCCESS);
+    TOF_REQUIRE(PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) == eSUCCESS);
+
+    TOF_CHECK_EQ(eSUCCESS, TofQueryFrameGeometry(Connection, &Geometry));
+    TOF_CHECK_EQ((UINT32)TOF_SIM_DEFAULT_PULSES, Geometry.NumPulses);
+    TOF_CHECK_EQ((UINT32)TOF_SIM_LINES, Geometry.NumLines);
+    TOF_CHECK_EQ(eTOF_DATA_FUSED, Geometry.Format);
+
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+}
+
+// ****************************************************************************
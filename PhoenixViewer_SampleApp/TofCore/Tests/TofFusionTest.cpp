@@ -0,0 +1,231 @@
+// ****************************************************************************
+//  TofFusionTest.cpp
+//
+// Tests of host fusion of the two detectors
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+#include "TofFusion.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+typedef struct
+{
+    UINT32 NumPulses;
+    UINT32 NumLines;
+} TofTestSize;
+
+static const TofTestSize sSizes[] = { { 120, 720 }, { 37, 11 }, { 5, 1 } };
+
+// ALL frames with strong, weak and missing returns, disagreeing detectors
+// and words with the top bit set
+static void TofTestAllFrame(UINT32 PlaneWords, UINT32 Seed, std::vector<UINT32>* pData)
+{
+    std::mt19937 Random(Seed);
+    UINT32 Time;
+
+
+    pData->resize((size_t)PlaneWords * 4);
+
+    for (UINT32 i = 0; i < PlaneWords; i++)
+    {
+        Time = 500 + (Random() % 20000);
+        (*pData)[i] = Time + (Random() % 60);
+        (*pData)[PlaneWords + i] = Random() % 3000;
+        (*pData)[(2 * PlaneWords) + i] = ((Random() % 8) == 0) ? Time + 150 + (Random() % 500) : Time + (Random() % 60);
+        (*pData)[(3 * PlaneWords) + i] = Random() % 3000;
+
+        switch (Random() % 16)
+        {
+        case 0:
+            (*pData)[i] = 0;
+            break;
+
+        case 1:
+            (*pData)[2 * PlaneWords + i] = 0;
+            break;
+
+        case 2:
+            (*pData)[(Random() % 4) * PlaneWords + i] |= 0x80000000u;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+// The documented rules, one pixel at a time
+static BOOL TofTestReferencePixel(UINT32 LeftTime, UINT32 LeftAmplitude, UINT32 RightTime, UINT32 RightAmplitude,
+                                  const TofFusionParams* pParams, UINT32* pTime, UINT32* pAmplitude)
+{
+    BOOL LeftValid = (LeftTime != 0) && (LeftAmplitude >= pParams->MinAmplitude);
+    BOOL RightValid = (RightTime != 0) && (RightAmplitude >= pParams->MinAmplitude);
+    FP32 LeftWeight = LeftValid ? (FP32)LeftAmplitude : 0.0f;
+    FP32 RightWeight = RightValid ? (FP32)RightAmplitude : 0.0f;
+    FP32 Sum = LeftWeight + RightWeight;
+
+
+    *pTime = 0;
+    *pAmplitude = 0;
+
+    switch (pParams->Policy)
+    {
+    case eTOF_FUSE_MEAN:
+        *pTime = (LeftTime + RightTime) >> 1;
+        *pAmplitude = (LeftAmplitude + RightAmplitude) >> 1;
+        return FALSE;
+
+    case eTOF_FUSE_MAX_CONFIDENCE:
+        if (LeftValid || RightValid)
+        {
+            *pTime = (RightWeight > LeftWeight) ? RightTime : LeftTime;
+            *pAmplitude = (RightWeight > LeftWeight) ? RightAmplitude : LeftAmplitude;
+        }
+
+        return FALSE;
+
+    default:
+        break;
+    }
+
+    if (( ! LeftValid) && ( ! RightValid))
+    {
+        return FALSE;
+    }
+
+    if ((pParams->Policy == eTOF_FUSE_REJECT_DISAGREEMENT) && LeftValid && RightValid &&
+        ((UINT32)abs((INT32)(LeftTime - RightTime)) > pParams->MaxDisagreement))
+    {
+        return TRUE;
+    }
+
+    *pTime = (UINT32)lrintf((((FP32)LeftTime * LeftWeight) + ((FP32)RightTime * RightWeight)) /
+                            ((Sum > 1.0f) ? Sum : 1.0f));
+    *pAmplitude = ((LeftValid ? LeftAmplitude : 0) + (RightValid ? RightAmplitude : 0)) >> ((LeftValid && RightValid) ? 1 : 0);
+
+    return FALSE;
+}
+
+// ****************************************************************************
+
+TOF_TEST(FusionMatchesReferenceForEveryPolicy)
+{
+    static const UINT32 sThreads[] = { 1, 3 };
+    TofFusionParams Params;
+    TofFuser Fuser;
+    TofFusionStats Stats;
+    std::vector<UINT32> Data;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    UINT32 PlaneWords;
+    UINT32 ExpectedTime;
+    UINT32 ExpectedAmplitude;
+    UINT32 Mismatches;
+    uint64_t Rejected;
+
+
+    for (UINT32 s = 0; s < sizeof(sSizes) / sizeof(sSizes[0]); s++)
+    {
+        PlaneWords = sSizes[s].NumPulses * sSizes[s].NumLines;
+        TofTestAllFrame(PlaneWords, s + 1, &Data);
+        Time.resize(PlaneWords);
+        Amplitude.resize(PlaneWords);
+
+        for (UINT32 Policy = eTOF_FUSE_MEAN; Policy <= eTOF_FUSE_REJECT_DISAGREEMENT; Policy++)
+        {
+            TofDefaultFusionParams(&Params);
+            Params.Policy = (TofFusionPolicyE)Policy;
+
+            for (UINT32 t = 0; t < sizeof(sThreads) / sizeof(sThreads[0]); t++)
+            {
+                TOF_REQUIRE(Fuser.Create(sSizes[s].NumPulses, sSizes[s].NumLines, &Params, sThreads[t]) == eSUCCESS);
+                TOF_REQUIRE(Fuser.Fuse(&Data[0], (UINT32)Data.size(), &Time[0], &Amplitude[0]) == eSUCCESS);
+
+                Mismatches = 0;
+                Rejected = 0;
+
+                for (UINT32 i = 0; i < PlaneWords; i++)
+                {
+                    Rejected += TofTestReferencePixel(Data[i], Data[PlaneWords + i], Data[(2 * PlaneWords) + i],
+                                                      Data[(3 * PlaneWords) + i], &Params, &ExpectedTime,
+                                                      &ExpectedAmplitude) ? 1 : 0;
+                    Mismatches += ((Time[i] != ExpectedTime) || (Amplitude[i] != ExpectedAmplitude)) ? 1 : 0;
+                }
+
+                Fuser.GetStats(&Stats);
+                TOF_CHECK_EQ(0u, Mismatches);
+                TOF_CHECK_EQ(Rejected, Stats.PixelsRejected);
+            }
+        }
+    }
+}
+
+TOF_TEST(MeanFusionOfAllFrameIsFirmwareFusedFrame)
+{
+    TofFrameGeometry AllGeometry;
+    TofFrameGeometry FusedGeometry;
+    TofFusionParams Params;
+    TofFuser Fuser;
+    std::vector<UINT32> All;
+    std::vector<UINT32> Fused;
+    std::vector<UINT32> Time(120 * 720);
+    std::vector<UINT32> Amplitude(120 * 720);
+    UINT32 Mismatches = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 120, 720, 1, 1, &AllGeometry) == eSUCCESS);
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 120, 720, 1, 1, &FusedGeometry) == eSUCCESS);
+
+    // Same seed and frame, so both formats carry the same detector samples
+    TofTestRender(&AllGeometry, eTOF_SIM_SCENE_ROOM, 3, &All);
+    TofTestRender(&FusedGeometry, eTOF_SIM_SCENE_ROOM, 3, &Fused);
+
+    TofDefaultFusionParams(&Params);
+    Params.Policy = eTOF_FUSE_MEAN;
+    TOF_REQUIRE(Fuser.Create(120, 720, &Params, 2) == eSUCCESS);
+    TOF_REQUIRE(Fuser.Fuse(&All[0], (UINT32)All.size(), &Time[0], &Amplitude[0]) == eSUCCESS);
+
+    for (UINT32 i = 0; i < 120 * 720; i++)
+    {
+        Mismatches += ((Time[i] != Fused[i]) || (Amplitude[i] != Fused[(120 * 720) + i])) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Mismatches);
+}
+
+TOF_TEST(FusionRejectsWrongFrames)
+{
+    TofFusionParams Params;
+    TofFuser Fuser;
+    TofFrameGeometry Geometry;
+    TofFusionStage Stage(NULL, 1);
+    std::vector<UINT32> Data(64 * 4 * 4, 0);
+    std::vector<UINT32> Plane(64 * 4);
+
+
+    TofDefaultFusionParams(&Params);
+    TOF_CHECK_EQ(eINVALID_ARG, Fuser.Create(0, 4, &Params, 1));
+    TOF_REQUIRE(Fuser.Create(64, 4, &Params, 1) == eSUCCESS);
+    TOF_CHECK(Fuser.Fuse(&Data[0], (UINT32)Data.size() - 1, &Plane[0], &Plane[0]) != eSUCCESS);
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, 64, 4, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK(Stage.Start(&Geometry) != eSUCCESS);
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_ALL, 64, 4, 1, 1, &Geometry) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, Stage.Start(&Geometry));
+}
+
+// ****************************************************************************
@@ -0,0 +1,106 @@
+// ****************************************************************************
+//  TofGeometryTest.cpp
+//
+// Tests of the frame geometry negotiated from the pulsing config
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofGeometry.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+typedef struct
+{
+    UINT32 NumPulses;
+    UINT32 NumLines;
+    UINT32 LinePhases;
+    UINT32 FramePhases;
+    PicoP_ToFDataFormatE Format;
+    UINT32 NumPlanes;
+} TofTestGeometryCase;
+
+TOF_TEST(GeometryPulseLinePhaseCombinations)
+{
+    const TofTestGeometryCase Cases[] =
+    {
+        { 120, 720, 1, 1, eTOF_DATA_FUSED,              2 },
+        { 120, 720, 2, 1, eTOF_DATA_FUSED,              2 },
+        { 120, 720, 4, 1, eTOF_DATA_FUSED,              2 },
+        { 120, 720, 1, 4, eTOF_DATA_FUSED,              2 },
+        { 240, 720, 2, 2, eTOF_DATA_LEFT_SENSOR_ONLY,   2 },
+        { 480, 360, 4, 3, eTOF_DATA_RIGHT_SENSOR_ONLY,  2 },
+        { 100, 720, 1, 1, eTOF_DATA_ALL,                4 },
+        { 1024, 16, 4, 1, eTOF_DATA_DEPTH_ONLY,         2 },
+        { 60, 1440, 2, 1, eTOF_DATA_AMPLITUDE_ONLY,     2 },
+    };
+    TofFrameGeometry Geometry;
+    const TofTestGeometryCase* pCase;
+
+
+    for (UINT32 i = 0; i < sizeof(Cases) / sizeof(Cases[0]); i++)
+    {
+        pCase = &Cases[i];
+
+        TOF_REQUIRE(TofTestGeometry(pCase->Format, pCase->NumPulses, pCase->NumLines,
+                                    pCase->LinePhases, pCase->FramePhases, &Geometry) == eSUCCESS);
+        TOF_CHECK_EQ(pCase->Format, Geometry.Format);
+        TOF_CHECK_EQ(pCase->NumPulses, Geometry.NumPulses);
+        TOF_CHECK_EQ(pCase->NumLines, Geometry.NumLines);
+        TOF_CHECK_EQ(pCase->NumPlanes, Geometry.NumPlanes);
+        TOF_CHECK_EQ(pCase->LinePhases, Geometry.LinePhases);
+        TOF_CHECK_EQ(pCase->FramePhases, Geometry.FramePhases);
+        TOF_CHECK_EQ(pCase->NumPulses * pCase->NumLines, Geometry.PlaneWords);
+        TOF_CHECK_EQ(Geometry.PlaneWords * pCase->NumPlanes, Geometry.FrameWords);
+        TOF_CHECK_EQ(Geometry.FrameWords * (UINT32)sizeof(UINT32), Geometry.FrameBytes);
+        TOF_CHECK_EQ(pCase->NumPulses * pCase->LinePhases, Geometry.ImagePulses);
+        TOF_CHECK_EQ(pCase->NumLines / pCase->LinePhases, Geometry.ImageLines);
+    }
+}
+
+// ****************************************************************************
+
+TOF_TEST(GeometryRejectsUnusableConfigs)
+{
+    PicoP_TofPulsingConfig Config;
+    TofFrameGeometry Geometry;
+
+
+    memset(&Config, 0, sizeof(Config));
+    Config.nrPulsesPerLine = 120;
+
+    TOF_CHECK_EQ(eSUCCESS, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 691200, &Geometry));
+    TOF_CHECK_EQ(eINVALID_ARG, TofMakeFrameGeometry(NULL, eTOF_DATA_FUSED, 691200, &Geometry));
+
+    // Frame size not a whole number of lines, or of line phase groups
+    TOF_CHECK_EQ(eFRAME_ERROR, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 691200 + 4, &Geometry));
+    TOF_CHECK_EQ(eFRAME_ERROR, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 0, &Geometry));
+    Config.nrLinePhases = 4;
+    TOF_CHECK_EQ(eFRAME_ERROR, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 120 * 2 * 4 * 6, &Geometry));
+    Config.nrLinePhases = 3;
+    TOF_CHECK_EQ(eINVALID_ARG, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 691200, &Geometry));
+    Config.nrLinePhases = 0;
+    Config.nrFramePhases = TOF_MAX_FRAME_PHASES + 1;
+    TOF_CHECK_EQ(eINVALID_ARG, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 691200, &Geometry));
+    Config.nrFramePhases = 0;
+
+    Config.nrPulsesPerLine = 0;
+    TOF_CHECK_EQ(eINVALID_ARG, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 691200, &Geometry));
+    Config.nrPulsesPerLine = TOF_MAX_PULSES_PER_LINE + 1;
+    TOF_CHECK_EQ(eNUM_PULSES_PER_LINE_TOO_LARGE, TofMakeFrameGeometry(&Config, eTOF_DATA_FUSED, 691200, &Geometry));
+    Config.nrPulsesPerLine = 120;
+
+    TOF_CHECK_EQ(eNOT_SUPPORTED_DATA_FORMAT,
+                 TofMakeFrameGeometry(&Config, (PicoP_ToFDataFormatE)0x7f, 691200, &Geometry));
+}
+
+// ****************************************************************************
@@ -0,0 +1,174 @@
+// ****************************************************************************
+//  TofLzfTest.cpp
+//
+// Tests of the LZF codec against streams in the liblzf format
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "TofLzf.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+//  The inputs below have either no repeated three byte sequence or only one,
+//  so liblzf's lzf_compress() produces the same stream whatever its hash
+//  table size or hash function. It never refers back to the first byte of
+//  the input and stops a match two bytes short of the end, so its streams
+//  differ from TofLzfCompress's; both must decode the same way.
+// ****************************************************************************
+
+typedef struct
+{
+    const char* pName;
+    std::vector<UINT8> Input;
+    std::vector<UINT8> Liblzf;          // lzf_compress() output
+    std::vector<UINT8> Ours;            // TofLzfCompress() output
+} TofTestLzfStream;
+
+static void TofTestLzfStreams(std::vector<TofTestLzfStream>* pStreams)
+{
+    TofTestLzfStream Stream;
+
+
+    pStreams->clear();
+
+    // 40 different bytes: a full run of 32 literals (control 31), then 8 (control 7)
+    Stream.pName = "literals";
+    Stream.Input.clear();
+
+    for (UINT8 i = 0; i < 40; i++)
+    {
+        Stream.Input.push_back((UINT8)('A' + i));
+    }
+
+    Stream.Liblzf.assign(1, 0x1f);
+    Stream.Liblzf.insert(Stream.Liblzf.end(), Stream.Input.begin(), Stream.Input.begin() + 32);
+    Stream.Liblzf.push_back(0x07);
+    Stream.Liblzf.insert(Stream.Liblzf.end(), Stream.Input.begin() + 32, Stream.Input.end());
+    Stream.Ours = Stream.Liblzf;
+    pStreams->push_back(Stream);
+
+    // 16 x 'a'. liblzf: 2 literals, 12 bytes from distance 1 (0xe0, 12 - 9,
+    // 0), 2 literals. Ours: 1 literal, 15 bytes from distance 1.
+    Stream.pName = "run of 16";
+    Stream.Input.assign(16, 'a');
+    Stream.Liblzf = { 0x01, 'a', 'a', 0xe0, 0x03, 0x00, 0x01, 'a', 'a' };
+    Stream.Ours = { 0x00, 'a', 0xe0, 0x06, 0x00 };
+    pStreams->push_back(Stream);
+
+    // 300 x 'a', past the longest back reference of 264 bytes (0xe0, 255, 0).
+    // liblzf: 2 literals, 264 and 32 bytes from distance 1, 2 literals.
+    // Ours: 1 literal, 264 and 35 bytes from distance 1.
+    Stream.pName = "run of 300";
+    Stream.Input.assign(300, 'a');
+    Stream.Liblzf = { 0x01, 'a', 'a', 0xe0, 0xff, 0x00, 0xe0, 0x17, 0x00, 0x01, 'a', 'a' };
+    Stream.Ours = { 0x00, 'a', 0xe0, 0xff, 0x00, 0xe0, 0x1a, 0x00 };
+    pStreams->push_back(Stream);
+}
+
+// ****************************************************************************
+
+TOF_TEST(LzfDecodesLiblzfStreams)
+{
+    std::vector<TofTestLzfStream> Streams;
+    std::vector<UINT8> Output;
+
+
+    TofTestLzfStreams(&Streams);
+
+    for (size_t i = 0; i < Streams.size(); i++)
+    {
+        Output.assign(Streams[i].Input.size(), 0);
+
+        TOF_CHECK_EQ(Streams[i].Input.size(), TofLzfDecompress(&Streams[i].Liblzf[0], Streams[i].Liblzf.size(),
+                                                               &Output[0], Output.size()));
+        TOF_CHECK(Output == Streams[i].Input);
+    }
+}
+
+TOF_TEST(LzfCompressesToKnownStreams)
+{
+    std::vector<TofTestLzfStream> Streams;
+    std::vector<UINT32> Table(TOF_LZF_TABLE_ENTRIES);
+    std::vector<UINT8> Output;
+    size_t Bytes;
+
+
+    TofTestLzfStreams(&Streams);
+
+    for (size_t i = 0; i < Streams.size(); i++)
+    {
+        Output.assign(TofLzfMaxBytes(Streams[i].Input.size()), 0);
+
+        Bytes = TofLzfCompress(&Streams[i].Input[0], Streams[i].Input.size(), &Output[0], Output.size(), &Table[0]);
+        Output.resize(Bytes);
+        TOF_CHECK(Output == Streams[i].Ours);
+    }
+}
+
+// ****************************************************************************
+//  The caller's table is cleared by every call, so whatever it holds from
+//  the last frame the output is the same
+// ****************************************************************************
+
+TOF_TEST(LzfOutputIndependentOfTable)
+{
+    std::vector<UINT8> Input(100000);
+    std::vector<UINT8> Clean(TofLzfMaxBytes(Input.size()));
+    std::vector<UINT8> Dirty(Clean.size());
+    std::vector<UINT8> Decoded(Input.size());
+    std::vector<UINT32> Table(TOF_LZF_TABLE_ENTRIES, 0);
+    size_t CleanBytes;
+    size_t DirtyBytes;
+    size_t Distance;
+    size_t Length;
+    BOOL Repeat;
+
+
+    srand(7);
+
+    // Random bytes broken by short repeats from up to 10 KB back, so some
+    // are out of reach of a back reference
+    for (size_t i = 0; i < Input.size(); i += Length)
+    {
+        Length = 4 + (rand() % 16);
+        Length = ((i + Length) < Input.size()) ? Length : (Input.size() - i);
+        Distance = 1 + (rand() % 10000);
+        Repeat = (i >= Distance) && ((rand() % 4) != 0);
+
+        for (size_t j = i; j < (i + Length); j++)
+        {
+            Input[j] = Repeat ? Input[j - Distance] : (UINT8)rand();
+        }
+    }
+
+    CleanBytes = TofLzfCompress(&Input[0], Input.size(), &Clean[0], Clean.size(), &Table[0]);
+
+    for (size_t i = 0; i < Table.size(); i++)
+    {
+        Table[i] = (UINT32)rand();
+    }
+
+    DirtyBytes = TofLzfCompress(&Input[0], Input.size(), &Dirty[0], Dirty.size(), &Table[0]);
+
+    TOF_REQUIRE(CleanBytes != 0);
+    TOF_CHECK(CleanBytes < Input.size());
+    TOF_CHECK_EQ(CleanBytes, DirtyBytes);
+    TOF_CHECK(memcmp(&Clean[0], &Dirty[0], CleanBytes) == 0);
+
+    TOF_CHECK_EQ(Input.size(), TofLzfDecompress(&Clean[0], CleanBytes, &Decoded[0], Decoded.size()));
+    TOF_CHECK(Decoded == Input);
+
+    TOF_CHECK_EQ((size_t)0, TofLzfCompress(&Input[0], Input.size(), &Clean[0], Clean.size(), NULL));
+}
+
+// ****************************************************************************
@@ -0,0 +1,173 @@
+// ****************************************************************************
+//  TofNormalizeTest.cpp
+//
+// Synthetic ramp tests of the percentile normalizer
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofNormalize.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+static void TofTestRamp(std::vector<UINT32>* pFrame, UINT32 Count, UINT32 First, UINT32 Step)
+{
+    pFrame->resize(Count);
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        (*pFrame)[i] = First + i * Step;
+    }
+}
+
+// ****************************************************************************
+//  A range of 0 .. 2 x full scale gives a scale of exactly one half, so every
+//  odd value lands on a .5. Each one must round up, in the vector blocks and
+//  in the scalar tail alike.
+// ****************************************************************************
+
+TOF_TEST(NormalizeRoundsHalfUpEverywhere8)
+{
+    std::vector<UINT32> Frame;
+    std::vector<UINT8> Output;
+    TofNormalizer Normalizer;
+    UINT32 Wrong = 0;
+
+
+    TofTestRamp(&Frame, 511, 0, 1);
+    Output.resize(Frame.size());
+    Normalizer.SetRangeLimit(510);
+    Normalizer.Normalize8(&Frame[0], &Output[0], (UINT32)Frame.size());
+
+    for (UINT32 i = 0; i < Frame.size(); i++)
+    {
+        Wrong += (Output[i] != (UINT8)((i + 1) / 2)) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Wrong);
+    TOF_CHECK_EQ(0u, (UINT32)Output[0]);
+    TOF_CHECK_EQ(1u, (UINT32)Output[1]);
+    TOF_CHECK_EQ(255u, (UINT32)Output[510]);
+}
+
+TOF_TEST(NormalizeRoundsHalfUpEverywhere16)
+{
+    std::vector<UINT32> Frame;
+    std::vector<UINT16> Output;
+    TofNormalizer Normalizer;
+    UINT32 Wrong = 0;
+
+
+    TofTestRamp(&Frame, 131071, 0, 1);
+    Output.resize(Frame.size());
+    Normalizer.SetRangeLimit(131070);
+    Normalizer.Normalize16(&Frame[0], &Output[0], (UINT32)Frame.size());
+
+    for (UINT32 i = 0; i < Frame.size(); i++)
+    {
+        Wrong += (Output[i] != (UINT16)((i + 1) / 2)) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Wrong);
+    TOF_CHECK_EQ(65535u, (UINT32)Output[131070]);
+}
+
+// ****************************************************************************
+//  The same ramp cut to every length up to two vector blocks past a multiple
+//  of eight: each value must map the same wherever it falls
+// ****************************************************************************
+
+TOF_TEST(NormalizeIndependentOfLength)
+{
+    std::vector<UINT32> Frame;
+    std::vector<UINT8> Full;
+    std::vector<UINT8> Part;
+    TofNormalizer Normalizer;
+    UINT32 Wrong = 0;
+
+
+    TofTestRamp(&Frame, 40, 1000, 37);
+    Full.resize(Frame.size());
+    Part.resize(Frame.size());
+
+    Normalizer.SetRangeLimit(2000);
+    Normalizer.Normalize8(&Frame[0], &Full[0], (UINT32)Frame.size());
+
+    for (UINT32 Count = 1; Count <= Frame.size(); Count++)
+    {
+        Normalizer.SetRangeLimit(2000);
+        Normalizer.Normalize8(&Frame[Frame.size() - Count], &Part[0], Count);
+
+        for (UINT32 i = 0; i < Count; i++)
+        {
+            Wrong += (Part[i] != Full[Frame.size() - Count + i]) ? 1 : 0;
+        }
+    }
+
+    TOF_CHECK_EQ(0u, Wrong);
+}
+
+// ****************************************************************************
+
+TOF_TEST(NormalizeClipsOutsideRange)
+{
+    std::vector<UINT32> Frame(16);
+    std::vector<UINT8> Output(16);
+    TofNormalizer Normalizer;
+
+
+    for (UINT32 i = 0; i < 16; i++)
+    {
+        Frame[i] = (i < 8) ? 0xffffffffu - i : 100000u + i;
+    }
+
+    Normalizer.SetRangeLimit(1000);
+    Normalizer.Normalize8(&Frame[0], &Output[0], 16);
+
+    for (UINT32 i = 0; i < 16; i++)
+    {
+        TOF_CHECK_EQ(255u, (UINT32)Output[i]);
+    }
+}
+
+TOF_TEST(NormalizeClipsToPercentilesOfPreviousFrame)
+{
+    std::vector<UINT32> Frame;
+    std::vector<UINT8> Output;
+    TofNormalizer Normalizer;
+    TofRangeStats Stats;
+
+
+    // 0 .. 102300 in steps of 100, one value per 64 wide bin
+    TofTestRamp(&Frame, 1024, 0, 100);
+    Output.resize(Frame.size());
+    Normalizer.SetRangeLimit(0xffff);
+    Normalizer.SetPercentiles(10.0f, 90.0f);
+
+    Normalizer.Normalize8(&Frame[0], &Output[0], (UINT32)Frame.size());
+    Normalizer.GetStats(&Stats);
+    TOF_CHECK_EQ(0u, Stats.Min);
+    TOF_CHECK_EQ(102300u, Stats.Max);
+
+    // The top third of the ramp is past the range limit and shares the last bin
+    TOF_CHECK(Stats.Low >= 10000);
+    TOF_CHECK(Stats.Low <= 10300);
+    TOF_CHECK_EQ(0xffffu, Stats.High);
+
+    // The next frame uses them
+    Normalizer.Normalize8(&Frame[0], &Output[0], (UINT32)Frame.size());
+    TOF_CHECK_EQ(0u, (UINT32)Output[50]);
+    TOF_CHECK_EQ(255u, (UINT32)Output[700]);
+    TOF_CHECK(Output[300] > 0);
+    TOF_CHECK(Output[300] < 255);
+}
+
+// ****************************************************************************
@@ -0,0 +1,248 @@
+// ****************************************************************************
+//  TofPhaseAssemblerTest.cpp
+//
+// Tests of line and frame phase reassembly
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <vector>
+#include "TofPhaseAssembler.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_IMAGE_LINES    6
+
+typedef struct
+{
+    TofFrameGeometry Geometry;
+    std::vector<UINT32> Data[4];        // One sub-frame per frame phase
+    TofFrameView Views[4];
+} TofTestPhased;
+
+// Every word of every sub-frame tells where it came from
+static UINT32 TofTestWord(UINT32 FramePhase, UINT32 Line, UINT32 Pulse, BOOL Amplitude)
+{
+    return (Amplitude ? 0x80000000u : 0) | (FramePhase << 24) | (Line << 12) | (Pulse + 1);
+}
+
+static BOOL TofTestPhasedMake(UINT32 NumPulses, UINT32 LinePhases, UINT32 FramePhases, TofTestPhased* pPhased)
+{
+    TofFrameGeometry* pGeometry = &pPhased->Geometry;
+    UINT32 NumLines = TOF_TEST_IMAGE_LINES * LinePhases;
+
+
+    if (TofTestGeometry(eTOF_DATA_FUSED, NumPulses, NumLines, LinePhases, FramePhases, pGeometry) != eSUCCESS)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 f = 0; f < FramePhases; f++)
+    {
+        pPhased->Data[f].resize(pGeometry->FrameWords);
+
+        for (UINT32 Line = 0; Line < NumLines; Line++)
+        {
+            for (UINT32 Pulse = 0; Pulse < NumPulses; Pulse++)
+            {
+                pPhased->Data[f][(Line * NumPulses) + Pulse] = TofTestWord(f, Line, Pulse, FALSE);
+                pPhased->Data[f][pGeometry->PlaneWords + (Line * NumPulses) + Pulse] = TofTestWord(f, Line, Pulse, TRUE);
+            }
+        }
+
+        if (TofMakeFrameView(&pPhased->Data[f][0], pGeometry->FrameWords, NumPulses, NumLines, eTOF_DATA_FUSED,
+                             &pPhased->Views[f]) != eSUCCESS)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+// ****************************************************************************
+//  Counts grid words that differ from the documented mapping: pulse p of
+//  line phase l in column p * LinePhases + l, scan line s of frame phase f
+//  in row s * FramePhases + f. Rows of phases not in Merged must be 0.
+// ****************************************************************************
+
+static UINT32 TofTestGridMismatches(const TofTestPhased* pPhased, const TofFrameView* pGrid, UINT32 Merged)
+{
+    const TofFrameGeometry* pGeometry = &pPhased->Geometry;
+    UINT32 Width = pGeometry->NumPulses * pGeometry->LinePhases;
+    UINT32 Mismatches = 0;
+    UINT32 Row;
+    UINT32 Column;
+    UINT32 Line;
+    BOOL Seen;
+
+
+    if ((pGrid->NumPulses != Width) || (pGrid->NumLines != pGeometry->ImageLines * pGeometry->FramePhases))
+    {
+        return 0xFFFFFFFFu;
+    }
+
+    for (UINT32 s = 0; s < pGeometry->ImageLines; s++)
+    {
+        for (UINT32 f = 0; f < pGeometry->FramePhases; f++)
+        {
+            Row = (s * pGeometry->FramePhases) + f;
+            Seen = (Merged & (1u << f)) ? TRUE : FALSE;
+
+            for (UINT32 l = 0; l < pGeometry->LinePhases; l++)
+            {
+                Line = (s * pGeometry->LinePhases) + l;
+
+                for (UINT32 p = 0; p < pGeometry->NumPulses; p++)
+                {
+                    Column = (p * pGeometry->LinePhases) + l;
+                    Mismatches += (pGrid->pTime[(Row * Width) + Column] != (Seen ? TofTestWord(f, Line, p, FALSE) : 0)) ? 1 : 0;
+                    Mismatches += (pGrid->pAmplitude[(Row * Width) + Column] != (Seen ? TofTestWord(f, Line, p, TRUE) : 0)) ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    return Mismatches;
+}
+
+// ****************************************************************************
+
+static const UINT32 sLinePhases[] = { 1, 2, 4 };
+static const UINT32 sPulses[] = { 7, 8, 61, 120, 122 };
+
+TOF_TEST(RollingMergesEveryPhaseCombination)
+{
+    TofTestPhased Phased;
+    TofPhaseAssembler Assembler;
+    TofFrameView Grid;
+    UINT32 Merged;
+    BOOL Updated;
+
+
+    for (UINT32 lp = 0; lp < sizeof(sLinePhases) / sizeof(sLinePhases[0]); lp++)
+    {
+        for (UINT32 FramePhases = 1; FramePhases <= 4; FramePhases++)
+        {
+            for (UINT32 np = 0; np < sizeof(sPulses) / sizeof(sPulses[0]); np++)
+            {
+                TOF_REQUIRE(TofTestPhasedMake(sPulses[np], sLinePhases[lp], FramePhases, &Phased));
+                TOF_REQUIRE(Assembler.Create(&Phased.Geometry, eTOF_PHASE_ROLLING) == eSUCCESS);
+                Merged = 0;
+
+                for (UINT32 f = 0; f < FramePhases; f++)
+                {
+                    TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[f], f, &Updated));
+                    TOF_CHECK(Updated);
+                    Merged |= 1u << f;
+
+                    // Visible straight away, the phases not yet seen are empty
+                    Assembler.GetView(&Grid);
+                    TOF_CHECK_EQ(0u, TofTestGridMismatches(&Phased, &Grid, Merged));
+                }
+            }
+        }
+    }
+}
+
+TOF_TEST(CompleteShowsOnlyWholeSetsOfEveryPhaseCombination)
+{
+    TofTestPhased Phased;
+    TofPhaseAssembler Assembler;
+    TofFrameView Grid;
+    TofPhaseStats Stats;
+    BOOL Updated;
+
+
+    for (UINT32 lp = 0; lp < sizeof(sLinePhases) / sizeof(sLinePhases[0]); lp++)
+    {
+        for (UINT32 FramePhases = 1; FramePhases <= 4; FramePhases++)
+        {
+            for (UINT32 np = 0; np < sizeof(sPulses) / sizeof(sPulses[0]); np++)
+            {
+                TOF_REQUIRE(TofTestPhasedMake(sPulses[np], sLinePhases[lp], FramePhases, &Phased));
+                TOF_REQUIRE(Assembler.Create(&Phased.Geometry, eTOF_PHASE_COMPLETE) == eSUCCESS);
+
+                // Phases in reverse order, so arrival order does not matter
+                for (UINT32 i = 0; i < FramePhases; i++)
+                {
+                    TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[FramePhases - 1 - i], FramePhases - 1 - i,
+                                                         &Updated));
+                    TOF_CHECK(Updated == (i == FramePhases - 1));
+                    Assembler.GetView(&Grid);
+                    TOF_CHECK_EQ(0u, TofTestGridMismatches(&Phased, &Grid, Updated ? 0xFu : 0u));
+                }
+
+                Assembler.GetStats(&Stats);
+                TOF_CHECK_EQ((uint64_t)1, Stats.SetsCompleted);
+                TOF_CHECK_EQ((uint64_t)FramePhases, Stats.SubFrames);
+            }
+        }
+    }
+}
+
+TOF_TEST(CompleteRestartsASetWithAMissingPhase)
+{
+    TofTestPhased Phased;
+    TofPhaseAssembler Assembler;
+    TofFrameView Grid;
+    TofPhaseStats Stats;
+    BOOL Updated;
+
+
+    TOF_REQUIRE(TofTestPhasedMake(120, 2, 4, &Phased));
+    TOF_REQUIRE(Assembler.Create(&Phased.Geometry, eTOF_PHASE_COMPLETE) == eSUCCESS);
+
+    // Phase 2 lost: 0 1 3, then 0 again starts a new set
+    TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[0], 0, &Updated));
+    TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[1], 1, &Updated));
+    TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[3], 3, &Updated));
+    TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[0], 0, &Updated));
+    TOF_CHECK( ! Updated);
+
+    for (UINT32 f = 1; f < 4; f++)
+    {
+        TOF_CHECK_EQ(eSUCCESS, Assembler.Add(&Phased.Views[f], f, &Updated));
+    }
+
+    TOF_CHECK(Updated);
+    Assembler.GetView(&Grid);
+    TOF_CHECK_EQ(0u, TofTestGridMismatches(&Phased, &Grid, 0xFu));
+
+    Assembler.GetStats(&Stats);
+    TOF_CHECK_EQ((uint64_t)1, Stats.SetsAbandoned);
+    TOF_CHECK_EQ((uint64_t)1, Stats.SetsCompleted);
+}
+
+TOF_TEST(AssemblerRejectsBadSubFrames)
+{
+    TofTestPhased Phased;
+    TofTestPhased Other;
+    TofPhaseAssembler Assembler;
+    TofPhaseStats Stats;
+
+
+    TOF_REQUIRE(TofTestPhasedMake(120, 2, 2, &Phased));
+    TOF_REQUIRE(TofTestPhasedMake(64, 2, 2, &Other));
+    TOF_CHECK_EQ(eINVALID_ARG, Assembler.Add(&Phased.Views[0], 0, NULL));
+    TOF_CHECK_EQ(eINVALID_ARG, Assembler.Create(NULL, eTOF_PHASE_ROLLING));
+
+    TOF_REQUIRE(Assembler.Create(&Phased.Geometry, eTOF_PHASE_ROLLING) == eSUCCESS);
+    TOF_CHECK_EQ(eFRAME_ERROR, Assembler.Add(&Phased.Views[0], 2, NULL));
+    TOF_CHECK_EQ(eFRAME_ERROR, Assembler.Add(&Other.Views[0], 0, NULL));
+    TOF_CHECK_EQ(eINVALID_ARG, Assembler.Add(NULL, 0, NULL));
+
+    Assembler.GetStats(&Stats);
+    TOF_CHECK_EQ((uint64_t)2, Stats.SubFramesRejected);
+    TOF_CHECK_EQ((uint64_t)0, Stats.SubFrames);
+}
+
+// ****************************************************************************
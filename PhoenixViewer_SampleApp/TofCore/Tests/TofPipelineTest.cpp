@@ -0,0 +1,254 @@
+// ****************************************************************************
+//  TofPipelineTest.cpp
+//
+// Tests of the staged frame pipeline
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TofPipeline.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_PULSES     64
+#define TOF_TEST_LINES      16
+
+// Records what reaches the end of the pipeline
+class TofTestSink : public TofPipelineStage
+{
+public:
+    TofTestSink() : mDelayUs(0), mFailOdd(FALSE), mBadPlanes(0) {}
+
+    virtual const char* GetName() const { return "test sink"; }
+
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame)
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+
+        if (mDelayUs != 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(mDelayUs));
+        }
+
+        if (mFailOdd && ((pFrame->SequenceNumber & 1) != 0))
+        {
+            return eFRAME_ERROR;
+        }
+
+        // The decoded time plane starts with the word the test stamped
+        mBadPlanes += ((pFrame->pPlanes == NULL) || (pFrame->pPlanes->GetTime()[0] != pFrame->SequenceNumber)) ? 1 : 0;
+        mSequence.push_back(pFrame->SequenceNumber);
+
+        return eSUCCESS;
+    }
+
+    std::mutex mLock;
+    UINT32 mDelayUs;
+    BOOL mFailOdd;
+    UINT32 mBadPlanes;
+    std::vector<UINT32> mSequence;
+};
+
+static void TofTestSubmit(TofPipeline* pPipeline, const TofFrameGeometry* pGeometry, UINT32 Count,
+                          std::atomic<UINT32>* pFailures)
+{
+    std::vector<UINT32> Frame;
+
+
+    TofTestRender(pGeometry, eTOF_SIM_SCENE_ROOM, 0, &Frame);
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        Frame[0] = i;
+        *pFailures += (pPipeline->Submit(&Frame[0], i, TofClock::now()) != eSUCCESS) ? 1 : 0;
+    }
+}
+
+// Waits up to a second for Count frames to leave the pipeline, one way or another
+static void TofTestDrain(TofPipeline* pPipeline, uint64_t Count)
+{
+    TofPipelineMetrics Metrics;
+    TofStageMetrics Stage;
+    uint64_t Left;
+
+
+    for (UINT32 i = 0; i < 1000; i++)
+    {
+        pPipeline->GetMetrics(&Metrics);
+        Left = Count - Metrics.FramesCompleted;
+
+        for (UINT32 s = 0; s < pPipeline->GetStageCount(); s++)
+        {
+            pPipeline->GetStageMetrics(s, &Stage);
+            Left -= Stage.FramesDropped + Stage.FramesRejected;
+        }
+
+        if (Left == 0)
+        {
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// ****************************************************************************
+
+TOF_TEST(PipelineRejectsBadArguments)
+{
+    TofPipeline Pipeline;
+    TofFrameGeometry Geometry;
+    TofTestSink Sink;
+    UINT32 Word = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, TOF_TEST_PULSES, TOF_TEST_LINES, 1, 1, &Geometry) == eSUCCESS);
+
+    TOF_CHECK_EQ(eINVALID_ARG, Pipeline.Start(&Geometry));
+    TOF_CHECK_EQ(eINVALID_ARG, Pipeline.AddStage(NULL, 1, 4, eTOF_QUEUE_BLOCK));
+    TOF_CHECK_EQ(eSUCCESS, Pipeline.AddStage(&Sink, 1, 4, eTOF_QUEUE_BLOCK));
+    TOF_CHECK_EQ(eINVALID_STATE, Pipeline.Submit(&Word, 0, TofClock::now()));
+    TOF_CHECK_EQ(eINVALID_ARG, Pipeline.Start(NULL));
+}
+
+TOF_TEST(PipelineBlockingDeliversEveryFrameInOrder)
+{
+    TofPipeline Pipeline;
+    TofFrameGeometry Geometry;
+    TofDecodeStage Decode;
+    TofTestSink Sink;
+    TofPipelineMetrics Metrics;
+    TofStageMetrics Stage;
+    std::atomic<UINT32> Failures(0);
+    UINT32 OutOfOrder = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, TOF_TEST_PULSES, TOF_TEST_LINES, 1, 1, &Geometry) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Decode, 1, 2, eTOF_QUEUE_BLOCK) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Sink, 1, 2, eTOF_QUEUE_BLOCK) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.Start(&Geometry) == eSUCCESS);
+
+    // A slow sink backs the queues up into Submit(), which waits
+    Sink.mDelayUs = 200;
+    TofTestSubmit(&Pipeline, &Geometry, 100, &Failures);
+    TofTestDrain(&Pipeline, 100);
+    Pipeline.GetMetrics(&Metrics);
+    Pipeline.Stop();
+
+    TOF_CHECK_EQ(0u, Failures.load());
+    TOF_CHECK_EQ(100u, (UINT32)Metrics.FramesSubmitted);
+    TOF_CHECK_EQ(100u, (UINT32)Metrics.FramesCompleted);
+    TOF_REQUIRE(Sink.mSequence.size() == 100);
+    TOF_CHECK_EQ(0u, Sink.mBadPlanes);
+
+    for (UINT32 i = 0; i < 100; i++)
+    {
+        OutOfOrder += (Sink.mSequence[i] != i) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, OutOfOrder);
+
+    for (UINT32 s = 0; s < Pipeline.GetStageCount(); s++)
+    {
+        Pipeline.GetStageMetrics(s, &Stage);
+        TOF_CHECK_EQ(100u, (UINT32)Stage.FramesProcessed);
+        TOF_CHECK_EQ(0u, (UINT32)Stage.FramesDropped);
+        TOF_CHECK(Stage.MaxQueueDepth <= 2);
+    }
+
+    // The sink's queue filled up behind its delay
+    TOF_CHECK_EQ(2u, Stage.MaxQueueDepth);
+    TOF_CHECK(Stage.TotalProcessUs >= 100 * 200);
+}
+
+TOF_TEST(PipelineDropOldestKeepsNewestFrames)
+{
+    TofPipeline Pipeline;
+    TofFrameGeometry Geometry;
+    TofDecodeStage Decode;
+    TofTestSink Sink;
+    TofStageMetrics Stage;
+    std::atomic<UINT32> Failures(0);
+    UINT32 OutOfOrder = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, TOF_TEST_PULSES, TOF_TEST_LINES, 1, 1, &Geometry) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Decode, 1, 4, eTOF_QUEUE_BLOCK) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Sink, 1, 2, eTOF_QUEUE_DROP_OLDEST) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.Start(&Geometry) == eSUCCESS);
+
+    Sink.mDelayUs = 1000;
+    TofTestSubmit(&Pipeline, &Geometry, 100, &Failures);
+    TofTestDrain(&Pipeline, 100);
+    Pipeline.GetStageMetrics(1, &Stage);
+    Pipeline.Stop();
+
+    // Everything submitted is either delivered or dropped, never lost
+    TOF_CHECK_EQ(0u, Failures.load());
+    TOF_CHECK(Stage.FramesDropped > 0);
+    TOF_CHECK_EQ(100u, (UINT32)(Stage.FramesProcessed + Stage.FramesDropped));
+    TOF_REQUIRE( ! Sink.mSequence.empty());
+    TOF_CHECK_EQ(99u, Sink.mSequence.back());
+
+    for (size_t i = 1; i < Sink.mSequence.size(); i++)
+    {
+        OutOfOrder += (Sink.mSequence[i] <= Sink.mSequence[i - 1]) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, OutOfOrder);
+}
+
+TOF_TEST(PipelineRejectedFramesGoNoFurther)
+{
+    TofPipeline Pipeline;
+    TofFrameGeometry Geometry;
+    TofDecodeStage Decode;
+    TofTestSink Filter;
+    TofTestSink Sink;
+    TofStageMetrics Stage;
+    TofPipelineMetrics Metrics;
+    std::atomic<UINT32> Failures(0);
+    UINT32 Odd = 0;
+
+
+    TOF_REQUIRE(TofTestGeometry(eTOF_DATA_FUSED, TOF_TEST_PULSES, TOF_TEST_LINES, 1, 1, &Geometry) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Decode, 3, 4, eTOF_QUEUE_BLOCK) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Filter, 1, 4, eTOF_QUEUE_BLOCK) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.AddStage(&Sink, 1, 4, eTOF_QUEUE_BLOCK) == eSUCCESS);
+    TOF_REQUIRE(Pipeline.Start(&Geometry) == eSUCCESS);
+
+    Filter.mFailOdd = TRUE;
+    TofTestSubmit(&Pipeline, &Geometry, 60, &Failures);
+    TofTestDrain(&Pipeline, 60);
+    Pipeline.GetStageMetrics(1, &Stage);
+    Pipeline.GetMetrics(&Metrics);
+    Pipeline.Stop();
+
+    TOF_CHECK_EQ(30u, (UINT32)Stage.FramesRejected);
+    TOF_CHECK_EQ(30u, (UINT32)Metrics.FramesCompleted);
+    TOF_REQUIRE(Sink.mSequence.size() == 30);
+    TOF_CHECK_EQ(0u, Sink.mBadPlanes);
+
+    for (size_t i = 0; i < Sink.mSequence.size(); i++)
+    {
+        Odd += Sink.mSequence[i] & 1;
+    }
+
+    TOF_CHECK_EQ(0u, Odd);
+}
+
+// ****************************************************************************
@@ -0,0 +1,219 @@
+// ****************************************************************************
+//  TofPointCloudTest.cpp
+//
+// Accuracy of the table driven point cloud converters against the scalar reference
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "TofPointCloud.h"
+#include "TofProjector.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+typedef struct
+{
+    std::vector<UINT32> Data;
+    TofFrameView View;
+} TofTestCloudFrame;
+
+// A simulated room with every seventh pixel dropped out and a few far and
+// near ranges mixed in
+static void TofTestCloudFrameMake(UINT32 NumPulses, UINT32 NumLines, TofTestCloudFrame* pFrame)
+{
+    TofFrameGeometry Geometry;
+    UINT32 Pixels = NumPulses * NumLines;
+
+
+    TofTestGeometry(eTOF_DATA_FUSED, NumPulses, NumLines, 1, 1, &Geometry);
+    TofTestRender(&Geometry, eTOF_SIM_SCENE_ROOM, 5, &pFrame->Data);
+    srand(NumPulses);
+
+    for (UINT32 i = 0; i < Pixels; i++)
+    {
+        if ((i % 7) == 3)
+        {
+            pFrame->Data[i] = 0;
+        }
+        else if ((i % 11) == 5)
+        {
+            pFrame->Data[i] = 1 + (UINT32)rand() % 200000;
+        }
+    }
+
+    TofMakeFrameView(&pFrame->Data[0], (UINT32)pFrame->Data.size(), NumPulses, NumLines, eTOF_DATA_FUSED,
+                     &pFrame->View);
+}
+
+static UINT32 TofTestCountMismatches(const std::vector<PicoP_Pcd_Data>& Expected, const std::vector<PicoP_Pcd_Data>& Actual)
+{
+    UINT32 Mismatches = 0;
+
+
+    for (size_t i = 0; i < Expected.size(); i++)
+    {
+        Mismatches += ((Expected[i].x != Actual[i].x) || (Expected[i].y != Actual[i].y) ||
+                       (Expected[i].z != Actual[i].z) || (Expected[i].intensity != Actual[i].intensity)) ? 1 : 0;
+    }
+
+    return Mismatches;
+}
+
+// ****************************************************************************
+//  Every pulsing mode, with pulse counts that do and do not fill whole
+//  SIMD groups, converted line by line must match the reference exactly
+// ****************************************************************************
+
+TOF_TEST(ProjectLinesMatchesScalarReference)
+{
+    static const PicoP_ToFPulsingModeE sModes[] = { eTOF_PULSING_EQUAL_ANGLE, eTOF_PULSING_EQUAL_TIME,
+                                                     eTOF_PULSING_POLYNOMIAL };
+    static const UINT32 sPulses[] = { 120, 61, 3 };
+    TofScanGeometry Scan;
+    TofRayTable Table;
+    TofTestCloudFrame Frame;
+    std::vector<PicoP_Pcd_Data> Expected;
+    std::vector<PicoP_Pcd_Data> Actual;
+    UINT32 NumPoints = 0;
+
+
+    for (UINT32 m = 0; m < sizeof(sModes) / sizeof(sModes[0]); m++)
+    {
+        for (UINT32 p = 0; p < sizeof(sPulses) / sizeof(sPulses[0]); p++)
+        {
+            TofDefaultScanGeometry(&Scan);
+            Scan.PulsingMode = sModes[m];
+            Scan.MillimetersPerCount = 0.75f;
+            TofTestCloudFrameMake(sPulses[p], 90, &Frame);
+
+            Expected.assign(sPulses[p] * 90, PicoP_Pcd_Data());
+            Actual.assign(Expected.size(), PicoP_Pcd_Data());
+
+            TOF_REQUIRE(TofFrameToPointCloudScalar(&Frame.View, &Scan, &Expected[0], (UINT32)Expected.size(),
+                                                   &NumPoints) == eSUCCESS);
+            TOF_REQUIRE(Table.Create(&Scan, sPulses[p], 90) == eSUCCESS);
+
+            // Out of order bands, as the projector's threads may finish
+            TofProjectLines(&Table, &Frame.View, 45, 90, &Actual[0]);
+            TofProjectLines(&Table, &Frame.View, 0, 45, &Actual[0]);
+            TOF_CHECK_EQ(0u, TofTestCountMismatches(Expected, Actual));
+
+            TOF_REQUIRE(TofFrameToPointCloud(&Frame.View, &Scan, &Actual[0], (UINT32)Actual.size(),
+                                             &NumPoints) == eSUCCESS);
+            TOF_CHECK_EQ((UINT32)Expected.size(), NumPoints);
+            TOF_CHECK_EQ(0u, TofTestCountMismatches(Expected, Actual));
+        }
+    }
+}
+
+TOF_TEST(ProjectLinesSoAWithinHalfMillimetre)
+{
+    TofScanGeometry Scan;
+    TofRayTable Table;
+    TofPointCloudSoA SoA;
+    TofTestCloudFrame Frame;
+    std::vector<PicoP_Pcd_Data> Expected(121 * 40);
+    UINT32 NumPoints = 0;
+    UINT32 Outside = 0;
+    FP32 Error;
+
+
+    TofDefaultScanGeometry(&Scan);
+    Scan.PulsingMode = eTOF_PULSING_EQUAL_TIME;
+    TofTestCloudFrameMake(121, 40, &Frame);
+
+    TOF_REQUIRE(TofFrameToPointCloudScalar(&Frame.View, &Scan, &Expected[0], (UINT32)Expected.size(),
+                                           &NumPoints) == eSUCCESS);
+    TOF_REQUIRE(Table.Create(&Scan, 121, 40) == eSUCCESS);
+    TOF_REQUIRE(SoA.Create((UINT32)Expected.size()) == eSUCCESS);
+    TofProjectLinesSoA(&Table, &Frame.View, 0, 40, &SoA);
+
+    for (UINT32 i = 0; i < NumPoints; i++)
+    {
+        Error = fabsf(SoA.GetX()[i] - Expected[i].x);
+        Error = fmaxf(Error, fabsf(SoA.GetY()[i] - Expected[i].y));
+        Error = fmaxf(Error, fabsf(SoA.GetZ()[i] - Expected[i].z));
+        Outside += ((Error > 0.5f) || (SoA.GetIntensity()[i] != (FP32)Expected[i].intensity)) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Outside);
+}
+
+TOF_TEST(ProjectorMatchesScalarOnEveryThreadCount)
+{
+    static const UINT32 sThreads[] = { 1, 2, 3, 7 };
+    TofScanGeometry Scan;
+    TofProjector Projector;
+    TofTestCloudFrame Frame;
+    std::vector<PicoP_Pcd_Data> Expected(120 * 101);
+    std::vector<PicoP_Pcd_Data> Actual(120 * 101);
+    UINT32 NumPoints = 0;
+
+
+    TofDefaultScanGeometry(&Scan);
+    TofTestCloudFrameMake(120, 101, &Frame);
+    TOF_REQUIRE(TofFrameToPointCloudScalar(&Frame.View, &Scan, &Expected[0], (UINT32)Expected.size(),
+                                           &NumPoints) == eSUCCESS);
+
+    for (UINT32 i = 0; i < sizeof(sThreads) / sizeof(sThreads[0]); i++)
+    {
+        TOF_REQUIRE(Projector.Create(&Scan, 120, 101, sThreads[i]) == eSUCCESS);
+        TOF_CHECK_EQ(sThreads[i], Projector.GetThreadCount());
+
+        Actual.assign(Actual.size(), PicoP_Pcd_Data());
+        TOF_CHECK_EQ(eSUCCESS, Projector.Project(&Frame.View, &Actual[0], (UINT32)Actual.size(), &NumPoints));
+        TOF_CHECK_EQ((UINT32)Expected.size(), NumPoints);
+        TOF_CHECK_EQ(0u, TofTestCountMismatches(Expected, Actual));
+
+        TOF_CHECK_EQ(eINVALID_ARG, Projector.Project(&Frame.View, &Actual[0], (UINT32)Actual.size() - 1, &NumPoints));
+        TOF_CHECK_EQ(0u, NumPoints);
+        Projector.Destroy();
+    }
+}
+
+TOF_TEST(ProjectIndicesMatchesOrganizedCloud)
+{
+    TofScanGeometry Scan;
+    TofProjector Projector;
+    TofTestCloudFrame Frame;
+    std::vector<PicoP_Pcd_Data> Expected(64 * 32);
+    std::vector<PicoP_Pcd_Data> Picked;
+    std::vector<PicoP_Pcd_Data> Actual;
+    std::vector<UINT32> Indices;
+    UINT32 NumPoints = 0;
+
+
+    TofDefaultScanGeometry(&Scan);
+    TofTestCloudFrameMake(64, 32, &Frame);
+    TOF_REQUIRE(TofFrameToPointCloudScalar(&Frame.View, &Scan, &Expected[0], (UINT32)Expected.size(),
+                                           &NumPoints) == eSUCCESS);
+
+    for (UINT32 i = 0; i < NumPoints; i++)
+    {
+        if (Frame.View.pTime[i] != 0)
+        {
+            Indices.push_back(i);
+            Picked.push_back(Expected[i]);
+        }
+    }
+
+    Actual.resize(Indices.size());
+    TOF_REQUIRE(Projector.Create(&Scan, 64, 32, 3) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, Projector.ProjectIndices(&Frame.View, &Indices[0], (UINT32)Indices.size(),
+                                                    &Actual[0], (UINT32)Actual.size(), &NumPoints));
+    TOF_CHECK_EQ((UINT32)Indices.size(), NumPoints);
+    TOF_CHECK_EQ(0u, TofTestCountMismatches(Picked, Actual));
+}
+
+// ****************************************************************************
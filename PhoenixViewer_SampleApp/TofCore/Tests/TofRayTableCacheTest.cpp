@@ -0,0 +1,120 @@
+// ****************************************************************************
+//  TofRayTableCacheTest.cpp
+//
+// Tests of the shared ray table cache
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <thread>
+#include <vector>
+#include "TofRayTableCache.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+TOF_TEST(RayTableCacheSharesOneTablePerConfiguration)
+{
+    TofRayTableCache Cache;
+    TofRayTableCacheStats Stats;
+    TofScanGeometry Scan;
+    TofRayTablePtr First;
+    TofRayTablePtr Again;
+    TofRayTablePtr Other;
+
+
+    TofDefaultScanGeometry(&Scan);
+
+    TOF_REQUIRE(Cache.Get(&Scan, 120, 720, &First) == eSUCCESS);
+    TOF_REQUIRE(Cache.Get(&Scan, 120, 720, &Again) == eSUCCESS);
+    TOF_CHECK(First == Again);
+    TOF_CHECK_EQ(120u, First->GetNumPulses());
+    TOF_CHECK_EQ(720u, First->GetNumLines());
+
+    // Any part of the key changing misses
+    Scan.PulsingMode = eTOF_PULSING_EQUAL_TIME;
+    TOF_REQUIRE(Cache.Get(&Scan, 120, 720, &Other) == eSUCCESS);
+    TOF_CHECK(Other != First);
+    TOF_CHECK_EQ(eTOF_PULSING_EQUAL_TIME, Other->GetGeometry()->PulsingMode);
+
+    Scan.HorizontalFov = 40.0f;
+    TOF_REQUIRE(Cache.Get(&Scan, 120, 720, &Other) == eSUCCESS);
+    TOF_REQUIRE(Cache.Get(&Scan, 120, 360, &Other) == eSUCCESS);
+    TOF_CHECK_EQ(360u, Other->GetNumLines());
+
+    Cache.GetStats(&Stats);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.Hits);
+    TOF_CHECK_EQ(4u, (UINT32)Stats.Builds);
+    TOF_CHECK_EQ(4u, Stats.Tables);
+
+    TOF_CHECK_EQ(eINVALID_ARG, Cache.Get(NULL, 120, 720, &Other));
+    TOF_CHECK(Cache.Get(&Scan, 0, 720, &Other) != eSUCCESS);
+}
+
+TOF_TEST(RayTableCacheDropsLeastRecentlyUsed)
+{
+    TofRayTableCache Cache;
+    TofRayTableCacheStats Stats;
+    TofScanGeometry Scan;
+    TofRayTablePtr Held;
+    TofRayTablePtr Table;
+
+
+    TofDefaultScanGeometry(&Scan);
+    TOF_REQUIRE(Cache.Get(&Scan, 8, 8, &Held) == eSUCCESS);
+
+    for (UINT32 i = 1; i <= TOF_RAY_TABLE_CACHE_SIZE; i++)
+    {
+        TOF_REQUIRE(Cache.Get(&Scan, 8, 8 + i, &Table) == eSUCCESS);
+    }
+
+    // 8 x 8 was dropped, yet the holder's table lives on
+    Cache.GetStats(&Stats);
+    TOF_CHECK_EQ((UINT32)TOF_RAY_TABLE_CACHE_SIZE, Stats.Tables);
+    TOF_CHECK_EQ(8u, Held->GetNumLines());
+    TOF_REQUIRE(Cache.Get(&Scan, 8, 8, &Table) == eSUCCESS);
+    TOF_CHECK(Table != Held);
+
+    Cache.Invalidate();
+    Cache.GetStats(&Stats);
+    TOF_CHECK_EQ(0u, Stats.Tables);
+    TOF_CHECK_EQ(8u, Table->GetNumPulses());
+}
+
+TOF_TEST(RayTableCacheBuildsOnceAcrossThreads)
+{
+    TofRayTableCache Cache;
+    TofRayTableCacheStats Stats;
+    TofScanGeometry Scan;
+    std::vector<TofRayTablePtr> Tables(8);
+    std::vector<std::thread> Threads;
+
+
+    TofDefaultScanGeometry(&Scan);
+
+    for (size_t i = 0; i < Tables.size(); i++)
+    {
+        Threads.push_back(std::thread([&, i]() { Cache.Get(&Scan, 120, 720, &Tables[i]); }));
+    }
+
+    for (size_t i = 0; i < Threads.size(); i++)
+    {
+        Threads[i].join();
+    }
+
+    Cache.GetStats(&Stats);
+    TOF_CHECK_EQ(1u, (UINT32)Stats.Builds);
+
+    for (size_t i = 1; i < Tables.size(); i++)
+    {
+        TOF_CHECK(Tables[i] == Tables[0]);
+    }
+}
+
+// ****************************************************************************
@@ -0,0 +1,256 @@
+// ****************************************************************************
+//  TofRecordingTest.cpp
+//
+// Round trip, truncation and playback tests of the recording format
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "TofRecording.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_PULSES     64
+#define TOF_TEST_LINES      16
+#define TOF_TEST_WORDS      (TOF_TEST_PULSES * TOF_TEST_LINES * 2)
+#define TOF_TEST_FRAMES     43          // Five full chunks and a partial one
+
+static void TofTestFrame(UINT32 Number, std::vector<UINT32>* pFrame)
+{
+    pFrame->resize(TOF_TEST_WORDS);
+
+    for (UINT32 i = 0; i < TOF_TEST_WORDS; i++)
+    {
+        (*pFrame)[i] = (Number << 20) ^ (i * 2654435761u);
+    }
+}
+
+// Writes TOF_TEST_FRAMES frames 1 ms apart, retrying any the writer was too busy for
+static PICOP_RC TofTestRecord(const char* pFileName, BOOL Compress)
+{
+    PicoP_TofPulsingConfig Config;
+    TofRecorder Recorder;
+    std::vector<UINT32> Frame;
+    TofClock::time_point Start = TofClock::now();
+    TofClock::time_point Time;
+    PICOP_RC PicopRc;
+
+
+    memset(&Config, 0, sizeof(Config));
+    Config.pulsingMode = eTOF_PULSING_EQUAL_ANGLE;
+    Config.nrPulsesPerLine = TOF_TEST_PULSES;
+    Config.nrFramePhases = 2;
+
+    PicopRc = Recorder.Open(pFileName, &Config, eTOF_DATA_LEFT_SENSOR_ONLY, TOF_TEST_WORDS * sizeof(UINT32), Compress);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    for (UINT32 i = 0; i < TOF_TEST_FRAMES; i++)
+    {
+        TofTestFrame(i, &Frame);
+        Time = Start + std::chrono::milliseconds(i);
+
+        while ((PicopRc = Recorder.Write(&Frame[0], 100 + i, Time, Time)) == eBUSY)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (PicopRc != eSUCCESS)
+        {
+            return PicopRc;
+        }
+    }
+
+    return Recorder.Close();
+}
+
+// Checks frame Index of the reader against what TofTestRecord wrote
+static BOOL TofTestCheckFrame(const TofRecordingReader* pReader, UINT32 Index)
+{
+    TofRecordedFrame Frame;
+    std::vector<UINT32> Expected;
+
+
+    TofTestFrame(Index, &Expected);
+
+    return (pReader->GetFrame(Index, &Frame) == eSUCCESS) &&
+           (Frame.FrameWords == TOF_TEST_WORDS) &&
+           (Frame.SequenceNumber == 100 + Index) &&
+           (Frame.TimestampUs == Index * 1000ull) &&
+           (memcmp(Frame.pData, &Expected[0], TOF_TEST_WORDS * sizeof(UINT32)) == 0);
+}
+
+static BOOL TofTestCopyPrefix(const char* pFrom, const char* pTo, double Fraction)
+{
+    std::vector<UINT8> Contents;
+    UINT8 Buffer[65536];
+    FILE* pFile;
+    size_t Read;
+    size_t Keep;
+
+
+    if ((pFile = fopen(pFrom, "rb")) == NULL)
+    {
+        return FALSE;
+    }
+
+    while ((Read = fread(Buffer, 1, sizeof(Buffer), pFile)) != 0)
+    {
+        Contents.insert(Contents.end(), Buffer, Buffer + Read);
+    }
+
+    fclose(pFile);
+    Keep = (size_t)(Contents.size() * Fraction);
+
+    if ((pFile = fopen(pTo, "wb")) == NULL)
+    {
+        return FALSE;
+    }
+
+    Read = fwrite(&Contents[0], 1, Keep, pFile);
+    fclose(pFile);
+
+    return (Read == Keep);
+}
+
+// ****************************************************************************
+
+TOF_TEST(RecordingRoundTrip)
+{
+    const char* pFileName = "TofRecordingTest.tofrec";
+    TofRecordingReader Reader;
+    TofRecordedFrame Frame;
+    UINT32 Bad = 0;
+
+
+    TOF_REQUIRE(TofTestRecord(pFileName, FALSE) == eSUCCESS);
+    TOF_REQUIRE(Reader.Open(pFileName) == eSUCCESS);
+
+    TOF_CHECK(Reader.WasComplete());
+    TOF_CHECK( ! Reader.IsCompressed());
+    TOF_CHECK_EQ((UINT32)TOF_TEST_FRAMES, Reader.GetFrameCount());
+    TOF_CHECK_EQ((UINT32)(TOF_TEST_WORDS * sizeof(UINT32)), Reader.GetFrameBytes());
+    TOF_CHECK_EQ(eTOF_DATA_LEFT_SENSOR_ONLY, Reader.GetDataFormat());
+    TOF_CHECK_EQ((UINT32)TOF_TEST_PULSES, (UINT32)Reader.GetPulsingConfig()->nrPulsesPerLine);
+    TOF_CHECK_EQ(2u, (UINT32)Reader.GetPulsingConfig()->nrFramePhases);
+
+    for (UINT32 i = 0; i < TOF_TEST_FRAMES; i++)
+    {
+        Bad += TofTestCheckFrame(&Reader, i) ? 0 : 1;
+    }
+
+    TOF_CHECK_EQ(0u, Bad);
+
+    // Random seeks, by index and by time
+    TOF_CHECK(TofTestCheckFrame(&Reader, 37));
+    TOF_CHECK(TofTestCheckFrame(&Reader, 2));
+    TOF_CHECK_EQ(17u, Reader.FindFrame(17500));
+    TOF_CHECK_EQ(0u, Reader.FindFrame(0));
+    TOF_CHECK_EQ((UINT32)(TOF_TEST_FRAMES - 1), Reader.FindFrame(1000000));
+    TOF_CHECK_EQ(eINVALID_ARG, Reader.GetFrame(TOF_TEST_FRAMES, &Frame));
+
+    Reader.Close();
+    remove(pFileName);
+}
+
+// ****************************************************************************
+//  A recording cut off mid-chunk has no index; the reader recovers every
+//  frame that reached the disk whole
+// ****************************************************************************
+
+TOF_TEST(RecordingRecoversTruncatedFile)
+{
+    const char* pFileName = "TofRecordingTest.tofrec";
+    const char* pCutName = "TofRecordingTestCut.tofrec";
+    TofRecordingReader Reader;
+    UINT32 Bad = 0;
+
+
+    TOF_REQUIRE(TofTestRecord(pFileName, FALSE) == eSUCCESS);
+    TOF_REQUIRE(TofTestCopyPrefix(pFileName, pCutName, 0.55));
+    TOF_REQUIRE(Reader.Open(pCutName) == eSUCCESS);
+
+    TOF_CHECK( ! Reader.WasComplete());
+    TOF_CHECK(Reader.GetFrameCount() >= TOF_RECORDING_CHUNK_FRAMES);
+    TOF_CHECK(Reader.GetFrameCount() < TOF_TEST_FRAMES);
+
+    for (UINT32 i = 0; i < Reader.GetFrameCount(); i++)
+    {
+        Bad += TofTestCheckFrame(&Reader, i) ? 0 : 1;
+    }
+
+    TOF_CHECK_EQ(0u, Bad);
+
+    Reader.Close();
+    remove(pFileName);
+    remove(pCutName);
+}
+
+// ****************************************************************************
+
+typedef struct
+{
+    std::atomic<UINT32> Frames;
+    std::atomic<UINT32> OutOfOrder;
+    UINT32 Next;
+} TofTestPlayback;
+
+static void TofTestOnPlayed(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofTestPlayback* pPlayback = (TofTestPlayback*)pContext;
+
+
+    pPlayback->OutOfOrder += ((pFrame->Result != eSUCCESS) || (pFrame->SequenceNumber != pPlayback->Next)) ? 1 : 0;
+    pPlayback->Next = pFrame->SequenceNumber + 1;
+    pPlayback->Frames++;
+}
+
+TOF_TEST(RecordingPlaysBackInOrder)
+{
+    const char* pFileName = "TofRecordingTest.tofrec";
+    TofRecordingReader Reader;
+    TofPlayer Player;
+    TofTestPlayback Playback;
+
+
+    Playback.Frames = 0;
+    Playback.OutOfOrder = 0;
+    Playback.Next = 100 + 10;
+
+    TOF_REQUIRE(TofTestRecord(pFileName, FALSE) == eSUCCESS);
+    TOF_REQUIRE(Reader.Open(pFileName) == eSUCCESS);
+
+    // As fast as the consumer takes them, from frame 10
+    TOF_REQUIRE(Player.Start(&Reader, 0.0f, 10, TofTestOnPlayed, &Playback) == eSUCCESS);
+
+    for (UINT32 Wait = 0; (Wait < 200) && Player.IsRunning(); Wait++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    Player.Stop();
+
+    TOF_CHECK_EQ((UINT32)(TOF_TEST_FRAMES - 10), Playback.Frames.load());
+    TOF_CHECK_EQ(0u, Playback.OutOfOrder.load());
+
+    Reader.Close();
+    remove(pFileName);
+}
+
+// ****************************************************************************
@@ -0,0 +1,143 @@
+// ****************************************************************************
+//  TofRendererTest.cpp
+//
+// Tests of the headless renderer backend
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "TofColorize.h"
+#include "TofMemory.h"
+#include "TofRenderer.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+static BOOL TofTestReadFile(const char* pFileName, std::vector<UINT8>* pContents)
+{
+    FILE* pFile = fopen(pFileName, "rb");
+    UINT8 Buffer[4096];
+    size_t Read;
+
+
+    pContents->clear();
+
+    if (pFile == NULL)
+    {
+        return FALSE;
+    }
+
+    while ((Read = fread(Buffer, 1, sizeof(Buffer), pFile)) != 0)
+    {
+        pContents->insert(pContents->end(), Buffer, Buffer + Read);
+    }
+
+    fclose(pFile);
+
+    return TRUE;
+}
+
+// ****************************************************************************
+
+TOF_TEST(RendererSurfaceIsPaddedDib)
+{
+    TofMemoryRenderer Renderer;
+    const TofSurface* pSurface = Renderer.GetSurface();
+
+
+    TOF_CHECK_EQ(eINVALID_ARG, Renderer.Create(0, 10));
+    TOF_REQUIRE(Renderer.Create(5, 3) == eSUCCESS);
+    TOF_CHECK(pSurface->pPixels != NULL);
+    TOF_CHECK_EQ(16u, pSurface->Stride);
+    TOF_CHECK_EQ(0u, ((size_t)pSurface->pPixels) % TOF_CACHE_LINE_SIZE);
+
+    Renderer.Destroy();
+    TOF_CHECK(pSurface->pPixels == NULL);
+}
+
+TOF_TEST(RendererAllocatesOnlyInCreate)
+{
+    std::vector<UINT32> Plane(120 * 720);
+    TofMemoryRenderer Renderer;
+    TofColorizer Colorizer;
+    TofRendererStats Stats;
+    const TofSurface* pSurface = Renderer.GetSurface();
+    const UINT8* pPixels;
+
+
+    for (size_t i = 0; i < Plane.size(); i++)
+    {
+        Plane[i] = (UINT32)i;
+    }
+
+    TOF_REQUIRE(Renderer.Create(520, 200) == eSUCCESS);
+    TOF_REQUIRE(Colorizer.Create(120, 720, pSurface->Width, pSurface->Height, pSurface->Stride,
+                                 80, 120, 180) == eSUCCESS);
+    pPixels = pSurface->pPixels;
+
+    for (UINT32 Frame = 0; Frame < 100; Frame++)
+    {
+        Colorizer.Colorize(&Plane[0], pSurface->pPixels);
+        Renderer.Present();
+    }
+
+    Renderer.GetStats(&Stats);
+    TOF_CHECK_EQ(1u, Stats.Allocations);
+    TOF_CHECK_EQ(100u, Stats.FramesPresented);
+    TOF_CHECK(pSurface->pPixels == pPixels);
+}
+
+// ****************************************************************************
+//  The PPM is top row first and red first, the surface is bottom-up BGR
+// ****************************************************************************
+
+TOF_TEST(RendererWritesPpmTopDown)
+{
+    const char* pFileName = "TofRendererTest.ppm";
+    const char Header[] = "P6\n3 2\n255\n";
+    TofMemoryRenderer Renderer;
+    const TofSurface* pSurface = Renderer.GetSurface();
+    std::vector<UINT8> Contents;
+    const UINT8* pImage;
+    UINT8* pPixel;
+
+
+    TOF_CHECK_EQ(eUNINITIALIZED, Renderer.WritePpm(pFileName));
+    TOF_REQUIRE(Renderer.Create(3, 2) == eSUCCESS);
+
+    // Bottom left blue, top right red
+    pPixel = pSurface->pPixels;
+    pPixel[0] = 0xff;
+    pPixel = pSurface->pPixels + pSurface->Stride + 2 * 3;
+    pPixel[2] = 0xff;
+
+    TOF_REQUIRE(Renderer.WritePpm(pFileName) == eSUCCESS);
+    TOF_REQUIRE(TofTestReadFile(pFileName, &Contents));
+    remove(pFileName);
+
+    TOF_REQUIRE(Contents.size() == (sizeof(Header) - 1) + 3 * 2 * 3);
+    TOF_CHECK(memcmp(&Contents[0], Header, sizeof(Header) - 1) == 0);
+
+    pImage = &Contents[sizeof(Header) - 1];
+
+    // Top row: red in the last pixel
+    TOF_CHECK_EQ(0xffu, (UINT32)pImage[2 * 3 + 0]);
+    TOF_CHECK_EQ(0u, (UINT32)pImage[2 * 3 + 2]);
+
+    // Bottom row: blue in the first pixel
+    TOF_CHECK_EQ(0u, (UINT32)pImage[3 * 3 + 0]);
+    TOF_CHECK_EQ(0xffu, (UINT32)pImage[3 * 3 + 2]);
+
+    TOF_CHECK_EQ(eFAILURE, Renderer.WritePpm("no/such/directory/TofRendererTest.ppm"));
+}
+
+// ****************************************************************************
@@ -0,0 +1,359 @@
+// ****************************************************************************
+//  TofSpatialFilterTest.cpp
+//
+// Tests of the spatial denoising filters
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "TofSpatialFilter.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+typedef struct
+{
+    UINT32 Width;
+    UINT32 Height;
+} TofTestSize;
+
+// Widths on and off the SIMD width, down to frames smaller than the window
+static const TofTestSize sSizes[] =
+{
+    { 120, 720 },
+    { 240, 360 },
+    { 37, 11 },
+    { 5, 3 },
+    { 1, 7 },
+    { 7, 1 },
+    { 2, 2 },
+};
+
+// A plane with smooth areas, steps, flying pixels, weak returns and dropouts
+static void TofTestPlanes(UINT32 Width, UINT32 Height, UINT32 Seed, std::vector<UINT32>* pTime,
+                          std::vector<UINT32>* pAmplitude)
+{
+    std::mt19937 Random(Seed);
+    std::normal_distribution<FP32> Noise(0.0f, 10.0f);
+    UINT32 i;
+
+
+    pTime->resize((size_t)Width * Height);
+    pAmplitude->resize((size_t)Width * Height);
+
+    for (UINT32 y = 0; y < Height; y++)
+    {
+        for (UINT32 x = 0; x < Width; x++)
+        {
+            i = (y * Width) + x;
+            (*pTime)[i] = (UINT32)((FP32)(((x < Width / 2) ? 3000 : 5000) + (y * 3)) + Noise(Random));
+            (*pAmplitude)[i] = 4 + (Random() % 1500);
+
+            if ((Random() % 40) == 0)
+            {
+                (*pTime)[i] = 9000 + (Random() % 4000);
+            }
+
+            if ((Random() % 60) == 0)
+            {
+                (*pTime)[i] = 0;
+                (*pAmplitude)[i] = 0;
+            }
+        }
+    }
+}
+
+static UINT32 TofTestClamp(INT32 Index, UINT32 Size)
+{
+    return (Index < 0) ? 0 : (((UINT32)Index >= Size) ? (Size - 1) : (UINT32)Index);
+}
+
+// ****************************************************************************
+//  Plain per pixel versions of the documented behaviour
+// ****************************************************************************
+
+static void TofTestReferenceMedian(UINT32 Width, UINT32 Height, INT32 Radius, const std::vector<UINT32>& Input,
+                                   std::vector<UINT32>* pOutput)
+{
+    std::vector<UINT32> Window;
+
+
+    pOutput->resize(Input.size());
+
+    for (INT32 y = 0; y < (INT32)Height; y++)
+    {
+        for (INT32 x = 0; x < (INT32)Width; x++)
+        {
+            Window.clear();
+
+            for (INT32 dy = -Radius; dy <= Radius; dy++)
+            {
+                for (INT32 dx = -Radius; dx <= Radius; dx++)
+                {
+                    Window.push_back(Input[(TofTestClamp(y + dy, Height) * Width) + TofTestClamp(x + dx, Width)]);
+                }
+            }
+
+            std::nth_element(Window.begin(), Window.begin() + (Window.size() / 2), Window.end());
+            (*pOutput)[(y * Width) + x] = Window[Window.size() / 2];
+        }
+    }
+}
+
+static void TofTestReferenceBilateral(UINT32 Width, UINT32 Height, const TofSpatialParams* pParams,
+                                      const std::vector<UINT32>& Time, const std::vector<UINT32>& Amplitude,
+                                      std::vector<UINT32>* pOutput)
+{
+    const INT32 Radius = (INT32)pParams->Radius;
+    const FP32 InvFull = 1.0f / (FP32)pParams->FullAmplitude;
+    const FP32 InvRange2 = 1.0f / (pParams->RangeSigma * pParams->RangeSigma);
+    UINT32 Neighbour;
+    FP32 Center;
+    FP32 Sum;
+    FP32 WeightSum;
+    FP32 Confidence;
+    FP32 Difference;
+    FP32 Weight;
+
+
+    pOutput->resize(Time.size());
+
+    for (INT32 y = 0; y < (INT32)Height; y++)
+    {
+        for (INT32 x = 0; x < (INT32)Width; x++)
+        {
+            Center = (FP32)Time[(y * Width) + x];
+            Sum = 0.0f;
+            WeightSum = 0.0f;
+
+            for (INT32 dy = -Radius; dy <= Radius; dy++)
+            {
+                for (INT32 dx = -Radius; dx <= Radius; dx++)
+                {
+                    Neighbour = (TofTestClamp(y + dy, Height) * Width) + TofTestClamp(x + dx, Width);
+                    Confidence = ((FP32)Amplitude[Neighbour] >= (FP32)pParams->MinAmplitude) ?
+                                 std::min((FP32)Amplitude[Neighbour] * InvFull, 1.0f) : 0.0f;
+                    Difference = (FP32)Time[Neighbour] - Center;
+                    Weight = expf(-(FP32)((dx * dx) + (dy * dy)) / (2.0f * pParams->SpatialSigma * pParams->SpatialSigma));
+                    Weight = (Weight * Confidence) / (1.0f + ((Difference * Difference) * InvRange2));
+                    Sum += Weight * (FP32)Time[Neighbour];
+                    WeightSum += Weight;
+                }
+            }
+
+            (*pOutput)[(y * Width) + x] = (WeightSum > 0.0f) ? (UINT32)lrintf(Sum / WeightSum) : Time[(y * Width) + x];
+        }
+    }
+}
+
+// Pixels differing from the reference by more than Tolerance; the first is reported
+static UINT32 TofTestMismatches(const std::vector<UINT32>& Expected, const std::vector<UINT32>& Actual,
+                                UINT32 Tolerance, UINT32 Width, UINT32 Height)
+{
+    UINT32 Count = 0;
+
+
+    for (size_t i = 0; i < Expected.size(); i++)
+    {
+        if ((UINT32)abs((INT32)Expected[i] - (INT32)Actual[i]) > Tolerance)
+        {
+            if (Count == 0)
+            {
+                printf("    %u x %u pixel %u: expected %u, got %u\n", Width, Height, (UINT32)i, Expected[i], Actual[i]);
+            }
+
+            Count++;
+        }
+    }
+
+    return Count;
+}
+
+// ****************************************************************************
+
+TOF_TEST(SpatialFilterRejectsBadParams)
+{
+    TofSpatialParams Params;
+    TofSpatialFilter Filter;
+    std::vector<UINT32> Plane(16, 0);
+
+
+    TofDefaultSpatialParams(&Params);
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(0, 720, &Params, 1));
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(120, 0, &Params, 1));
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(120, 720, NULL, 1));
+
+    Params.Filter = eTOF_SPATIAL_BILATERAL;
+    Params.Radius = 0;
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(120, 720, &Params, 1));
+    Params.Radius = TOF_SPATIAL_MAX_RADIUS + 1;
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(120, 720, &Params, 1));
+    Params.Radius = 1;
+    Params.RangeSigma = 0.0f;
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(120, 720, &Params, 1));
+
+    // Not created
+    TOF_CHECK(Filter.Filter(&Plane[0], &Plane[0]) != eSUCCESS);
+}
+
+TOF_TEST(SpatialMediansMatchBruteForceAtEveryGeometry)
+{
+    static const TofSpatialFilterE sFilters[] = { eTOF_SPATIAL_MEDIAN_3X3, eTOF_SPATIAL_MEDIAN_5X5 };
+    static const UINT32 sThreads[] = { 1, 3 };
+    TofSpatialParams Params;
+    TofSpatialFilter Filter;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Expected;
+    std::vector<UINT32> Actual;
+
+
+    TofDefaultSpatialParams(&Params);
+
+    for (UINT32 s = 0; s < sizeof(sSizes) / sizeof(sSizes[0]); s++)
+    {
+        TofTestPlanes(sSizes[s].Width, sSizes[s].Height, s + 1, &Time, &Amplitude);
+
+        for (UINT32 f = 0; f < sizeof(sFilters) / sizeof(sFilters[0]); f++)
+        {
+            TofTestReferenceMedian(sSizes[s].Width, sSizes[s].Height, (INT32)f + 1, Time, &Expected);
+            Params.Filter = sFilters[f];
+
+            for (UINT32 t = 0; t < sizeof(sThreads) / sizeof(sThreads[0]); t++)
+            {
+                TOF_REQUIRE(Filter.Create(sSizes[s].Width, sSizes[s].Height, &Params, sThreads[t]) == eSUCCESS);
+                Actual = Time;
+                TOF_REQUIRE(Filter.Filter(&Actual[0], &Amplitude[0]) == eSUCCESS);
+                TOF_CHECK_EQ(0u, TofTestMismatches(Expected, Actual, 0, sSizes[s].Width, sSizes[s].Height));
+            }
+        }
+    }
+}
+
+TOF_TEST(SpatialBilateralMatchesFormulaAtEveryGeometry)
+{
+    static const UINT32 sThreads[] = { 1, 3 };
+    TofSpatialParams Params;
+    TofSpatialFilter Filter;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Expected;
+    std::vector<UINT32> Actual;
+
+
+    TofDefaultSpatialParams(&Params);
+    Params.Filter = eTOF_SPATIAL_BILATERAL;
+
+    for (UINT32 Radius = 1; Radius <= TOF_SPATIAL_MAX_RADIUS; Radius++)
+    {
+        Params.Radius = Radius;
+
+        for (UINT32 s = 0; s < sizeof(sSizes) / sizeof(sSizes[0]); s++)
+        {
+            TofTestPlanes(sSizes[s].Width, sSizes[s].Height, s + 11, &Time, &Amplitude);
+            TofTestReferenceBilateral(sSizes[s].Width, sSizes[s].Height, &Params, Time, Amplitude, &Expected);
+
+            for (UINT32 t = 0; t < sizeof(sThreads) / sizeof(sThreads[0]); t++)
+            {
+                TOF_REQUIRE(Filter.Create(sSizes[s].Width, sSizes[s].Height, &Params, sThreads[t]) == eSUCCESS);
+                Actual = Time;
+                TOF_REQUIRE(Filter.Filter(&Actual[0], &Amplitude[0]) == eSUCCESS);
+                TOF_CHECK_EQ(0u, TofTestMismatches(Expected, Actual, 0, sSizes[s].Width, sSizes[s].Height));
+            }
+        }
+    }
+}
+
+// ****************************************************************************
+
+TOF_TEST(SpatialMedianRemovesFlyingPixelsAndKeepsEdges)
+{
+    TofSpatialParams Params;
+    TofSpatialFilter Filter;
+    std::vector<UINT32> Time(64 * 16);
+    std::vector<UINT32> Amplitude(64 * 16, 1000);
+
+
+    for (UINT32 i = 0; i < Time.size(); i++)
+    {
+        Time[i] = ((i % 64) < 32) ? 3000 : 5000;
+    }
+
+    Time[(8 * 64) + 10] = 12000;
+    Time[(3 * 64) + 40] = 1;
+
+    TofDefaultSpatialParams(&Params);
+    TOF_REQUIRE(Filter.Create(64, 16, &Params, 2) == eSUCCESS);
+    TOF_REQUIRE(Filter.Filter(&Time[0], &Amplitude[0]) == eSUCCESS);
+
+    TOF_CHECK_EQ(3000u, Time[(8 * 64) + 10]);
+    TOF_CHECK_EQ(5000u, Time[(3 * 64) + 40]);
+    TOF_CHECK_EQ(3000u, Time[(5 * 64) + 31]);
+    TOF_CHECK_EQ(5000u, Time[(5 * 64) + 32]);
+}
+
+TOF_TEST(SpatialBilateralSmoothsFlatAreasAndKeepsSteps)
+{
+    std::mt19937 Random(7);
+    std::normal_distribution<FP32> Noise(0.0f, 8.0f);
+    TofSpatialParams Params;
+    TofSpatialFilter Filter;
+    std::vector<UINT32> Time(64 * 32);
+    std::vector<UINT32> Amplitude(64 * 32, 1024);
+    std::vector<UINT32> Truth(64 * 32);
+    double RawError = 0.0;
+    double FilteredError = 0.0;
+    UINT32 WeakPixel = (10 * 64) + 5;
+
+
+    for (UINT32 i = 0; i < Time.size(); i++)
+    {
+        Truth[i] = ((i % 64) < 32) ? 3000 : 5000;
+        Time[i] = (UINT32)((FP32)Truth[i] + Noise(Random));
+        RawError += ((double)Time[i] - Truth[i]) * ((double)Time[i] - Truth[i]);
+    }
+
+    // Neighbours of a lone pixel too weak to use, so it is kept
+    for (INT32 dy = -2; dy <= 2; dy++)
+    {
+        for (INT32 dx = -2; dx <= 2; dx++)
+        {
+            Amplitude[WeakPixel + (dy * 64) + dx] = 0;
+        }
+    }
+
+    Time[WeakPixel] = 4321;
+
+    TofDefaultSpatialParams(&Params);
+    Params.Filter = eTOF_SPATIAL_BILATERAL;
+    TOF_REQUIRE(Filter.Create(64, 32, &Params, 2) == eSUCCESS);
+    TOF_REQUIRE(Filter.Filter(&Time[0], &Amplitude[0]) == eSUCCESS);
+
+    TOF_CHECK_EQ(4321u, Time[WeakPixel]);
+
+    for (UINT32 i = 0; i < Time.size(); i++)
+    {
+        if (i != WeakPixel)
+        {
+            // The 2000 count step is far outside RangeSigma, so it does not blur
+            TOF_CHECK((Time[i] < 4000) == (Truth[i] < 4000));
+            FilteredError += ((double)Time[i] - Truth[i]) * ((double)Time[i] - Truth[i]);
+        }
+    }
+
+    TOF_CHECK(FilteredError * 4.0 < RawError);
+}
+
+// ****************************************************************************
@@ -0,0 +1,266 @@
+// ****************************************************************************
+//  TofTemporalFilterTest.cpp
+//
+// Tests of the temporal denoising filter
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "TofTemporalFilter.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_PIXELS     1001        // Not a multiple of the SIMD width
+
+// A fixed scene with noise, weak returns and dropouts; frame Number
+static void TofTestNoisyFrame(UINT32 Number, std::vector<UINT32>* pTime, std::vector<UINT32>* pAmplitude,
+                              std::vector<UINT32>* pTruth)
+{
+    std::mt19937 Random(Number + 1);
+    std::normal_distribution<FP32> Noise(0.0f, 12.0f);
+
+
+    pTime->resize(TOF_TEST_PIXELS);
+    pAmplitude->resize(TOF_TEST_PIXELS);
+    pTruth->resize(TOF_TEST_PIXELS);
+
+    for (UINT32 i = 0; i < TOF_TEST_PIXELS; i++)
+    {
+        (*pTruth)[i] = 2000 + (i * 7);
+        (*pAmplitude)[i] = 8 + ((i * 37) % 2000);
+        (*pTime)[i] = (UINT32)((FP32)(*pTruth)[i] + Noise(Random));
+
+        if (((i + Number) % 53) == 0)
+        {
+            (*pTime)[i] = 0;
+            (*pAmplitude)[i] = 0;
+        }
+    }
+}
+
+// ****************************************************************************
+//  Plain per pixel versions of the documented behaviour
+// ****************************************************************************
+
+static void TofTestReferenceEma(const TofTemporalParams* pParams, std::vector<FP32>* pAverage, UINT32* pTime,
+                                const UINT32* pAmplitude)
+{
+    const FP32 AlphaPerCount = pParams->Alpha / (FP32)pParams->FullAmplitude;
+    FP32 Weight;
+    FP32 Difference;
+
+
+    for (UINT32 i = 0; i < TOF_TEST_PIXELS; i++)
+    {
+        if (pAmplitude[i] >= pParams->MinAmplitude)
+        {
+            Difference = (FP32)pTime[i] - (*pAverage)[i];
+            Weight = std::min((FP32)pAmplitude[i] * AlphaPerCount, pParams->Alpha);
+
+            if (((*pAverage)[i] < 0.0f) || (fabsf(Difference) > (FP32)pParams->MotionThreshold))
+            {
+                (*pAverage)[i] = (FP32)pTime[i];
+            }
+            else
+            {
+                (*pAverage)[i] += Weight * Difference;
+            }
+        }
+
+        if ((*pAverage)[i] >= 0.0f)
+        {
+            pTime[i] = (UINT32)lrintf((*pAverage)[i]);
+        }
+    }
+}
+
+static void TofTestReferenceMedian(const TofTemporalParams* pParams, std::vector<std::vector<UINT32> >* pHistory,
+                                   UINT32* pTime, const UINT32* pAmplitude)
+{
+    std::vector<UINT32> Sorted;
+
+
+    for (UINT32 i = 0; i < TOF_TEST_PIXELS; i++)
+    {
+        std::vector<UINT32>& History = (*pHistory)[i];
+
+        if (History.empty())
+        {
+            History.assign(pParams->MedianLength, pTime[i]);
+        }
+        else
+        {
+            History.push_back((pAmplitude[i] < pParams->MinAmplitude) ? History.back() : pTime[i]);
+            History.erase(History.begin());
+        }
+
+        Sorted = History;
+        std::sort(Sorted.begin(), Sorted.end());
+        pTime[i] = Sorted[pParams->MedianLength / 2];
+    }
+}
+
+// ****************************************************************************
+
+TOF_TEST(TemporalFilterRejectsBadParams)
+{
+    TofTemporalFilter Filter;
+    TofTemporalParams Params;
+    UINT32 Word = 0;
+
+
+    TofDefaultTemporalParams(&Params);
+    TOF_CHECK_EQ(eUNINITIALIZED, Filter.Filter(&Word, &Word, 1));
+
+    Params.Alpha = 0.0f;
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(8, 8, &Params));
+    Params.Alpha = 0.5f;
+    Params.Mode = eTOF_TEMPORAL_MEDIAN;
+    Params.MedianLength = 4;
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(8, 8, &Params));
+    Params.MedianLength = 9;
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Create(8, 8, &Params));
+    Params.MedianLength = 3;
+    TOF_CHECK_EQ(eSUCCESS, Filter.Create(8, 8, &Params));
+    TOF_CHECK_EQ(eINVALID_ARG, Filter.Filter(&Word, &Word, 65));
+}
+
+TOF_TEST(TemporalEmaMatchesReference)
+{
+    TofTemporalFilter Filter;
+    TofTemporalParams Params;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Truth;
+    std::vector<UINT32> Expected;
+    std::vector<FP32> Average(TOF_TEST_PIXELS, -1.0f);
+    UINT32 Mismatches = 0;
+
+
+    TofDefaultTemporalParams(&Params);
+    TOF_REQUIRE(Filter.Create(TOF_TEST_PIXELS, 1, &Params) == eSUCCESS);
+
+    for (UINT32 Frame = 0; Frame < 20; Frame++)
+    {
+        TofTestNoisyFrame(Frame, &Time, &Amplitude, &Truth);
+
+        // Jump part of the scene past the motion threshold half way
+        for (UINT32 i = 0; (Frame >= 10) && (i < 100); i++)
+        {
+            Time[i] += (Time[i] != 0) ? 1000 : 0;
+        }
+
+        Expected = Time;
+        TofTestReferenceEma(&Params, &Average, &Expected[0], &Amplitude[0]);
+        TOF_REQUIRE(Filter.Filter(&Time[0], &Amplitude[0], TOF_TEST_PIXELS) == eSUCCESS);
+        Mismatches += (Time != Expected) ? 1 : 0;
+    }
+
+    TOF_CHECK_EQ(0u, Mismatches);
+}
+
+TOF_TEST(TemporalMedianMatchesReference)
+{
+    static const UINT32 sLengths[] = { 3, 5, 7 };
+    TofTemporalFilter Filter;
+    TofTemporalParams Params;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Truth;
+    std::vector<UINT32> Expected;
+    std::vector<std::vector<UINT32> > History;
+    UINT32 Mismatches;
+
+
+    for (UINT32 l = 0; l < sizeof(sLengths) / sizeof(sLengths[0]); l++)
+    {
+        TofDefaultTemporalParams(&Params);
+        Params.Mode = eTOF_TEMPORAL_MEDIAN;
+        Params.MedianLength = sLengths[l];
+        TOF_REQUIRE(Filter.Create(TOF_TEST_PIXELS, 1, &Params) == eSUCCESS);
+        History.assign(TOF_TEST_PIXELS, std::vector<UINT32>());
+        Mismatches = 0;
+
+        for (UINT32 Frame = 0; Frame < 15; Frame++)
+        {
+            TofTestNoisyFrame(Frame, &Time, &Amplitude, &Truth);
+
+            // Times with the top bit set must still sort as unsigned
+            Time[5] = 0x80000000u + Frame;
+            Time[6] = 0xfffffff0u - Frame;
+
+            Expected = Time;
+            TofTestReferenceMedian(&Params, &History, &Expected[0], &Amplitude[0]);
+            TOF_REQUIRE(Filter.Filter(&Time[0], &Amplitude[0], TOF_TEST_PIXELS) == eSUCCESS);
+            Mismatches += (Time != Expected) ? 1 : 0;
+        }
+
+        TOF_CHECK_EQ(0u, Mismatches);
+    }
+}
+
+// ****************************************************************************
+//  Both modes must bring the error down, and no dropout may reach the
+//  output of a pixel with usable returns
+// ****************************************************************************
+
+TOF_TEST(TemporalFilterReducesNoise)
+{
+    static const TofTemporalModeE sModes[] = { eTOF_TEMPORAL_EMA, eTOF_TEMPORAL_MEDIAN };
+    TofTemporalFilter Filter;
+    TofTemporalParams Params;
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Truth;
+    double RawError;
+    double FilteredError;
+    double Difference;
+    UINT32 Zeros;
+
+
+    for (UINT32 m = 0; m < 2; m++)
+    {
+        TofDefaultTemporalParams(&Params);
+        Params.Mode = sModes[m];
+        TOF_REQUIRE(Filter.Create(TOF_TEST_PIXELS, 1, &Params) == eSUCCESS);
+        RawError = 0.0;
+        FilteredError = 0.0;
+        Zeros = 0;
+
+        for (UINT32 Frame = 0; Frame < 40; Frame++)
+        {
+            TofTestNoisyFrame(Frame, &Time, &Amplitude, &Truth);
+
+            for (UINT32 i = 0; (Frame >= 20) && (i < TOF_TEST_PIXELS); i++)
+            {
+                Difference = (Time[i] != 0) ? (double)Time[i] - Truth[i] : 0.0;
+                RawError += Difference * Difference;
+            }
+
+            Filter.Filter(&Time[0], &Amplitude[0], TOF_TEST_PIXELS);
+
+            for (UINT32 i = 0; (Frame >= 20) && (i < TOF_TEST_PIXELS); i++)
+            {
+                Zeros += ((Time[i] == 0) && (8 + ((i * 37) % 2000) >= Params.MinAmplitude)) ? 1 : 0;
+                Difference = (Time[i] != 0) ? (double)Time[i] - Truth[i] : 0.0;
+                FilteredError += Difference * Difference;
+            }
+        }
+
+        TOF_CHECK_EQ(0u, Zeros);
+        TOF_CHECK(FilteredError < RawError * 0.5);
+    }
+}
+
+// ****************************************************************************
@@ -0,0 +1,102 @@
+// ****************************************************************************
+//  TofTest.cpp
+//
+// Test registry and main() for the TofCore and TofSim tests
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "TofTest.h"
+
+// ****************************************************************************
+
+typedef struct
+{
+    const char* pName;
+    TofTestFunction pfnTest;
+} TofTestCase;
+
+// Built on first use, the registrations run during static initialisation
+static std::vector<TofTestCase>& TofTestCases()
+{
+    static std::vector<TofTestCase> sCases;
+
+    return sCases;
+}
+
+static unsigned sFailures = 0;
+
+// ****************************************************************************
+
+TofTestRegistrar::TofTestRegistrar(const char* pName, TofTestFunction pfnTest)
+{
+    TofTestCase Case;
+
+
+    Case.pName = pName;
+    Case.pfnTest = pfnTest;
+    TofTestCases().push_back(Case);
+}
+
+void TofTestFail(const char* pFile, int Line, const char* pExpression)
+{
+    printf("%s:%d: check failed: %s\n", pFile, Line, pExpression);
+    sFailures++;
+}
+
+void TofTestFailValues(const char* pFile, int Line, const char* pExpression, double Expected, double Actual)
+{
+    printf("%s:%d: check failed: %s (expected %.9g, got %.9g)\n", pFile, Line, pExpression, Expected, Actual);
+    sFailures++;
+}
+
+// ****************************************************************************
+
+int main(int argc, char** argv)
+{
+    const char* pFilter = (argc > 1) ? argv[1] : NULL;
+    unsigned Run = 0;
+    unsigned Failed = 0;
+    unsigned Before;
+
+
+    for (size_t i = 0; i < TofTestCases().size(); i++)
+    {
+        const TofTestCase& Case = TofTestCases()[i];
+
+        if ((pFilter != NULL) && (strstr(Case.pName, pFilter) == NULL))
+        {
+            continue;
+        }
+
+        printf("[ RUN      ] %s\n", Case.pName);
+        fflush(stdout);
+
+        Before = sFailures;
+        Case.pfnTest();
+        Run++;
+
+        if (sFailures != Before)
+        {
+            Failed++;
+        }
+
+        printf("%s %s\n", (sFailures != Before) ? "[  FAILED  ]" : "[       OK ]", Case.pName);
+        fflush(stdout);
+    }
+
+    printf("%u tests run, %u failed\n", Run, Failed);
+
+    return ((Failed != 0) || (Run == 0)) ? 1 : 0;
+}
+
+// ****************************************************************************
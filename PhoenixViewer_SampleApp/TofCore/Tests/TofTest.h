@@ -0,0 +1,56 @@
+// ****************************************************************************
+//  TofTest.h
+//
+// Minimal unit test support for the TofCore and TofSim tests
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <math.h>
+
+// ****************************************************************************
+// Each test file defines its tests with TOF_TEST and links TofTest.cpp, which
+// provides main(). A test runs to the end unless a TOF_REQUIRE fails; every
+// failed check is reported with its file and line. Passing a name on the
+// command line runs only the tests whose names contain it.
+// ****************************************************************************
+
+typedef void (*TofTestFunction)();
+
+class TofTestRegistrar
+{
+public:
+    TofTestRegistrar(const char* pName, TofTestFunction pfnTest);
+};
+
+void TofTestFail(const char* pFile, int Line, const char* pExpression);
+void TofTestFailValues(const char* pFile, int Line, const char* pExpression, double Expected, double Actual);
+
+#define TOF_TEST(Name) \
+    static void Name(); \
+    static TofTestRegistrar Name##Registrar(#Name, Name); \
+    static void Name()
+
+#define TOF_CHECK(Expression) \
+    do { if ( ! (Expression)) { TofTestFail(__FILE__, __LINE__, #Expression); } } while (0)
+
+#define TOF_REQUIRE(Expression) \
+    do { if ( ! (Expression)) { TofTestFail(__FILE__, __LINE__, #Expression); return; } } while (0)
+
+#define TOF_CHECK_EQ(Expected, Actual) \
+    do { if ( ! ((Expected) == (Actual))) { TofTestFailValues(__FILE__, __LINE__, #Expected " == " #Actual, \
+         (double)(Expected), (double)(Actual)); } } while (0)
+
+#define TOF_CHECK_NEAR(Expected, Actual, Tolerance) \
+    do { if ( ! (fabs((double)(Expected) - (double)(Actual)) <= (double)(Tolerance))) { \
+         TofTestFailValues(__FILE__, __LINE__, #Expected " ~= " #Actual, (double)(Expected), (double)(Actual)); } } while (0)
+
+// ****************************************************************************
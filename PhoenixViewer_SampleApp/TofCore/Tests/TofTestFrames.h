@@ -0,0 +1,86 @@
+// ****************************************************************************
+//  TofTestFrames.h
+//
+// Synthetic frames and the simulated device for the TofCore tests and
+// benchmarks
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <string.h>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+#include "TofSimScene.h"
+
+// ****************************************************************************
+//  Geometry of the frames a device sends for the given pulsing, as
+//  TofQueryFrameGeometry would report it. Phases of 1 mean no phasing.
+// ****************************************************************************
+
+inline PICOP_RC TofTestGeometry(PicoP_ToFDataFormatE Format, UINT32 NumPulses, UINT32 NumLines,
+                                UINT32 LinePhases, UINT32 FramePhases, TofFrameGeometry* pGeometry)
+{
+    PicoP_TofPulsingConfig Config;
+
+
+    memset(&Config, 0, sizeof(Config));
+    Config.pulsingMode = eTOF_PULSING_EQUAL_ANGLE;
+    Config.nrPulsesPerLine = (UINT16)NumPulses;
+    Config.nrLinePhases = (LinePhases == 1) ? 0 : LinePhases;
+    Config.nrFramePhases = (FramePhases == 1) ? 0 : FramePhases;
+
+    return TofMakeFrameGeometry(&Config, Format, NumPulses * NumLines * TofPlanesPerFrame(Format) * sizeof(UINT32),
+                                pGeometry);
+}
+
+// ****************************************************************************
+//  Frame FrameNumber of a simulated scene, as the device would send it
+// ****************************************************************************
+
+inline void TofTestRender(const TofFrameGeometry* pGeometry, TofSimSceneE Scene, UINT32 FrameNumber,
+                          std::vector<UINT32>* pFrame)
+{
+    TofSimScene Sim;
+
+
+    Sim.SetScene(Scene, 1);
+    pFrame->assign(pGeometry->FrameWords, 0);
+    Sim.Render(pGeometry, FrameNumber, FrameNumber / 30.0f, &(*pFrame)[0]);
+}
+
+// ****************************************************************************
+//  Opens the simulated device with pConfig, which applies from the connection
+//  on. Returns NULL if it cannot be opened.
+// ****************************************************************************
+
+inline PicoP_HANDLE TofTestConnect(PicoP_HANDLE* pLibrary, const TofSimConfig* pConfig)
+{
+    PicoP_HANDLE Connection = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+
+
+    TofSimSetConfig(pConfig);
+
+    PicoP_TLC_OpenLibrary(pLibrary);
+    PicoP_TLC_OpenConnectionUsb(*pLibrary, Usb, &Connection);
+
+    return Connection;
+}
+
+inline void TofTestDisconnect(PicoP_HANDLE Library, PicoP_HANDLE Connection)
+{
+    PicoP_TLC_CloseConnection(Connection);
+    PicoP_TLC_CloseLibrary(Library);
+}
+
+// ****************************************************************************
@@ -0,0 +1,178 @@
+// ****************************************************************************
+//  TofValidMaskTest.cpp
+//
+// Tests of valid pixel masking and compaction
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "TofFrame.h"
+#include "TofValidMask.h"
+#include "TofTest.h"
+
+// ****************************************************************************
+
+#define TOF_TEST_MIN_AMPLITUDE      100
+
+// Counts on and off the SIMD width and the 64 bit mask word
+static const UINT32 sCounts[] = { 1, 3, 4, 5, 63, 64, 65, 127, 1001, 120 * 720 };
+
+// Valid pixels at about Percent in 100, with returns at exactly the
+// threshold, just below it, and strong returns with no time
+static void TofTestPlanes(UINT32 Count, UINT32 Percent, UINT32 Seed, std::vector<UINT32>* pTime,
+                          std::vector<UINT32>* pAmplitude)
+{
+    std::mt19937 Random(Seed);
+
+
+    pTime->resize(Count);
+    pAmplitude->resize(Count);
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        (*pTime)[i] = 1 + (Random() % 50000);
+        (*pAmplitude)[i] = ((Random() % 100) < Percent) ? TOF_TEST_MIN_AMPLITUDE + (Random() % 3) * 500 :
+                                                          Random() % TOF_TEST_MIN_AMPLITUDE;
+
+        if ((Random() % 17) == 0)
+        {
+            (*pTime)[i] = 0;
+            (*pAmplitude)[i] = 4000;
+        }
+    }
+}
+
+static void TofTestReferenceIndices(const std::vector<UINT32>& Time, const std::vector<UINT32>& Amplitude,
+                                    std::vector<UINT32>* pIndices)
+{
+    pIndices->clear();
+
+    for (UINT32 i = 0; i < Time.size(); i++)
+    {
+        if ((Time[i] != 0) && (Amplitude[i] >= TOF_TEST_MIN_AMPLITUDE))
+        {
+            pIndices->push_back(i);
+        }
+    }
+}
+
+// ****************************************************************************
+
+TOF_TEST(ValidMaskMatchesReferenceAtEveryRatio)
+{
+    static const UINT32 sPercents[] = { 0, 10, 50, 90, 100 };
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Expected;
+    std::vector<uint64_t> Mask;
+    UINT32 Valid;
+    UINT32 Bits;
+    BOOL Set;
+
+
+    for (UINT32 c = 0; c < sizeof(sCounts) / sizeof(sCounts[0]); c++)
+    {
+        for (UINT32 p = 0; p < sizeof(sPercents) / sizeof(sPercents[0]); p++)
+        {
+            TofTestPlanes(sCounts[c], sPercents[p], (c * 10) + p, &Time, &Amplitude);
+            TofTestReferenceIndices(Time, Amplitude, &Expected);
+
+            // Filled with ones so bits past Count must be cleared
+            Mask.assign(TOF_MASK_WORDS(sCounts[c]), ~(uint64_t)0);
+            Valid = TofBuildValidMask(&Time[0], &Amplitude[0], sCounts[c], TOF_TEST_MIN_AMPLITUDE, &Mask[0]);
+            TOF_CHECK_EQ((UINT32)Expected.size(), Valid);
+
+            Bits = 0;
+
+            for (UINT32 i = 0; i < TOF_MASK_WORDS(sCounts[c]) * 64; i++)
+            {
+                Set = ((Mask[i / 64] >> (i % 64)) & 1) ? TRUE : FALSE;
+                Bits += Set ? 1 : 0;
+
+                if (Set && ((i >= sCounts[c]) || (Time[i] == 0) || (Amplitude[i] < TOF_TEST_MIN_AMPLITUDE)))
+                {
+                    TOF_CHECK_EQ(sCounts[c], i);
+                    break;
+                }
+            }
+
+            TOF_CHECK_EQ(Valid, Bits);
+        }
+    }
+}
+
+TOF_TEST(ValidIndicesMatchReferenceAtEveryRatio)
+{
+    static const UINT32 sPercents[] = { 0, 10, 50, 90, 100 };
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Expected;
+    std::vector<UINT32> Compacted;
+    std::vector<UINT32> FromMask;
+    std::vector<uint64_t> Mask;
+    UINT32 Valid;
+
+
+    for (UINT32 c = 0; c < sizeof(sCounts) / sizeof(sCounts[0]); c++)
+    {
+        for (UINT32 p = 0; p < sizeof(sPercents) / sizeof(sPercents[0]); p++)
+        {
+            TofTestPlanes(sCounts[c], sPercents[p], (c * 10) + p + 1000, &Time, &Amplitude);
+            TofTestReferenceIndices(Time, Amplitude, &Expected);
+
+            Compacted.assign(sCounts[c], 0xFFFFFFFFu);
+            Valid = TofCompactValid(&Time[0], &Amplitude[0], sCounts[c], TOF_TEST_MIN_AMPLITUDE, &Compacted[0]);
+            TOF_REQUIRE(Valid == Expected.size());
+            Compacted.resize(Valid);
+            TOF_CHECK(Compacted == Expected);
+
+            Mask.resize(TOF_MASK_WORDS(sCounts[c]));
+            TofBuildValidMask(&Time[0], &Amplitude[0], sCounts[c], TOF_TEST_MIN_AMPLITUDE, &Mask[0]);
+            FromMask.assign(sCounts[c], 0xFFFFFFFFu);
+            Valid = TofMaskToIndices(&Mask[0], sCounts[c], &FromMask[0]);
+            TOF_REQUIRE(Valid == Expected.size());
+            FromMask.resize(Valid);
+            TOF_CHECK(FromMask == Expected);
+        }
+    }
+}
+
+TOF_TEST(ValidMaskStageListsValidPixels)
+{
+    std::vector<UINT32> Time;
+    std::vector<UINT32> Amplitude;
+    std::vector<UINT32> Data;
+    std::vector<UINT32> Expected;
+    std::vector<UINT32> Valid(64 * 16);
+    TofValidMaskStage Stage(TOF_TEST_MIN_AMPLITUDE);
+    TofPipelineFrame Frame = TofPipelineFrame();
+    TofFrame Planes;
+
+
+    TofTestPlanes(64 * 16, 60, 5, &Time, &Amplitude);
+    TofTestReferenceIndices(Time, Amplitude, &Expected);
+    Data = Time;
+    Data.insert(Data.end(), Amplitude.begin(), Amplitude.end());
+
+    TOF_REQUIRE(Planes.Create(64, 16) == eSUCCESS);
+    TOF_REQUIRE(Planes.Deinterleave(&Data[0], (UINT32)Data.size(), eTOF_DATA_FUSED) == eSUCCESS);
+    Frame.pPlanes = &Planes;
+    Frame.pValid = &Valid[0];
+
+    TOF_CHECK_EQ(eSUCCESS, Stage.Process(&Frame));
+    TOF_CHECK(Frame.Masked);
+    TOF_REQUIRE(Frame.NumValid == Expected.size());
+    Valid.resize(Frame.NumValid);
+    TOF_CHECK(Valid == Expected);
+}
+
+// ****************************************************************************
@@ -0,0 +1,490 @@
+// ****************************************************************************
+//  TofAcquisition.cpp
+//
+// Event driven acquisition of 3D (ToF) frames from a TLC connection
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "TofAcquisition.h"
+
+// ****************************************************************************
+
+std::mutex TofAcquisition::sActiveLock;
+TofAcquisition* TofAcquisition::sActive = NULL;
+
+// ****************************************************************************
+
+TofAcquisition::TofAcquisition()
+    : mConnectionHandle(NULL),
+      mCallback(NULL),
+      mContext(NULL),
+      mRing(NULL),
+      mPool(NULL),
+      mMode(eTOF_ACQUIRE_ALL_FRAMES),
+      mFrameWords(0),
+      mSequenceNumber(0),
+      mDeviceFrame(0),
+      mFramesDelivered(0),
+      mFramesSkipped(0),
+      mAcquireCalls(0),
+      mPendingEvents(0),
+      mStopRequested(FALSE),
+      mRunning(FALSE)
+{
+}
+
+TofAcquisition::~TofAcquisition()
+{
+    Stop();
+}
+
+// ****************************************************************************
+//  Sizes the frame buffer, hooks the TLC event and starts the acquisition thread
+// ****************************************************************************
+
+PICOP_RC TofAcquisition::Start(PicoP_HANDLE ConnectionHandle, TofFrameCallback pfnCallback, void* pContext)
+{
+    PICOP_RC PicopRc;
+    UINT32 FrameBytes = 0;
+
+
+    if ((ConnectionHandle == NULL) || (pfnCallback == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mRunning)
+    {
+        return eALREADY_OPENED;
+    }
+
+    // The frame size depends on the pulsing configuration, so ask for it
+    // instead of assuming the default geometry
+    PicopRc = PicoP_TLC_GetTofFrameDimensions(ConnectionHandle, &FrameBytes);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if (FrameBytes < sizeof(UINT32))
+    {
+        return eFRAME_ERROR;
+    }
+
+    if ((mRing != NULL) && (mRing->GetFrameWords() < (FrameBytes / sizeof(UINT32))))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((mRing == NULL) && (mPool != NULL) && (mPool->GetFrameWords() < (FrameBytes / sizeof(UINT32))))
+    {
+        return eINVALID_ARG;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(sActiveLock);
+
+        if (sActive != NULL)
+        {
+            return eBUSY;
+        }
+
+        sActive = this;
+    }
+
+    mConnectionHandle = ConnectionHandle;
+    mCallback = pfnCallback;
+    mContext = pContext;
+    mFrameWords = FrameBytes / sizeof(UINT32);
+    mFrameBuffer.assign((size_t)mFrameWords * TOF_ACQUISITION_MAX_BATCH, 0);
+    mSequenceNumber = 0;
+    mDeviceFrame = 0;
+    mFramesDelivered.store(0);
+    mFramesSkipped.store(0);
+    mAcquireCalls.store(0);
+    mPendingEvents = 0;
+    mStopRequested = FALSE;
+
+    mThread = std::thread(&TofAcquisition::AcquisitionThread, this);
+    mRunning = TRUE;
+
+    PicopRc = PicoP_TLC_SetEventCallbackFunction(ConnectionHandle, &TofAcquisition::EventCallback, 0);
+
+    if (PicopRc != eSUCCESS)
+    {
+        Stop();
+        return PicopRc;
+    }
+
+    // Frames may already be cached from before the callback was registered
+    SignalFrames();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofAcquisition::Restart()
+{
+    if (mCallback == NULL)
+    {
+        return eUNINITIALIZED;
+    }
+
+    Stop();
+
+    return Start(mConnectionHandle, mCallback, mContext);
+}
+
+// ****************************************************************************
+//  Unhooks the TLC event and waits for the acquisition thread to finish
+// ****************************************************************************
+
+void TofAcquisition::Stop()
+{
+    if ( ! mRunning.exchange(FALSE))
+    {
+        return;
+    }
+
+    PicoP_TLC_SetEventCallbackFunction(mConnectionHandle, NULL, 0);
+
+    // Waits for a callback that picked this instance up before it was unhooked
+    {
+        std::lock_guard<std::mutex> Lock(sActiveLock);
+
+        if (sActive == this)
+        {
+            sActive = NULL;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStopRequested = TRUE;
+    }
+
+    mWake.notify_one();
+
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+// ****************************************************************************
+
+void TofAcquisition::GetStats(TofAcquisitionStats* pStats) const
+{
+    pStats->FramesDelivered = mFramesDelivered.load(std::memory_order_relaxed);
+    pStats->FramesSkipped = mFramesSkipped.load(std::memory_order_relaxed);
+    pStats->AcquireCalls = mAcquireCalls.load(std::memory_order_relaxed);
+}
+
+// ****************************************************************************
+//  Called by the TLC library on its own thread. Only wakes the acquisition
+//  thread; the frame itself is read there so the driver is never held up.
+// ****************************************************************************
+
+UINT32 TofAcquisition::EventCallback(void* pvParam, PicoP_TofEventE EventType, void* pEvent)
+{
+    std::lock_guard<std::mutex> Lock(sActiveLock);
+
+
+    (void)pvParam;
+    (void)pEvent;
+
+    if ((sActive != NULL) && (EventType == eEVENT_TOF_DATA_FRAMES_RECEIVED))
+    {
+        sActive->SignalFrames();
+    }
+
+    return 0;
+}
+
+// ****************************************************************************
+
+void TofAcquisition::SignalFrames()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+        // Keep the time of the oldest event not yet serviced
+        if (mPendingEvents == 0)
+        {
+            mEventTime = TofClock::now();
+        }
+
+        mPendingEvents++;
+    }
+
+    mWake.notify_one();
+}
+
+// ****************************************************************************
+
+void TofAcquisition::DeliverFailure(PICOP_RC Result)
+{
+    TofAcquiredFrame Frame;
+
+    Frame.Result = Result;
+    Frame.pData = NULL;
+    Frame.FrameWords = 0;
+    Frame.SequenceNumber = mSequenceNumber;
+    Frame.DeviceFrame = mDeviceFrame;
+    Frame.EventTime = TofClock::now();
+    Frame.AcquireTime = Frame.EventTime;
+    Frame.pPooled = NULL;
+
+    mCallback(mContext, &Frame);
+}
+
+// ****************************************************************************
+//  Sleeps until the driver reports frames, then reads the cached frames and
+//  hands them to the consumer. Without a ring or pool, up to
+//  TOF_ACQUISITION_MAX_BATCH frames are read per call into the scratch
+//  arena; with either, each frame is read straight into its slot or pooled
+//  frame. In eTOF_ACQUIRE_LATEST_ONLY mode the stale frames are first
+//  discarded in batches. Stops on the first API failure, which is reported
+//  to the consumer.
+// ****************************************************************************
+
+void TofAcquisition::AcquisitionThread()
+{
+    PICOP_RC PicopRc;
+    UINT32 Count = 0;
+    UINT32 RetFrame = 0;
+    UINT32 Batch;
+    UINT32 Skipped;
+    UINT32 Calls;
+    UINT32* pDestination;
+    UINT32 DestinationWords;
+    TofRingSlot* pSlot;
+    TofPooledFrame* pPooled;
+    TofFramePool* pPool = (mRing == NULL) ? mPool : NULL;
+    TofClock::time_point EventTime;
+    TofAcquiredFrame Frame;
+
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> Lock(mLock);
+
+            mWake.wait_for(Lock, std::chrono::milliseconds(TOF_ACQUISITION_WATCHDOG_MS),
+                [this] { return mStopRequested || (mPendingEvents != 0); });
+
+            if (mStopRequested)
+            {
+                break;
+            }
+
+            EventTime = (mPendingEvents != 0) ? mEventTime : TofClock::now();
+            mPendingEvents = 0;
+        }
+
+        // See how many frames are buffered
+        PicopRc = PicoP_TLC_GetTofFrameCount(mConnectionHandle, &Count);
+
+        if (PicopRc != eSUCCESS)
+        {
+            DeliverFailure(PicopRc);
+            break;
+        }
+
+        // Drain everything but the newest frame without delivering it
+        if ((mMode == eTOF_ACQUIRE_LATEST_ONLY) && (Count > 1))
+        {
+            PicopRc = TofSkipFrames(mConnectionHandle, mFrameWords, Count - 1,
+                                    &mFrameBuffer[0], (UINT32)mFrameBuffer.size(), &Skipped, &Calls);
+
+            mFramesSkipped.fetch_add(Skipped, std::memory_order_relaxed);
+            mDeviceFrame += Skipped;
+            mAcquireCalls.fetch_add(Calls, std::memory_order_relaxed);
+
+            if (PicopRc != eSUCCESS)
+            {
+                DeliverFailure(PicopRc);
+                break;
+            }
+
+            Count = (Skipped < Count) ? (Count - Skipped) : 0;
+        }
+
+        while (Count != 0)
+        {
+            // Read straight into the ring or a pooled frame when there is room
+            pSlot = (mRing != NULL) ? mRing->BeginWrite() : NULL;
+            pPooled = (pPool != NULL) ? pPool->Acquire() : NULL;
+
+            if (pSlot != NULL)
+            {
+                pDestination = pSlot->pData;
+                DestinationWords = mFrameWords;
+                Batch = 1;
+            }
+            else if (pPooled != NULL)
+            {
+                pDestination = pPooled->pData;
+                DestinationWords = mFrameWords;
+                Batch = 1;
+            }
+            else
+            {
+                pDestination = &mFrameBuffer[0];
+                DestinationWords = (UINT32)mFrameBuffer.size();
+                Batch = ((mRing != NULL) || (pPool != NULL)) ? 1 : Count;
+            }
+
+            PicopRc = TofAcquireBatch(mConnectionHandle, mFrameWords, Batch,
+                                      pDestination, DestinationWords, &RetFrame);
+
+            mAcquireCalls.fetch_add(1, std::memory_order_relaxed);
+
+            if ((PicopRc != eSUCCESS) || (RetFrame == 0))
+            {
+                if (pPooled != NULL)
+                {
+                    TofFrameRelease(pPooled);
+                }
+
+                break;
+            }
+
+            Count = (RetFrame < Count) ? (Count - RetFrame) : 0;
+
+            for (UINT32 i = 0; i < RetFrame; i++)
+            {
+                Frame.Result = eSUCCESS;
+                Frame.pData = pDestination + (size_t)i * mFrameWords;
+                Frame.FrameWords = mFrameWords;
+                Frame.SequenceNumber = mSequenceNumber++;
+                Frame.DeviceFrame = mDeviceFrame++;
+                Frame.EventTime = EventTime;
+                Frame.AcquireTime = TofClock::now();
+                Frame.pPooled = pPooled;
+
+                if (pPool != NULL)
+                {
+                    // Every frame was in use, the miss has been counted by the pool
+                    if (pPooled == NULL)
+                    {
+                        continue;
+                    }
+
+                    pPooled->FrameWords = Frame.FrameWords;
+                    pPooled->SequenceNumber = Frame.SequenceNumber;
+                    pPooled->DeviceFrame = Frame.DeviceFrame;
+                    pPooled->AcquireTime = Frame.AcquireTime;
+                }
+
+                if (mRing != NULL)
+                {
+                    // The ring was full, the drop has been counted by the ring
+                    if (pSlot == NULL)
+                    {
+                        continue;
+                    }
+
+                    pSlot->FrameWords = Frame.FrameWords;
+                    pSlot->SequenceNumber = Frame.SequenceNumber;
+                    pSlot->DeviceFrame = Frame.DeviceFrame;
+                    pSlot->EventTime = Frame.EventTime;
+                    mRing->EndWrite();
+                }
+
+                mCallback(mContext, &Frame);
+                mFramesDelivered.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            if (pPooled != NULL)
+            {
+                TofFrameRelease(pPooled);
+            }
+        }
+
+        if (PicopRc != eSUCCESS)
+        {
+            DeliverFailure(PicopRc);
+            break;
+        }
+    }
+}
+
+// ****************************************************************************
+//  Reads up to MaxFrames cached frames into pArena with one
+//  PicoP_TLC_AcquireTofFrame call. MaxFrames is limited to what fits in the
+//  arena.
+// ****************************************************************************
+
+PICOP_RC TofAcquireBatch(PicoP_HANDLE ConnectionHandle, UINT32 FrameWords, UINT32 MaxFrames,
+                         UINT32* pArena, UINT32 ArenaWords, UINT32* pRetFrames)
+{
+    UINT32 Frames;
+
+
+    *pRetFrames = 0;
+
+    if ((pArena == NULL) || (FrameWords == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    Frames = ArenaWords / FrameWords;
+
+    if (Frames > MaxFrames)
+    {
+        Frames = MaxFrames;
+    }
+
+    if (Frames == 0)
+    {
+        return eINVALID_ARG;
+    }
+
+    return PicoP_TLC_AcquireTofFrame(ConnectionHandle, Frames, pArena, pRetFrames);
+}
+
+// ****************************************************************************
+//  Discards StaleFrames cached frames, reading as many per call as pScratch
+//  holds. The TLC API has no discard call, so the payloads still cross the
+//  bus, but they land in one scratch area and are never handed on.
+// ****************************************************************************
+
+PICOP_RC TofSkipFrames(PicoP_HANDLE ConnectionHandle, UINT32 FrameWords, UINT32 StaleFrames,
+                       UINT32* pScratch, UINT32 ScratchWords, UINT32* pSkipped, UINT32* pCalls)
+{
+    PICOP_RC PicopRc = eSUCCESS;
+    UINT32 RetFrame = 0;
+
+
+    *pSkipped = 0;
+    *pCalls = 0;
+
+    while (StaleFrames != 0)
+    {
+        PicopRc = TofAcquireBatch(ConnectionHandle, FrameWords, StaleFrames, pScratch, ScratchWords, &RetFrame);
+        (*pCalls)++;
+
+        if ((PicopRc != eSUCCESS) || (RetFrame == 0))
+        {
+            break;
+        }
+
+        RetFrame = (RetFrame < StaleFrames) ? RetFrame : StaleFrames;
+        *pSkipped += RetFrame;
+        StaleFrames -= RetFrame;
+    }
+
+    return PicopRc;
+}
+
+// ****************************************************************************
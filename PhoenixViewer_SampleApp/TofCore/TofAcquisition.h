@@ -0,0 +1,163 @@
+// ****************************************************************************
+//  TofAcquisition.h
+//
+// Event driven acquisition of 3D (ToF) frames from a TLC connection
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFramePool.h"
+#include "TofFrameRing.h"
+
+// ****************************************************************************
+
+// If no eEVENT_TOF_DATA_FRAMES_RECEIVED arrives within this time the
+// acquisition thread checks the frame count anyway, so a lost event can
+// never stall the stream.
+#define TOF_ACQUISITION_WATCHDOG_MS  500
+
+// Most frames read with a single PicoP_TLC_AcquireTofFrame call, which also
+// sizes the acquisition thread's scratch arena
+#define TOF_ACQUISITION_MAX_BATCH    4
+
+typedef enum
+{
+    eTOF_ACQUIRE_ALL_FRAMES = 0,        // Deliver every frame the device cached
+    eTOF_ACQUIRE_LATEST_ONLY            // Discard stale frames, deliver only the newest
+} TofAcquireModeE;
+
+typedef struct
+{
+    UINT32 FramesDelivered;             // Frames handed to the consumer
+    UINT32 FramesSkipped;               // Stale frames discarded in eTOF_ACQUIRE_LATEST_ONLY
+    UINT32 AcquireCalls;                // PicoP_TLC_AcquireTofFrame calls made
+} TofAcquisitionStats;
+
+// ****************************************************************************
+// Handed to the consumer for every frame (or failure) on the acquisition thread.
+// pData is only valid for the duration of the callback. When a frame ring is
+// attached the frame has already been published to it and pData points at
+// the ring slot. When a frame pool is attached pData is pPooled->pData, and
+// the consumer keeps the frame by taking a reference with TofFrameAddRef.
+// ****************************************************************************
+
+typedef struct
+{
+    PICOP_RC Result;                    // eSUCCESS, or the failing API's return code
+    const UINT32* pData;                // Frame as returned by PicoP_TLC_AcquireTofFrame
+    UINT32 FrameWords;                  // Number of UINT32 words in pData
+    UINT32 SequenceNumber;              // Frames delivered since Start()
+    UINT32 DeviceFrame;                 // Frames read from the device since Start(), skipped ones included
+    TofClock::time_point EventTime;     // When the driver signalled the frame
+    TofClock::time_point AcquireTime;   // When the frame was copied out of the driver
+    TofPooledFrame* pPooled;            // Frame holding pData when a pool is attached, else NULL
+} TofAcquiredFrame;
+
+typedef void (*TofFrameCallback)(void* pContext, const TofAcquiredFrame* pFrame);
+
+// ****************************************************************************
+// Batch helpers. Frames are stored back to back, FrameWords apart, and each
+// helper call is a single device transaction per batch. FrameWords must be
+// what the device sends now; TofAcquisition::Start() checks it once, and a
+// data format switch needs a Restart().
+// ****************************************************************************
+
+PICOP_RC TofAcquireBatch(PicoP_HANDLE ConnectionHandle, UINT32 FrameWords, UINT32 MaxFrames,
+                         UINT32* pArena, UINT32 ArenaWords, UINT32* pRetFrames);
+
+PICOP_RC TofSkipFrames(PicoP_HANDLE ConnectionHandle, UINT32 FrameWords, UINT32 StaleFrames,
+                       UINT32* pScratch, UINT32 ScratchWords, UINT32* pSkipped, UINT32* pCalls);
+
+// ****************************************************************************
+// Registers for eEVENT_TOF_DATA_FRAMES_RECEIVED and acquires frames on a
+// dedicated thread as soon as the driver reports them. Only one instance can
+// be started at a time since the TLC callback carries no user context.
+// ****************************************************************************
+
+class TofAcquisition
+{
+public:
+    TofAcquisition();
+    ~TofAcquisition();
+
+    PICOP_RC Start(PicoP_HANDLE ConnectionHandle, TofFrameCallback pfnCallback, void* pContext);
+    void Stop();
+
+    // Starts again with the connection, callback and context of the last
+    // Start(), sized for the frames the device sends now. Used after a
+    // change of data format or pulsing config made while stopped. Not from
+    // the frame callback, which runs on the thread being stopped.
+    PICOP_RC Restart();
+
+    // Frames are read straight into the ring's slots. Frames that arrive while
+    // the ring is full are read (to drain the device) but not delivered.
+    void SetFrameRing(TofFrameRing* pRing) { mRing = pRing; }
+
+    // Frames are read straight into frames taken from the pool and released
+    // after the callback, so they go back to the pool unless the consumer
+    // kept a reference. Frames that arrive while every pooled frame is in use
+    // are read but not delivered. Ignored when a frame ring is attached.
+    void SetFramePool(TofFramePool* pPool) { mPool = pPool; }
+
+    // Call before Start()
+    void SetMode(TofAcquireModeE Mode) { mMode = Mode; }
+
+    BOOL IsRunning() const { return mRunning; }
+    void GetStats(TofAcquisitionStats* pStats) const;
+
+private:
+    TofAcquisition(const TofAcquisition&);
+    TofAcquisition& operator=(const TofAcquisition&);
+
+    static UINT32 EventCallback(void* pvParam, PicoP_TofEventE EventType, void* pEvent);
+
+    void SignalFrames();
+    void AcquisitionThread();
+    void DeliverFailure(PICOP_RC Result);
+
+    PicoP_HANDLE mConnectionHandle;
+    TofFrameCallback mCallback;
+    void* mContext;
+    TofFrameRing* mRing;
+    TofFramePool* mPool;
+    TofAcquireModeE mMode;
+
+    std::vector<UINT32> mFrameBuffer;   // Scratch arena of TOF_ACQUISITION_MAX_BATCH frames
+    UINT32 mFrameWords;
+    UINT32 mSequenceNumber;
+    UINT32 mDeviceFrame;                // Every frame read, delivered or not
+
+    std::atomic<UINT32> mFramesDelivered;
+    std::atomic<UINT32> mFramesSkipped;
+    std::atomic<UINT32> mAcquireCalls;
+
+    std::thread mThread;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    UINT32 mPendingEvents;
+    TofClock::time_point mEventTime;
+    BOOL mStopRequested;
+    std::atomic<BOOL> mRunning;
+
+    // The TLC callback holds sActiveLock while it signals sActive, so once
+    // Stop() has cleared sActive no callback can still be using this instance
+    static std::mutex sActiveLock;
+    static TofAcquisition* sActive;
+};
+
+// ****************************************************************************
@@ -0,0 +1,186 @@
+// ****************************************************************************
+//  TofBoundedQueue.h
+//
+// Fixed capacity queue between pipeline threads
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+// What Push() does when the queue is full: wait for the consumer to take an
+// item, or evict the oldest item to make room. An evicted item is handed back
+// to the caller, so items that own resources (pooled frames) can be recycled.
+// ****************************************************************************
+
+typedef enum
+{
+    eTOF_QUEUE_BLOCK = 0,
+    eTOF_QUEUE_DROP_OLDEST
+} TofQueuePolicyE;
+
+// ****************************************************************************
+
+template<typename T>
+class TofBoundedQueue
+{
+public:
+    TofBoundedQueue()
+        : mCapacity(1),
+          mPolicy(eTOF_QUEUE_BLOCK),
+          mHead(0),
+          mDepth(0),
+          mClosed(FALSE),
+          mMaxDepth(0),
+          mDropped(0)
+    {
+    }
+
+    // The only call that allocates; Push() and Pop() never do
+    void Create(UINT32 Capacity, TofQueuePolicyE Policy)
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+
+        mCapacity = (Capacity == 0) ? 1 : Capacity;
+        mPolicy = Policy;
+        mClosed = FALSE;
+        mMaxDepth = 0;
+        mDropped = 0;
+        mHead = 0;
+        mDepth = 0;
+        mItems.assign(mCapacity, T());
+    }
+
+    // Returns FALSE, without queuing Item, once the queue is closed. *pEvicted
+    // is set and *pWasEvicted TRUE when the oldest item had to make room.
+    BOOL Push(const T& Item, T* pEvicted, BOOL* pWasEvicted)
+    {
+        std::unique_lock<std::mutex> Lock(mLock);
+
+
+        *pWasEvicted = FALSE;
+
+        while ((mPolicy == eTOF_QUEUE_BLOCK) && (mDepth >= mCapacity) && ( ! mClosed))
+        {
+            mNotFull.wait(Lock);
+        }
+
+        if (mClosed)
+        {
+            return FALSE;
+        }
+
+        if (mDepth >= mCapacity)
+        {
+            *pEvicted = mItems[mHead];
+            *pWasEvicted = TRUE;
+            mHead = (mHead + 1) % mCapacity;
+            mDepth--;
+            mDropped++;
+        }
+
+        mItems[(mHead + mDepth) % mCapacity] = Item;
+        mDepth++;
+        mMaxDepth = (mDepth > mMaxDepth) ? mDepth : mMaxDepth;
+        Lock.unlock();
+
+        mNotEmpty.notify_one();
+
+        return TRUE;
+    }
+
+    // Waits for an item; returns FALSE once the queue is closed and empty
+    BOOL Pop(T* pItem)
+    {
+        std::unique_lock<std::mutex> Lock(mLock);
+
+
+        while ((mDepth == 0) && ( ! mClosed))
+        {
+            mNotEmpty.wait(Lock);
+        }
+
+        if (mDepth == 0)
+        {
+            return FALSE;
+        }
+
+        *pItem = mItems[mHead];
+        mHead = (mHead + 1) % mCapacity;
+        mDepth--;
+        Lock.unlock();
+
+        mNotFull.notify_one();
+
+        return TRUE;
+    }
+
+    // Wakes every waiter; Pop() still drains what is queued
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(mLock);
+            mClosed = TRUE;
+        }
+
+        mNotEmpty.notify_all();
+        mNotFull.notify_all();
+    }
+
+    UINT32 GetDepth()
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+
+        return mDepth;
+    }
+
+    UINT32 GetMaxDepth()
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+
+        return mMaxDepth;
+    }
+
+    uint64_t GetDropped()
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+
+        return mDropped;
+    }
+
+private:
+    TofBoundedQueue(const TofBoundedQueue&);
+    TofBoundedQueue& operator=(const TofBoundedQueue&);
+
+    std::vector<T> mItems;              // Ring of mCapacity items, the oldest at mHead
+    UINT32 mCapacity;
+    TofQueuePolicyE mPolicy;
+    UINT32 mHead;
+    UINT32 mDepth;
+    BOOL mClosed;
+    UINT32 mMaxDepth;
+    uint64_t mDropped;
+
+    std::mutex mLock;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+};
+
+// ****************************************************************************
@@ -0,0 +1,401 @@
+// ****************************************************************************
+//  TofCloudWriter.cpp
+//
+// Exports frames as PCD or PLY point cloud files
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "TofCloudWriter.h"
+#include "TofLzf.h"
+#include "TofMemory.h"
+#include "TofValidMask.h"
+
+// ****************************************************************************
+
+#define TOF_CLOUD_POINTS_ALIGN      16
+
+// ****************************************************************************
+
+TofCloudWriter::TofCloudWriter()
+    : mFormat(eTOF_CLOUD_PCD_BINARY),
+      mNumPoints(0),
+      mMinAmplitude(0),
+      mPointsOffset(0),
+      mStopRequested(FALSE)
+{
+    mPathPrefix[0] = '\0';
+    mHeader[0] = '\0';
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+TofCloudWriter::~TofCloudWriter()
+{
+    Close();
+}
+
+// ****************************************************************************
+//  Sizes every buffer for a whole file, formats the organized header (or
+//  leaves room for the largest unorganized one) and starts the writer thread
+// ****************************************************************************
+
+PICOP_RC TofCloudWriter::Open(const char* pPathPrefix, TofCloudFileFormatE Format,
+                              const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines)
+{
+    size_t PointBytes;
+    size_t HeaderBytes;
+    size_t MaxHeaderBytes;
+    char Unorganized[TOF_CLOUD_WRITER_MAX_HEADER];
+    PICOP_RC PicopRc;
+
+
+    if ((pPathPrefix == NULL) || (pGeometry == NULL) ||
+        (strlen(pPathPrefix) >= sizeof(mPathPrefix)) ||
+        (Format > eTOF_CLOUD_PLY))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (IsOpen())
+    {
+        return eALREADY_OPENED;
+    }
+
+    PicopRc = TofSharedRayTables()->Get(pGeometry, NumPulses, NumLines, &mTable);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    snprintf(mPathPrefix, sizeof(mPathPrefix), "%s", pPathPrefix);
+    mFormat = Format;
+    mNumPoints = NumPulses * NumLines;
+    PointBytes = (size_t)mNumPoints * sizeof(PicoP_Pcd_Data);
+
+    HeaderBytes = FormatHeader(NumPulses, NumLines, mHeader);
+    MaxHeaderBytes = HeaderBytes;
+
+    // The unorganized header is longest when every pixel is valid
+    if (mMinAmplitude != 0)
+    {
+        mValid.resize(mNumPoints);
+        MaxHeaderBytes = FormatHeader(mNumPoints, 1, Unorganized);
+        MaxHeaderBytes = (MaxHeaderBytes > HeaderBytes) ? MaxHeaderBytes : HeaderBytes;
+    }
+
+    mPointsOffset = TOF_ALIGN_UP(MaxHeaderBytes, TOF_CLOUD_POINTS_ALIGN);
+
+    // The header sits right in front of the points, so an uncompressed file
+    // is one contiguous write
+    mBuffers.resize(TOF_CLOUD_WRITER_BUFFERS);
+    mFreeBuffers.clear();
+    mFullBuffers.clear();
+
+    for (UINT32 i = 0; i < TOF_CLOUD_WRITER_BUFFERS; i++)
+    {
+        mBuffers[i].Data.resize(mPointsOffset + PointBytes + TOF_CLOUD_POINTS_ALIGN);
+        memcpy(&mBuffers[i].Data[mPointsOffset - HeaderBytes], mHeader, HeaderBytes);
+        mBuffers[i].HeaderBytes = HeaderBytes;
+        mBuffers[i].NumPoints = mNumPoints;
+        mFreeBuffers.push_back(i);
+    }
+
+    if (Format == eTOF_CLOUD_PCD_BINARY_COMPRESSED)
+    {
+        mFields.resize(PointBytes);
+        mPacked.resize(MaxHeaderBytes + (2 * sizeof(UINT32)) + TofLzfMaxBytes(PointBytes));
+        mLzfTable.resize(TOF_LZF_TABLE_ENTRIES);
+    }
+
+    memset(&mStats, 0, sizeof(mStats));
+    mStopRequested = FALSE;
+    mThread = std::thread(&TofCloudWriter::WriterThread, this);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Writes whatever is queued, then stops the writer. Returns eDEVICE_ERROR
+//  if any file could not be written.
+// ****************************************************************************
+
+PICOP_RC TofCloudWriter::Close()
+{
+    if ( ! mThread.joinable())
+    {
+        return eSUCCESS;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStopRequested = TRUE;
+    }
+
+    mWake.notify_all();
+    mThread.join();
+
+    mBuffers.clear();
+    mFreeBuffers.clear();
+    mFullBuffers.clear();
+    mFields.clear();
+    mPacked.clear();
+    mLzfTable.clear();
+    mValid.clear();
+    mTable.reset();
+
+    return (mStats.FilesFailed == 0) ? eSUCCESS : eDEVICE_ERROR;
+}
+
+// ****************************************************************************
+//  Formats the header of a Width x Height cloud into pHeader (of
+//  TOF_CLOUD_WRITER_MAX_HEADER bytes) and returns its length
+// ****************************************************************************
+
+size_t TofCloudWriter::FormatHeader(UINT32 Width, UINT32 Height, char* pHeader)
+{
+    int Length;
+
+
+    if (mFormat == eTOF_CLOUD_PLY)
+    {
+        Length = snprintf(pHeader, TOF_CLOUD_WRITER_MAX_HEADER,
+                          "ply\n"
+                          "format binary_little_endian 1.0\n"
+                          "comment Microvision ToF frame, %u x %u, millimetres\n"
+                          "element vertex %u\n"
+                          "property int x\n"
+                          "property int y\n"
+                          "property int z\n"
+                          "property uint intensity\n"
+                          "end_header\n",
+                          mTable->GetNumPulses(), mTable->GetNumLines(), Width * Height);
+    }
+    else
+    {
+        Length = snprintf(pHeader, TOF_CLOUD_WRITER_MAX_HEADER,
+                          "# .PCD v0.7 - Point Cloud Data file format\n"
+                          "VERSION 0.7\n"
+                          "FIELDS x y z intensity\n"
+                          "SIZE 4 4 4 4\n"
+                          "TYPE I I I U\n"
+                          "COUNT 1 1 1 1\n"
+                          "WIDTH %u\n"
+                          "HEIGHT %u\n"
+                          "VIEWPOINT 0 0 0 1 0 0 0\n"
+                          "POINTS %u\n"
+                          "DATA %s\n",
+                          Width, Height, Width * Height,
+                          (mFormat == eTOF_CLOUD_PCD_BINARY_COMPRESSED) ? "binary_compressed" : "binary");
+    }
+
+    return (Length > 0) ? (size_t)Length : 0;
+}
+
+// ****************************************************************************
+//  Projects the frame into a free buffer and queues it; returns eBUSY if it
+//  had to be dropped because the writer is behind
+// ****************************************************************************
+
+PICOP_RC TofCloudWriter::Write(const TofFrameView* pView, UINT32 SequenceNumber)
+{
+    Buffer* pBuffer;
+    PicoP_Pcd_Data* pPoints;
+    UINT32 NumValid;
+    UINT32 Index;
+
+
+    if ((pView == NULL) || (pView->pTime == NULL) || (pView->pAmplitude == NULL) || ( ! IsOpen()))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((pView->NumPulses != mTable->GetNumPulses()) || (pView->NumLines != mTable->GetNumLines()))
+    {
+        return eFRAME_ERROR;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+        if (mFreeBuffers.empty())
+        {
+            mStats.FilesDropped++;
+            return eBUSY;
+        }
+
+        Index = mFreeBuffers.back();
+        mFreeBuffers.pop_back();
+    }
+
+    pBuffer = &mBuffers[Index];
+    pPoints = (PicoP_Pcd_Data*)&pBuffer->Data[mPointsOffset];
+
+    if (mMinAmplitude != 0)
+    {
+        NumValid = TofCompactValid(pView->pTime, pView->pAmplitude, mNumPoints, mMinAmplitude, &mValid[0]);
+        TofProjectIndices(mTable.get(), pView, &mValid[0], NumValid, pPoints);
+
+        pBuffer->HeaderBytes = FormatHeader(NumValid, 1, mHeader);
+        pBuffer->NumPoints = NumValid;
+        memcpy(&pBuffer->Data[mPointsOffset - pBuffer->HeaderBytes], mHeader, pBuffer->HeaderBytes);
+    }
+    else
+    {
+        TofProjectLines(mTable.get(), pView, 0, pView->NumLines, pPoints);
+    }
+
+    pBuffer->SequenceNumber = SequenceNumber;
+
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mFullBuffers.push_back(Index);
+    }
+
+    mWake.notify_one();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofCloudWriter::GetStats(TofCloudWriterStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pStats = mStats;
+}
+
+// ****************************************************************************
+//  Splits the points into one array per field, as binary_compressed stores
+//  them, and compresses that into mPacked behind the header. Returns the
+//  file size.
+// ****************************************************************************
+
+size_t TofCloudWriter::Compress(const Buffer* pBuffer)
+{
+    const PicoP_Pcd_Data* pPoints = (const PicoP_Pcd_Data*)&pBuffer->Data[mPointsOffset];
+    INT32* pX = (INT32*)&mFields[0];
+    UINT32 NumPoints = pBuffer->NumPoints;
+    size_t HeaderBytes = pBuffer->HeaderBytes;
+    INT32* pY = pX + NumPoints;
+    INT32* pZ = pY + NumPoints;
+    UINT32* pIntensity = (UINT32*)(pZ + NumPoints);
+    UINT32 Sizes[2];
+
+
+    for (UINT32 i = 0; i < NumPoints; i++)
+    {
+        pX[i] = pPoints[i].x;
+        pY[i] = pPoints[i].y;
+        pZ[i] = pPoints[i].z;
+        pIntensity[i] = pPoints[i].intensity;
+    }
+
+    Sizes[1] = NumPoints * (UINT32)sizeof(PicoP_Pcd_Data);
+    Sizes[0] = (UINT32)TofLzfCompress(&mFields[0], Sizes[1], &mPacked[HeaderBytes + sizeof(Sizes)],
+                                      mPacked.size() - HeaderBytes - sizeof(Sizes), &mLzfTable[0]);
+    memcpy(&mPacked[0], &pBuffer->Data[mPointsOffset - HeaderBytes], HeaderBytes);
+    memcpy(&mPacked[HeaderBytes], Sizes, sizeof(Sizes));
+
+    return HeaderBytes + sizeof(Sizes) + Sizes[0];
+}
+
+// ****************************************************************************
+
+void TofCloudWriter::WriteFile(const Buffer* pBuffer)
+{
+    char FileName[TOF_CLOUD_WRITER_MAX_PATH];
+    const UINT8* pData;
+    size_t Bytes;
+    BOOL Written = FALSE;
+    FILE* pFile = NULL;
+    int Length;
+
+
+    // mPathPrefix leaves TOF_CLOUD_WRITER_MAX_SUFFIX for the longest suffix,
+    // so this always fits; a name that somehow didn't is a failed file, not
+    // a truncated one
+    Length = snprintf(FileName, sizeof(FileName), "%s%08u%s", mPathPrefix, pBuffer->SequenceNumber,
+                      (mFormat == eTOF_CLOUD_PLY) ? ".ply" : ".pcd");
+
+    if (mFormat == eTOF_CLOUD_PCD_BINARY_COMPRESSED)
+    {
+        Bytes = Compress(pBuffer);
+        pData = &mPacked[0];
+    }
+    else
+    {
+        Bytes = pBuffer->HeaderBytes + ((size_t)pBuffer->NumPoints * sizeof(PicoP_Pcd_Data));
+        pData = &pBuffer->Data[mPointsOffset - pBuffer->HeaderBytes];
+    }
+
+    if ((Length > 0) && ((size_t)Length < sizeof(FileName)))
+    {
+        pFile = fopen(FileName, "wb");
+    }
+
+    if (pFile != NULL)
+    {
+        // The file is written in one piece, stdio buffering would only add a copy
+        setvbuf(pFile, NULL, _IONBF, 0);
+        Written = (fwrite(pData, 1, Bytes, pFile) == Bytes);
+        Written = (fclose(pFile) == 0) && Written;
+    }
+
+    std::lock_guard<std::mutex> Lock(mLock);
+
+    if (Written)
+    {
+        mStats.FilesWritten++;
+        mStats.BytesWritten += Bytes;
+    }
+    else
+    {
+        mStats.FilesFailed++;
+    }
+}
+
+// ****************************************************************************
+//  Writes queued buffers in order until stopped with nothing left queued
+// ****************************************************************************
+
+void TofCloudWriter::WriterThread()
+{
+    std::unique_lock<std::mutex> Lock(mLock);
+    UINT32 Index;
+
+
+    for (;;)
+    {
+        while (mFullBuffers.empty() && ( ! mStopRequested))
+        {
+            mWake.wait(Lock);
+        }
+
+        if (mFullBuffers.empty())
+        {
+            break;
+        }
+
+        Index = mFullBuffers.front();
+        mFullBuffers.erase(mFullBuffers.begin());
+        Lock.unlock();
+
+        WriteFile(&mBuffers[Index]);
+
+        Lock.lock();
+        mFreeBuffers.push_back(Index);
+    }
+}
+
+// ****************************************************************************
@@ -0,0 +1,128 @@
+// ****************************************************************************
+//  TofCloudWriter.h
+//
+// Exports frames as PCD or PLY point cloud files
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TofPointCloud.h"
+#include "TofRayTableCache.h"
+
+// ****************************************************************************
+// One file per frame, named <PathPrefix><sequence number, 8 digits>.pcd (or
+// .ply). Points are the organized NumPulses x NumLines cloud in PicoP_Pcd_Data
+// units: x, y, z in millimetres as 32 bit integers and the amplitude as an
+// unsigned 32 bit intensity. With SetMinAmplitude() only the valid pixels
+// are written (see TofValidMask.h), as an unorganized cloud: WIDTH is the
+// number of points and HEIGHT 1.
+//
+//   PCD binary              header, then the points as stored in memory
+//   PCD binary_compressed   header, compressed and raw sizes, then the
+//                           x, y, z and intensity arrays one after the
+//                           other, LZF compressed
+//   PLY                     binary little endian, same record as PCD binary
+//
+// The organized header only depends on the frame size, so it is formatted
+// once in Open(); an unorganized one is formatted per frame. Write() projects the frame straight into a file sized buffer
+// behind the header and queues it; a writer thread compresses (for
+// binary_compressed) and writes it. If every buffer is still queued the frame
+// is dropped and counted, so a slow disk never holds up acquisition. Only one
+// thread may call Write() at a time.
+// ****************************************************************************
+
+#define TOF_CLOUD_WRITER_BUFFERS        4
+#define TOF_CLOUD_WRITER_MAX_PATH       260
+#define TOF_CLOUD_WRITER_MAX_SUFFIX     16          // Up to 10 digits, the extension and the terminator
+#define TOF_CLOUD_WRITER_MAX_HEADER     512
+
+typedef enum
+{
+    eTOF_CLOUD_PCD_BINARY = 0,
+    eTOF_CLOUD_PCD_BINARY_COMPRESSED,
+    eTOF_CLOUD_PLY
+} TofCloudFileFormatE;
+
+typedef struct
+{
+    UINT32 FilesWritten;
+    UINT32 FilesDropped;                // No buffer free, the disk fell behind
+    UINT32 FilesFailed;                 // Could not be created or written
+    uint64_t BytesWritten;
+} TofCloudWriterStats;
+
+// ****************************************************************************
+
+class TofCloudWriter
+{
+public:
+    TofCloudWriter();
+    ~TofCloudWriter();
+
+    PICOP_RC Open(const char* pPathPrefix, TofCloudFileFormatE Format, const TofScanGeometry* pGeometry,
+                  UINT32 NumPulses, UINT32 NumLines);
+    PICOP_RC Close();
+
+    // Call before Open(); 0 (the default) writes every pixel
+    void SetMinAmplitude(UINT32 MinAmplitude) { mMinAmplitude = MinAmplitude; }
+
+    PICOP_RC Write(const TofFrameView* pView, UINT32 SequenceNumber);
+
+    BOOL IsOpen() const { return mThread.joinable(); }
+    void GetStats(TofCloudWriterStats* pStats);
+
+private:
+    TofCloudWriter(const TofCloudWriter&);
+    TofCloudWriter& operator=(const TofCloudWriter&);
+
+    typedef struct
+    {
+        std::vector<UINT8> Data;        // Header ends at mPointsOffset, then the points
+        size_t HeaderBytes;
+        UINT32 NumPoints;
+        UINT32 SequenceNumber;
+    } Buffer;
+
+    size_t FormatHeader(UINT32 Width, UINT32 Height, char* pHeader);
+    size_t Compress(const Buffer* pBuffer);
+    void WriteFile(const Buffer* pBuffer);
+    void WriterThread();
+
+    char mPathPrefix[TOF_CLOUD_WRITER_MAX_PATH - TOF_CLOUD_WRITER_MAX_SUFFIX];
+    TofCloudFileFormatE mFormat;
+    TofRayTablePtr mTable;
+    UINT32 mNumPoints;                  // In a whole frame
+    UINT32 mMinAmplitude;
+    char mHeader[TOF_CLOUD_WRITER_MAX_HEADER];
+    size_t mPointsOffset;               // Headers are right-aligned to this 16 byte boundary
+    std::vector<UINT32> mValid;         // Indices of the frame being written, with a minimum amplitude
+
+    std::vector<Buffer> mBuffers;
+    std::vector<UINT32> mFreeBuffers;
+    std::vector<UINT32> mFullBuffers;   // Oldest first
+
+    std::vector<UINT8> mFields;         // binary_compressed: the field arrays
+    std::vector<UINT8> mPacked;         // binary_compressed: the file image
+    std::vector<UINT32> mLzfTable;      // binary_compressed: TofLzfCompress scratch
+
+    std::thread mThread;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    BOOL mStopRequested;
+    TofCloudWriterStats mStats;
+};
+
+// ****************************************************************************
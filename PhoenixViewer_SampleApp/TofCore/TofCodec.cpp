@@ -0,0 +1,526 @@
+// ****************************************************************************
+//  TofCodec.cpp
+//
+// Lossless compression of ToF frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "TofCodec.h"
+
+// ****************************************************************************
+
+static inline UINT32 ZigZag(UINT32 Residual)
+{
+    return (Residual << 1) ^ (UINT32)((INT32)Residual >> 31);
+}
+
+static inline UINT32 UnZigZag(UINT32 Value)
+{
+    return (Value >> 1) ^ (0 - (Value & 1));
+}
+
+static inline UINT32 BitWidth(UINT32 Value)
+{
+    UINT32 Width = 0;
+
+
+    while (Value != 0)
+    {
+        Width++;
+        Value >>= 1;
+    }
+
+    return Width;
+}
+
+// ****************************************************************************
+//  Prediction for word i of a line. pLine is the line being coded, pUp the
+//  line above (NULL on the first line), pPrevious the same line in the
+//  reference frame (NULL for a key frame). Callers only pass a mode whose
+//  inputs exist.
+// ****************************************************************************
+
+static inline UINT32 Predict(TofPredictorE Mode, const UINT32* pLine, const UINT32* pUp,
+                             const UINT32* pPrevious, UINT32 i)
+{
+    switch (Mode)
+    {
+    case eTOF_PREDICT_LEFT:
+        return (i == 0) ? 0 : pLine[i - 1];
+
+    case eTOF_PREDICT_UP:
+        return pUp[i];
+
+    case eTOF_PREDICT_PREVIOUS:
+        return pPrevious[i];
+
+    case eTOF_PREDICT_NONE:
+    default:
+        return 0;
+    }
+}
+
+// ****************************************************************************
+//  Picks the predictor with the smallest packed size. Every mode's residuals
+//  are ORed per block in one pass; the OR has the same bit width as the
+//  largest residual, which is what the block packs at.
+// ****************************************************************************
+
+static TofPredictorE ChoosePredictor(const UINT32* pLine, const UINT32* pUp, const UINT32* pPrevious,
+                                     UINT32 Count)
+{
+    UINT32 Cost[eTOF_PREDICT_COUNT] = {0};
+    UINT32 Or[eTOF_PREDICT_COUNT];
+    UINT32 BlockEnd;
+    UINT32 Left;
+    UINT32 Best = eTOF_PREDICT_NONE;
+
+
+    for (UINT32 Start = 0; Start < Count; Start += TOF_CODEC_BLOCK)
+    {
+        BlockEnd = (Start + TOF_CODEC_BLOCK < Count) ? (Start + TOF_CODEC_BLOCK) : Count;
+        memset(Or, 0, sizeof(Or));
+
+        for (UINT32 i = Start; i < BlockEnd; i++)
+        {
+            Left = (i == 0) ? 0 : pLine[i - 1];
+
+            Or[eTOF_PREDICT_NONE] |= ZigZag(pLine[i]);
+            Or[eTOF_PREDICT_LEFT] |= ZigZag(pLine[i] - Left);
+
+            if (pUp != NULL)
+            {
+                Or[eTOF_PREDICT_UP] |= ZigZag(pLine[i] - pUp[i]);
+            }
+
+            if (pPrevious != NULL)
+            {
+                Or[eTOF_PREDICT_PREVIOUS] |= ZigZag(pLine[i] - pPrevious[i]);
+            }
+        }
+
+        for (UINT32 Mode = 0; Mode < eTOF_PREDICT_COUNT; Mode++)
+        {
+            Cost[Mode] += BitWidth(Or[Mode]) * (BlockEnd - Start);
+        }
+    }
+
+    for (UINT32 Mode = eTOF_PREDICT_LEFT; Mode < eTOF_PREDICT_COUNT; Mode++)
+    {
+        if (((Mode == eTOF_PREDICT_UP) && (pUp == NULL)) ||
+            ((Mode == eTOF_PREDICT_PREVIOUS) && (pPrevious == NULL)))
+        {
+            continue;
+        }
+
+        if (Cost[Mode] < Cost[Best])
+        {
+            Best = Mode;
+        }
+    }
+
+    return (TofPredictorE)Best;
+}
+
+// ****************************************************************************
+
+size_t TofCodecMaxBytes(UINT32 Words, UINT32 LineWords)
+{
+    size_t Lines;
+    size_t Blocks;
+
+
+    if (LineWords == 0)
+    {
+        return 0;
+    }
+
+    Lines = (Words + LineWords - 1) / LineWords;
+    Blocks = Lines * ((LineWords + TOF_CODEC_BLOCK - 1) / TOF_CODEC_BLOCK);
+
+    // Predictor byte per line, width byte per block, every word at 32 bits
+    return sizeof(TofCodecHeader) + Lines + Blocks + (size_t)Words * sizeof(UINT32);
+}
+
+// ****************************************************************************
+//  Codes one line: the predictor byte, then per block a width byte and the
+//  residuals packed LSB first at that width, padded to a whole byte.
+// ****************************************************************************
+
+static UINT8* EncodeLine(const UINT32* pLine, const UINT32* pUp, const UINT32* pPrevious,
+                         UINT32 Count, UINT8* pOut, BOOL* pUsedReference)
+{
+    TofPredictorE Mode;
+    UINT32 Residual[TOF_CODEC_BLOCK];
+    UINT32 BlockCount;
+    UINT32 Or;
+    UINT32 Width;
+    uint64_t Bits;
+    UINT32 NumBits;
+
+
+    Mode = ChoosePredictor(pLine, pUp, pPrevious, Count);
+    *pOut++ = (UINT8)Mode;
+
+    if (Mode == eTOF_PREDICT_PREVIOUS)
+    {
+        *pUsedReference = TRUE;
+    }
+
+    for (UINT32 Start = 0; Start < Count; Start += TOF_CODEC_BLOCK)
+    {
+        BlockCount = (Count - Start < TOF_CODEC_BLOCK) ? (Count - Start) : TOF_CODEC_BLOCK;
+        Or = 0;
+
+        for (UINT32 i = 0; i < BlockCount; i++)
+        {
+            Residual[i] = ZigZag(pLine[Start + i] - Predict(Mode, pLine, pUp, pPrevious, Start + i));
+            Or |= Residual[i];
+        }
+
+        Width = BitWidth(Or);
+        *pOut++ = (UINT8)Width;
+
+        if (Width == 0)
+        {
+            continue;
+        }
+
+        Bits = 0;
+        NumBits = 0;
+
+        for (UINT32 i = 0; i < BlockCount; i++)
+        {
+            Bits |= (uint64_t)Residual[i] << NumBits;
+            NumBits += Width;
+
+            if (NumBits >= 32)
+            {
+                memcpy(pOut, &Bits, sizeof(UINT32));
+                pOut += sizeof(UINT32);
+                Bits >>= 32;
+                NumBits -= 32;
+            }
+        }
+
+        while (NumBits > 0)
+        {
+            *pOut++ = (UINT8)Bits;
+            Bits >>= 8;
+            NumBits = (NumBits > 8) ? (NumBits - 8) : 0;
+        }
+    }
+
+    return pOut;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofEncodeFrame(const UINT32* pFrame, const UINT32* pReference, UINT32 Words, UINT32 LineWords,
+                        UINT8* pOut, size_t OutCapacity, size_t* pOutBytes)
+{
+    TofCodecHeader Header;
+    BOOL UsedReference = FALSE;
+    UINT8* pNext;
+    UINT32 Count;
+
+
+    if ((pFrame == NULL) || (pOut == NULL) || (pOutBytes == NULL) || (Words == 0) || (LineWords == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (OutCapacity < TofCodecMaxBytes(Words, LineWords))
+    {
+        return eINVALID_ARG;
+    }
+
+    pNext = pOut + sizeof(TofCodecHeader);
+
+    for (UINT32 Start = 0; Start < Words; Start += LineWords)
+    {
+        Count = (Words - Start < LineWords) ? (Words - Start) : LineWords;
+
+        pNext = EncodeLine(pFrame + Start,
+                           (Start == 0) ? NULL : (pFrame + Start - LineWords),
+                           (pReference == NULL) ? NULL : (pReference + Start),
+                           Count, pNext, &UsedReference);
+    }
+
+    Header.Magic = TOF_CODEC_MAGIC;
+    Header.Words = Words;
+    Header.LineWords = LineWords;
+    Header.Flags = UsedReference ? TOF_CODEC_FLAG_INTER : 0;
+    memcpy(pOut, &Header, sizeof(Header));
+
+    *pOutBytes = (size_t)(pNext - pOut);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Decodes one line, checking every read against pEnd so a damaged or
+//  truncated buffer fails instead of reading past it
+// ****************************************************************************
+
+static const UINT8* DecodeLine(const UINT8* pIn, const UINT8* pEnd, const UINT32* pUp,
+                               const UINT32* pPrevious, UINT32 Count, UINT32* pLine)
+{
+    TofPredictorE Mode;
+    UINT32 BlockCount;
+    UINT32 Width;
+    UINT32 Mask;
+    uint64_t Bits;
+    UINT32 NumBits;
+    size_t BlockBytes;
+
+
+    if (pIn >= pEnd)
+    {
+        return NULL;
+    }
+
+    Mode = (TofPredictorE)*pIn++;
+
+    if ((Mode >= eTOF_PREDICT_COUNT) ||
+        ((Mode == eTOF_PREDICT_UP) && (pUp == NULL)) ||
+        ((Mode == eTOF_PREDICT_PREVIOUS) && (pPrevious == NULL)))
+    {
+        return NULL;
+    }
+
+    for (UINT32 Start = 0; Start < Count; Start += TOF_CODEC_BLOCK)
+    {
+        BlockCount = (Count - Start < TOF_CODEC_BLOCK) ? (Count - Start) : TOF_CODEC_BLOCK;
+
+        if (pIn >= pEnd)
+        {
+            return NULL;
+        }
+
+        Width = *pIn++;
+        BlockBytes = ((size_t)BlockCount * Width + 7) / 8;
+
+        if ((Width > 32) || ((size_t)(pEnd - pIn) < BlockBytes))
+        {
+            return NULL;
+        }
+
+        Mask = (Width == 32) ? 0xffffffff : ((1u << Width) - 1);
+        Bits = 0;
+        NumBits = 0;
+
+        for (UINT32 i = 0; i < BlockCount; i++)
+        {
+            while (NumBits < Width)
+            {
+                Bits |= (uint64_t)*pIn++ << NumBits;
+                NumBits += 8;
+            }
+
+            pLine[Start + i] = UnZigZag((UINT32)Bits & Mask) + Predict(Mode, pLine, pUp, pPrevious, Start + i);
+            Bits >>= Width;
+            NumBits -= Width;
+        }
+    }
+
+    return pIn;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofDecodeFrame(const UINT8* pIn, size_t InBytes, const UINT32* pReference,
+                        UINT32* pFrame, UINT32 Words)
+{
+    TofCodecHeader Header;
+    const UINT8* pEnd = pIn + InBytes;
+    UINT32 Count;
+
+
+    if ((pIn == NULL) || (pFrame == NULL) || (InBytes < sizeof(TofCodecHeader)))
+    {
+        return eINVALID_ARG;
+    }
+
+    memcpy(&Header, pIn, sizeof(Header));
+    pIn += sizeof(Header);
+
+    if ((Header.Magic != TOF_CODEC_MAGIC) || (Header.LineWords == 0))
+    {
+        return eFRAME_ERROR;
+    }
+
+    if (Header.Words != Words)
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((Header.Flags & TOF_CODEC_FLAG_INTER) && (pReference == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    for (UINT32 Start = 0; Start < Words; Start += Header.LineWords)
+    {
+        Count = (Words - Start < Header.LineWords) ? (Words - Start) : Header.LineWords;
+
+        pIn = DecodeLine(pIn, pEnd,
+                         (Start == 0) ? NULL : (pFrame + Start - Header.LineWords),
+                         (pReference == NULL) ? NULL : (pReference + Start),
+                         Count, pFrame + Start);
+
+        if (pIn == NULL)
+        {
+            return eFRAME_ERROR;
+        }
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Runs Work(i) for i = 0 .. Count - 1 on up to Threads threads, each thread
+//  taking the next index as it finishes one. Returns the first failure.
+// ****************************************************************************
+
+template<typename WorkFn>
+static PICOP_RC RunParallel(UINT32 Count, UINT32 Threads, WorkFn Work)
+{
+    std::atomic<UINT32> Next(0);
+    std::atomic<int> Result((int)eSUCCESS);
+    std::vector<std::thread> Workers;
+
+
+    auto Worker = [&]()
+    {
+        UINT32 Index;
+        PICOP_RC rc;
+
+
+        while ((Index = Next++) < Count)
+        {
+            rc = Work(Index);
+
+            if (rc != eSUCCESS)
+            {
+                Result = (int)rc;
+            }
+        }
+    };
+
+    if (Threads == 0)
+    {
+        Threads = std::thread::hardware_concurrency();
+    }
+
+    Threads = (Threads > Count) ? Count : Threads;
+
+    for (UINT32 i = 1; i < Threads; i++)
+    {
+        Workers.push_back(std::thread(Worker));
+    }
+
+    Worker();
+
+    for (size_t i = 0; i < Workers.size(); i++)
+    {
+        Workers[i].join();
+    }
+
+    return (PICOP_RC)Result.load();
+}
+
+// ****************************************************************************
+
+PICOP_RC TofEncodeFrames(const UINT32* pFrames, UINT32 FrameCount, UINT32 FrameWords, UINT32 LineWords,
+                         UINT32 KeyInterval, UINT32 Threads, std::vector<std::vector<UINT8> >* pEncoded)
+{
+    size_t MaxBytes = TofCodecMaxBytes(FrameWords, LineWords);
+
+
+    if ((pFrames == NULL) || (pEncoded == NULL) || (MaxBytes == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    KeyInterval = (KeyInterval == 0) ? 1 : KeyInterval;
+    pEncoded->resize(FrameCount);
+
+    // The encoder has every raw frame, so inter frames don't wait on each other
+    return RunParallel(FrameCount, Threads, [&](UINT32 Index) -> PICOP_RC
+    {
+        std::vector<UINT8>& Out = (*pEncoded)[Index];
+        const UINT32* pFrame = pFrames + (size_t)Index * FrameWords;
+        size_t Bytes = 0;
+        PICOP_RC rc;
+
+
+        Out.resize(MaxBytes);
+        rc = TofEncodeFrame(pFrame, ((Index % KeyInterval) == 0) ? NULL : (pFrame - FrameWords),
+                            FrameWords, LineWords, &Out[0], Out.size(), &Bytes);
+        Out.resize(Bytes);
+
+        return rc;
+    });
+}
+
+// ****************************************************************************
+
+PICOP_RC TofDecodeFrames(const std::vector<std::vector<UINT8> >& Encoded, UINT32 KeyInterval, UINT32 Threads,
+                         UINT32* pFrames, UINT32 FrameWords)
+{
+    UINT32 FrameCount = (UINT32)Encoded.size();
+    UINT32 Runs;
+
+
+    if ((pFrames == NULL) || (FrameWords == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    KeyInterval = (KeyInterval == 0) ? 1 : KeyInterval;
+    Runs = (FrameCount + KeyInterval - 1) / KeyInterval;
+
+    // Each run starts at a key frame and decodes in order
+    return RunParallel(Runs, Threads, [&](UINT32 Run) -> PICOP_RC
+    {
+        UINT32 First = Run * KeyInterval;
+        UINT32 Last = (First + KeyInterval < FrameCount) ? (First + KeyInterval) : FrameCount;
+        UINT32* pFrame;
+        PICOP_RC rc;
+
+
+        for (UINT32 Index = First; Index < Last; Index++)
+        {
+            pFrame = pFrames + (size_t)Index * FrameWords;
+
+            if (Encoded[Index].empty())
+            {
+                return eFRAME_ERROR;
+            }
+
+            rc = TofDecodeFrame(&Encoded[Index][0], Encoded[Index].size(),
+                                (Index == First) ? NULL : (pFrame - FrameWords), pFrame, FrameWords);
+
+            if (rc != eSUCCESS)
+            {
+                return rc;
+            }
+        }
+
+        return eSUCCESS;
+    });
+}
+
+// ****************************************************************************
@@ -0,0 +1,86 @@
+// ****************************************************************************
+//  TofCodec.h
+//
+// Lossless compression of ToF frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+// Frames are coded a line (LineWords words) at a time. Each line picks the
+// predictor that leaves the smallest residuals:
+//
+//   none      the value itself
+//   left      the previous word on the line
+//   up        the same word on the line above
+//   previous  the same word in the reference (previous) frame
+//
+// Residuals are zigzag mapped so small negative and positive differences
+// both become small numbers, then packed in blocks of TOF_CODEC_BLOCK words,
+// each block at the bit width of its largest residual. Time and amplitude
+// words rarely use more than 12 - 16 of their 32 bits, and neighbouring
+// pulses are close, so most blocks pack to a few bits per word.
+//
+// A frame coded without a reference (a key frame) decodes on its own; one
+// coded against the previous frame needs that frame to decode.
+// ****************************************************************************
+
+#define TOF_CODEC_MAGIC         0x5a434654      // "TFCZ"
+#define TOF_CODEC_BLOCK         32
+#define TOF_CODEC_FLAG_INTER    0x00000001      // Decoding needs the reference frame
+
+typedef struct
+{
+    UINT32 Magic;                       // TOF_CODEC_MAGIC
+    UINT32 Words;                       // Words in the decoded frame
+    UINT32 LineWords;
+    UINT32 Flags;
+} TofCodecHeader;
+
+typedef enum
+{
+    eTOF_PREDICT_NONE = 0,
+    eTOF_PREDICT_LEFT,
+    eTOF_PREDICT_UP,
+    eTOF_PREDICT_PREVIOUS,
+    eTOF_PREDICT_COUNT
+} TofPredictorE;
+
+// ****************************************************************************
+
+// Largest encoded size of a Words word frame, for sizing output buffers
+size_t TofCodecMaxBytes(UINT32 Words, UINT32 LineWords);
+
+// pReference is the previous frame, or NULL for a key frame
+PICOP_RC TofEncodeFrame(const UINT32* pFrame, const UINT32* pReference, UINT32 Words, UINT32 LineWords,
+                        UINT8* pOut, size_t OutCapacity, size_t* pOutBytes);
+
+PICOP_RC TofDecodeFrame(const UINT8* pIn, size_t InBytes, const UINT32* pReference,
+                        UINT32* pFrame, UINT32 Words);
+
+// ****************************************************************************
+// Batch coding on several threads. Frames are FrameWords apart in pFrames;
+// every KeyInterval-th frame is a key frame, the rest are coded against the
+// frame before them. Encoding splits the batch by frame, decoding by run of
+// frames starting at a key frame.
+// ****************************************************************************
+
+PICOP_RC TofEncodeFrames(const UINT32* pFrames, UINT32 FrameCount, UINT32 FrameWords, UINT32 LineWords,
+                         UINT32 KeyInterval, UINT32 Threads, std::vector<std::vector<UINT8> >* pEncoded);
+
+PICOP_RC TofDecodeFrames(const std::vector<std::vector<UINT8> >& Encoded, UINT32 KeyInterval, UINT32 Threads,
+                         UINT32* pFrames, UINT32 FrameWords);
+
+// ****************************************************************************
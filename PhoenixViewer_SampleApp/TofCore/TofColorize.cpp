@@ -0,0 +1,265 @@
+// ****************************************************************************
+//  TofColorize.cpp
+//
+// Converts a time or amplitude plane into a 24 bit (BGR) bitmap
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include <math.h>
+#include "TofColorize.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+void TofNarrowLowByteScalar(const UINT32* pSource, UINT8* pDestination, UINT32 Count)
+{
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        pDestination[i] = (UINT8)(pSource[i] & 0x000000ff);
+    }
+}
+
+// ****************************************************************************
+
+void TofNarrowLowByte(const UINT32* pSource, UINT8* pDestination, UINT32 Count)
+{
+    UINT32 i = 0;
+
+#if defined(TOF_SIMD_AVX2)
+    const __m256i Mask = _mm256_set1_epi32(0xff);
+    const __m256i Order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    for (; (i + 32) <= Count; i += 32)
+    {
+        __m256i A = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pSource + i)), Mask);
+        __m256i B = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pSource + i + 8)), Mask);
+        __m256i C = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pSource + i + 16)), Mask);
+        __m256i D = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pSource + i + 24)), Mask);
+
+        // The packs work per 128 bit lane, the permute puts the words back in order
+        __m256i Packed = _mm256_packus_epi16(_mm256_packs_epi32(A, B), _mm256_packs_epi32(C, D));
+        _mm256_storeu_si256((__m256i*)(pDestination + i), _mm256_permutevar8x32_epi32(Packed, Order));
+    }
+#endif
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i Mask128 = _mm_set1_epi32(0xff);
+
+    for (; (i + 16) <= Count; i += 16)
+    {
+        __m128i A = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pSource + i)), Mask128);
+        __m128i B = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pSource + i + 4)), Mask128);
+        __m128i C = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pSource + i + 8)), Mask128);
+        __m128i D = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pSource + i + 12)), Mask128);
+
+        __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(A, B), _mm_packs_epi32(C, D));
+        _mm_storeu_si128((__m128i*)(pDestination + i), Packed);
+    }
+#endif
+
+    TofNarrowLowByteScalar(pSource + i, pDestination + i, Count - i);
+}
+
+// ****************************************************************************
+
+TofColorizer::TofColorizer()
+    : mNumPulses(0),
+      mNumLines(0),
+      mBitmapStride(0),
+      mContiguous(FALSE),
+      mExpandLine(&TofColorizer::ExpandScattered)
+{
+    SetPalette(eTOF_PALETTE_GRAY);
+}
+
+// ****************************************************************************
+//  Builds the row and column tables. BitmapStride is the byte length of one
+//  bitmap row. The image occupies columns OffsetX .. OffsetX + ImageWidth - 1
+//  and rows 0 .. ImageHeight.
+// ****************************************************************************
+
+PICOP_RC TofColorizer::Create(UINT32 NumPulses, UINT32 NumLines,
+                              UINT32 BitmapWidth, UINT32 BitmapHeight, UINT32 BitmapStride,
+                              UINT32 OffsetX, UINT32 ImageWidth, UINT32 ImageHeight)
+{
+    UINT32 Row;
+
+
+    if ((NumPulses == 0) || (NumLines == 0) || (ImageWidth == 0) ||
+        ((OffsetX + ImageWidth) > BitmapWidth) ||
+        (ImageHeight >= BitmapHeight) ||
+        (BitmapStride < (BitmapWidth * TOF_BYTES_PER_PIXEL)))
+    {
+        return eINVALID_ARG;
+    }
+
+    mNumPulses = NumPulses;
+    mNumLines = NumLines;
+    mBitmapStride = BitmapStride;
+    mContiguous = (ImageWidth == NumPulses);
+
+    // When several lines fall on the same row the last one drawn wins
+    mRowSource.assign(ImageHeight + 1, -1);
+
+    for (UINT32 Line = 0; Line < NumLines; Line++)
+    {
+        Row = ((NumLines - Line) * ImageHeight) / NumLines;
+        mRowSource[Row] = (INT32)Line;
+    }
+
+    mColumnOffset.resize(NumPulses);
+
+    for (UINT32 Pulse = 0; Pulse < NumPulses; Pulse++)
+    {
+        mColumnOffset[Pulse] = (OffsetX + (Pulse * ImageWidth) / NumPulses) * TOF_BYTES_PER_PIXEL;
+    }
+
+    mLine.resize(NumPulses);
+
+    mExpandLine = mContiguous ? &TofColorizer::ExpandContiguous : &TofColorizer::ExpandScattered;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofColorizer::SetPalette(TofPaletteE Palette)
+{
+    UINT32 Red;
+    UINT32 Green;
+    UINT32 Blue;
+    double T;
+
+
+    for (UINT32 Value = 0; Value < 256; Value++)
+    {
+        switch (Palette)
+        {
+        case eTOF_PALETTE_YELLOW:
+            Red = Value;
+            Green = Value;
+            Blue = 0;
+            break;
+
+        case eTOF_PALETTE_FALSE_COLOR:
+            // Piecewise linear blue - cyan - yellow - red ramp
+            T = Value / 255.0;
+            Red = (UINT32)(255.0 * fmin(fmax(1.5 - fabs(4.0 * T - 3.0), 0.0), 1.0));
+            Green = (UINT32)(255.0 * fmin(fmax(1.5 - fabs(4.0 * T - 2.0), 0.0), 1.0));
+            Blue = (UINT32)(255.0 * fmin(fmax(1.5 - fabs(4.0 * T - 1.0), 0.0), 1.0));
+            break;
+
+        case eTOF_PALETTE_GRAY:
+        default:
+            Red = Value;
+            Green = Value;
+            Blue = Value;
+            break;
+        }
+
+        mPalette[Value] = (Red << 16) | (Green << 8) | Blue;
+    }
+}
+
+// ****************************************************************************
+//  Looks each byte up in the palette and stores it as blue, green, red.
+//  Adjacent pixels are stored four bytes at a time, the fourth is overwritten
+//  by the next pixel; the last pixel is stored bytewise so nothing past the
+//  image is touched.
+// ****************************************************************************
+
+void TofColorizer::ExpandContiguous(const UINT8* pIndices, UINT8* pRow) const
+{
+    UINT32 Color;
+    UINT32 Last = mNumPulses - 1;
+    UINT8* pPixel = pRow + mColumnOffset[0];
+
+
+    for (UINT32 Pulse = 0; Pulse < Last; Pulse++)
+    {
+        Color = mPalette[pIndices[Pulse]];
+        memcpy(pPixel, &Color, sizeof(Color));
+        pPixel += TOF_BYTES_PER_PIXEL;
+    }
+
+    Color = mPalette[pIndices[Last]];
+    pPixel[0] = (UINT8)Color;
+    pPixel[1] = (UINT8)(Color >> 8);
+    pPixel[2] = (UINT8)(Color >> 16);
+}
+
+// ****************************************************************************
+//  Image narrower or wider than the line: every pulse goes through the
+//  column table
+// ****************************************************************************
+
+void TofColorizer::ExpandScattered(const UINT8* pIndices, UINT8* pRow) const
+{
+    UINT32 Color;
+    UINT8* pPixel;
+
+
+    for (UINT32 Pulse = 0; Pulse < mNumPulses; Pulse++)
+    {
+        Color = mPalette[pIndices[Pulse]];
+        pPixel = pRow + mColumnOffset[Pulse];
+        pPixel[0] = (UINT8)Color;
+        pPixel[1] = (UINT8)(Color >> 8);
+        pPixel[2] = (UINT8)(Color >> 16);
+    }
+}
+
+// ****************************************************************************
+//  Draws the low byte of each word of pPlane through the palette
+// ****************************************************************************
+
+void TofColorizer::Colorize(const UINT32* pPlane, UINT8* pBitmap)
+{
+    INT32 Line;
+
+
+    for (size_t Row = 0; Row < mRowSource.size(); Row++)
+    {
+        Line = mRowSource[Row];
+
+        if (Line < 0)
+        {
+            continue;
+        }
+
+        TofNarrowLowByte(pPlane + (size_t)Line * mNumPulses, &mLine[0], mNumPulses);
+        (this->*mExpandLine)(&mLine[0], pBitmap + Row * mBitmapStride);
+    }
+}
+
+// ****************************************************************************
+//  Draws an already 8 bit plane (e.g. from TofNormalizer) through the palette
+// ****************************************************************************
+
+void TofColorizer::ColorizeNarrowed(const UINT8* pPlane, UINT8* pBitmap)
+{
+    INT32 Line;
+
+
+    for (size_t Row = 0; Row < mRowSource.size(); Row++)
+    {
+        Line = mRowSource[Row];
+
+        if (Line < 0)
+        {
+            continue;
+        }
+
+        (this->*mExpandLine)(pPlane + (size_t)Line * mNumPulses, pBitmap + Row * mBitmapStride);
+    }
+}
+
+// ****************************************************************************
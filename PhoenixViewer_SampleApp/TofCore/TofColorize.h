@@ -0,0 +1,81 @@
+// ****************************************************************************
+//  TofColorize.h
+//
+// Converts a time or amplitude plane into a 24 bit (BGR) bitmap
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <vector>
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+
+#define TOF_BYTES_PER_PIXEL     3       // Blue, green, red
+
+typedef enum
+{
+    eTOF_PALETTE_GRAY = 0,              // Gray scale
+    eTOF_PALETTE_YELLOW,                // Green + red, blue off
+    eTOF_PALETTE_FALSE_COLOR            // Blue (low) through red (high)
+} TofPaletteE;
+
+// ****************************************************************************
+// Narrows each word to its low byte, vectorized where TofSimd.h allows
+// ****************************************************************************
+
+void TofNarrowLowByte(const UINT32* pSource, UINT8* pDestination, UINT32 Count);
+void TofNarrowLowByteScalar(const UINT32* pSource, UINT8* pDestination, UINT32 Count);
+
+// ****************************************************************************
+// Draws a NumLines x NumPulses plane into an ImageWidth x ImageHeight area of
+// a bottom-up 24 bit bitmap, with line 0 at the top of the image. Which source
+// line lands on which bitmap row, and where each pulse lands within a row, is
+// worked out once in Create() so the per-frame work is a table walk with no
+// divides. Bitmap rows that no line maps to are left untouched.
+//
+// Create() also picks the line expander: a line drawn one pulse per pixel
+// is stored a word at a time, a scaled one goes through the column table.
+// ****************************************************************************
+
+class TofColorizer
+{
+public:
+    TofColorizer();
+
+    PICOP_RC Create(UINT32 NumPulses, UINT32 NumLines,
+                    UINT32 BitmapWidth, UINT32 BitmapHeight, UINT32 BitmapStride,
+                    UINT32 OffsetX, UINT32 ImageWidth, UINT32 ImageHeight);
+
+    void SetPalette(TofPaletteE Palette);
+
+    void Colorize(const UINT32* pPlane, UINT8* pBitmap);
+    void ColorizeNarrowed(const UINT8* pPlane, UINT8* pBitmap);
+
+private:
+    typedef void (TofColorizer::*ExpandLineFn)(const UINT8* pIndices, UINT8* pRow) const;
+
+    void ExpandContiguous(const UINT8* pIndices, UINT8* pRow) const;
+    void ExpandScattered(const UINT8* pIndices, UINT8* pRow) const;
+
+    UINT32 mNumPulses;
+    UINT32 mNumLines;
+    UINT32 mBitmapStride;
+    BOOL mContiguous;                       // Pulses land on adjacent pixels
+    ExpandLineFn mExpandLine;
+
+    std::vector<INT32> mRowSource;          // Source line per bitmap row, -1 for none
+    std::vector<UINT32> mColumnOffset;      // Byte offset within a row per pulse
+    std::vector<UINT8> mLine;               // One narrowed line
+    UINT32 mPalette[256];                   // 0x00RRGGBB
+};
+
+// ****************************************************************************
@@ -0,0 +1,51 @@
+// ****************************************************************************
+//  TofCore.h
+//
+// Platform independent ToF frame processing library
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+// ****************************************************************************
+// Everything in TofCore builds against the PicoP_TLC headers and the C++
+// standard library only; Windows specific code (the GDI renderer) stays in
+// the viewer.
+// ****************************************************************************
+
+#include "TofMemory.h"
+#include "TofGeometry.h"
+#include "TofFrameView.h"
+#include "TofFrame.h"
+#include "TofFrameRing.h"
+#include "TofFramePool.h"
+#include "TofFrameDecoder.h"
+#include "TofAcquisition.h"
+#include "TofFormatController.h"
+#include "TofDOutBGovernor.h"
+#include "TofPhaseAssembler.h"
+#include "TofNormalize.h"
+#include "TofColorize.h"
+#include "TofRenderer.h"
+#include "TofPointCloud.h"
+#include "TofRayTableCache.h"
+#include "TofProjector.h"
+#include "TofLzf.h"
+#include "TofCloudWriter.h"
+#include "TofCodec.h"
+#include "TofRecording.h"
+#include "TofBoundedQueue.h"
+#include "TofPipeline.h"
+#include "TofTemporalFilter.h"
+#include "TofSpatialFilter.h"
+#include "TofValidMask.h"
+#include "TofFusion.h"
+
+// ****************************************************************************
@@ -0,0 +1,410 @@
+// ****************************************************************************
+//  TofDOutBGovernor.cpp
+//
+// Closed loop control of the TDC B data scale
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <string.h>
+#include "TofDOutBGovernor.h"
+#include "TofFrameDecoder.h"
+
+// ****************************************************************************
+
+void TofDefaultDOutBGovernorParams(TofDOutBGovernorParams* pParams)
+{
+    pParams->TargetFps = 30.0f;
+    pParams->Tolerance = 0.05f;
+    pParams->BudgetBytesPerSecond = 0;
+    pParams->WindowMs = 1000;
+    pParams->MinScale = DOUTB_SCALE_MAX / 16;
+    pParams->StepDown = DOUTB_SCALE_MAX / 16;
+    pParams->StepUp = DOUTB_SCALE_MAX / 16;
+    pParams->HoldWindows = 10;
+    pParams->MaxHoldWindows = 60;
+    pParams->MinAmplitude = 16;
+    pParams->MinUseful = 0.2f;
+}
+
+// ****************************************************************************
+
+TofDOutBGovernor::TofDOutBGovernor()
+    : mScale(DOUTB_SCALE_MAX),
+      mApplied(DOUTB_SCALE_MAX),
+      mWindowFrames(0),
+      mWindowStarted(FALSE),
+      mSamples(0),
+      mReturns(0),
+      mFilledIn(0),
+      mPixels(0),
+      mHealthyRun(0),
+      mHoldWindows(0),
+      mRetrying(FALSE),
+      mStepping(FALSE),
+      mStepFrom(DOUTB_SCALE_MAX),
+      mStepFps(0.0f),
+      mHeldFps(0.0f)
+{
+    TofDefaultDOutBGovernorParams(&mParams);
+    memset(&mGeometry, 0, sizeof(mGeometry));
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+// ****************************************************************************
+
+PICOP_RC TofDOutBGovernor::Create(const TofDOutBGovernorParams* pParams, const TofFrameGeometry* pGeometry,
+                                  UINT32 Scale)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if ((pParams == NULL) || (pGeometry == NULL) || (pGeometry->PlaneWords == 0) ||
+        (TofPlanesPerFrame(pGeometry->Format) == 0) || (Scale > DOUTB_SCALE_MAX) ||
+        ( ! (pParams->TargetFps > 0.0f)) || (pParams->Tolerance < 0.0f) || (pParams->WindowMs == 0) ||
+        (pParams->MinScale > DOUTB_SCALE_MAX) || (pParams->StepDown == 0) || (pParams->StepUp == 0) ||
+        (pParams->HoldWindows == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (TofTdcBPlanesPerFrame(pGeometry->Format) == 0)
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    mParams = *pParams;
+    mParams.MaxHoldWindows = (mParams.MaxHoldWindows < mParams.HoldWindows) ? mParams.HoldWindows :
+                             mParams.MaxHoldWindows;
+    mGeometry = *pGeometry;
+    mScale = Scale;
+    mApplied = Scale;
+    memset(&mStats, 0, sizeof(mStats));
+    mStats.BudgetScale = ScaleForBudget();
+    mStats.ShortScale = TOF_DOUTB_NO_SHORT_SCALE;
+    mWindowStarted = FALSE;
+    mSamples = 0;
+    mReturns = 0;
+    mFilledIn = 0;
+    mPixels = 0;
+    mHealthyRun = 0;
+    mHoldWindows = mParams.HoldWindows;
+    mRetrying = FALSE;
+    mStepping = FALSE;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Highest scale whose TDC B readout at the target frame rate fits the budget
+// ****************************************************************************
+
+UINT32 TofDOutBGovernor::ScaleForBudget() const
+{
+    FP32 Full = mParams.TargetFps * TofTdcBReadBytes(mGeometry.PlaneWords, DOUTB_SCALE_MAX);
+    FP32 Scale;
+
+
+    if ((mParams.BudgetBytesPerSecond == 0) || ( ! (Full > 0.0f)))
+    {
+        return DOUTB_SCALE_MAX;
+    }
+
+    Scale = (mParams.BudgetBytesPerSecond * (FP32)DOUTB_SCALE_MAX) / Full;
+
+    return (Scale >= DOUTB_SCALE_MAX) ? DOUTB_SCALE_MAX : (UINT32)Scale;
+}
+
+void TofDOutBGovernor::StartWindow(TofClock::time_point Now, UINT32 FramesReceived)
+{
+    mWindowStart = Now;
+    mWindowFrames = FramesReceived;
+    mWindowStarted = TRUE;
+    mSamples = 0;
+    mReturns = 0;
+    mFilledIn = 0;
+    mPixels = 0;
+}
+
+// ****************************************************************************
+//  Without a left plane of the same kind every TDC B return counts as filled
+//  in. Depth only frames have no amplitude, any time counts as a return.
+// ****************************************************************************
+
+PICOP_RC TofDOutBGovernor::MeasureFrame(const UINT32* pData, UINT32 FrameWords)
+{
+    TofFramePlanes Planes;
+    const UINT32* pRight;
+    const UINT32* pLeft;
+    UINT32 Threshold;
+    uint64_t Returns = 0;
+    uint64_t FilledIn = 0;
+    PICOP_RC PicopRc;
+
+
+    if (mGeometry.PlaneWords == 0)
+    {
+        return eUNINITIALIZED;
+    }
+
+    PicopRc = TofMakeFramePlanes(pData, FrameWords, mGeometry.NumPulses, mGeometry.NumLines, mGeometry.Format, &Planes);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    pRight = Planes.pPlane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_AMPLITUDE];
+    pLeft = Planes.pPlane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_AMPLITUDE];
+    Threshold = (mParams.MinAmplitude == 0) ? 1 : mParams.MinAmplitude;
+
+    if (pRight == NULL)
+    {
+        pRight = Planes.pPlane[eTOF_DETECTOR_RIGHT][eTOF_CHANNEL_TIME];
+        pLeft = Planes.pPlane[eTOF_DETECTOR_LEFT][eTOF_CHANNEL_TIME];
+        Threshold = 1;
+    }
+
+    if (pRight == NULL)
+    {
+        return eSUCCESS;
+    }
+
+    for (UINT32 i = 0; i < mGeometry.PlaneWords; i++)
+    {
+        UINT32 Right = (pRight[i] >= Threshold) ? 1 : 0;
+        UINT32 Left = (pLeft != NULL) && (pLeft[i] >= Threshold) ? 1 : 0;
+
+        Returns += Right;
+        FilledIn += Right & (Left ^ 1);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+        mSamples += ((uint64_t)mGeometry.PlaneWords * mApplied) / DOUTB_SCALE_MAX;
+        mReturns += Returns;
+        mFilledIn += FilledIn;
+        mPixels += mGeometry.PlaneWords;
+        mStats.FramesMeasured++;
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Only does anything at the end of a window
+// ****************************************************************************
+
+BOOL TofDOutBGovernor::Update(TofClock::time_point Now, UINT32 FramesReceived)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+    FP32 Seconds;
+    FP32 Fps;
+    FP32 Margin;
+    FP32 Proportional;
+    BOOL Short;
+    BOOL Wasted;
+    UINT32 Ceiling;
+    UINT32 Scale;
+
+
+    if (mGeometry.PlaneWords == 0)
+    {
+        return FALSE;
+    }
+
+    // Nothing is measured at a scale not yet applied
+    if (mScale != mApplied)
+    {
+        return TRUE;
+    }
+
+    if (( ! mWindowStarted) || (FramesReceived < mWindowFrames))
+    {
+        StartWindow(Now, FramesReceived);
+        return FALSE;
+    }
+
+    Seconds = std::chrono::duration<FP32>(Now - mWindowStart).count();
+
+    if (Seconds < (mParams.WindowMs / 1000.0f))
+    {
+        return FALSE;
+    }
+
+    Fps = (FramesReceived - mWindowFrames) / Seconds;
+    Short = (Fps < (mParams.TargetFps * (1.0f - mParams.Tolerance)));
+    Wasted = FALSE;
+
+    // More than the count of a window moves by on its own
+    Margin = ((Fps * mParams.Tolerance) > (2.0f / Seconds)) ? (Fps * mParams.Tolerance) : (2.0f / Seconds);
+
+    if (mSamples != 0)
+    {
+        mStats.Useful = (FP32)mReturns / mSamples;
+        mStats.FilledIn = (FP32)mFilledIn / mPixels;
+        Wasted = (mStats.Useful < mParams.MinUseful);
+    }
+
+    StartWindow(Now, FramesReceived);
+
+    mStats.Windows++;
+    mStats.LastFps = Fps;
+    mStats.Throughput = Fps * mGeometry.FrameBytes;
+    Scale = mApplied;
+
+    // Until the frame rate recovers or the link carries a different rate
+    if (mStats.Held && (( ! Short) || (fabsf(Fps - mHeldFps) > Margin)))
+    {
+        mStats.Held = FALSE;
+    }
+
+    if (Short && ( ! mStats.Held) && mStepping)
+    {
+        if (Fps > (mStepFps + Margin))
+        {
+            // The steps so far raised the rate, judge the next ones from here
+            mStepFrom = mApplied;
+            mStepFps = Fps;
+        }
+        else if (((uint64_t)mApplied * 3) <= ((uint64_t)mStepFrom * 2))
+        {
+            // Down by a third for nothing: the readout is not the limit
+            mStats.FailedStepsDown++;
+            mStats.Held = TRUE;
+            mStats.ShortScale = TOF_DOUTB_NO_SHORT_SCALE;
+            mHeldFps = Fps;
+            mStepping = FALSE;
+            Scale = mStepFrom;
+        }
+    }
+
+    if (Short)
+    {
+        mStats.ShortWindows++;
+        mHealthyRun = 0;
+
+        if (( ! mStats.Held) && (mApplied > 0))
+        {
+            if ( ! mStepping)
+            {
+                mStepping = TRUE;
+                mStepFrom = mApplied;
+                mStepFps = Fps;
+            }
+
+            if (mRetrying)
+            {
+                mHoldWindows = ((mHoldWindows * 2) > mParams.MaxHoldWindows) ? mParams.MaxHoldWindows :
+                               (mHoldWindows * 2);
+                mRetrying = FALSE;
+            }
+
+            Proportional = (mApplied * Fps) / mParams.TargetFps;
+            Scale = (mApplied > mParams.StepDown) ? (mApplied - mParams.StepDown) : 0;
+            Scale = (Proportional < Scale) ? (UINT32)Proportional : Scale;
+
+            mStats.ShortScale = mApplied;
+            mStats.StepsDown++;
+        }
+    }
+    else
+    {
+        mStepping = FALSE;
+        mHealthyRun++;
+
+        // The last retry has held, the next one need not wait any longer
+        if (mRetrying && (mHealthyRun >= mParams.HoldWindows))
+        {
+            mRetrying = FALSE;
+            mHoldWindows = mParams.HoldWindows;
+        }
+
+        if ((mStats.ShortScale != TOF_DOUTB_NO_SHORT_SCALE) && (mHealthyRun >= mHoldWindows))
+        {
+            mStats.ShortScale = TOF_DOUTB_NO_SHORT_SCALE;
+            mRetrying = TRUE;
+            mHealthyRun = 0;
+        }
+
+        Ceiling = DOUTB_SCALE_MAX;
+
+        if (mStats.ShortScale != TOF_DOUTB_NO_SHORT_SCALE)
+        {
+            Ceiling = (mStats.ShortScale > TOF_DOUTB_SCALE_QUANTUM) ? (mStats.ShortScale - TOF_DOUTB_SCALE_QUANTUM) : 0;
+        }
+
+        Scale = mApplied + mParams.StepUp;
+        Scale = (Scale < Ceiling) ? Scale : ((Ceiling > mApplied) ? Ceiling : mApplied);
+    }
+
+    mStats.BudgetScale = ScaleForBudget();
+    Scale = (Scale < mStats.BudgetScale) ? Scale : mStats.BudgetScale;
+
+    if (Wasted)
+    {
+        Scale = (mParams.MinScale < mStats.BudgetScale) ? mParams.MinScale : mStats.BudgetScale;
+    }
+
+    mScale = (Scale >= DOUTB_SCALE_MAX) ? DOUTB_SCALE_MAX : ((Scale / TOF_DOUTB_SCALE_QUANTUM) * TOF_DOUTB_SCALE_QUANTUM);
+
+    return (mScale != mApplied);
+}
+
+// ****************************************************************************
+
+PICOP_RC TofDOutBGovernor::Apply(PicoP_HANDLE ConnectionHandle)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+    PICOP_RC PicopRc;
+
+
+    if (mGeometry.PlaneWords == 0)
+    {
+        return eUNINITIALIZED;
+    }
+
+    PicopRc = PicoP_TLC_SetDOutBScale(ConnectionHandle, mScale, FALSE);
+
+    if (PicopRc != eSUCCESS)
+    {
+        mScale = mApplied;
+        return PicopRc;
+    }
+
+    mStats.Changes += (mScale != mApplied) ? 1 : 0;
+    mApplied = mScale;
+
+    // Frames already on their way were sent at the old scale
+    mWindowStarted = FALSE;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+UINT32 TofDOutBGovernor::GetScale()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mScale;
+}
+
+void TofDOutBGovernor::GetStats(TofDOutBGovernorStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pStats = mStats;
+}
+
+// ****************************************************************************
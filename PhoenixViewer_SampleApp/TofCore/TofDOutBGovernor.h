@@ -0,0 +1,155 @@
+// ****************************************************************************
+//  TofDOutBGovernor.h
+//
+// Closed loop control of the TDC B data scale
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include "PicoP_TLC_Api.h"
+#include "TofFrameRing.h"
+#include "TofGeometry.h"
+
+// ****************************************************************************
+// PicoP_TLC_SetDOutBScale reads TDC B (the right detector) for only
+// DOutBScale / DOUTB_SCALE_MAX of the pixels. The frame sent is the same
+// size at any scale, so the scale saves nothing on the link; what it saves
+// is the TDC B readout in the device (TofTdcBReadBytes), which may be what
+// limits the frame rate. The governor keeps the scale as high as it can
+// while holding TargetFps, from what it measures rather than a model of the
+// device:
+//
+//  - Frame rate: every WindowMs it works out the frame rate and the bytes
+//    per second the link carried. A window short of the target lowers the
+//    scale in proportion to the shortfall, by at least StepDown. A rate
+//    changes by a frame a window on its own, so the steps are judged over
+//    the run of short windows: once the scale is down by a third without
+//    the rate rising by more than two frames a window (or Tolerance), the
+//    limit is the link or the host. The scale goes back and is held until
+//    the frame rate recovers or moves by as much again.
+//  - Healthy windows raise the scale by StepUp, up to just below the last
+//    scale that fell short. After HoldWindows healthy windows that scale is
+//    tried again; each try that falls short doubles the wait, up to
+//    MaxHoldWindows.
+//  - Budget: the TDC B readout at TargetFps never exceeds
+//    BudgetBytesPerSecond.
+//  - Quality: MeasureFrame() counts how many of the TDC B samples read hold
+//    a return of at least MinAmplitude, and the pixels only TDC B returned
+//    from. When fewer than MinUseful of the samples hold a return, reading
+//    them only costs readout time, and the scale drops to MinScale, not
+//    lower, so the returns can still be measured.
+//
+// Only formats carrying a TDC B plane are governed. The fused format and
+// the left detector alone are refused: TDC B is not seen on its own, so the
+// returns the scale trades cannot be measured. Alongside a
+// TofFormatController, give its levels TOF_DOUTB_NO_SCALE so its switches
+// leave the scale to the governor, and after it switches the format,
+// Create() the governor again for the new one. The scale moves in steps of
+// TOF_DOUTB_SCALE_QUANTUM, and the frame size does not change, so Apply()
+// needs no restart of the acquisition. MeasureFrame() may be called on the
+// acquisition thread while another thread calls Update().
+// ****************************************************************************
+
+#define TOF_DOUTB_SCALE_QUANTUM     (DOUTB_SCALE_MAX / 64)
+#define TOF_DOUTB_NO_SHORT_SCALE    (DOUTB_SCALE_MAX + 1)
+
+typedef struct
+{
+    FP32 TargetFps;
+    FP32 Tolerance;                     // Fraction of TargetFps a window may fall short by
+    UINT32 BudgetBytesPerSecond;        // TDC B readout, 0 for none
+    UINT32 WindowMs;
+    UINT32 MinScale;
+    UINT32 StepDown;                    // Least a short window lowers the scale by
+    UINT32 StepUp;
+    UINT32 HoldWindows;
+    UINT32 MaxHoldWindows;
+    UINT32 MinAmplitude;
+    FP32 MinUseful;
+} TofDOutBGovernorParams;
+
+typedef struct
+{
+    uint64_t Windows;
+    uint64_t ShortWindows;
+    uint64_t StepsDown;
+    uint64_t FailedStepsDown;           // Did not raise the frame rate
+    uint64_t Changes;                   // Of the scale
+    uint64_t FramesMeasured;
+    FP32 LastFps;
+    FP32 Throughput;                    // Bytes per second the link carried in the last window
+    FP32 Useful;                        // Of the TDC B samples read, the fraction holding a return
+    FP32 FilledIn;                      // Of the pixels, the fraction only TDC B returned from
+    UINT32 BudgetScale;                 // Most the budget allows
+    UINT32 ShortScale;                  // Last scale short of the target, TOF_DOUTB_NO_SHORT_SCALE once retried
+    BOOL Held;                          // The scale is not what limits the frame rate
+} TofDOutBGovernorStats;
+
+// 30 fps, no budget, MinScale MAX / 16
+void TofDefaultDOutBGovernorParams(TofDOutBGovernorParams* pParams);
+
+// ****************************************************************************
+
+class TofDOutBGovernor
+{
+public:
+    TofDOutBGovernor();
+
+    // Scale is the one the device uses now. A format without a TDC B plane
+    // gives eNOT_SUPPORTED_DATA_FORMAT.
+    PICOP_RC Create(const TofDOutBGovernorParams* pParams, const TofFrameGeometry* pGeometry, UINT32 Scale);
+
+    // Adds a raw frame of the geometry's format to the window's statistics
+    PICOP_RC MeasureFrame(const UINT32* pData, UINT32 FrameWords);
+
+    // FramesReceived is a running count of frames read. Returns TRUE when
+    // the scale should change to GetScale().
+    BOOL Update(TofClock::time_point Now, UINT32 FramesReceived);
+
+    PICOP_RC Apply(PicoP_HANDLE ConnectionHandle);
+
+    UINT32 GetScale();
+    void GetStats(TofDOutBGovernorStats* pStats);
+
+private:
+    TofDOutBGovernor(const TofDOutBGovernor&);
+    TofDOutBGovernor& operator=(const TofDOutBGovernor&);
+
+    UINT32 ScaleForBudget() const;
+    void StartWindow(TofClock::time_point Now, UINT32 FramesReceived);
+
+    TofDOutBGovernorParams mParams;
+    TofFrameGeometry mGeometry;
+    UINT32 mScale;                      // Wanted
+    UINT32 mApplied;                    // Set on the device
+    TofDOutBGovernorStats mStats;
+
+    std::mutex mLock;                   // The window's statistics and mStats
+    TofClock::time_point mWindowStart;
+    UINT32 mWindowFrames;               // FramesReceived at mWindowStart
+    BOOL mWindowStarted;
+    uint64_t mSamples;                  // TDC B samples read, in the frames measured this window
+    uint64_t mReturns;                  // Of those, holding a return
+    uint64_t mFilledIn;
+    uint64_t mPixels;
+
+    UINT32 mHealthyRun;
+    UINT32 mHoldWindows;                // HoldWindows, doubled by every retry that fell short
+    BOOL mRetrying;                     // Cleared ShortScale, not yet held for HoldWindows since
+    BOOL mStepping;                     // Short windows in a row, stepping down
+    UINT32 mStepFrom;                   // Scale the steps are judged from
+    FP32 mStepFps;                      // Frame rate at mStepFrom
+    FP32 mHeldFps;
+};
+
+// ****************************************************************************
@@ -0,0 +1,361 @@
+// ****************************************************************************
+//  TofFormatController.cpp
+//
+// Switches the ToF data format to fit the link bandwidth
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofFormatController.h"
+
+// ****************************************************************************
+
+void TofDefaultFormatControlParams(TofFormatControlParams* pParams)
+{
+    memset(pParams, 0, sizeof(TofFormatControlParams));
+
+    pParams->TargetFps = 30.0f;
+    pParams->Tolerance = 0.1f;
+    pParams->WindowMs = 500;
+    pParams->MaxQueueDepth = 2;
+    pParams->DownWindows = 2;
+    pParams->UpWindows = 10;
+    pParams->MaxUpWindows = 60;
+    pParams->SettleMs = 500;
+
+    for (UINT32 Level = 0; Level < TOF_FORMAT_MAX_LEVELS; Level++)
+    {
+        pParams->Levels[Level].DOutBScale = TOF_DOUTB_NO_SCALE;
+    }
+
+    pParams->NumLevels = 3;
+    pParams->Levels[0].Format = eTOF_DATA_ALL;
+    pParams->Levels[0].DOutBScale = DOUTB_SCALE_MAX;
+    pParams->Levels[1].Format = eTOF_DATA_ALL;
+    pParams->Levels[1].DOutBScale = DOUTB_SCALE_MAX / 2;
+    pParams->Levels[2].Format = eTOF_DATA_FUSED;
+}
+
+// ****************************************************************************
+
+TofFormatController::TofFormatController()
+    : mPlaneWords(0),
+      mLevel(TOF_FORMAT_NO_LEVEL),
+      mTarget(TOF_FORMAT_NO_LEVEL),
+      mWindowFrames(0),
+      mMaxQueueDepth(0),
+      mSettling(FALSE),
+      mShortRun(0),
+      mHealthyRun(0),
+      mUpWindows(0),
+      mProbing(FALSE)
+{
+    TofDefaultFormatControlParams(&mParams);
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFormatController::Create(const TofFormatControlParams* pParams, const TofFrameGeometry* pGeometry,
+                                     UINT32 DOutBScale)
+{
+    if ((pParams == NULL) || (pGeometry == NULL) || (pGeometry->PlaneWords == 0) ||
+        (pParams->NumLevels == 0) || (pParams->NumLevels > TOF_FORMAT_MAX_LEVELS) ||
+        ( ! (pParams->TargetFps > 0.0f)) || (pParams->Tolerance < 0.0f) || (pParams->WindowMs == 0) ||
+        (pParams->DownWindows == 0) || (pParams->UpWindows == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    for (UINT32 Level = 0; Level < pParams->NumLevels; Level++)
+    {
+        if ((TofPlanesPerFrame(pParams->Levels[Level].Format) == 0) ||
+            ((pParams->Levels[Level].DOutBScale > DOUTB_SCALE_MAX) &&
+             (pParams->Levels[Level].DOutBScale != TOF_DOUTB_NO_SCALE)))
+        {
+            return eINVALID_ARG;
+        }
+    }
+
+    mParams = *pParams;
+    mParams.MaxUpWindows = (mParams.MaxUpWindows < mParams.UpWindows) ? mParams.UpWindows : mParams.MaxUpWindows;
+    mPlaneWords = pGeometry->PlaneWords;
+    mLevel = TOF_FORMAT_NO_LEVEL;
+    mTarget = 0;
+    memset(&mStats, 0, sizeof(mStats));
+
+    for (UINT32 Level = 0; Level < mParams.NumLevels; Level++)
+    {
+        if ((mParams.Levels[Level].Format == pGeometry->Format) &&
+            ((mParams.Levels[Level].DOutBScale == DOutBScale) ||
+             (mParams.Levels[Level].DOutBScale == TOF_DOUTB_NO_SCALE)))
+        {
+            mLevel = Level;
+            mTarget = Level;
+            break;
+        }
+    }
+
+    mSettling = TRUE;
+    mShortRun = 0;
+    mHealthyRun = 0;
+    mUpWindows = mParams.UpWindows;
+    mProbing = FALSE;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+const TofFormatLevel* TofFormatController::GetLevelSettings(UINT32 Level) const
+{
+    return (Level < mParams.NumLevels) ? &mParams.Levels[Level] : NULL;
+}
+
+UINT32 TofFormatController::GetMaxFrameWords() const
+{
+    UINT32 MaxWords = 0;
+    UINT32 Words;
+
+
+    for (UINT32 Level = 0; Level < mParams.NumLevels; Level++)
+    {
+        Words = TofPlanesPerFrame(mParams.Levels[Level].Format) * mPlaneWords;
+        MaxWords = (Words > MaxWords) ? Words : MaxWords;
+    }
+
+    return MaxWords;
+}
+
+UINT32 TofFormatController::LevelBytes(UINT32 Level) const
+{
+    return TofLinkBytesPerFrame(mParams.Levels[Level].Format, mPlaneWords);
+}
+
+// ****************************************************************************
+
+void TofFormatController::StartWindow(TofClock::time_point Now, UINT32 FramesReceived)
+{
+    mWindowStart = Now;
+    mWindowFrames = FramesReceived;
+    mMaxQueueDepth = 0;
+}
+
+// ****************************************************************************
+//  Only does anything at the end of a window
+// ****************************************************************************
+
+BOOL TofFormatController::Update(TofClock::time_point Now, UINT32 FramesReceived, UINT32 QueueDepth)
+{
+    FP32 Seconds;
+    FP32 Fps;
+    BOOL Short;
+    BOOL Backlog;
+    UINT32 Next;
+
+
+    if ((mPlaneWords == 0) || (mLevel == TOF_FORMAT_NO_LEVEL))
+    {
+        return (mPlaneWords != 0);
+    }
+
+    if (mTarget != mLevel)
+    {
+        return TRUE;
+    }
+
+    if (mSettling)
+    {
+        mSettling = FALSE;
+        mSettleEnd = Now + std::chrono::milliseconds(mParams.SettleMs);
+        StartWindow(Now, FramesReceived);
+        return FALSE;
+    }
+
+    // A count restarted along with the acquisition restarts the window
+    if ((Now < mSettleEnd) || (FramesReceived < mWindowFrames))
+    {
+        StartWindow(Now, FramesReceived);
+        return FALSE;
+    }
+
+    mMaxQueueDepth = (QueueDepth > mMaxQueueDepth) ? QueueDepth : mMaxQueueDepth;
+    Seconds = std::chrono::duration<FP32>(Now - mWindowStart).count();
+
+    if (Seconds < (mParams.WindowMs / 1000.0f))
+    {
+        return FALSE;
+    }
+
+    Fps = (FramesReceived - mWindowFrames) / Seconds;
+    Backlog = (mMaxQueueDepth > mParams.MaxQueueDepth);
+    Short = (Fps < (mParams.TargetFps * (1.0f - mParams.Tolerance))) || Backlog;
+    StartWindow(Now, FramesReceived);
+
+    mStats.Windows++;
+    mStats.LastFps = Fps;
+
+    if ( ! Short)
+    {
+        mShortRun = 0;
+        mHealthyRun++;
+
+        // Carrying more than the link last managed, so it has got faster
+        // and the levels it could not take are worth trying again soon
+        if ((mStats.LinkEstimate > 0.0f) &&
+            ((Fps * LevelBytes(mLevel)) > (mStats.LinkEstimate * (1.0f + mParams.Tolerance))))
+        {
+            mStats.LinkEstimate = 0.0f;
+            mUpWindows = mParams.UpWindows;
+        }
+
+        // The last step up has held, the next one need not wait any longer
+        if (mProbing && (mHealthyRun >= mParams.UpWindows))
+        {
+            mProbing = FALSE;
+            mUpWindows = mParams.UpWindows;
+        }
+
+        if ((mLevel > 0) && (mHealthyRun >= mUpWindows))
+        {
+            mTarget = mLevel - 1;
+            mProbing = TRUE;
+            mHealthyRun = 0;
+            mStats.StepsUp++;
+        }
+
+        return (mTarget != mLevel);
+    }
+
+    mStats.ShortWindows++;
+    mHealthyRun = 0;
+    mShortRun++;
+
+    // A host that cannot keep up says nothing about the link
+    if ( ! Backlog)
+    {
+        mStats.LinkEstimate = Fps * LevelBytes(mLevel);
+    }
+
+    if ((mShortRun < mParams.DownWindows) || ((mLevel + 1) >= mParams.NumLevels))
+    {
+        return FALSE;
+    }
+
+    // Levels that send fewer bytes but still too many for the link are
+    // skipped. One sending as many as this, with less of TDC B read, is
+    // tried: the short rate may be the readout and not the link.
+    Next = mLevel + 1;
+
+    while (( ! Backlog) && ((Next + 1) < mParams.NumLevels) && (LevelBytes(Next) < LevelBytes(mLevel)) &&
+           ((mParams.TargetFps * LevelBytes(Next)) > mStats.LinkEstimate))
+    {
+        Next++;
+    }
+
+    if (mProbing)
+    {
+        mUpWindows = ((mUpWindows * 2) > mParams.MaxUpWindows) ? mParams.MaxUpWindows : (mUpWindows * 2);
+        mProbing = FALSE;
+        mStats.FailedStepsUp++;
+    }
+
+    mTarget = Next;
+    mShortRun = 0;
+    mStats.StepsDown++;
+
+    return TRUE;
+}
+
+// ****************************************************************************
+//  The device only takes a new format with sensing disabled. If a step
+//  fails sensing is still enabled again, so the stream carries on as it was.
+//  Acquisition is stopped first so no read is in flight while the frame
+//  size changes.
+// ****************************************************************************
+
+PICOP_RC TofFormatController::Apply(PicoP_HANDLE ConnectionHandle, TofAcquisition* pAcquisition)
+{
+    const TofFormatLevel* pLevel = GetLevelSettings(mTarget);
+    BOOL Restart = (pAcquisition != NULL) && pAcquisition->IsRunning();
+    PICOP_RC PicopRc;
+    PICOP_RC RestartRc;
+
+
+    if (pLevel == NULL)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if (Restart)
+    {
+        pAcquisition->Stop();
+    }
+
+    PicopRc = SwitchLevel(ConnectionHandle, pLevel);
+
+    if (Restart)
+    {
+        RestartRc = pAcquisition->Restart();
+        PicopRc = (PicopRc == eSUCCESS) ? RestartRc : PicopRc;
+    }
+
+    return PicopRc;
+}
+
+PICOP_RC TofFormatController::SwitchLevel(PicoP_HANDLE ConnectionHandle, const TofFormatLevel* pLevel)
+{
+    PICOP_RC PicopRc;
+
+
+    PicopRc = PicoP_TLC_SetSensingState(ConnectionHandle, eSENSING_DISABLED, FALSE);
+
+    if (PicopRc != eSUCCESS)
+    {
+        mTarget = (mLevel == TOF_FORMAT_NO_LEVEL) ? mTarget : mLevel;
+        return PicopRc;
+    }
+
+    PicopRc = PicoP_TLC_SetTofDataFormat(ConnectionHandle, pLevel->Format, FALSE);
+
+    if ((PicopRc == eSUCCESS) && (pLevel->DOutBScale != TOF_DOUTB_NO_SCALE))
+    {
+        PicopRc = PicoP_TLC_SetDOutBScale(ConnectionHandle, pLevel->DOutBScale, FALSE);
+    }
+
+    if (PicopRc != eSUCCESS)
+    {
+        // The format may have changed already; put it back as far as possible
+        if (mLevel != TOF_FORMAT_NO_LEVEL)
+        {
+            PicoP_TLC_SetTofDataFormat(ConnectionHandle, mParams.Levels[mLevel].Format, FALSE);
+
+            if (mParams.Levels[mLevel].DOutBScale != TOF_DOUTB_NO_SCALE)
+            {
+                PicoP_TLC_SetDOutBScale(ConnectionHandle, mParams.Levels[mLevel].DOutBScale, FALSE);
+            }
+
+            mTarget = mLevel;
+        }
+
+        PicoP_TLC_SetSensingState(ConnectionHandle, eSENSING_ENABLED, FALSE);
+        return PicopRc;
+    }
+
+    mLevel = mTarget;
+    mSettling = TRUE;
+    mShortRun = 0;
+    mHealthyRun = 0;
+    mStats.Switches++;
+
+    return PicoP_TLC_SetSensingState(ConnectionHandle, eSENSING_ENABLED, FALSE);
+}
+
+// ****************************************************************************
@@ -0,0 +1,154 @@
+// ****************************************************************************
+//  TofFormatController.h
+//
+// Switches the ToF data format to fit the link bandwidth
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include "PicoP_TLC_Api.h"
+#include "TofAcquisition.h"
+#include "TofFrameRing.h"
+#include "TofGeometry.h"
+
+// ****************************************************************************
+
+#define TOF_FORMAT_MAX_LEVELS       8
+#define TOF_FORMAT_NO_LEVEL         0xffffffffu
+
+// ****************************************************************************
+// eTOF_DATA_ALL carries both detectors and twice the bytes of the fused
+// format; on a loaded bus the device then drops frames. The controller walks
+// a ladder of formats and TDC B scales, best first, to keep the frame rate at
+// TargetFps. A lower format needs less of the link (see
+// TofLinkBytesPerFrame); a lower scale sends as many bytes but reads less of
+// TDC B (see TofTdcBReadBytes), which helps when the readout is the limit:
+//
+//  - Every WindowMs it works out the frame rate from the frames received and
+//    notes the deepest backlog of frames waiting to be read.
+//  - DownWindows windows in a row short of the target, or backed up, step
+//    down. When the rate fell short the link carried about Fps * bytes per
+//    frame, so the step goes as far down as needed for that to fit, but
+//    stops first at a level that only lowers the scale.
+//  - UpWindows healthy windows in a row step back up one level. A step up
+//    that is stepped straight back down doubles the wait before the next,
+//    up to MaxUpWindows, so a link that cannot take the level is not
+//    probed every few seconds, until a window shows the link carrying more
+//    than it did when it last fell short.
+//
+// Update() only decides; Apply() makes the switch. A switch changes the frame
+// size (ALL frames are twice the fused ones), so Apply() stops a running
+// TofAcquisition first and restarts it sized for the new frames. A ring or
+// pool attached to it must hold GetMaxFrameWords() or the restart is
+// refused, so frames are never read at the wrong size. Windows in the first
+// SettleMs after a switch are not counted. One thread drives the
+// controller, and not the frame callback.
+//
+// A level whose DOutBScale is TOF_DOUTB_NO_SCALE leaves the scale alone, so
+// a TofDOutBGovernor can look after it; levels are TOF_DOUTB_NO_SCALE unless
+// set. When the governor runs, give the ladder no scale levels, or each
+// switch to one overrides the governor until it is created again.
+// ****************************************************************************
+
+typedef struct
+{
+    PicoP_ToFDataFormatE Format;
+    UINT32 DOutBScale;                  // 0 .. DOUTB_SCALE_MAX, or TOF_DOUTB_NO_SCALE
+} TofFormatLevel;
+
+typedef struct
+{
+    FP32 TargetFps;
+    FP32 Tolerance;                     // Fraction of TargetFps a window may fall short by
+    UINT32 WindowMs;
+    UINT32 MaxQueueDepth;               // A deeper backlog counts as backed up
+    UINT32 DownWindows;
+    UINT32 UpWindows;
+    UINT32 MaxUpWindows;
+    UINT32 SettleMs;
+    UINT32 NumLevels;
+    TofFormatLevel Levels[TOF_FORMAT_MAX_LEVELS];
+} TofFormatControlParams;
+
+typedef struct
+{
+    uint64_t Windows;
+    uint64_t ShortWindows;              // Below the target or backed up
+    uint64_t StepsDown;
+    uint64_t StepsUp;
+    uint64_t FailedStepsUp;             // Stepped straight back down
+    uint64_t Switches;                  // Made by Apply()
+    FP32 LastFps;
+    FP32 LinkEstimate;                  // Bytes per second, from the last window short of the target; 0 if none yet
+} TofFormatControlStats;
+
+// Levels ALL, ALL with half of TDC B, fused with the scale left alone; 30 fps
+void TofDefaultFormatControlParams(TofFormatControlParams* pParams);
+
+// ****************************************************************************
+
+class TofFormatController
+{
+public:
+    TofFormatController();
+
+    // Starts at the level matching the device's current format and scale,
+    // if there is one, otherwise the first Update() asks for level 0. A
+    // TOF_DOUTB_NO_SCALE level matches any scale.
+    PICOP_RC Create(const TofFormatControlParams* pParams, const TofFrameGeometry* pGeometry, UINT32 DOutBScale);
+
+    // FramesReceived is a running count of frames read, QueueDepth the frames
+    // waiting to be read (PicoP_TLC_GetTofFrameCount, or a ring's backlog).
+    // Returns TRUE when a switch to GetTargetLevel() is due.
+    BOOL Update(TofClock::time_point Now, UINT32 FramesReceived, UINT32 QueueDepth);
+
+    // Switches the device to the target level, with sensing disabled while
+    // the format changes; nothing is committed to persistent memory. On
+    // failure the controller stays at the current level. A running
+    // pAcquisition is stopped around the switch and restarted after it,
+    // also on failure, sized for whatever the device then sends.
+    PICOP_RC Apply(PicoP_HANDLE ConnectionHandle, TofAcquisition* pAcquisition = NULL);
+
+    // Largest frame of any level, to size frame rings and pools once
+    UINT32 GetMaxFrameWords() const;
+
+    UINT32 GetLevel() const { return mLevel; }
+    UINT32 GetTargetLevel() const { return mTarget; }
+    const TofFormatLevel* GetLevelSettings(UINT32 Level) const;
+    void GetStats(TofFormatControlStats* pStats) const { *pStats = mStats; }
+
+private:
+    TofFormatController(const TofFormatController&);
+    TofFormatController& operator=(const TofFormatController&);
+
+    void StartWindow(TofClock::time_point Now, UINT32 FramesReceived);
+    PICOP_RC SwitchLevel(PicoP_HANDLE ConnectionHandle, const TofFormatLevel* pLevel);
+    UINT32 LevelBytes(UINT32 Level) const;
+
+    TofFormatControlParams mParams;
+    UINT32 mPlaneWords;
+    UINT32 mLevel;                      // TOF_FORMAT_NO_LEVEL until the first Apply() if none matched
+    UINT32 mTarget;
+    TofFormatControlStats mStats;
+
+    TofClock::time_point mWindowStart;
+    UINT32 mWindowFrames;               // FramesReceived at mWindowStart
+    UINT32 mMaxQueueDepth;
+    BOOL mSettling;                     // Switched, the settle time starts on the next Update()
+    TofClock::time_point mSettleEnd;
+    UINT32 mShortRun;                   // Windows in a row short of the target
+    UINT32 mHealthyRun;
+    UINT32 mUpWindows;                  // UpWindows, doubled by every failed step up
+    BOOL mProbing;                      // Stepped up, not yet held for UpWindows
+};
+
+// ****************************************************************************
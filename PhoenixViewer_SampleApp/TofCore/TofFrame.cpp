@@ -0,0 +1,136 @@
+// ****************************************************************************
+//  TofFrame.cpp
+//
+// Owning ToF frame: aligned time and amplitude planes
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofFrame.h"
+#include "TofFrameDecoder.h"
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+TofFrame::TofFrame()
+    : mpTime(NULL),
+      mpAmplitude(NULL),
+      mNumPulses(0),
+      mNumLines(0),
+      mSequenceNumber(0),
+      mFormat(eTOF_DATA_FUSED)
+{
+}
+
+TofFrame::~TofFrame()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Allocates both planes for NumLines lines of NumPulses words
+// ****************************************************************************
+
+PICOP_RC TofFrame::Create(UINT32 NumPulses, UINT32 NumLines)
+{
+    size_t PlaneBytes = (size_t)NumPulses * NumLines * sizeof(UINT32);
+
+
+    if ((NumPulses == 0) || (NumLines == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((mpTime != NULL) && (NumPulses == mNumPulses) && (NumLines == mNumLines))
+    {
+        return eSUCCESS;
+    }
+
+    Destroy();
+
+    mpTime = (UINT32*)TofAlignedAlloc(PlaneBytes, TOF_CACHE_LINE_SIZE);
+    mpAmplitude = (UINT32*)TofAlignedAlloc(PlaneBytes, TOF_CACHE_LINE_SIZE);
+
+    if ((mpTime == NULL) || (mpAmplitude == NULL))
+    {
+        Destroy();
+        return eFAILURE;
+    }
+
+    memset(mpTime, 0, PlaneBytes);
+    memset(mpAmplitude, 0, PlaneBytes);
+    mNumPulses = NumPulses;
+    mNumLines = NumLines;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofFrame::Destroy()
+{
+    TofAlignedFree(mpTime);
+    TofAlignedFree(mpAmplitude);
+    mpTime = NULL;
+    mpAmplitude = NULL;
+    mNumPulses = 0;
+    mNumLines = 0;
+    mSequenceNumber = 0;
+}
+
+// ****************************************************************************
+//  Copies both planes of a view, which must match the frame's dimensions
+// ****************************************************************************
+
+PICOP_RC TofFrame::CopyFrom(const TofFrameView* pView)
+{
+    size_t PlaneBytes;
+
+
+    if ((pView == NULL) || (pView->pTime == NULL) || (mpTime == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((pView->NumPulses != mNumPulses) || (pView->NumLines != mNumLines))
+    {
+        return eFRAME_ERROR;
+    }
+
+    PlaneBytes = (size_t)mNumPulses * mNumLines * sizeof(UINT32);
+    memcpy(mpTime, pView->pTime, PlaneBytes);
+    memcpy(mpAmplitude, pView->pAmplitude, PlaneBytes);
+    mFormat = pView->Format;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Fills the frame's planes from a raw acquired frame in any format, as the
+//  fused detector of TofFrameDecoder
+// ****************************************************************************
+
+PICOP_RC TofFrame::Deinterleave(const UINT32* pData, UINT32 FrameWords, PicoP_ToFDataFormatE Format)
+{
+    return TofDecodeDetector(pData, FrameWords, Format, eTOF_DETECTOR_FUSED, this);
+}
+
+// ****************************************************************************
+
+void TofFrame::GetView(TofFrameView* pView) const
+{
+    pView->pTime = mpTime;
+    pView->pAmplitude = mpAmplitude;
+    pView->NumPulses = mNumPulses;
+    pView->NumLines = mNumLines;
+    pView->Format = mFormat;
+}
+
+// ****************************************************************************
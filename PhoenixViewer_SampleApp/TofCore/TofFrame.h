@@ -0,0 +1,60 @@
+// ****************************************************************************
+//  TofFrame.h
+//
+// Owning ToF frame: aligned time and amplitude planes
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "TofFrameView.h"
+
+// ****************************************************************************
+// A TofFrame keeps its own copy of the two planes, each in its own cache line
+// aligned allocation, so it stays valid after the ring slot or acquisition
+// buffer it came from has been reused. Create() sizes it once; CopyFrom()
+// then only copies.
+// ****************************************************************************
+
+class TofFrame
+{
+public:
+    TofFrame();
+    ~TofFrame();
+
+    PICOP_RC Create(UINT32 NumPulses, UINT32 NumLines);
+    void Destroy();
+
+    PICOP_RC CopyFrom(const TofFrameView* pView);
+    PICOP_RC Deinterleave(const UINT32* pData, UINT32 FrameWords, PicoP_ToFDataFormatE Format);
+
+    UINT32* GetTime() { return mpTime; }
+    UINT32* GetAmplitude() { return mpAmplitude; }
+    UINT32 GetNumPulses() const { return mNumPulses; }
+    UINT32 GetNumLines() const { return mNumLines; }
+    UINT32 GetSequenceNumber() const { return mSequenceNumber; }
+    void SetSequenceNumber(UINT32 SequenceNumber) { mSequenceNumber = SequenceNumber; }
+    void SetFormat(PicoP_ToFDataFormatE Format) { mFormat = Format; }
+
+    void GetView(TofFrameView* pView) const;
+
+private:
+    TofFrame(const TofFrame&);
+    TofFrame& operator=(const TofFrame&);
+
+    UINT32* mpTime;
+    UINT32* mpAmplitude;
+    UINT32 mNumPulses;
+    UINT32 mNumLines;
+    UINT32 mSequenceNumber;
+    PicoP_ToFDataFormatE mFormat;
+};
+
+// ****************************************************************************
@@ -0,0 +1,496 @@
+// ****************************************************************************
+//  TofFrameDecoder.cpp
+//
+// Plane layout of every ToF data format
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofFrameDecoder.h"
+#include "TofMemory.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+//  Plane of each detector's time and amplitude in a frame of the format,
+//  -1 where the format does not carry it
+// ****************************************************************************
+
+template <PicoP_ToFDataFormatE Format> struct TofFormatTraits;
+
+template <> struct TofFormatTraits<eTOF_DATA_FUSED>
+{
+    enum { Planes = 2, FusedTime = 0, FusedAmplitude = 1, LeftTime = -1, LeftAmplitude = -1, RightTime = -1, RightAmplitude = -1 };
+};
+
+template <> struct TofFormatTraits<eTOF_DATA_LEFT_SENSOR_ONLY>
+{
+    enum { Planes = 2, FusedTime = -1, FusedAmplitude = -1, LeftTime = 0, LeftAmplitude = 1, RightTime = -1, RightAmplitude = -1 };
+};
+
+template <> struct TofFormatTraits<eTOF_DATA_RIGHT_SENSOR_ONLY>
+{
+    enum { Planes = 2, FusedTime = -1, FusedAmplitude = -1, LeftTime = -1, LeftAmplitude = -1, RightTime = 0, RightAmplitude = 1 };
+};
+
+template <> struct TofFormatTraits<eTOF_DATA_DEPTH_ONLY>
+{
+    enum { Planes = 2, FusedTime = -1, FusedAmplitude = -1, LeftTime = 0, LeftAmplitude = -1, RightTime = 1, RightAmplitude = -1 };
+};
+
+template <> struct TofFormatTraits<eTOF_DATA_AMPLITUDE_ONLY>
+{
+    enum { Planes = 2, FusedTime = -1, FusedAmplitude = -1, LeftTime = -1, LeftAmplitude = 0, RightTime = -1, RightAmplitude = 1 };
+};
+
+template <> struct TofFormatTraits<eTOF_DATA_ALL>
+{
+    enum { Planes = 4, FusedTime = -1, FusedAmplitude = -1, LeftTime = 0, LeftAmplitude = 1, RightTime = 2, RightAmplitude = 3 };
+};
+
+// ****************************************************************************
+//  Where one channel of a detector comes from: plane First, the mean of
+//  planes First and Second, or nothing (First -1). The fused detector falls
+//  back on the one detector sent, or the mean of both. A detector only
+//  counts towards the mean where it has a return: its time (FirstValid,
+//  SecondValid) is not 0, or the channel itself where no time is sent.
+// ****************************************************************************
+
+template <typename Traits, TofDetectorE Detector, TofChannelE Channel>
+struct TofChannelSource
+{
+    enum
+    {
+        Fused = (Channel == eTOF_CHANNEL_TIME) ? (int)Traits::FusedTime : (int)Traits::FusedAmplitude,
+        Left = (Channel == eTOF_CHANNEL_TIME) ? (int)Traits::LeftTime : (int)Traits::LeftAmplitude,
+        Right = (Channel == eTOF_CHANNEL_TIME) ? (int)Traits::RightTime : (int)Traits::RightAmplitude,
+        Own = (Detector == eTOF_DETECTOR_LEFT) ? (int)Left : (Detector == eTOF_DETECTOR_RIGHT) ? (int)Right : (int)Fused,
+        Combined = (Detector == eTOF_DETECTOR_FUSED) && (Fused < 0),
+        First = (Own >= 0) ? (int)Own : ( ! Combined) ? -1 : (Left >= 0) ? (int)Left : (int)Right,
+        Second = (Combined && (Left >= 0) && (Right >= 0)) ? (int)Right : -1,
+        FirstValid = ((int)Traits::LeftTime >= 0) ? (int)Traits::LeftTime : (int)First,
+        SecondValid = ((int)Traits::RightTime >= 0) ? (int)Traits::RightTime : (int)Second
+    };
+};
+
+// ****************************************************************************
+//  Mean of two detectors' planes where both have a return, the one that
+//  has where only one does, else 0. A dropout (0) on one detector would
+//  otherwise halve the range. The mean is halved before it is added, so
+//  words with the top bit set do not overflow.
+// ****************************************************************************
+
+static void TofMeanPlanes(const UINT32* pFirst, const UINT32* pSecond, const UINT32* pFirstValid,
+                          const UINT32* pSecondValid, size_t Count, UINT32* pOut)
+{
+    UINT32 First;
+    UINT32 Second;
+    size_t i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i Zero = _mm_setzero_si128();
+    const __m128i One = _mm_set1_epi32(1);
+
+    for (; (i + 4) <= Count; i += 4)
+    {
+        __m128i FirstMissing = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(pFirstValid + i)), Zero);
+        __m128i SecondMissing = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(pSecondValid + i)), Zero);
+        __m128i vFirst = _mm_andnot_si128(FirstMissing, _mm_loadu_si128((const __m128i*)(pFirst + i)));
+        __m128i vSecond = _mm_andnot_si128(SecondMissing, _mm_loadu_si128((const __m128i*)(pSecond + i)));
+        __m128i Either = _mm_or_si128(FirstMissing, SecondMissing);
+        __m128i Mean = _mm_add_epi32(_mm_add_epi32(_mm_srli_epi32(vFirst, 1), _mm_srli_epi32(vSecond, 1)),
+                                     _mm_and_si128(_mm_and_si128(vFirst, vSecond), One));
+
+        // With one missing it is 0, so the other is the or of both
+        _mm_storeu_si128((__m128i*)(pOut + i), _mm_or_si128(_mm_and_si128(Either, _mm_or_si128(vFirst, vSecond)),
+                                                            _mm_andnot_si128(Either, Mean)));
+    }
+#endif
+
+    for (; i < Count; i++)
+    {
+        First = (pFirstValid[i] != 0) ? pFirst[i] : 0;
+        Second = (pSecondValid[i] != 0) ? pSecond[i] : 0;
+        pOut[i] = ((pFirstValid[i] == 0) || (pSecondValid[i] == 0)) ? (First | Second) :
+                  ((First >> 1) + (Second >> 1) + (First & Second & 1));
+    }
+}
+
+// One channel; the planes are constants, so only one branch is kept
+template <int First, int Second, int FirstValid, int SecondValid>
+static inline void TofDecodeChannel(const UINT32* pData, size_t PlaneWords, UINT32* pOut)
+{
+    if (First < 0)
+    {
+        memset(pOut, 0, PlaneWords * sizeof(UINT32));
+    }
+    else if (Second < 0)
+    {
+        memcpy(pOut, pData + (First * PlaneWords), PlaneWords * sizeof(UINT32));
+    }
+    else
+    {
+        TofMeanPlanes(pData + (First * PlaneWords), pData + (Second * PlaneWords),
+                      pData + (FirstValid * PlaneWords), pData + (SecondValid * PlaneWords), PlaneWords, pOut);
+    }
+}
+
+// ****************************************************************************
+
+template <PicoP_ToFDataFormatE Format, TofDetectorE Detector>
+struct TofDetectorDecoder
+{
+    typedef TofFormatTraits<Format> Traits;
+    typedef TofChannelSource<Traits, Detector, eTOF_CHANNEL_TIME> Time;
+    typedef TofChannelSource<Traits, Detector, eTOF_CHANNEL_AMPLITUDE> Amplitude;
+
+    enum
+    {
+        Available = (Time::First >= 0) || (Amplitude::First >= 0),
+        ZeroCopy = (Time::Second < 0) && (Amplitude::Second < 0)
+    };
+
+    static void Decode(const UINT32* pData, size_t PlaneWords, UINT32* pTime, UINT32* pAmplitude)
+    {
+        TofDecodeChannel<Time::First, Time::Second, Time::FirstValid, Time::SecondValid>(pData, PlaneWords, pTime);
+        TofDecodeChannel<Amplitude::First, Amplitude::Second, Amplitude::FirstValid, Amplitude::SecondValid>(
+            pData, PlaneWords, pAmplitude);
+    }
+};
+
+// ****************************************************************************
+//  Everything about one format, indexed by PicoP_ToFDataFormatE
+// ****************************************************************************
+
+typedef void (*TofDecodeFunction)(const UINT32* pData, size_t PlaneWords, UINT32* pTime, UINT32* pAmplitude);
+
+typedef struct
+{
+    UINT32 Planes;
+    INT32 Plane[eTOF_NUM_DETECTORS][eTOF_NUM_CHANNELS];     // As carried, -1 if not
+    INT32 Source[eTOF_NUM_DETECTORS][eTOF_NUM_CHANNELS];    // As decoded, -1 if the mean or nothing
+    TofDecodeFunction pDecode[eTOF_NUM_DETECTORS];           // NULL if the detector is not available
+    BOOL ZeroCopy[eTOF_NUM_DETECTORS];
+} TofFormatLayout;
+
+#define TOF_DETECTOR_SOURCE(Format, Detector) \
+    { TofDetectorDecoder<Format, Detector>::Time::Second < 0 ? TofDetectorDecoder<Format, Detector>::Time::First : -1, \
+      TofDetectorDecoder<Format, Detector>::Amplitude::Second < 0 ? TofDetectorDecoder<Format, Detector>::Amplitude::First : -1 }
+
+#define TOF_DETECTOR_DECODE(Format, Detector) \
+    (TofDetectorDecoder<Format, Detector>::Available ? &TofDetectorDecoder<Format, Detector>::Decode : NULL)
+
+#define TOF_FORMAT_LAYOUT(Format) \
+    { TofFormatTraits<Format>::Planes, \
+      { { TofFormatTraits<Format>::FusedTime, TofFormatTraits<Format>::FusedAmplitude }, \
+        { TofFormatTraits<Format>::LeftTime, TofFormatTraits<Format>::LeftAmplitude }, \
+        { TofFormatTraits<Format>::RightTime, TofFormatTraits<Format>::RightAmplitude } }, \
+      { TOF_DETECTOR_SOURCE(Format, eTOF_DETECTOR_FUSED), \
+        TOF_DETECTOR_SOURCE(Format, eTOF_DETECTOR_LEFT), \
+        TOF_DETECTOR_SOURCE(Format, eTOF_DETECTOR_RIGHT) }, \
+      { TOF_DETECTOR_DECODE(Format, eTOF_DETECTOR_FUSED), \
+        TOF_DETECTOR_DECODE(Format, eTOF_DETECTOR_LEFT), \
+        TOF_DETECTOR_DECODE(Format, eTOF_DETECTOR_RIGHT) }, \
+      { TofDetectorDecoder<Format, eTOF_DETECTOR_FUSED>::ZeroCopy, \
+        TofDetectorDecoder<Format, eTOF_DETECTOR_LEFT>::ZeroCopy, \
+        TofDetectorDecoder<Format, eTOF_DETECTOR_RIGHT>::ZeroCopy } }
+
+static const TofFormatLayout sFormatLayouts[] =
+{
+    TOF_FORMAT_LAYOUT(eTOF_DATA_FUSED),
+    TOF_FORMAT_LAYOUT(eTOF_DATA_LEFT_SENSOR_ONLY),
+    TOF_FORMAT_LAYOUT(eTOF_DATA_RIGHT_SENSOR_ONLY),
+    TOF_FORMAT_LAYOUT(eTOF_DATA_DEPTH_ONLY),
+    TOF_FORMAT_LAYOUT(eTOF_DATA_AMPLITUDE_ONLY),
+    TOF_FORMAT_LAYOUT(eTOF_DATA_ALL)
+};
+
+#define TOF_NUM_FORMATS     (sizeof(sFormatLayouts) / sizeof(sFormatLayouts[0]))
+
+// ****************************************************************************
+
+static const TofFormatLayout* TofGetFormatLayout(PicoP_ToFDataFormatE Format)
+{
+    return ((UINT32)Format < TOF_NUM_FORMATS) ? &sFormatLayouts[Format] : NULL;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofMakeFramePlanes(const UINT32* pData, UINT32 FrameWords, UINT32 NumPulses, UINT32 NumLines,
+                            PicoP_ToFDataFormatE Format, TofFramePlanes* pPlanes)
+{
+    const TofFormatLayout* pLayout = TofGetFormatLayout(Format);
+    size_t PlaneWords = (size_t)NumPulses * NumLines;
+    INT32 Plane;
+
+
+    if (pPlanes == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    memset(pPlanes, 0, sizeof(TofFramePlanes));
+
+    if ((pData == NULL) || (PlaneWords == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (pLayout == NULL)
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    if (FrameWords < (PlaneWords * pLayout->Planes))
+    {
+        return eFRAME_ERROR;
+    }
+
+    for (UINT32 Detector = 0; Detector < eTOF_NUM_DETECTORS; Detector++)
+    {
+        for (UINT32 Channel = 0; Channel < eTOF_NUM_CHANNELS; Channel++)
+        {
+            Plane = pLayout->Plane[Detector][Channel];
+            pPlanes->pPlane[Detector][Channel] = (Plane < 0) ? NULL : pData + (Plane * PlaneWords);
+        }
+    }
+
+    pPlanes->NumPulses = NumPulses;
+    pPlanes->NumLines = NumLines;
+    pPlanes->Format = Format;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofDecodeDetector(const UINT32* pData, UINT32 FrameWords, PicoP_ToFDataFormatE Format,
+                           TofDetectorE Detector, TofFrame* pFrame)
+{
+    const TofFormatLayout* pLayout = TofGetFormatLayout(Format);
+    size_t PlaneWords;
+
+
+    if ((pData == NULL) || (pFrame == NULL) || (pFrame->GetTime() == NULL) ||
+        ((UINT32)Detector >= eTOF_NUM_DETECTORS))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((pLayout == NULL) || (pLayout->pDecode[Detector] == NULL))
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    PlaneWords = (size_t)pFrame->GetNumPulses() * pFrame->GetNumLines();
+
+    if (FrameWords < (PlaneWords * pLayout->Planes))
+    {
+        return eFRAME_ERROR;
+    }
+
+    pLayout->pDecode[Detector](pData, PlaneWords, pFrame->GetTime(), pFrame->GetAmplitude());
+    pFrame->SetFormat(Format);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+TofFrameDecoder::TofFrameDecoder()
+    : mDetector(eTOF_DETECTOR_FUSED),
+      mpDecode(NULL),
+      mZeroCopy(FALSE),
+      mpZeroPlane(NULL)
+{
+    memset(&mGeometry, 0, sizeof(mGeometry));
+}
+
+TofFrameDecoder::~TofFrameDecoder()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFrameDecoder::Create(const TofFrameGeometry* pGeometry, TofDetectorE Detector)
+{
+    const TofFormatLayout* pLayout;
+    size_t PlaneBytes;
+
+
+    if ((pGeometry == NULL) || (pGeometry->PlaneWords == 0) || ((UINT32)Detector >= eTOF_NUM_DETECTORS))
+    {
+        return eINVALID_ARG;
+    }
+
+    pLayout = TofGetFormatLayout(pGeometry->Format);
+
+    if ((pLayout == NULL) || (pLayout->pDecode[Detector] == NULL))
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    Destroy();
+
+    PlaneBytes = (size_t)pGeometry->PlaneWords * sizeof(UINT32);
+
+    // A zero copy view still needs something to point at for a channel
+    // the format does not carry
+    if (pLayout->ZeroCopy[Detector] &&
+        ((pLayout->Source[Detector][eTOF_CHANNEL_TIME] < 0) || (pLayout->Source[Detector][eTOF_CHANNEL_AMPLITUDE] < 0)))
+    {
+        mpZeroPlane = (UINT32*)TofAlignedAlloc(PlaneBytes, TOF_CACHE_LINE_SIZE);
+
+        if (mpZeroPlane == NULL)
+        {
+            return eFAILURE;
+        }
+
+        memset(mpZeroPlane, 0, PlaneBytes);
+    }
+
+    mGeometry = *pGeometry;
+    mDetector = Detector;
+    mpDecode = pLayout->pDecode[Detector];
+    mZeroCopy = pLayout->ZeroCopy[Detector];
+
+    return eSUCCESS;
+}
+
+PICOP_RC TofFrameDecoder::CreateFromDevice(PicoP_HANDLE ConnectionHandle, TofDetectorE Detector)
+{
+    TofFrameGeometry Geometry;
+    PICOP_RC PicopRc;
+
+
+    PicopRc = TofQueryFrameGeometry(ConnectionHandle, &Geometry);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    return Create(&Geometry, Detector);
+}
+
+// ****************************************************************************
+
+void TofFrameDecoder::Destroy()
+{
+    TofAlignedFree(mpZeroPlane);
+    mpZeroPlane = NULL;
+    mScratch.Destroy();
+    memset(&mGeometry, 0, sizeof(mGeometry));
+    mDetector = eTOF_DETECTOR_FUSED;
+    mpDecode = NULL;
+    mZeroCopy = FALSE;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFrameDecoder::GetPlanes(const UINT32* pData, UINT32 FrameWords, TofFramePlanes* pPlanes) const
+{
+    if (mpDecode == NULL)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if (FrameWords < mGeometry.FrameWords)
+    {
+        return eFRAME_ERROR;
+    }
+
+    return TofMakeFramePlanes(pData, FrameWords, mGeometry.NumPulses, mGeometry.NumLines, mGeometry.Format, pPlanes);
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFrameDecoder::Decode(const UINT32* pData, UINT32 FrameWords, TofFrame* pFrame) const
+{
+    if (mpDecode == NULL)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if ((pData == NULL) || (pFrame == NULL) || (pFrame->GetTime() == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((FrameWords < mGeometry.FrameWords) ||
+        (pFrame->GetNumPulses() != mGeometry.NumPulses) || (pFrame->GetNumLines() != mGeometry.NumLines))
+    {
+        return eFRAME_ERROR;
+    }
+
+    mpDecode(pData, mGeometry.PlaneWords, pFrame->GetTime(), pFrame->GetAmplitude());
+    pFrame->SetFormat(mGeometry.Format);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFrameDecoder::GetView(const UINT32* pData, UINT32 FrameWords, TofFrameView* pView)
+{
+    const TofFormatLayout* pLayout = TofGetFormatLayout(mGeometry.Format);
+    INT32 Time;
+    INT32 Amplitude;
+    PICOP_RC PicopRc;
+
+
+    TofClearFrameView(pView);
+
+    if (mpDecode == NULL)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if (pData == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    if (FrameWords < mGeometry.FrameWords)
+    {
+        return eFRAME_ERROR;
+    }
+
+    if ( ! mZeroCopy)
+    {
+        PicopRc = mScratch.Create(mGeometry.NumPulses, mGeometry.NumLines);
+
+        if (PicopRc == eSUCCESS)
+        {
+            PicopRc = Decode(pData, FrameWords, &mScratch);
+        }
+
+        if (PicopRc == eSUCCESS)
+        {
+            mScratch.GetView(pView);
+        }
+
+        return PicopRc;
+    }
+
+    Time = pLayout->Source[mDetector][eTOF_CHANNEL_TIME];
+    Amplitude = pLayout->Source[mDetector][eTOF_CHANNEL_AMPLITUDE];
+
+    pView->pTime = (Time < 0) ? mpZeroPlane : pData + ((size_t)Time * mGeometry.PlaneWords);
+    pView->pAmplitude = (Amplitude < 0) ? mpZeroPlane : pData + ((size_t)Amplitude * mGeometry.PlaneWords);
+    pView->NumPulses = mGeometry.NumPulses;
+    pView->NumLines = mGeometry.NumLines;
+    pView->Format = mGeometry.Format;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
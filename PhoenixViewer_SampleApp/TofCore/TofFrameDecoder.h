@@ -0,0 +1,124 @@
+// ****************************************************************************
+//  TofFrameDecoder.h
+//
+// Plane layout of every ToF data format
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "PicoP_TLC_Api.h"
+#include "TofFrame.h"
+#include "TofFrameView.h"
+#include "TofGeometry.h"
+
+// ****************************************************************************
+// Which planes a frame carries depends on its data format:
+//
+//   eTOF_DATA_FUSED                fused time, fused amplitude
+//   eTOF_DATA_LEFT_SENSOR_ONLY     left time, left amplitude
+//   eTOF_DATA_RIGHT_SENSOR_ONLY    right time, right amplitude
+//   eTOF_DATA_DEPTH_ONLY           left time, right time
+//   eTOF_DATA_AMPLITUDE_ONLY       left amplitude, right amplitude
+//   eTOF_DATA_ALL                  left time, left amplitude, right time,
+//                                  right amplitude
+//
+// so only the first three are time followed by amplitude, as TofFrameView
+// expects. TofFramePlanes names every plane a frame carries.
+// ****************************************************************************
+
+typedef enum
+{
+    eTOF_DETECTOR_FUSED = 0,
+    eTOF_DETECTOR_LEFT,
+    eTOF_DETECTOR_RIGHT,
+    eTOF_NUM_DETECTORS
+} TofDetectorE;
+
+typedef enum
+{
+    eTOF_CHANNEL_TIME = 0,
+    eTOF_CHANNEL_AMPLITUDE,
+    eTOF_NUM_CHANNELS
+} TofChannelE;
+
+typedef struct
+{
+    const UINT32* pPlane[eTOF_NUM_DETECTORS][eTOF_NUM_CHANNELS];   // NULL where the format does not carry it
+    UINT32 NumPulses;
+    UINT32 NumLines;
+    PicoP_ToFDataFormatE Format;
+} TofFramePlanes;
+
+// ****************************************************************************
+
+// Points pPlanes into pData without copying anything
+PICOP_RC TofMakeFramePlanes(const UINT32* pData, UINT32 FrameWords, UINT32 NumPulses, UINT32 NumLines,
+                            PicoP_ToFDataFormatE Format, TofFramePlanes* pPlanes);
+
+// Fills pFrame's time and amplitude planes with Detector's, see below
+PICOP_RC TofDecodeDetector(const UINT32* pData, UINT32 FrameWords, PicoP_ToFDataFormatE Format,
+                           TofDetectorE Detector, TofFrame* pFrame);
+
+// ****************************************************************************
+// Turns frames of one geometry into the time and amplitude of one detector.
+// eTOF_DETECTOR_FUSED is the best the format allows: the fused planes, the
+// planes of the one detector a single detector format sends, or the mean of
+// both detectors' planes. Unlike the firmware's fused format, a detector
+// with no return (time 0, or the channel itself when no time is sent) is
+// left out of the mean rather than halving it. A channel the format does
+// not carry is 0. Asking for a detector the format has nothing of, such
+// as the left one of fused frames, fails in Create().
+//
+// Each format and detector has its own kernel, picked in Create(), so there
+// is no per pixel test of the layout. Decode() may be called from several
+// threads at once; GetView() may not.
+// ****************************************************************************
+
+class TofFrameDecoder
+{
+public:
+    TofFrameDecoder();
+    ~TofFrameDecoder();
+
+    PICOP_RC Create(const TofFrameGeometry* pGeometry, TofDetectorE Detector);
+
+    // Reads the current data format and frame size from the device
+    PICOP_RC CreateFromDevice(PicoP_HANDLE ConnectionHandle, TofDetectorE Detector);
+
+    void Destroy();
+
+    PICOP_RC GetPlanes(const UINT32* pData, UINT32 FrameWords, TofFramePlanes* pPlanes) const;
+    PICOP_RC Decode(const UINT32* pData, UINT32 FrameWords, TofFrame* pFrame) const;
+
+    // Points pView into pData where the detector's planes are sent as they
+    // are, otherwise decodes into a frame of the decoder's own, which the
+    // view is valid until the next call
+    PICOP_RC GetView(const UINT32* pData, UINT32 FrameWords, TofFrameView* pView);
+
+    const TofFrameGeometry* GetGeometry() const { return &mGeometry; }
+    TofDetectorE GetDetector() const { return mDetector; }
+    BOOL IsZeroCopy() const { return mZeroCopy; }
+
+private:
+    TofFrameDecoder(const TofFrameDecoder&);
+    TofFrameDecoder& operator=(const TofFrameDecoder&);
+
+    typedef void (*DecodeFunction)(const UINT32* pData, size_t PlaneWords, UINT32* pTime, UINT32* pAmplitude);
+
+    TofFrameGeometry mGeometry;
+    TofDetectorE mDetector;
+    DecodeFunction mpDecode;
+    BOOL mZeroCopy;                     // GetView() needs no copy
+    UINT32* mpZeroPlane;                // Stands in for a channel the format lacks
+    TofFrame mScratch;                  // GetView() decodes here otherwise
+};
+
+// ****************************************************************************
@@ -0,0 +1,226 @@
+// ****************************************************************************
+//  TofFramePool.cpp
+//
+// Preallocated, reference counted frame buffers
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofFramePool.h"
+
+// ****************************************************************************
+
+void TofFrameAddRef(TofPooledFrame* pFrame)
+{
+    pFrame->RefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ****************************************************************************
+//  The release that drops the last reference must see every write the other
+//  holders made, hence acq_rel
+// ****************************************************************************
+
+void TofFrameRelease(TofPooledFrame* pFrame)
+{
+    if (pFrame->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        pFrame->pPool->Recycle(pFrame);
+    }
+}
+
+// ****************************************************************************
+
+TofFramePool::TofFramePool()
+    : mFrames(NULL),
+      mStorage(NULL),
+      mStorageBytes(0),
+      mLargePages(FALSE),
+      mPageAllocated(FALSE),
+      mFrameCount(0),
+      mFrameWords(0),
+      mSlotBytes(0),
+      mFramesAcquired(0),
+      mFramesRecycled(0),
+      mFramesExhausted(0),
+      mMaxFramesInUse(0)
+{
+}
+
+TofFramePool::~TofFramePool()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Allocates FrameCount frames of FrameBytes each in one block
+// ****************************************************************************
+
+PICOP_RC TofFramePool::Create(UINT32 FrameBytes, UINT32 FrameCount, UINT32 Flags)
+{
+    size_t Total;
+
+
+    if ((FrameBytes < sizeof(UINT32)) || (FrameCount == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    mSlotBytes = (UINT32)TOF_ALIGN_UP(FrameBytes, TOF_CACHE_LINE_SIZE);
+    Total = (size_t)mSlotBytes * FrameCount;
+
+    if (Flags & TOF_POOL_LARGE_PAGES)
+    {
+        mStorage = (UINT8*)TofLargePageAlloc(Total, &mStorageBytes, &mLargePages);
+        mPageAllocated = TRUE;
+    }
+    else
+    {
+        mStorage = (UINT8*)TofAlignedAlloc(Total, TOF_CACHE_LINE_SIZE);
+        mStorageBytes = Total;
+        mLargePages = FALSE;
+        mPageAllocated = FALSE;
+    }
+
+    if (mStorage == NULL)
+    {
+        mStorageBytes = 0;
+        return eFAILURE;
+    }
+
+    mFrameCount = FrameCount;
+    mFrameWords = FrameBytes / sizeof(UINT32);
+    mFrames = new TofPooledFrame[FrameCount];
+    mFreeFrames.reserve(FrameCount);
+
+    // Hand out the lowest frames first
+    for (UINT32 i = FrameCount; i-- != 0; )
+    {
+        mFrames[i].pData = (UINT32*)(mStorage + (size_t)i * mSlotBytes);
+        mFrames[i].FrameWords = mFrameWords;
+        mFrames[i].SequenceNumber = 0;
+        mFrames[i].DeviceFrame = 0;
+        mFrames[i].pPool = this;
+        mFrames[i].RefCount.store(0, std::memory_order_relaxed);
+        mFreeFrames.push_back(&mFrames[i]);
+    }
+
+    mFramesAcquired = 0;
+    mFramesRecycled = 0;
+    mFramesExhausted = 0;
+    mMaxFramesInUse = 0;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFramePool::CreateForDevice(PicoP_HANDLE ConnectionHandle, UINT32 FrameCount, UINT32 Flags)
+{
+    UINT32 FrameBytes = 0;
+    PICOP_RC PicopRc;
+
+
+    PicopRc = PicoP_TLC_GetTofFrameDimensions(ConnectionHandle, &FrameBytes);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    return Create(FrameBytes, FrameCount, Flags);
+}
+
+// ****************************************************************************
+
+void TofFramePool::Destroy()
+{
+    if (mStorage == NULL)
+    {
+        return;
+    }
+
+    if (mPageAllocated)
+    {
+        TofLargePageFree(mStorage, mStorageBytes);
+    }
+    else
+    {
+        TofAlignedFree(mStorage);
+    }
+
+    delete[] mFrames;
+    mFrames = NULL;
+    mStorage = NULL;
+    mStorageBytes = 0;
+    mLargePages = FALSE;
+    mFrameCount = 0;
+    mFrameWords = 0;
+    mFreeFrames.clear();
+}
+
+// ****************************************************************************
+
+TofPooledFrame* TofFramePool::Acquire()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+    TofPooledFrame* pFrame;
+    UINT32 InUse;
+
+
+    if (mFreeFrames.empty())
+    {
+        mFramesExhausted++;
+        return NULL;
+    }
+
+    pFrame = mFreeFrames.back();
+    mFreeFrames.pop_back();
+    pFrame->RefCount.store(1, std::memory_order_relaxed);
+
+    mFramesAcquired++;
+    InUse = mFrameCount - (UINT32)mFreeFrames.size();
+    mMaxFramesInUse = (InUse > mMaxFramesInUse) ? InUse : mMaxFramesInUse;
+
+    return pFrame;
+}
+
+// ****************************************************************************
+
+void TofFramePool::Recycle(TofPooledFrame* pFrame)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    // Capacity was reserved for every frame, so this never allocates
+    mFreeFrames.push_back(pFrame);
+    mFramesRecycled++;
+}
+
+// ****************************************************************************
+
+void TofFramePool::GetStats(TofFramePoolStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    pStats->FrameCount = mFrameCount;
+    pStats->FrameBytes = mSlotBytes;
+    pStats->StorageBytes = mStorageBytes;
+    pStats->LargePages = mLargePages;
+    pStats->FramesAcquired = mFramesAcquired;
+    pStats->FramesRecycled = mFramesRecycled;
+    pStats->FramesExhausted = mFramesExhausted;
+    pStats->FramesInUse = mFrameCount - (UINT32)mFreeFrames.size();
+    pStats->MaxFramesInUse = mMaxFramesInUse;
+}
+
+// ****************************************************************************
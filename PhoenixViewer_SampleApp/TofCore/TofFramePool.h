@@ -0,0 +1,120 @@
+// ****************************************************************************
+//  TofFramePool.h
+//
+// Preallocated, reference counted frame buffers
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFrameRing.h"
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+// Create() flags
+#define TOF_POOL_LARGE_PAGES        0x00000001  // Back the frames with large pages when the OS grants them
+
+class TofFramePool;
+
+// ****************************************************************************
+// One frame buffer owned by a TofFramePool. Acquire() hands it out holding
+// one reference. Anyone keeping the frame past the call that gave it to them
+// takes a reference of their own with TofFrameAddRef, and the last
+// TofFrameRelease puts it back on the pool's free list, from whichever thread
+// that happens on.
+// ****************************************************************************
+
+typedef struct TofPooledFrame
+{
+    UINT32* pData;                      // Cache line aligned, room for the pool's frame size
+    UINT32 FrameWords;                  // Valid words in pData, set by the producer
+    UINT32 SequenceNumber;              // Set by the producer
+    UINT32 DeviceFrame;                 // Set by the producer
+    TofClock::time_point AcquireTime;   // Set by the producer
+    TofFramePool* pPool;
+    std::atomic<UINT32> RefCount;
+} TofPooledFrame;
+
+void TofFrameAddRef(TofPooledFrame* pFrame);
+void TofFrameRelease(TofPooledFrame* pFrame);
+
+typedef struct
+{
+    UINT32 FrameCount;
+    UINT32 FrameBytes;                  // Per frame, rounded up to a cache line
+    uint64_t StorageBytes;              // One block for every frame
+    BOOL LargePages;                    // The block is backed by large pages
+    uint64_t FramesAcquired;            // Frames handed out by Acquire()
+    uint64_t FramesRecycled;            // Frames returned by their last release
+    uint64_t FramesExhausted;           // Acquire() calls that found every frame in use
+    UINT32 FramesInUse;
+    UINT32 MaxFramesInUse;
+} TofFramePoolStats;
+
+// ****************************************************************************
+// All frames live in one block allocated by Create(); Acquire() and the last
+// release only move a pointer on or off the free list, so a running stream
+// never touches the heap. The free list is a stack: the frame released last,
+// whose lines are most likely still cached, is the next one handed out.
+// Every frame must have been released before Destroy().
+// ****************************************************************************
+
+class TofFramePool
+{
+public:
+    TofFramePool();
+    ~TofFramePool();
+
+    PICOP_RC Create(UINT32 FrameBytes, UINT32 FrameCount, UINT32 Flags);
+
+    // Sizes the frames with PicoP_TLC_GetTofFrameDimensions
+    PICOP_RC CreateForDevice(PicoP_HANDLE ConnectionHandle, UINT32 FrameCount, UINT32 Flags);
+
+    void Destroy();
+
+    // Never waits; NULL when every frame is in use
+    TofPooledFrame* Acquire();
+
+    UINT32 GetFrameWords() const { return mFrameWords; }
+    UINT32 GetFrameCount() const { return mFrameCount; }
+    void GetStats(TofFramePoolStats* pStats);
+
+private:
+    TofFramePool(const TofFramePool&);
+    TofFramePool& operator=(const TofFramePool&);
+
+    friend void TofFrameRelease(TofPooledFrame* pFrame);
+
+    void Recycle(TofPooledFrame* pFrame);
+
+    TofPooledFrame* mFrames;
+    std::vector<TofPooledFrame*> mFreeFrames;
+    UINT8* mStorage;
+    size_t mStorageBytes;
+    BOOL mLargePages;
+    BOOL mPageAllocated;                // mStorage came from TofLargePageAlloc
+    UINT32 mFrameCount;
+    UINT32 mFrameWords;
+    UINT32 mSlotBytes;
+
+    std::mutex mLock;
+    uint64_t mFramesAcquired;
+    uint64_t mFramesRecycled;
+    uint64_t mFramesExhausted;
+    UINT32 mMaxFramesInUse;
+};
+
+// ****************************************************************************
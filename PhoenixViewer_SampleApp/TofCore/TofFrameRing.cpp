@@ -0,0 +1,219 @@
+// ****************************************************************************
+//  TofFrameRing.cpp
+//
+// Lock-free single-producer/single-consumer ring of preallocated ToF frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "TofFrameRing.h"
+
+// ****************************************************************************
+
+TofFrameRing::TofFrameRing()
+    : mHead(0),
+      mDropped(0),
+      mTail(0),
+      mSkipped(0),
+      mHolding(FALSE),
+      mStorage(NULL),
+      mSlotCount(0),
+      mSlotMask(0),
+      mFrameWords(0)
+{
+    Destroy();
+}
+
+TofFrameRing::~TofFrameRing()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Allocates SlotCount frames of FrameBytes each (as reported by
+//  PicoP_TLC_GetTofFrameDimensions). Must not be called while either side
+//  is using the ring.
+// ****************************************************************************
+
+PICOP_RC TofFrameRing::Create(UINT32 FrameBytes, UINT32 SlotCount)
+{
+    UINT32 Slots = 2;
+    size_t SlotStride;
+
+
+    if ((FrameBytes < sizeof(UINT32)) || (SlotCount > TOF_RING_MAX_SLOTS))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    while (Slots < SlotCount)
+    {
+        Slots <<= 1;
+    }
+
+    // Each frame starts on its own cache line so the two threads never share one
+    SlotStride = TOF_ALIGN_UP((size_t)FrameBytes, TOF_CACHE_LINE_SIZE);
+    mStorage = (UINT8*)TofAlignedAlloc(SlotStride * Slots, TOF_CACHE_LINE_SIZE);
+
+    if (mStorage == NULL)
+    {
+        return eFAILURE;
+    }
+
+    mSlotCount = Slots;
+    mSlotMask = Slots - 1;
+    mFrameWords = FrameBytes / sizeof(UINT32);
+
+    for (UINT32 i = 0; i < Slots; i++)
+    {
+        mSlots[i].pData = (UINT32*)(mStorage + i * SlotStride);
+        mSlots[i].FrameWords = mFrameWords;
+        mSlots[i].SequenceNumber = 0;
+        mSlots[i].DeviceFrame = 0;
+    }
+
+    mHead.store(0);
+    mTail.store(0);
+    mDropped.store(0);
+    mSkipped.store(0);
+    mHolding = FALSE;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofFrameRing::Destroy()
+{
+    if (mStorage != NULL)
+    {
+        TofAlignedFree(mStorage);
+        mStorage = NULL;
+    }
+
+    for (UINT32 i = 0; i < TOF_RING_MAX_SLOTS; i++)
+    {
+        mSlots[i].pData = NULL;
+        mSlots[i].FrameWords = 0;
+        mSlots[i].SequenceNumber = 0;
+        mSlots[i].DeviceFrame = 0;
+    }
+
+    mSlotCount = 0;
+    mSlotMask = 0;
+    mFrameWords = 0;
+}
+
+// ****************************************************************************
+
+void TofFrameRing::GetStats(TofRingStats* pStats) const
+{
+    pStats->Published = mHead.load(std::memory_order_relaxed);
+    pStats->Dropped = mDropped.load(std::memory_order_relaxed);
+    pStats->Skipped = mSkipped.load(std::memory_order_relaxed);
+}
+
+// ****************************************************************************
+//  Producer: returns the next free slot, or NULL (and counts a drop) if the
+//  consumer still owns every slot
+// ****************************************************************************
+
+TofRingSlot* TofFrameRing::BeginWrite()
+{
+    UINT32 Head = mHead.load(std::memory_order_relaxed);
+    UINT32 Tail = mTail.load(std::memory_order_acquire);
+
+
+    if ((mSlotCount == 0) || ((Head - Tail) >= mSlotCount))
+    {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    return &mSlots[Head & mSlotMask];
+}
+
+// ****************************************************************************
+//  Producer: publishes the slot returned by BeginWrite
+// ****************************************************************************
+
+void TofFrameRing::EndWrite()
+{
+    mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// ****************************************************************************
+//  Consumer: returns the oldest unread frame, or NULL if there is none
+// ****************************************************************************
+
+const TofRingSlot* TofFrameRing::BeginRead()
+{
+    UINT32 Tail = mTail.load(std::memory_order_relaxed);
+
+
+    // A frame held by ReadLatest() has already been seen
+    if (mHolding)
+    {
+        Tail++;
+        mTail.store(Tail, std::memory_order_release);
+        mHolding = FALSE;
+    }
+
+    if (Tail == mHead.load(std::memory_order_acquire))
+    {
+        return NULL;
+    }
+
+    return &mSlots[Tail & mSlotMask];
+}
+
+// ****************************************************************************
+//  Consumer: hands the slot returned by BeginRead back to the producer
+// ****************************************************************************
+
+void TofFrameRing::EndRead()
+{
+    mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// ****************************************************************************
+//  Consumer: releases everything older than the newest frame and returns the
+//  newest one. The returned slot stays owned by the consumer until the next
+//  ReadLatest() or BeginRead() call, so it can be redrawn without copying.
+//  Returns NULL if there is neither a new nor a held frame.
+// ****************************************************************************
+
+const TofRingSlot* TofFrameRing::ReadLatest()
+{
+    UINT32 Head = mHead.load(std::memory_order_acquire);
+    UINT32 Tail = mTail.load(std::memory_order_relaxed);
+    UINT32 Newest;
+
+
+    if (Head == Tail)
+    {
+        return NULL;
+    }
+
+    Newest = Head - 1;
+
+    if (Newest != Tail)
+    {
+        mSkipped.fetch_add((Newest - Tail) - (mHolding ? 1 : 0), std::memory_order_relaxed);
+        mTail.store(Newest, std::memory_order_release);
+    }
+
+    mHolding = TRUE;
+
+    return &mSlots[Newest & mSlotMask];
+}
+
+// ****************************************************************************
@@ -0,0 +1,101 @@
+// ****************************************************************************
+//  TofFrameRing.h
+//
+// Lock-free single-producer/single-consumer ring of preallocated ToF frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include "PicoP_TLC_Api.h"
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+typedef std::chrono::steady_clock TofClock;
+
+// Ring sizes are rounded up to a power of two
+#define TOF_RING_MAX_SLOTS      64
+
+// ****************************************************************************
+// One preallocated frame. pData is cache line aligned and large enough for the
+// frame size the ring was created with.
+// ****************************************************************************
+
+typedef struct
+{
+    UINT32* pData;                      // Frame words as returned by PicoP_TLC_AcquireTofFrame
+    UINT32 FrameWords;                  // Valid words in pData
+    UINT32 SequenceNumber;              // Set by the producer
+    UINT32 DeviceFrame;                 // Set by the producer
+    TofClock::time_point EventTime;     // Set by the producer
+} TofRingSlot;
+
+typedef struct
+{
+    UINT32 Published;                   // Frames made visible to the consumer
+    UINT32 Dropped;                     // Frames the producer could not store (ring full)
+    UINT32 Skipped;                     // Frames the consumer passed over in ReadLatest()
+} TofRingStats;
+
+// ****************************************************************************
+// The producer (acquisition thread) calls BeginWrite/EndWrite and never blocks:
+// when every slot is in use BeginWrite returns NULL and the frame is counted
+// as dropped. The consumer (display thread) either walks the frames in order
+// with BeginRead/EndRead or jumps to the newest one with ReadLatest. A slot is
+// never handed to the producer while the consumer holds it, so the consumer
+// can't see a torn frame.
+// ****************************************************************************
+
+class TofFrameRing
+{
+public:
+    TofFrameRing();
+    ~TofFrameRing();
+
+    PICOP_RC Create(UINT32 FrameBytes, UINT32 SlotCount);
+    void Destroy();
+
+    UINT32 GetSlotCount() const { return mSlotCount; }
+    UINT32 GetFrameWords() const { return mFrameWords; }
+    void GetStats(TofRingStats* pStats) const;
+
+    // Producer side
+    TofRingSlot* BeginWrite();
+    void EndWrite();
+
+    // Consumer side
+    const TofRingSlot* BeginRead();
+    void EndRead();
+    const TofRingSlot* ReadLatest();
+
+private:
+    TofFrameRing(const TofFrameRing&);
+    TofFrameRing& operator=(const TofFrameRing&);
+
+    // Written by the producer only
+    alignas(TOF_CACHE_LINE_SIZE) std::atomic<UINT32> mHead;
+    std::atomic<UINT32> mDropped;
+
+    // Written by the consumer only
+    alignas(TOF_CACHE_LINE_SIZE) std::atomic<UINT32> mTail;
+    std::atomic<UINT32> mSkipped;
+    BOOL mHolding;                      // ReadLatest() owns the slot at mTail
+
+    alignas(TOF_CACHE_LINE_SIZE) TofRingSlot mSlots[TOF_RING_MAX_SLOTS];
+    UINT8* mStorage;
+    UINT32 mSlotCount;
+    UINT32 mSlotMask;
+    UINT32 mFrameWords;
+};
+
+// ****************************************************************************
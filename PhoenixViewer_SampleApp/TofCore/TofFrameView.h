@@ -0,0 +1,100 @@
+// ****************************************************************************
+//  TofFrameView.h
+//
+// Non-owning, typed view of the planes inside an acquired ToF frame
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stddef.h>
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+// A time (depth) plane and an amplitude plane, each NumLines lines of
+// NumPulses words. A view just points into the buffer it was made from, so it
+// is only valid while the buffer is (for a ring slot, until the slot is
+// released).
+// ****************************************************************************
+
+typedef struct
+{
+    const UINT32* pTime;                // NumLines * NumPulses time words
+    const UINT32* pAmplitude;           // NumLines * NumPulses amplitude words
+    UINT32 NumPulses;                   // Pulses per line
+    UINT32 NumLines;                    // Lines per frame
+    PicoP_ToFDataFormatE Format;        // Format the frame was acquired in
+} TofFrameView;
+
+// ****************************************************************************
+
+inline void TofClearFrameView(TofFrameView* pView)
+{
+    pView->pTime = NULL;
+    pView->pAmplitude = NULL;
+    pView->NumPulses = 0;
+    pView->NumLines = 0;
+    pView->Format = eTOF_DATA_FUSED;
+}
+
+// ****************************************************************************
+//  Points pView at the planes in pData without copying anything. Only the
+//  depth + amplitude formats (fused, left or right detector) are laid out
+//  that way; TofFrameDecoder handles the others.
+// ****************************************************************************
+
+inline PICOP_RC TofMakeFrameView(const UINT32* pData, UINT32 FrameWords,
+                                 UINT32 NumPulses, UINT32 NumLines,
+                                 PicoP_ToFDataFormatE Format, TofFrameView* pView)
+{
+    UINT32 PlaneWords = NumPulses * NumLines;
+
+
+    TofClearFrameView(pView);
+
+    if ((pData == NULL) || (PlaneWords == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((Format != eTOF_DATA_FUSED) &&
+        (Format != eTOF_DATA_LEFT_SENSOR_ONLY) &&
+        (Format != eTOF_DATA_RIGHT_SENSOR_ONLY))
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    if (FrameWords < (PlaneWords * 2))
+    {
+        return eFRAME_ERROR;
+    }
+
+    pView->pTime = pData;
+    pView->pAmplitude = pData + PlaneWords;
+    pView->NumPulses = NumPulses;
+    pView->NumLines = NumLines;
+    pView->Format = Format;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+inline const UINT32* TofTimeLine(const TofFrameView* pView, UINT32 Line)
+{
+    return pView->pTime + (size_t)Line * pView->NumPulses;
+}
+
+inline const UINT32* TofAmplitudeLine(const TofFrameView* pView, UINT32 Line)
+{
+    return pView->pAmplitude + (size_t)Line * pView->NumPulses;
+}
+
+// ****************************************************************************
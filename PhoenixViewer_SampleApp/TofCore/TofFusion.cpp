@@ -0,0 +1,507 @@
+// ****************************************************************************
+//  TofFusion.cpp
+//
+// Host side fusion of the two detectors of eTOF_DATA_ALL frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <string.h>
+#include "TofFusion.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+#define TOF_FUSION_PLANES           4
+#define TOF_FUSION_BAND_ALIGN       16          // Pixels; bands start on a cache line
+#define TOF_FUSION_MAX_SIGNED       0x7fffffffu
+
+// ****************************************************************************
+//  One pixel. The weighted time is worked out in single precision in the
+//  same order as the vector code, so both round the same way.
+// ****************************************************************************
+
+static inline BOOL TofFusePixel(UINT32 LeftTime, UINT32 LeftAmplitude, UINT32 RightTime, UINT32 RightAmplitude,
+                                const TofFusionParams* pParams, UINT32* pTime, UINT32* pAmplitude)
+{
+    BOOL LeftValid = (LeftTime != 0) && (LeftAmplitude >= pParams->MinAmplitude);
+    BOOL RightValid = (RightTime != 0) && (RightAmplitude >= pParams->MinAmplitude);
+    FP32 LeftWeight = LeftValid ? (FP32)LeftAmplitude : 0.0f;
+    FP32 RightWeight = RightValid ? (FP32)RightAmplitude : 0.0f;
+    FP32 Sum;
+    INT32 Difference;
+
+
+    if (pParams->Policy == eTOF_FUSE_MEAN)
+    {
+        *pTime = (LeftTime + RightTime) >> 1;
+        *pAmplitude = (LeftAmplitude + RightAmplitude) >> 1;
+        return FALSE;
+    }
+
+    *pTime = 0;
+    *pAmplitude = 0;
+
+    if (( ! LeftValid) && ( ! RightValid))
+    {
+        return FALSE;
+    }
+
+    if (pParams->Policy == eTOF_FUSE_MAX_CONFIDENCE)
+    {
+        *pTime = (RightWeight > LeftWeight) ? RightTime : LeftTime;
+        *pAmplitude = (RightWeight > LeftWeight) ? RightAmplitude : LeftAmplitude;
+        return FALSE;
+    }
+
+    if ((pParams->Policy == eTOF_FUSE_REJECT_DISAGREEMENT) && LeftValid && RightValid)
+    {
+        Difference = (INT32)(LeftTime - RightTime);
+        Difference = (Difference < 0) ? -Difference : Difference;
+
+        if ((UINT32)Difference > pParams->MaxDisagreement)
+        {
+            return TRUE;
+        }
+    }
+
+    Sum = LeftWeight + RightWeight;
+    *pTime = (UINT32)lrintf((((FP32)LeftTime * LeftWeight) + ((FP32)RightTime * RightWeight)) /
+                            ((Sum > 1.0f) ? Sum : 1.0f));
+    *pAmplitude = (LeftValid ? LeftAmplitude : 0) + (RightValid ? RightAmplitude : 0);
+    *pAmplitude >>= (LeftValid && RightValid) ? 1 : 0;
+
+    return FALSE;
+}
+
+// ****************************************************************************
+//  Fuses Count pixels, returns how many were rejected. Words with the top bit
+//  set would convert as negative, so a group holding one goes through the
+//  scalar path; the mean needs no conversion.
+// ****************************************************************************
+
+static uint64_t TofFusePixels(const UINT32* pLeftTime, const UINT32* pLeftAmplitude,
+                              const UINT32* pRightTime, const UINT32* pRightAmplitude, UINT32 Count,
+                              const TofFusionParams* pParams, UINT32* pTime, UINT32* pAmplitude)
+{
+    uint64_t Rejected = 0;
+    UINT32 i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i Zero = _mm_setzero_si128();
+    const __m128i Ones = _mm_set1_epi32(-1);
+    const __m128i MinAmplitude = _mm_set1_epi32((int)pParams->MinAmplitude);
+    const __m128i MaxDisagreement = _mm_set1_epi32((int)pParams->MaxDisagreement);
+    const __m128 One = _mm_set1_ps(1.0f);
+    __m128i RejectCount = _mm_setzero_si128();
+    UINT32 Lanes[4];
+    TofFusionPolicyE Policy = pParams->Policy;
+
+    for (; (i + 4) <= Count; i += 4)
+    {
+        __m128i LeftTime = _mm_loadu_si128((const __m128i*)(pLeftTime + i));
+        __m128i LeftAmplitude = _mm_loadu_si128((const __m128i*)(pLeftAmplitude + i));
+        __m128i RightTime = _mm_loadu_si128((const __m128i*)(pRightTime + i));
+        __m128i RightAmplitude = _mm_loadu_si128((const __m128i*)(pRightAmplitude + i));
+        __m128i Time;
+        __m128i Amplitude;
+
+        if (Policy == eTOF_FUSE_MEAN)
+        {
+            _mm_storeu_si128((__m128i*)(pTime + i), _mm_srli_epi32(_mm_add_epi32(LeftTime, RightTime), 1));
+            _mm_storeu_si128((__m128i*)(pAmplitude + i),
+                             _mm_srli_epi32(_mm_add_epi32(LeftAmplitude, RightAmplitude), 1));
+            continue;
+        }
+
+        if (_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(LeftTime, LeftAmplitude),
+                                                          _mm_or_si128(RightTime, RightAmplitude)))) != 0)
+        {
+            for (UINT32 j = i; j < (i + 4); j++)
+            {
+                Rejected += TofFusePixel(pLeftTime[j], pLeftAmplitude[j], pRightTime[j], pRightAmplitude[j],
+                                         pParams, pTime + j, pAmplitude + j);
+            }
+
+            continue;
+        }
+
+        __m128i LeftMissing = _mm_or_si128(_mm_cmpeq_epi32(LeftTime, Zero), _mm_cmplt_epi32(LeftAmplitude, MinAmplitude));
+        __m128i RightMissing = _mm_or_si128(_mm_cmpeq_epi32(RightTime, Zero), _mm_cmplt_epi32(RightAmplitude, MinAmplitude));
+        __m128i Any = _mm_andnot_si128(_mm_and_si128(LeftMissing, RightMissing), Ones);
+        __m128i Both = _mm_andnot_si128(_mm_or_si128(LeftMissing, RightMissing), Ones);
+        __m128i LeftUsed = _mm_andnot_si128(LeftMissing, LeftAmplitude);
+        __m128i RightUsed = _mm_andnot_si128(RightMissing, RightAmplitude);
+
+        if (Policy == eTOF_FUSE_MAX_CONFIDENCE)
+        {
+            __m128i PickRight = _mm_cmpgt_epi32(RightUsed, LeftUsed);
+
+            Time = _mm_or_si128(_mm_and_si128(PickRight, RightTime), _mm_andnot_si128(PickRight, LeftTime));
+            Amplitude = _mm_or_si128(_mm_and_si128(PickRight, RightAmplitude),
+                                     _mm_andnot_si128(PickRight, LeftAmplitude));
+            _mm_storeu_si128((__m128i*)(pTime + i), _mm_and_si128(Any, Time));
+            _mm_storeu_si128((__m128i*)(pAmplitude + i), _mm_and_si128(Any, Amplitude));
+            continue;
+        }
+
+        __m128 LeftWeight = _mm_cvtepi32_ps(LeftUsed);
+        __m128 RightWeight = _mm_cvtepi32_ps(RightUsed);
+        __m128 Sum = _mm_max_ps(_mm_add_ps(LeftWeight, RightWeight), One);
+        __m128 Weighted = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(LeftTime), LeftWeight),
+                                     _mm_mul_ps(_mm_cvtepi32_ps(RightTime), RightWeight));
+        __m128i AmplitudeSum = _mm_add_epi32(LeftUsed, RightUsed);
+
+        Time = _mm_and_si128(Any, _mm_cvtps_epi32(_mm_div_ps(Weighted, Sum)));
+        Amplitude = _mm_or_si128(_mm_and_si128(Both, _mm_srli_epi32(AmplitudeSum, 1)),
+                                 _mm_andnot_si128(Both, AmplitudeSum));
+
+        if (Policy == eTOF_FUSE_REJECT_DISAGREEMENT)
+        {
+            __m128i Difference = _mm_sub_epi32(LeftTime, RightTime);
+            __m128i Sign = _mm_srai_epi32(Difference, 31);
+            __m128i Distance = _mm_sub_epi32(_mm_xor_si128(Difference, Sign), Sign);
+            __m128i Reject = _mm_and_si128(Both, _mm_cmpgt_epi32(Distance, MaxDisagreement));
+
+            Time = _mm_andnot_si128(Reject, Time);
+            Amplitude = _mm_andnot_si128(Reject, Amplitude);
+            RejectCount = _mm_sub_epi32(RejectCount, Reject);
+        }
+
+        _mm_storeu_si128((__m128i*)(pTime + i), Time);
+        _mm_storeu_si128((__m128i*)(pAmplitude + i), Amplitude);
+    }
+
+    _mm_storeu_si128((__m128i*)Lanes, RejectCount);
+    Rejected += (uint64_t)Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+#endif
+
+    for (; i < Count; i++)
+    {
+        Rejected += TofFusePixel(pLeftTime[i], pLeftAmplitude[i], pRightTime[i], pRightAmplitude[i],
+                                 pParams, pTime + i, pAmplitude + i);
+    }
+
+    return Rejected;
+}
+
+// ****************************************************************************
+
+void TofDefaultFusionParams(TofFusionParams* pParams)
+{
+    pParams->Policy = eTOF_FUSE_AMPLITUDE_WEIGHTED;
+    pParams->MinAmplitude = 16;
+    pParams->MaxDisagreement = 100;
+}
+
+// ****************************************************************************
+
+TofFuser::TofFuser()
+    : mPlaneWords(0),
+      mNumPulses(0),
+      mNumLines(0),
+      mBands(0),
+      mpData(NULL),
+      mpTime(NULL),
+      mpAmplitude(NULL),
+      mGeneration(0),
+      mBandsPending(0),
+      mStopRequested(FALSE)
+{
+    TofDefaultFusionParams(&mParams);
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+TofFuser::~TofFuser()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Starts Threads - 1 workers
+// ****************************************************************************
+
+PICOP_RC TofFuser::Create(UINT32 NumPulses, UINT32 NumLines, const TofFusionParams* pParams, UINT32 Threads)
+{
+    PICOP_RC PicopRc;
+    UINT32 MaxBands;
+
+
+    if ((NumPulses == 0) || (NumLines == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    PicopRc = SetParams(pParams);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    mNumPulses = NumPulses;
+    mNumLines = NumLines;
+    mPlaneWords = NumPulses * NumLines;
+
+    if (Threads == 0)
+    {
+        Threads = std::thread::hardware_concurrency();
+    }
+
+    // A band smaller than a few cache lines is no use
+    MaxBands = (mPlaneWords + (4 * TOF_FUSION_BAND_ALIGN) - 1) / (4 * TOF_FUSION_BAND_ALIGN);
+    mBands = (Threads == 0) ? 1 : Threads;
+    mBands = (mBands > MaxBands) ? MaxBands : mBands;
+    mBandRejected.assign(mBands, 0);
+    memset(&mStats, 0, sizeof(mStats));
+    mStopRequested = FALSE;
+
+    for (UINT32 Band = 1; Band < mBands; Band++)
+    {
+        mWorkers.push_back(std::thread(&TofFuser::WorkerThread, this, Band, mGeneration));
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofFuser::Destroy()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStopRequested = TRUE;
+    }
+
+    mWake.notify_all();
+
+    for (size_t i = 0; i < mWorkers.size(); i++)
+    {
+        mWorkers[i].join();
+    }
+
+    mWorkers.clear();
+    mBandRejected.clear();
+    mPlaneWords = 0;
+    mNumPulses = 0;
+    mNumLines = 0;
+    mBands = 0;
+}
+
+// ****************************************************************************
+//  The thresholds are clamped so the vector code can compare them signed
+// ****************************************************************************
+
+PICOP_RC TofFuser::SetParams(const TofFusionParams* pParams)
+{
+    if ((pParams == NULL) || (pParams->Policy > eTOF_FUSE_REJECT_DISAGREEMENT))
+    {
+        return eINVALID_ARG;
+    }
+
+    mParams = *pParams;
+    mParams.MinAmplitude = (mParams.MinAmplitude == 0) ? 1 : mParams.MinAmplitude;
+    mParams.MinAmplitude = (mParams.MinAmplitude > TOF_FUSION_MAX_SIGNED) ? TOF_FUSION_MAX_SIGNED : mParams.MinAmplitude;
+    mParams.MaxDisagreement = (mParams.MaxDisagreement > TOF_FUSION_MAX_SIGNED) ? TOF_FUSION_MAX_SIGNED : mParams.MaxDisagreement;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFuser::Fuse(const UINT32* pData, UINT32 FrameWords, UINT32* pTime, UINT32* pAmplitude)
+{
+    if (mBands == 0)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if ((pData == NULL) || (pTime == NULL) || (pAmplitude == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (FrameWords < (mPlaneWords * TOF_FUSION_PLANES))
+    {
+        return eFRAME_ERROR;
+    }
+
+    mpData = pData;
+    mpTime = pTime;
+    mpAmplitude = pAmplitude;
+    Run();
+
+    mStats.Frames++;
+
+    for (UINT32 Band = 0; Band < mBands; Band++)
+    {
+        mStats.PixelsRejected += mBandRejected[Band];
+    }
+
+    return eSUCCESS;
+}
+
+PICOP_RC TofFuser::Fuse(const UINT32* pData, UINT32 FrameWords, TofFrame* pFrame)
+{
+    if ((pFrame->GetNumPulses() != mNumPulses) || (pFrame->GetNumLines() != mNumLines))
+    {
+        return eFRAME_ERROR;
+    }
+
+    return Fuse(pData, FrameWords, pFrame->GetTime(), pFrame->GetAmplitude());
+}
+
+// ****************************************************************************
+//  Releases the workers on the current frame, fuses band 0 here and waits
+//  for the rest
+// ****************************************************************************
+
+void TofFuser::Run()
+{
+    if (mBands > 1)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(mLock);
+            mBandsPending = mBands - 1;
+            mGeneration++;
+        }
+
+        mWake.notify_all();
+    }
+
+    FuseBand(0);
+
+    if (mBands > 1)
+    {
+        std::unique_lock<std::mutex> Lock(mLock);
+
+        while (mBandsPending != 0)
+        {
+            mDone.wait(Lock);
+        }
+    }
+
+    mpData = NULL;
+    mpTime = NULL;
+    mpAmplitude = NULL;
+}
+
+// ****************************************************************************
+
+void TofFuser::FuseBand(UINT32 Band)
+{
+    UINT32 Groups = (mPlaneWords + TOF_FUSION_BAND_ALIGN - 1) / TOF_FUSION_BAND_ALIGN;
+    UINT32 First = ((Band * Groups) / mBands) * TOF_FUSION_BAND_ALIGN;
+    UINT32 End = (((Band + 1) * Groups) / mBands) * TOF_FUSION_BAND_ALIGN;
+
+
+    End = (End > mPlaneWords) ? mPlaneWords : End;
+
+    mBandRejected[Band] = TofFusePixels(mpData + First, mpData + mPlaneWords + First,
+                                        mpData + (2 * (size_t)mPlaneWords) + First,
+                                        mpData + (3 * (size_t)mPlaneWords) + First,
+                                        End - First, &mParams, mpTime + First, mpAmplitude + First);
+}
+
+// ****************************************************************************
+//  Fuses band Band of every frame Run() releases. Generation is the frame
+//  count when the worker was started, so a frame released before the worker
+//  first takes the lock is not missed.
+// ****************************************************************************
+
+void TofFuser::WorkerThread(UINT32 Band, UINT32 Generation)
+{
+    std::unique_lock<std::mutex> Lock(mLock);
+
+
+    for (;;)
+    {
+        while ((mGeneration == Generation) && ( ! mStopRequested))
+        {
+            mWake.wait(Lock);
+        }
+
+        if (mStopRequested)
+        {
+            break;
+        }
+
+        Generation = mGeneration;
+        Lock.unlock();
+
+        FuseBand(Band);
+
+        Lock.lock();
+
+        if (--mBandsPending == 0)
+        {
+            mDone.notify_one();
+        }
+    }
+}
+
+// ****************************************************************************
+
+TofFusionStage::TofFusionStage(const TofFusionParams* pParams, UINT32 Threads)
+    : mThreads(Threads)
+{
+    TofDefaultFusionParams(&mParams);
+
+    if (pParams != NULL)
+    {
+        mParams = *pParams;
+    }
+}
+
+PICOP_RC TofFusionStage::Start(const TofFrameGeometry* pGeometry)
+{
+    if (pGeometry->Format != eTOF_DATA_ALL)
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    return mFuser.Create(pGeometry->NumPulses, pGeometry->NumLines, &mParams, mThreads);
+}
+
+PICOP_RC TofFusionStage::Process(TofPipelineFrame* pFrame)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mFuser.Fuse(pFrame->pRaw, pFrame->FrameWords, pFrame->pPlanes);
+}
+
+PICOP_RC TofFusionStage::SetParams(const TofFusionParams* pParams)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if (pParams == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    mParams = *pParams;
+
+    return (mFuser.GetThreadCount() != 0) ? mFuser.SetParams(pParams) : eSUCCESS;
+}
+
+void TofFusionStage::GetStats(TofFusionStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    mFuser.GetStats(pStats);
+}
+
+// ****************************************************************************
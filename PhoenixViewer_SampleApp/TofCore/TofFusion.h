@@ -0,0 +1,151 @@
+// ****************************************************************************
+//  TofFusion.h
+//
+// Host side fusion of the two detectors of eTOF_DATA_ALL frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFrame.h"
+#include "TofPipeline.h"
+
+// ****************************************************************************
+// An eTOF_DATA_ALL frame holds four planes: left time, left amplitude, right
+// time, right amplitude. Fusing them on the host instead of in firmware
+// (eTOF_DATA_FUSED) costs twice the link bandwidth but makes the rule
+// selectable. A detector's pixel counts as a return when its time is not 0
+// and its amplitude is at least MinAmplitude.
+//
+//   eTOF_FUSE_MEAN                 (left + right) / 2 in both planes, returns
+//                                  or not, as the simulator's fused format
+//   eTOF_FUSE_AMPLITUDE_WEIGHTED   time weighted by the amplitudes of the
+//                                  detectors with a return; amplitude their
+//                                  mean
+//   eTOF_FUSE_MAX_CONFIDENCE       time and amplitude of the detector with
+//                                  the larger amplitude
+//   eTOF_FUSE_REJECT_DISAGREEMENT  as weighted, but a pixel whose detectors
+//                                  both returned more than MaxDisagreement
+//                                  counts apart is dropped (time 0): one of
+//                                  them saw a mixed or multipath return
+// ****************************************************************************
+
+typedef enum
+{
+    eTOF_FUSE_MEAN = 0,
+    eTOF_FUSE_AMPLITUDE_WEIGHTED,
+    eTOF_FUSE_MAX_CONFIDENCE,
+    eTOF_FUSE_REJECT_DISAGREEMENT
+} TofFusionPolicyE;
+
+typedef struct
+{
+    TofFusionPolicyE Policy;
+    UINT32 MinAmplitude;                // Weaker returns are ignored; 0 counts as 1
+    UINT32 MaxDisagreement;             // eTOF_FUSE_REJECT_DISAGREEMENT, in time counts
+} TofFusionParams;
+
+typedef struct
+{
+    uint64_t Frames;
+    uint64_t PixelsRejected;            // Dropped by eTOF_FUSE_REJECT_DISAGREEMENT
+} TofFusionStats;
+
+void TofDefaultFusionParams(TofFusionParams* pParams);
+
+// ****************************************************************************
+// Fuses NumPulses x NumLines frames into a time and an amplitude plane. The
+// pixels are split into one band per thread as in TofProjector, four at a
+// time where TofSimd.h allows; the results match the scalar code exactly.
+// Only one thread may call Fuse() at a time.
+// ****************************************************************************
+
+class TofFuser
+{
+public:
+    TofFuser();
+    ~TofFuser();
+
+    // Threads 0 uses one thread per processor
+    PICOP_RC Create(UINT32 NumPulses, UINT32 NumLines, const TofFusionParams* pParams, UINT32 Threads);
+    void Destroy();
+
+    // Takes effect from the next Fuse(); not to be called during one
+    PICOP_RC SetParams(const TofFusionParams* pParams);
+
+    PICOP_RC Fuse(const UINT32* pData, UINT32 FrameWords, UINT32* pTime, UINT32* pAmplitude);
+    PICOP_RC Fuse(const UINT32* pData, UINT32 FrameWords, TofFrame* pFrame);
+
+    UINT32 GetThreadCount() const { return mBands; }
+    void GetStats(TofFusionStats* pStats) const { *pStats = mStats; }
+
+private:
+    TofFuser(const TofFuser&);
+    TofFuser& operator=(const TofFuser&);
+
+    void Run();
+    void FuseBand(UINT32 Band);
+    void WorkerThread(UINT32 Band, UINT32 Generation);
+
+    TofFusionParams mParams;
+    UINT32 mPlaneWords;
+    UINT32 mNumPulses;
+    UINT32 mNumLines;
+    UINT32 mBands;
+    std::vector<uint64_t> mBandRejected;    // Written by each band, summed after the frame
+    TofFusionStats mStats;
+
+    // The frame being fused
+    const UINT32* mpData;
+    UINT32* mpTime;
+    UINT32* mpAmplitude;
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    UINT32 mGeneration;                 // Bumped for every frame
+    UINT32 mBandsPending;
+    BOOL mStopRequested;
+};
+
+// ****************************************************************************
+// Pipeline stage fusing pRaw into pPlanes, in place of the TofDecodeStage
+// (which only takes the mean) for pipelines started with an eTOF_DATA_ALL
+// geometry. Threads split each frame, as for TofProjectStage.
+// ****************************************************************************
+
+class TofFusionStage : public TofPipelineStage
+{
+public:
+    TofFusionStage(const TofFusionParams* pParams, UINT32 Threads);
+
+    virtual const char* GetName() const { return "fuse"; }
+    virtual PICOP_RC Start(const TofFrameGeometry* pGeometry);
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+    // May be called while the pipeline runs, to tune the fusion live
+    PICOP_RC SetParams(const TofFusionParams* pParams);
+    void GetStats(TofFusionStats* pStats);
+
+private:
+    TofFusionParams mParams;
+    UINT32 mThreads;
+    TofFuser mFuser;
+    std::mutex mLock;                   // The fuser takes one frame at a time
+};
+
+// ****************************************************************************
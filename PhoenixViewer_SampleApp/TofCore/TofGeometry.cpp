@@ -0,0 +1,179 @@
+// ****************************************************************************
+//  TofGeometry.cpp
+//
+// Frame geometry negotiated with the device at connect time
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "TofGeometry.h"
+
+// ****************************************************************************
+
+UINT32 TofPlanesPerFrame(PicoP_ToFDataFormatE Format)
+{
+    switch (Format)
+    {
+    case eTOF_DATA_FUSED:
+    case eTOF_DATA_LEFT_SENSOR_ONLY:
+    case eTOF_DATA_RIGHT_SENSOR_ONLY:
+        return 2;                       // Depth, amplitude
+
+    case eTOF_DATA_DEPTH_ONLY:
+    case eTOF_DATA_AMPLITUDE_ONLY:
+        return 2;                       // Left, right
+
+    case eTOF_DATA_ALL:
+        return 4;                       // Depth and amplitude of each detector
+
+    default:
+        return 0;
+    }
+}
+
+// ****************************************************************************
+
+UINT32 TofTdcBPlanesPerFrame(PicoP_ToFDataFormatE Format)
+{
+    switch (Format)
+    {
+    case eTOF_DATA_RIGHT_SENSOR_ONLY:
+        return 2;
+
+    case eTOF_DATA_DEPTH_ONLY:
+    case eTOF_DATA_AMPLITUDE_ONLY:
+        return 1;                       // Right
+
+    case eTOF_DATA_ALL:
+        return 2;
+
+    default:
+        return 0;
+    }
+}
+
+// ****************************************************************************
+
+UINT32 TofLinkBytesPerFrame(PicoP_ToFDataFormatE Format, UINT32 PlaneWords)
+{
+    return TofPlanesPerFrame(Format) * PlaneWords * sizeof(UINT32);
+}
+
+UINT32 TofTdcBReadBytes(UINT32 PlaneWords, UINT32 DOutBScale)
+{
+    uint64_t Bytes = (uint64_t)PlaneWords * 2 * sizeof(UINT32);
+
+
+    DOutBScale = (DOutBScale > DOUTB_SCALE_MAX) ? DOUTB_SCALE_MAX : DOutBScale;
+
+    return (UINT32)((Bytes * DOutBScale) / DOUTB_SCALE_MAX);
+}
+
+// ****************************************************************************
+//  The number of lines is not reported directly, it follows from the frame
+//  size once the pulses per line and the number of planes are known.
+// ****************************************************************************
+
+PICOP_RC TofMakeFrameGeometry(const PicoP_TofPulsingConfig* pConfig, PicoP_ToFDataFormatE Format,
+                              UINT32 FrameBytes, TofFrameGeometry* pGeometry)
+{
+    UINT32 LineBytes;
+
+
+    if ((pConfig == NULL) || (pGeometry == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    memset(pGeometry, 0, sizeof(TofFrameGeometry));
+
+    if (pConfig->nrPulsesPerLine == 0)
+    {
+        return eINVALID_ARG;
+    }
+
+    if (pConfig->nrPulsesPerLine > TOF_MAX_PULSES_PER_LINE)
+    {
+        return eNUM_PULSES_PER_LINE_TOO_LARGE;
+    }
+
+    // 0 means no phasing
+    pGeometry->LinePhases = (pConfig->nrLinePhases == 0) ? 1 : pConfig->nrLinePhases;
+    pGeometry->FramePhases = (pConfig->nrFramePhases == 0) ? 1 : pConfig->nrFramePhases;
+
+    if (((pGeometry->LinePhases != 1) && (pGeometry->LinePhases != 2) && (pGeometry->LinePhases != 4)) ||
+        (pGeometry->FramePhases > TOF_MAX_FRAME_PHASES))
+    {
+        return eINVALID_ARG;
+    }
+
+    pGeometry->NumPlanes = TofPlanesPerFrame(Format);
+
+    if (pGeometry->NumPlanes == 0)
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    LineBytes = pConfig->nrPulsesPerLine * pGeometry->NumPlanes * sizeof(UINT32);
+
+    if ((FrameBytes == 0) || ((FrameBytes % LineBytes) != 0) ||
+        (((FrameBytes / LineBytes) % pGeometry->LinePhases) != 0))
+    {
+        return eFRAME_ERROR;
+    }
+
+    pGeometry->Format = Format;
+    pGeometry->NumPulses = pConfig->nrPulsesPerLine;
+    pGeometry->NumLines = FrameBytes / LineBytes;
+    pGeometry->PlaneWords = pGeometry->NumPulses * pGeometry->NumLines;
+    pGeometry->FrameWords = pGeometry->PlaneWords * pGeometry->NumPlanes;
+    pGeometry->FrameBytes = FrameBytes;
+    pGeometry->ImagePulses = pGeometry->NumPulses * pGeometry->LinePhases;
+    pGeometry->ImageLines = pGeometry->NumLines / pGeometry->LinePhases;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofQueryFrameGeometry(PicoP_HANDLE ConnectionHandle, TofFrameGeometry* pGeometry)
+{
+    PicoP_TofPulsingConfig PulsingConfig;
+    PicoP_ToFDataFormatE Format;
+    UINT32 FrameBytes = 0;
+    PICOP_RC PicopRc;
+
+
+    PicopRc = PicoP_TLC_GetTofPulsingConfig(ConnectionHandle, &PulsingConfig, eCURRENT_VALUE);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    PicopRc = PicoP_TLC_GetTofDataFormat(ConnectionHandle, &Format, eCURRENT_VALUE);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    PicopRc = PicoP_TLC_GetTofFrameDimensions(ConnectionHandle, &FrameBytes);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    return TofMakeFrameGeometry(&PulsingConfig, Format, FrameBytes, pGeometry);
+}
+
+// ****************************************************************************
@@ -0,0 +1,73 @@
+// ****************************************************************************
+//  TofGeometry.h
+//
+// Frame geometry negotiated with the device at connect time
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+
+#define TOF_MAX_PULSES_PER_LINE     1024
+#define TOF_MAX_LINE_PHASES         4
+#define TOF_MAX_FRAME_PHASES        4
+#define TOF_DOUTB_NO_SCALE          0xffffffffu     // A TDC B scale setting that leaves the device's scale as it is
+
+// ****************************************************************************
+// The device sends NumLines lines of NumPulses words per plane. With line
+// phasing, LinePhases consecutive lines sample the same scan line at offset
+// positions, so the image drawn from a frame is ImagePulses wide and
+// ImageLines high; the words are the same, only the line length changes.
+// ****************************************************************************
+
+typedef struct
+{
+    PicoP_ToFDataFormatE Format;        // Data format the frames are sent in
+    UINT32 NumPulses;                   // Pulses per acquired line (nrPulsesPerLine)
+    UINT32 NumLines;                    // Acquired lines per plane
+    UINT32 NumPlanes;                   // Planes per frame
+    UINT32 LinePhases;                  // 1, 2 or 4
+    UINT32 FramePhases;                 // 1 .. TOF_MAX_FRAME_PHASES
+    UINT32 PlaneWords;                  // NumPulses * NumLines
+    UINT32 FrameWords;                  // PlaneWords * NumPlanes
+    UINT32 FrameBytes;                  // As reported by PicoP_TLC_GetTofFrameDimensions
+    UINT32 ImagePulses;                 // NumPulses * LinePhases
+    UINT32 ImageLines;                  // NumLines / LinePhases
+} TofFrameGeometry;
+
+// ****************************************************************************
+
+UINT32 TofPlanesPerFrame(PicoP_ToFDataFormatE Format);
+
+// Planes of a frame taken from TDC B, the right detector. The fused planes
+// count as TDC A: they are built from both, but TDC B is not seen on its own.
+UINT32 TofTdcBPlanesPerFrame(PicoP_ToFDataFormatE Format);
+
+// Bytes a frame takes on the link. The device sends every plane of the
+// format whatever the TDC B scale, so this is the size
+// PicoP_TLC_GetTofFrameDimensions reports.
+UINT32 TofLinkBytesPerFrame(PicoP_ToFDataFormatE Format, UINT32 PlaneWords);
+
+// Bytes read from TDC B inside the device for a frame, time and amplitude,
+// when PicoP_TLC_SetDOutBScale reads DOutBScale / DOUTB_SCALE_MAX of them.
+// This is what the scale saves; the frame sent is the same size.
+UINT32 TofTdcBReadBytes(UINT32 PlaneWords, UINT32 DOutBScale);
+
+// Derives the geometry from a pulsing config, data format and frame size in bytes
+PICOP_RC TofMakeFrameGeometry(const PicoP_TofPulsingConfig* pConfig, PicoP_ToFDataFormatE Format,
+                              UINT32 FrameBytes, TofFrameGeometry* pGeometry);
+
+// Reads the current pulsing config, data format and frame size from the device
+PICOP_RC TofQueryFrameGeometry(PicoP_HANDLE ConnectionHandle, TofFrameGeometry* pGeometry);
+
+// ****************************************************************************
@@ -0,0 +1,230 @@
+// ****************************************************************************
+//  TofLzf.cpp
+//
+// LZF compression, the scheme PCD binary_compressed files use
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofLzf.h"
+
+// ****************************************************************************
+
+#define TOF_LZF_MAX_LITERALS    32
+#define TOF_LZF_MAX_OFFSET      8192
+#define TOF_LZF_MAX_MATCH       264         // 2 + 7 + 255
+
+// ****************************************************************************
+
+static inline UINT32 TofLzfHash(const UINT8* p)
+{
+    UINT32 Value = ((UINT32)p[0] << 16) | ((UINT32)p[1] << 8) | p[2];
+
+
+    return (Value * 2654435761u) >> (32 - TOF_LZF_HASH_BITS);
+}
+
+// ****************************************************************************
+
+size_t TofLzfMaxBytes(size_t InBytes)
+{
+    // Every TOF_LZF_MAX_LITERALS literals cost one control byte
+    return InBytes + (InBytes / TOF_LZF_MAX_LITERALS) + 2;
+}
+
+// ****************************************************************************
+//  Greedy single probe compressor. A byte is reserved for the control byte of
+//  the literal run in progress and filled in when the run ends; a run that
+//  ends empty gives its byte back. The table is cleared first so the output
+//  depends only on pIn, not on what was compressed before.
+// ****************************************************************************
+
+size_t TofLzfCompress(const UINT8* pIn, size_t InBytes, UINT8* pOut, size_t OutCapacity, UINT32* pTable)
+{
+    size_t In = 0;
+    size_t Out = 1;
+    size_t Literals = 0;
+    size_t Reference;
+    size_t Offset;
+    size_t MaxLength;
+    size_t Length;
+    UINT32 Hash;
+
+
+    if ((pIn == NULL) || (pOut == NULL) || (pTable == NULL) || (OutCapacity < TofLzfMaxBytes(InBytes)))
+    {
+        return 0;
+    }
+
+    memset(pTable, 0, TOF_LZF_TABLE_ENTRIES * sizeof(UINT32));
+
+    while ((In + 2) < InBytes)
+    {
+        // Table entries are position + 1 so 0 means empty
+        Hash = TofLzfHash(pIn + In);
+        Reference = pTable[Hash];
+        pTable[Hash] = (UINT32)(In + 1);
+
+        if ((Reference != 0) && ((In - Reference) < TOF_LZF_MAX_OFFSET) &&
+            (memcmp(pIn + Reference - 1, pIn + In, 3) == 0))
+        {
+            Reference--;
+            Offset = In - Reference - 1;
+            MaxLength = ((InBytes - In) < TOF_LZF_MAX_MATCH) ? (InBytes - In) : TOF_LZF_MAX_MATCH;
+            Length = 3;
+
+            while ((Length < MaxLength) && (pIn[Reference + Length] == pIn[In + Length]))
+            {
+                Length++;
+            }
+
+            if (Literals != 0)
+            {
+                pOut[Out - Literals - 1] = (UINT8)(Literals - 1);
+            }
+            else
+            {
+                Out--;
+            }
+
+            Length -= 2;
+
+            if (Length < 7)
+            {
+                pOut[Out++] = (UINT8)((Offset >> 8) + (Length << 5));
+            }
+            else
+            {
+                pOut[Out++] = (UINT8)((Offset >> 8) + (7 << 5));
+                pOut[Out++] = (UINT8)(Length - 7);
+            }
+
+            pOut[Out++] = (UINT8)Offset;
+            In += Length + 2;
+            Literals = 0;
+            Out++;
+
+            // Seed the table with the last position of the match so the
+            // next search can start from it
+            if ((In + 2) < InBytes)
+            {
+                pTable[TofLzfHash(pIn + In - 1)] = (UINT32)In;
+            }
+
+            continue;
+        }
+
+        pOut[Out++] = pIn[In++];
+        Literals++;
+
+        if (Literals == TOF_LZF_MAX_LITERALS)
+        {
+            pOut[Out - Literals - 1] = (UINT8)(Literals - 1);
+            Literals = 0;
+            Out++;
+        }
+    }
+
+    while (In < InBytes)
+    {
+        pOut[Out++] = pIn[In++];
+        Literals++;
+
+        if (Literals == TOF_LZF_MAX_LITERALS)
+        {
+            pOut[Out - Literals - 1] = (UINT8)(Literals - 1);
+            Literals = 0;
+            Out++;
+        }
+    }
+
+    if (Literals != 0)
+    {
+        pOut[Out - Literals - 1] = (UINT8)(Literals - 1);
+    }
+    else
+    {
+        Out--;
+    }
+
+    return Out;
+}
+
+// ****************************************************************************
+
+size_t TofLzfDecompress(const UINT8* pIn, size_t InBytes, UINT8* pOut, size_t OutCapacity)
+{
+    size_t In = 0;
+    size_t Out = 0;
+    size_t Length;
+    size_t Distance;
+    UINT32 Control;
+
+
+    if ((pIn == NULL) || (pOut == NULL))
+    {
+        return 0;
+    }
+
+    while (In < InBytes)
+    {
+        Control = pIn[In++];
+
+        if (Control < TOF_LZF_MAX_LITERALS)
+        {
+            Length = Control + 1;
+
+            if (((InBytes - In) < Length) || ((OutCapacity - Out) < Length))
+            {
+                return 0;
+            }
+
+            memcpy(pOut + Out, pIn + In, Length);
+            In += Length;
+            Out += Length;
+            continue;
+        }
+
+        Length = Control >> 5;
+
+        if (Length == 7)
+        {
+            if (In >= InBytes)
+            {
+                return 0;
+            }
+
+            Length += pIn[In++];
+        }
+
+        if (In >= InBytes)
+        {
+            return 0;
+        }
+
+        Length += 2;
+        Distance = (((size_t)(Control & 0x1f) << 8) | pIn[In++]) + 1;
+
+        if ((Distance > Out) || ((OutCapacity - Out) < Length))
+        {
+            return 0;
+        }
+
+        // The reference may overlap the bytes being written
+        for (size_t i = 0; i < Length; i++, Out++)
+        {
+            pOut[Out] = pOut[Out - Distance];
+        }
+    }
+
+    return Out;
+}
+
+// ****************************************************************************
@@ -0,0 +1,42 @@
+// ****************************************************************************
+//  TofLzf.h
+//
+// LZF compression, the scheme PCD binary_compressed files use
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stddef.h>
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+// The output is the liblzf stream format, so PCL's lzf_decompress() reads
+// it. A control byte below 32 starts a run of control + 1 literal bytes;
+// anything else is a back reference of up to 264 bytes no more than 8 KB
+// back.
+// ****************************************************************************
+
+// Size of the hash table TofLzfCompress works in
+#define TOF_LZF_HASH_BITS       14
+#define TOF_LZF_TABLE_ENTRIES   (1 << TOF_LZF_HASH_BITS)
+
+// Largest compressed size of InBytes, for sizing the output buffer
+size_t TofLzfMaxBytes(size_t InBytes);
+
+// OutCapacity must be at least TofLzfMaxBytes(InBytes). pTable is
+// TOF_LZF_TABLE_ENTRIES words of scratch kept by the caller, so compressing
+// frame after frame allocates nothing. Returns the compressed size.
+size_t TofLzfCompress(const UINT8* pIn, size_t InBytes, UINT8* pOut, size_t OutCapacity, UINT32* pTable);
+
+// Returns the decompressed size, 0 if the stream is damaged or does not fit
+size_t TofLzfDecompress(const UINT8* pIn, size_t InBytes, UINT8* pOut, size_t OutCapacity);
+
+// ****************************************************************************
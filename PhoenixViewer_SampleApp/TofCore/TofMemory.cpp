@@ -0,0 +1,195 @@
+// ****************************************************************************
+//  TofMemory.cpp
+//
+// Aligned allocation helpers for frame buffers
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include <atomic>
+#ifdef _WIN32
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+static std::atomic<uint64_t> sAllocations(0);
+static std::atomic<uint64_t> sFrees(0);
+static std::atomic<uint64_t> sBytesAllocated(0);
+static std::atomic<uint64_t> sLargePageAllocations(0);
+
+// ****************************************************************************
+
+static void TofCountAllocation(size_t Size, BOOL LargePages)
+{
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+    sBytesAllocated.fetch_add(Size, std::memory_order_relaxed);
+
+    if (LargePages)
+    {
+        sLargePageAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// ****************************************************************************
+
+void* TofAlignedAlloc(size_t Size, size_t Alignment)
+{
+    if (Size == 0)
+    {
+        return NULL;
+    }
+
+    void* pMemory = NULL;
+
+#ifdef _WIN32
+    pMemory = _aligned_malloc(Size, Alignment);
+#else
+    if (posix_memalign(&pMemory, Alignment, Size) != 0)
+    {
+        pMemory = NULL;
+    }
+#endif
+
+    if (pMemory != NULL)
+    {
+        TofCountAllocation(Size, FALSE);
+    }
+
+    return pMemory;
+}
+
+// ****************************************************************************
+
+void TofAlignedFree(void* pMemory)
+{
+    if (pMemory == NULL)
+    {
+        return;
+    }
+
+    sFrees.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef _WIN32
+    _aligned_free(pMemory);
+#else
+    free(pMemory);
+#endif
+}
+
+// ****************************************************************************
+
+void* TofLargePageAlloc(size_t Size, size_t* pAllocated, BOOL* pLargePages)
+{
+    void* pMemory = NULL;
+    size_t PageSize;
+
+
+    *pAllocated = 0;
+    *pLargePages = FALSE;
+
+    if (Size == 0)
+    {
+        return NULL;
+    }
+
+#ifdef _WIN32
+    PageSize = GetLargePageMinimum();
+
+    if (PageSize != 0)
+    {
+        *pAllocated = TOF_ALIGN_UP(Size, PageSize);
+        pMemory = VirtualAlloc(NULL, *pAllocated, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        *pLargePages = (pMemory != NULL) ? TRUE : FALSE;
+    }
+
+    if (pMemory == NULL)
+    {
+        SYSTEM_INFO SystemInfo;
+
+        GetSystemInfo(&SystemInfo);
+        *pAllocated = TOF_ALIGN_UP(Size, SystemInfo.dwPageSize);
+        pMemory = VirtualAlloc(NULL, *pAllocated, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#else
+    // Explicit huge pages only exist when the administrator reserved some;
+    // otherwise ask for transparent huge pages on an ordinary mapping
+    PageSize = (size_t)2 << 20;
+    *pAllocated = TOF_ALIGN_UP(Size, PageSize);
+#ifdef MAP_HUGETLB
+    pMemory = mmap(NULL, *pAllocated, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    *pLargePages = (pMemory != MAP_FAILED) ? TRUE : FALSE;
+#else
+    pMemory = MAP_FAILED;
+#endif
+
+    if (pMemory == MAP_FAILED)
+    {
+        pMemory = mmap(NULL, *pAllocated, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+        if (pMemory != MAP_FAILED)
+        {
+            madvise(pMemory, *pAllocated, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    if (pMemory == MAP_FAILED)
+    {
+        pMemory = NULL;
+    }
+#endif
+
+    if (pMemory == NULL)
+    {
+        *pAllocated = 0;
+        return NULL;
+    }
+
+    TofCountAllocation(*pAllocated, *pLargePages);
+
+    return pMemory;
+}
+
+// ****************************************************************************
+
+void TofLargePageFree(void* pMemory, size_t Allocated)
+{
+    if (pMemory == NULL)
+    {
+        return;
+    }
+
+    sFrees.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef _WIN32
+    (void)Allocated;
+    VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+    munmap(pMemory, Allocated);
+#endif
+}
+
+// ****************************************************************************
+
+void TofGetMemoryStats(TofMemoryStats* pStats)
+{
+    pStats->Allocations = sAllocations.load(std::memory_order_relaxed);
+    pStats->Frees = sFrees.load(std::memory_order_relaxed);
+    pStats->BytesAllocated = sBytesAllocated.load(std::memory_order_relaxed);
+    pStats->LargePageAllocations = sLargePageAllocations.load(std::memory_order_relaxed);
+}
+
+// ****************************************************************************
@@ -0,0 +1,56 @@
+// ****************************************************************************
+//  TofMemory.h
+//
+// Aligned allocation helpers for frame buffers
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+
+#define TOF_CACHE_LINE_SIZE     64
+
+// Rounds Size up to the next multiple of Alignment (a power of two)
+#define TOF_ALIGN_UP(Size, Alignment)   (((Size) + ((Alignment) - 1)) & ~((size_t)(Alignment) - 1))
+
+// ****************************************************************************
+// Every allocation made through the functions below is counted, so a caller
+// can check that a running stream no longer allocates.
+// ****************************************************************************
+
+typedef struct
+{
+    uint64_t Allocations;               // Successful allocations
+    uint64_t Frees;
+    uint64_t BytesAllocated;            // Total requested by those allocations
+    uint64_t LargePageAllocations;      // Allocations the OS backed with large pages
+} TofMemoryStats;
+
+// ****************************************************************************
+
+void* TofAlignedAlloc(size_t Size, size_t Alignment);
+void TofAlignedFree(void* pMemory);
+
+// Page aligned memory for long lived buffers. Size is rounded up to the page
+// size actually used, which is returned in *pAllocated and must be passed to
+// TofLargePageFree. Large pages are tried first and *pLargePages reports
+// whether they were granted (on Windows that needs the "Lock pages in
+// memory" privilege); otherwise ordinary pages are used.
+void* TofLargePageAlloc(size_t Size, size_t* pAllocated, BOOL* pLargePages);
+void TofLargePageFree(void* pMemory, size_t Allocated);
+
+void TofGetMemoryStats(TofMemoryStats* pStats);
+
+// ****************************************************************************
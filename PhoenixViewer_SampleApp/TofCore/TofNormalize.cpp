@@ -0,0 +1,236 @@
+// ****************************************************************************
+//  TofNormalize.cpp
+//
+// Maps the dynamic range of a time or amplitude plane onto 8 or 16 bits
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofNormalize.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+#if defined(TOF_SIMD_SSE2)
+
+// UINT32 to float without going through a signed conversion of the full word
+static inline __m128 LoadAsFloat(const UINT32* pSource)
+{
+    __m128i Value = _mm_loadu_si128((const __m128i*)pSource);
+    __m128 High = _mm_cvtepi32_ps(_mm_srli_epi32(Value, 16));
+    __m128 Low = _mm_cvtepi32_ps(_mm_and_si128(Value, _mm_set1_epi32(0xffff)));
+
+    return _mm_add_ps(_mm_mul_ps(High, _mm_set1_ps(65536.0f)), Low);
+}
+
+static inline void StoreOutput(UINT8* pDestination, __m128i A, __m128i B)
+{
+    __m128i Words = _mm_packs_epi32(A, B);
+    _mm_storel_epi64((__m128i*)pDestination, _mm_packus_epi16(Words, Words));
+}
+
+static inline void StoreOutput(UINT16* pDestination, __m128i A, __m128i B)
+{
+    // SSE2 only has a signed 32 -> 16 bit pack, so shift into signed range and back
+    const __m128i Bias = _mm_set1_epi32(0x8000);
+    __m128i Words = _mm_packs_epi32(_mm_sub_epi32(A, Bias), _mm_sub_epi32(B, Bias));
+
+    _mm_storeu_si128((__m128i*)pDestination, _mm_xor_si128(Words, _mm_set1_epi16((short)0x8000)));
+}
+
+#endif
+
+// ****************************************************************************
+
+TofNormalizer::TofNormalizer()
+    : mLowPercent(TOF_DEFAULT_LOW_PERCENT),
+      mHighPercent(TOF_DEFAULT_HIGH_PERCENT)
+{
+    SetRangeLimit(TOF_DEFAULT_RANGE_LIMIT);
+}
+
+// ****************************************************************************
+
+void TofNormalizer::SetPercentiles(FP32 LowPercent, FP32 HighPercent)
+{
+    if ((LowPercent < 0.0f) || (HighPercent > 100.0f) || (LowPercent >= HighPercent))
+    {
+        return;
+    }
+
+    mLowPercent = LowPercent;
+    mHighPercent = HighPercent;
+}
+
+// ****************************************************************************
+//  Sets the largest value the histogram resolves; the bin width follows from it
+// ****************************************************************************
+
+void TofNormalizer::SetRangeLimit(UINT32 RangeLimit)
+{
+    mRangeLimit = (RangeLimit != 0) ? RangeLimit : 1;
+    mShift = 0;
+
+    while ((mRangeLimit >> mShift) > (TOF_HISTOGRAM_BINS - 1))
+    {
+        mShift++;
+    }
+
+    Reset();
+}
+
+// ****************************************************************************
+
+void TofNormalizer::Reset()
+{
+    mLow = 0;
+    mHigh = mRangeLimit;
+    mMin = 0;
+    mMax = 0;
+    memset(mHistogram, 0, sizeof(mHistogram));
+}
+
+// ****************************************************************************
+
+void TofNormalizer::GetStats(TofRangeStats* pStats) const
+{
+    pStats->Low = mLow;
+    pStats->High = mHigh;
+    pStats->Min = mMin;
+    pStats->Max = mMax;
+}
+
+// ****************************************************************************
+
+void TofNormalizer::Normalize8(const UINT32* pSource, UINT8* pDestination, UINT32 Count)
+{
+    Normalize<UINT8, 0xff>(pSource, pDestination, Count);
+}
+
+void TofNormalizer::Normalize16(const UINT32* pSource, UINT16* pDestination, UINT32 Count)
+{
+    Normalize<UINT16, 0xffff>(pSource, pDestination, Count);
+}
+
+// ****************************************************************************
+//  Remaps Low .. High onto 0 .. OutputMax and histograms the frame in the same
+//  pass. Each block of eight is remapped with SSE2 and then binned while it
+//  is still in L1. Both paths round half up (add 0.5, then truncate), so the
+//  output does not depend on where the vector blocks end.
+// ****************************************************************************
+
+template <typename OutputT, UINT32 OutputMax>
+void TofNormalizer::Normalize(const UINT32* pSource, OutputT* pDestination, UINT32 Count)
+{
+    const UINT32 LastBin = TOF_HISTOGRAM_BINS - 1;
+    const FP32 Low = (FP32)mLow;
+    const FP32 Scale = (FP32)OutputMax / (FP32)(mHigh - mLow);
+    UINT32 Min = 0xffffffff;
+    UINT32 Max = 0;
+    UINT32 Value;
+    FP32 Mapped;
+    UINT32 i = 0;
+
+
+    memset(mHistogram, 0, sizeof(mHistogram));
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128 vLow = _mm_set1_ps(Low);
+    const __m128 vScale = _mm_set1_ps(Scale);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vOutputMax = _mm_set1_ps((FP32)OutputMax);
+    const __m128 vHalf = _mm_set1_ps(0.5f);
+
+    for (; (i + 8) <= Count; i += 8)
+    {
+        __m128 A = _mm_mul_ps(_mm_sub_ps(LoadAsFloat(pSource + i), vLow), vScale);
+        __m128 B = _mm_mul_ps(_mm_sub_ps(LoadAsFloat(pSource + i + 4), vLow), vScale);
+
+        A = _mm_add_ps(_mm_min_ps(_mm_max_ps(A, vZero), vOutputMax), vHalf);
+        B = _mm_add_ps(_mm_min_ps(_mm_max_ps(B, vZero), vOutputMax), vHalf);
+
+        StoreOutput(pDestination + i, _mm_cvttps_epi32(A), _mm_cvttps_epi32(B));
+
+        for (UINT32 k = i; k < (i + 8); k++)
+        {
+            Value = pSource[k];
+            Min = (Value < Min) ? Value : Min;
+            Max = (Value > Max) ? Value : Max;
+            mHistogram[(Value >= mRangeLimit) ? LastBin : (Value >> mShift)]++;
+        }
+    }
+#endif
+
+    for (; i < Count; i++)
+    {
+        Value = pSource[i];
+        Min = (Value < Min) ? Value : Min;
+        Max = (Value > Max) ? Value : Max;
+        mHistogram[(Value >= mRangeLimit) ? LastBin : (Value >> mShift)]++;
+
+        Mapped = ((FP32)Value - Low) * Scale;
+        Mapped = (Mapped < 0.0f) ? 0.0f : ((Mapped > (FP32)OutputMax) ? (FP32)OutputMax : Mapped);
+        pDestination[i] = (OutputT)(Mapped + 0.5f);
+    }
+
+    mMin = (Count != 0) ? Min : 0;
+    mMax = Max;
+
+    UpdateClipPoints(Count);
+}
+
+// ****************************************************************************
+//  Picks the clip points for the next frame from this frame's histogram
+// ****************************************************************************
+
+void TofNormalizer::UpdateClipPoints(UINT32 Count)
+{
+    double LowTarget = (double)Count * mLowPercent / 100.0;
+    double HighTarget = (double)Count * mHighPercent / 100.0;
+    double Total = 0.0;
+    UINT32 LowBin = 0;
+    UINT32 HighBin = TOF_HISTOGRAM_BINS - 1;
+    BOOL LowFound = FALSE;
+    UINT32 High;
+
+
+    if (Count == 0)
+    {
+        return;
+    }
+
+    for (UINT32 Bin = 0; Bin < TOF_HISTOGRAM_BINS; Bin++)
+    {
+        Total += mHistogram[Bin];
+
+        if (( ! LowFound) && (Total > LowTarget))
+        {
+            LowBin = Bin;
+            LowFound = TRUE;
+        }
+
+        if (Total >= HighTarget)
+        {
+            HighBin = Bin;
+            break;
+        }
+    }
+
+    mLow = LowBin << mShift;
+    High = ((HighBin + 1) << mShift) - 1;
+    mHigh = (High < mRangeLimit) ? High : mRangeLimit;
+
+    if (mHigh <= mLow)
+    {
+        mHigh = mLow + 1;
+    }
+}
+
+// ****************************************************************************
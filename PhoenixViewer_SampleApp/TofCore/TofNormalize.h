@@ -0,0 +1,73 @@
+// ****************************************************************************
+//  TofNormalize.h
+//
+// Maps the dynamic range of a time or amplitude plane onto 8 or 16 bits
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+
+#define TOF_HISTOGRAM_BINS          1024
+#define TOF_DEFAULT_RANGE_LIMIT     0xffff      // Values above this share the top bin
+#define TOF_DEFAULT_LOW_PERCENT     1.0f
+#define TOF_DEFAULT_HIGH_PERCENT    99.0f
+
+typedef struct
+{
+    UINT32 Low;                 // Value mapped to 0
+    UINT32 High;                // Value mapped to full scale
+    UINT32 Min;                 // Smallest value in the last frame
+    UINT32 Max;                 // Largest value in the last frame
+} TofRangeStats;
+
+// ****************************************************************************
+// Each call remaps a frame with the clip points found in the previous frame
+// while building the histogram of the current one, so the frame is read only
+// once. The new clip points (the configured percentiles of the histogram)
+// take effect on the next call, a one frame lag for a live stream. Until the
+// first frame has been seen the range is 0 .. range limit.
+// ****************************************************************************
+
+class TofNormalizer
+{
+public:
+    TofNormalizer();
+
+    void SetPercentiles(FP32 LowPercent, FP32 HighPercent);
+    void SetRangeLimit(UINT32 RangeLimit);
+    void Reset();
+
+    void Normalize8(const UINT32* pSource, UINT8* pDestination, UINT32 Count);
+    void Normalize16(const UINT32* pSource, UINT16* pDestination, UINT32 Count);
+
+    void GetStats(TofRangeStats* pStats) const;
+
+private:
+    template <typename OutputT, UINT32 OutputMax>
+    void Normalize(const UINT32* pSource, OutputT* pDestination, UINT32 Count);
+
+    void UpdateClipPoints(UINT32 Count);
+
+    FP32 mLowPercent;
+    FP32 mHighPercent;
+    UINT32 mRangeLimit;
+    UINT32 mShift;              // Value >> mShift is the bin
+    UINT32 mLow;
+    UINT32 mHigh;
+    UINT32 mMin;
+    UINT32 mMax;
+    UINT32 mHistogram[TOF_HISTOGRAM_BINS];
+};
+
+// ****************************************************************************
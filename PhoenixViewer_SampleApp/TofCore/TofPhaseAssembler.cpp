@@ -0,0 +1,276 @@
+// ****************************************************************************
+//  TofPhaseAssembler.cpp
+//
+// Reassembly of line and frame phased sub-frames into the full resolution grid
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofPhaseAssembler.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+//  Interleaves the LinePhases lines of one scan line (NumPulses words each,
+//  one after the other at pSource) into a grid row: word p of line l goes to
+//  p * LinePhases + l. Two phases interleave with an unpack, four with a
+//  4 x 4 transpose.
+// ****************************************************************************
+
+static void TofInterleaveLines(const UINT32* pSource, UINT32 NumPulses, UINT32 LinePhases, UINT32* pRow)
+{
+    UINT32 Pulse = 0;
+
+
+    if (LinePhases == 1)
+    {
+        memcpy(pRow, pSource, NumPulses * sizeof(UINT32));
+        return;
+    }
+
+#if defined(TOF_SIMD_SSE2)
+    const UINT32* pLine1 = pSource + NumPulses;
+    const UINT32* pLine2 = pSource + (2 * NumPulses);
+    const UINT32* pLine3 = pSource + (3 * NumPulses);
+
+    if (LinePhases == 2)
+    {
+        for (; (Pulse + 4) <= NumPulses; Pulse += 4)
+        {
+            __m128i Line0 = _mm_loadu_si128((const __m128i*)(pSource + Pulse));
+            __m128i Line1 = _mm_loadu_si128((const __m128i*)(pLine1 + Pulse));
+
+            _mm_storeu_si128((__m128i*)(pRow + (2 * Pulse)), _mm_unpacklo_epi32(Line0, Line1));
+            _mm_storeu_si128((__m128i*)(pRow + (2 * Pulse) + 4), _mm_unpackhi_epi32(Line0, Line1));
+        }
+    }
+    else
+    {
+        for (; (Pulse + 4) <= NumPulses; Pulse += 4)
+        {
+            __m128i Line0 = _mm_loadu_si128((const __m128i*)(pSource + Pulse));
+            __m128i Line1 = _mm_loadu_si128((const __m128i*)(pLine1 + Pulse));
+            __m128i Line2 = _mm_loadu_si128((const __m128i*)(pLine2 + Pulse));
+            __m128i Line3 = _mm_loadu_si128((const __m128i*)(pLine3 + Pulse));
+
+            __m128i Lo01 = _mm_unpacklo_epi32(Line0, Line1);
+            __m128i Lo23 = _mm_unpacklo_epi32(Line2, Line3);
+            __m128i Hi01 = _mm_unpackhi_epi32(Line0, Line1);
+            __m128i Hi23 = _mm_unpackhi_epi32(Line2, Line3);
+
+            _mm_storeu_si128((__m128i*)(pRow + (4 * Pulse)), _mm_unpacklo_epi64(Lo01, Lo23));
+            _mm_storeu_si128((__m128i*)(pRow + (4 * Pulse) + 4), _mm_unpackhi_epi64(Lo01, Lo23));
+            _mm_storeu_si128((__m128i*)(pRow + (4 * Pulse) + 8), _mm_unpacklo_epi64(Hi01, Hi23));
+            _mm_storeu_si128((__m128i*)(pRow + (4 * Pulse) + 12), _mm_unpackhi_epi64(Hi01, Hi23));
+        }
+    }
+#endif
+
+    for (; Pulse < NumPulses; Pulse++)
+    {
+        for (UINT32 Phase = 0; Phase < LinePhases; Phase++)
+        {
+            pRow[(Pulse * LinePhases) + Phase] = pSource[(Phase * NumPulses) + Pulse];
+        }
+    }
+}
+
+// ****************************************************************************
+
+TofPhaseAssembler::TofPhaseAssembler()
+    : mMode(eTOF_PHASE_ROLLING),
+      mWidth(0),
+      mHeight(0),
+      mVisible(0),
+      mPhasesMerged(0),
+      mFormat(eTOF_DATA_FUSED)
+{
+    memset(&mGeometry, 0, sizeof(mGeometry));
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+TofPhaseAssembler::~TofPhaseAssembler()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Allocates the grid, and the back grid when waiting for complete sets
+// ****************************************************************************
+
+PICOP_RC TofPhaseAssembler::Create(const TofFrameGeometry* pGeometry, TofPhaseModeE Mode)
+{
+    PICOP_RC PicopRc;
+
+
+    if ((pGeometry == NULL) || (pGeometry->NumPulses == 0) || (pGeometry->LinePhases == 0) ||
+        (pGeometry->FramePhases == 0) || (pGeometry->ImageLines == 0) || (Mode > eTOF_PHASE_COMPLETE))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    mGeometry = *pGeometry;
+    mMode = Mode;
+    mWidth = pGeometry->NumPulses * pGeometry->LinePhases;
+    mHeight = pGeometry->ImageLines * pGeometry->FramePhases;
+
+    for (UINT32 i = 0; i < ((Mode == eTOF_PHASE_COMPLETE) ? 2u : 1u); i++)
+    {
+        PicopRc = mGrids[i].Create(mWidth, mHeight);
+
+        if (PicopRc != eSUCCESS)
+        {
+            Destroy();
+            return PicopRc;
+        }
+    }
+
+    memset(&mStats, 0, sizeof(mStats));
+    Reset();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofPhaseAssembler::Destroy()
+{
+    mGrids[0].Destroy();
+    mGrids[1].Destroy();
+    mWidth = 0;
+    mHeight = 0;
+}
+
+// ****************************************************************************
+
+void TofPhaseAssembler::Reset()
+{
+    size_t PlaneBytes = (size_t)mWidth * mHeight * sizeof(UINT32);
+
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        if (mGrids[i].GetTime() != NULL)
+        {
+            memset(mGrids[i].GetTime(), 0, PlaneBytes);
+            memset(mGrids[i].GetAmplitude(), 0, PlaneBytes);
+        }
+    }
+
+    mVisible = 0;
+    mPhasesMerged = 0;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofPhaseAssembler::Add(const TofFrameView* pView, UINT32 FramePhase, BOOL* pUpdated)
+{
+    UINT32 AllPhases = (1u << mGeometry.FramePhases) - 1;
+    UINT32 Back;
+
+
+    if (pUpdated != NULL)
+    {
+        *pUpdated = FALSE;
+    }
+
+    if ((pView == NULL) || (pView->pTime == NULL) || (pView->pAmplitude == NULL) || (mWidth == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((pView->NumPulses != mGeometry.NumPulses) || (pView->NumLines != mGeometry.NumLines) ||
+        (FramePhase >= mGeometry.FramePhases))
+    {
+        mStats.SubFramesRejected++;
+        return eFRAME_ERROR;
+    }
+
+    mFormat = pView->Format;
+    mStats.SubFrames++;
+
+    if (mMode == eTOF_PHASE_ROLLING)
+    {
+        Merge(pView, FramePhase, &mGrids[mVisible]);
+        mPhasesMerged |= 1u << FramePhase;
+
+        if (mPhasesMerged == AllPhases)
+        {
+            mStats.SetsCompleted++;
+            mPhasesMerged = 0;
+        }
+
+        if (pUpdated != NULL)
+        {
+            *pUpdated = TRUE;
+        }
+
+        return eSUCCESS;
+    }
+
+    // A phase seen twice means the set lost a sub-frame; start a new one
+    if (mPhasesMerged & (1u << FramePhase))
+    {
+        mStats.SetsAbandoned++;
+        mPhasesMerged = 0;
+    }
+
+    Back = mVisible ^ 1;
+    Merge(pView, FramePhase, &mGrids[Back]);
+    mPhasesMerged |= 1u << FramePhase;
+
+    if (mPhasesMerged == AllPhases)
+    {
+        mStats.SetsCompleted++;
+        mPhasesMerged = 0;
+        mVisible = Back;
+
+        if (pUpdated != NULL)
+        {
+            *pUpdated = TRUE;
+        }
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Writes every row of frame phase FramePhase: scan line s of the sub-frame
+//  becomes row s * FramePhases + FramePhase
+// ****************************************************************************
+
+void TofPhaseAssembler::Merge(const TofFrameView* pView, UINT32 FramePhase, TofFrame* pGrid)
+{
+    UINT32 LinePhases = mGeometry.LinePhases;
+    size_t SourceStride = (size_t)mGeometry.NumPulses * LinePhases;
+    size_t Row;
+
+
+    for (UINT32 ScanLine = 0; ScanLine < mGeometry.ImageLines; ScanLine++)
+    {
+        Row = ((size_t)ScanLine * mGeometry.FramePhases) + FramePhase;
+
+        TofInterleaveLines(pView->pTime + (ScanLine * SourceStride), mGeometry.NumPulses, LinePhases,
+                           pGrid->GetTime() + (Row * mWidth));
+        TofInterleaveLines(pView->pAmplitude + (ScanLine * SourceStride), mGeometry.NumPulses, LinePhases,
+                           pGrid->GetAmplitude() + (Row * mWidth));
+    }
+}
+
+// ****************************************************************************
+
+void TofPhaseAssembler::GetView(TofFrameView* pView) const
+{
+    mGrids[mVisible].GetView(pView);
+    pView->Format = mFormat;
+}
+
+// ****************************************************************************
@@ -0,0 +1,107 @@
+// ****************************************************************************
+//  TofPhaseAssembler.h
+//
+// Reassembly of line and frame phased sub-frames into the full resolution grid
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include "TofFrame.h"
+#include "TofGeometry.h"
+
+// ****************************************************************************
+// With phasing each frame the device sends is a sub-frame of a denser grid
+// (see TofGeometry.h). Scan line s of frame phase f is sampled by lines
+// s * LinePhases + l, l = 0 .. LinePhases - 1, each offset by l / LinePhases
+// of a pulse; frame phase f offsets the scan lines by f / FramePhases of a
+// line. The assembled grid is therefore NumPulses * LinePhases wide and
+// ImageLines * FramePhases high, with pulse p of line phase l in column
+// p * LinePhases + l and scan line s of frame phase f in row
+// s * FramePhases + f.
+//
+// Frames carry no phase number, so the caller supplies it. The device cycles
+// through the frame phases in order, so the phase is the count of frames the
+// device has sent, modulo FramePhases: TofAcquiredFrame::DeviceFrame, which
+// also counts the frames skipped in eTOF_ACQUIRE_LATEST_ONLY and those read
+// while the ring or pool was full. SequenceNumber only counts delivered
+// frames and goes out of step at the first skip. Frames the device drops
+// itself when its cache overflows are not reported through the TLC API, so
+// acquisition must keep the cache drained (it does on every event) and
+// start with sensing, or the phases are off by the frames lost.
+//
+//   eTOF_PHASE_ROLLING     every sub-frame is merged straight into the grid,
+//                          which always holds the newest sample of every row;
+//                          rows of phases not yet seen are 0 (no return)
+//   eTOF_PHASE_COMPLETE    sub-frames are merged into a back grid that only
+//                          replaces the visible one once every phase of a set
+//                          has arrived; a repeated phase means one was lost,
+//                          and the set is started again
+// ****************************************************************************
+
+typedef enum
+{
+    eTOF_PHASE_ROLLING = 0,
+    eTOF_PHASE_COMPLETE
+} TofPhaseModeE;
+
+typedef struct
+{
+    uint64_t SubFrames;                 // Merged
+    uint64_t SetsCompleted;             // Every phase merged
+    uint64_t SetsAbandoned;             // A phase repeated before the set was complete
+    uint64_t SubFramesRejected;         // Wrong size or phase number
+} TofPhaseStats;
+
+// ****************************************************************************
+
+class TofPhaseAssembler
+{
+public:
+    TofPhaseAssembler();
+    ~TofPhaseAssembler();
+
+    PICOP_RC Create(const TofFrameGeometry* pGeometry, TofPhaseModeE Mode);
+    void Destroy();
+
+    // Forgets every phase merged so far and clears the grid
+    void Reset();
+
+    // Merges a sub-frame of the geometry given to Create(). *pUpdated is set
+    // when GetView() shows something new: after every sub-frame when
+    // rolling, after the last of a set otherwise.
+    PICOP_RC Add(const TofFrameView* pView, UINT32 FramePhase, BOOL* pUpdated);
+
+    // The visible grid; valid until the next Add() or Reset()
+    void GetView(TofFrameView* pView) const;
+
+    UINT32 GetWidth() const { return mWidth; }
+    UINT32 GetHeight() const { return mHeight; }
+    void GetStats(TofPhaseStats* pStats) const { *pStats = mStats; }
+
+private:
+    TofPhaseAssembler(const TofPhaseAssembler&);
+    TofPhaseAssembler& operator=(const TofPhaseAssembler&);
+
+    void Merge(const TofFrameView* pView, UINT32 FramePhase, TofFrame* pGrid);
+
+    TofFrameGeometry mGeometry;
+    TofPhaseModeE mMode;
+    UINT32 mWidth;
+    UINT32 mHeight;
+    TofFrame mGrids[2];
+    UINT32 mVisible;                    // Index of the grid GetView() shows
+    UINT32 mPhasesMerged;               // Bit per frame phase in the set being assembled
+    PicoP_ToFDataFormatE mFormat;       // Of the last sub-frame
+    TofPhaseStats mStats;
+};
+
+// ****************************************************************************
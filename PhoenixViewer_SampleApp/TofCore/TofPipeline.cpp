@@ -0,0 +1,548 @@
+// ****************************************************************************
+//  TofPipeline.cpp
+//
+// Staged, multi-threaded frame processing
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofPipeline.h"
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+static uint64_t TofElapsedUs(TofClock::time_point From, TofClock::time_point To)
+{
+    return (To > From) ? (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(To - From).count() : 0;
+}
+
+// ****************************************************************************
+
+TofPipeline::TofPipeline()
+    : mRunning(FALSE)
+{
+    memset(&mGeometry, 0, sizeof(mGeometry));
+    memset(&mMetrics, 0, sizeof(mMetrics));
+}
+
+TofPipeline::~TofPipeline()
+{
+    Stop();
+
+    for (size_t i = 0; i < mStages.size(); i++)
+    {
+        delete mStages[i];
+    }
+}
+
+// ****************************************************************************
+
+PICOP_RC TofPipeline::AddStage(TofPipelineStage* pStage, UINT32 Threads, UINT32 QueueDepth,
+                               TofQueuePolicyE Policy)
+{
+    Stage* pNew;
+
+
+    if ((pStage == NULL) || (Threads == 0) || (QueueDepth == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mRunning)
+    {
+        return eBUSY;
+    }
+
+    pNew = new Stage;
+    pNew->pStage = pStage;
+    pNew->Threads = Threads;
+    pNew->QueueDepth = QueueDepth;
+    pNew->Policy = Policy;
+    mStages.push_back(pNew);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Allocates the frames, starts every stage, then their workers
+// ****************************************************************************
+
+PICOP_RC TofPipeline::Start(const TofFrameGeometry* pGeometry)
+{
+    UINT32 FrameCount = 1;
+    PICOP_RC PicopRc;
+
+
+    if ((pGeometry == NULL) || (pGeometry->FrameWords == 0) || mStages.empty())
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mRunning)
+    {
+        return eBUSY;
+    }
+
+    mGeometry = *pGeometry;
+
+    // Every queue full and every worker holding a frame, plus the one being
+    // submitted
+    for (size_t i = 0; i < mStages.size(); i++)
+    {
+        FrameCount += mStages[i]->QueueDepth + mStages[i]->Threads;
+    }
+
+    PicopRc = AllocateFrames(FrameCount);
+
+    for (size_t i = 0; (i < mStages.size()) && (PicopRc == eSUCCESS); i++)
+    {
+        PicopRc = mStages[i]->pStage->Start(pGeometry);
+    }
+
+    if (PicopRc != eSUCCESS)
+    {
+        FreeFrames();
+        return PicopRc;
+    }
+
+    memset(&mMetrics, 0, sizeof(mMetrics));
+
+    for (size_t i = 0; i < mStages.size(); i++)
+    {
+        mStages[i]->Queue.Create(mStages[i]->QueueDepth, mStages[i]->Policy);
+        memset(&mStages[i]->Metrics, 0, sizeof(TofStageMetrics));
+        mStages[i]->Metrics.pName = mStages[i]->pStage->GetName();
+    }
+
+    mRunning = TRUE;
+
+    for (UINT32 i = 0; i < (UINT32)mStages.size(); i++)
+    {
+        for (UINT32 Thread = 0; Thread < mStages[i]->Threads; Thread++)
+        {
+            mStages[i]->Workers.push_back(std::thread(&TofPipeline::WorkerThread, this, i));
+        }
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Stops taking frames and lets the ones already queued run through: each
+//  stage is closed only once the stage before it has finished
+// ****************************************************************************
+
+void TofPipeline::Stop()
+{
+    if ( ! mRunning.exchange(FALSE))
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < mStages.size(); i++)
+    {
+        mStages[i]->Queue.Close();
+
+        for (size_t Thread = 0; Thread < mStages[i]->Workers.size(); Thread++)
+        {
+            mStages[i]->Workers[Thread].join();
+        }
+
+        mStages[i]->Workers.clear();
+    }
+
+    mFreeFrames.Close();
+    FreeFrames();
+}
+
+// ****************************************************************************
+
+PICOP_RC TofPipeline::AllocateFrames(UINT32 Count)
+{
+    TofPipelineFrame* pFrame;
+    size_t PlaneWords = (size_t)mGeometry.NumPulses * mGeometry.NumLines;
+
+
+    if (mRawFrames.Create(mGeometry.FrameWords * sizeof(UINT32), Count, 0) != eSUCCESS)
+    {
+        return eFAILURE;
+    }
+
+    mFrames.resize(Count);
+    mFreeFrames.Create(Count, eTOF_QUEUE_BLOCK);
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        pFrame = &mFrames[i];
+        *pFrame = TofPipelineFrame();
+        pFrame->FrameWords = mGeometry.FrameWords;
+        pFrame->pPoints = (PicoP_Pcd_Data*)TofAlignedAlloc(PlaneWords * sizeof(PicoP_Pcd_Data), TOF_CACHE_LINE_SIZE);
+        pFrame->pValid = (UINT32*)TofAlignedAlloc(PlaneWords * sizeof(UINT32), TOF_CACHE_LINE_SIZE);
+        pFrame->pPlanes = new TofFrame;
+
+        if ((pFrame->pPoints == NULL) || (pFrame->pValid == NULL) ||
+            (pFrame->pPlanes->Create(mGeometry.NumPulses, mGeometry.NumLines) != eSUCCESS))
+        {
+            return eFAILURE;
+        }
+    }
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        Recycle(&mFrames[i]);
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofPipeline::FreeFrames()
+{
+    for (size_t i = 0; i < mFrames.size(); i++)
+    {
+        TofAlignedFree(mFrames[i].pPoints);
+        TofAlignedFree(mFrames[i].pValid);
+        delete mFrames[i].pPlanes;
+    }
+
+    mFrames.clear();
+    mRawFrames.Destroy();
+}
+
+// ****************************************************************************
+//  Copies a frame into one of the pipeline's own pooled frames and queues it
+//  for the first stage. Waits while every frame is in use, which only
+//  happens when a blocking stage is backed up.
+// ****************************************************************************
+
+PICOP_RC TofPipeline::Submit(const UINT32* pData, UINT32 SequenceNumber, TofClock::time_point AcquireTime)
+{
+    TofPooledFrame* pSource;
+    PICOP_RC PicopRc;
+
+
+    if (pData == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    if ( ! mRunning)
+    {
+        return eINVALID_STATE;
+    }
+
+    // There is a raw frame for every pipeline frame, and Submit() is the only
+    // user of the pool, so this only fails when called from several threads
+    pSource = mRawFrames.Acquire();
+
+    if (pSource == NULL)
+    {
+        return eBUSY;
+    }
+
+    memcpy(pSource->pData, pData, (size_t)mGeometry.FrameWords * sizeof(UINT32));
+    pSource->FrameWords = mGeometry.FrameWords;
+    pSource->SequenceNumber = SequenceNumber;
+    pSource->AcquireTime = AcquireTime;
+
+    PicopRc = Enter(pSource);
+    TofFrameRelease(pSource);
+
+    return PicopRc;
+}
+
+// ****************************************************************************
+//  Queues a pooled frame for the first stage without copying it. The
+//  pipeline holds its own reference until the frame leaves the last stage.
+// ****************************************************************************
+
+PICOP_RC TofPipeline::SubmitFrame(TofPooledFrame* pFrame)
+{
+    if ((pFrame == NULL) || (pFrame->FrameWords < mGeometry.FrameWords))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ( ! mRunning)
+    {
+        return eINVALID_STATE;
+    }
+
+    return Enter(pFrame);
+}
+
+// ****************************************************************************
+
+PICOP_RC TofPipeline::Enter(TofPooledFrame* pSource)
+{
+    TofPipelineFrame* pFrame;
+
+
+    if ( ! mFreeFrames.Pop(&pFrame))
+    {
+        return eINVALID_STATE;
+    }
+
+    TofFrameAddRef(pSource);
+    pFrame->pSource = pSource;
+    pFrame->pRaw = pSource->pData;
+    pFrame->NumPoints = 0;
+    pFrame->NumValid = 0;
+    pFrame->Masked = FALSE;
+    pFrame->SequenceNumber = pSource->SequenceNumber;
+    pFrame->AcquireTime = pSource->AcquireTime;
+
+    {
+        std::lock_guard<std::mutex> Lock(mMetricsLock);
+        mMetrics.FramesSubmitted++;
+    }
+
+    Forward(0, pFrame);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofPipeline::OnAcquiredFrame(void* pContext, const TofAcquiredFrame* pFrame)
+{
+    TofPipeline* pPipeline = (TofPipeline*)pContext;
+
+
+    if ((pFrame->Result != eSUCCESS) || (pFrame->FrameWords < pPipeline->mGeometry.FrameWords))
+    {
+        return;
+    }
+
+    if (pFrame->pPooled != NULL)
+    {
+        pPipeline->SubmitFrame(pFrame->pPooled);
+    }
+    else
+    {
+        pPipeline->Submit(pFrame->pData, pFrame->SequenceNumber, pFrame->AcquireTime);
+    }
+}
+
+// ****************************************************************************
+//  Queues a frame for stage Next, recycling whatever the queue evicts, or
+//  finishes it after the last stage
+// ****************************************************************************
+
+void TofPipeline::Forward(UINT32 Next, TofPipelineFrame* pFrame)
+{
+    TofPipelineFrame* pEvicted = NULL;
+    BOOL WasEvicted;
+
+
+    if (Next >= mStages.size())
+    {
+        Complete(pFrame);
+        return;
+    }
+
+    pFrame->QueueTime = TofClock::now();
+
+    if ( ! mStages[Next]->Queue.Push(pFrame, &pEvicted, &WasEvicted))
+    {
+        // Stopping
+        Recycle(pFrame);
+        return;
+    }
+
+    if (WasEvicted)
+    {
+        Recycle(pEvicted);
+    }
+}
+
+// ****************************************************************************
+
+void TofPipeline::Complete(TofPipelineFrame* pFrame)
+{
+    uint64_t LatencyUs = TofElapsedUs(pFrame->AcquireTime, TofClock::now());
+
+
+    {
+        std::lock_guard<std::mutex> Lock(mMetricsLock);
+        mMetrics.FramesCompleted++;
+        mMetrics.TotalLatencyUs += LatencyUs;
+        mMetrics.MaxLatencyUs = (LatencyUs > mMetrics.MaxLatencyUs) ? LatencyUs : mMetrics.MaxLatencyUs;
+    }
+
+    Recycle(pFrame);
+}
+
+// ****************************************************************************
+
+void TofPipeline::Recycle(TofPipelineFrame* pFrame)
+{
+    TofPipelineFrame* pEvicted;
+    BOOL WasEvicted;
+
+
+    if (pFrame->pSource != NULL)
+    {
+        TofFrameRelease(pFrame->pSource);
+        pFrame->pSource = NULL;
+        pFrame->pRaw = NULL;
+    }
+
+    // The free queue holds every frame, so this never waits or evicts
+    mFreeFrames.Push(pFrame, &pEvicted, &WasEvicted);
+}
+
+// ****************************************************************************
+
+void TofPipeline::WorkerThread(UINT32 StageIndex)
+{
+    Stage* pStage = mStages[StageIndex];
+    TofPipelineFrame* pFrame;
+    TofClock::time_point Begin;
+    uint64_t WaitUs;
+    uint64_t ProcessUs;
+    PICOP_RC PicopRc;
+
+
+    while (pStage->Queue.Pop(&pFrame))
+    {
+        Begin = TofClock::now();
+        WaitUs = TofElapsedUs(pFrame->QueueTime, Begin);
+
+        PicopRc = pStage->pStage->Process(pFrame);
+        ProcessUs = TofElapsedUs(Begin, TofClock::now());
+
+        {
+            std::lock_guard<std::mutex> Lock(pStage->MetricsLock);
+            TofStageMetrics* pMetrics = &pStage->Metrics;
+
+            pMetrics->FramesProcessed++;
+            pMetrics->FramesRejected += (PicopRc != eSUCCESS) ? 1 : 0;
+            pMetrics->TotalWaitUs += WaitUs;
+            pMetrics->TotalProcessUs += ProcessUs;
+            pMetrics->MaxProcessUs = (ProcessUs > pMetrics->MaxProcessUs) ? ProcessUs : pMetrics->MaxProcessUs;
+        }
+
+        if (PicopRc != eSUCCESS)
+        {
+            Recycle(pFrame);
+            continue;
+        }
+
+        Forward(StageIndex + 1, pFrame);
+    }
+}
+
+// ****************************************************************************
+
+void TofPipeline::GetStageMetrics(UINT32 Stage, TofStageMetrics* pMetrics)
+{
+    if ((pMetrics == NULL) || (Stage >= mStages.size()))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mStages[Stage]->MetricsLock);
+        *pMetrics = mStages[Stage]->Metrics;
+    }
+
+    pMetrics->FramesDropped = mStages[Stage]->Queue.GetDropped();
+    pMetrics->QueueDepth = mStages[Stage]->Queue.GetDepth();
+    pMetrics->MaxQueueDepth = mStages[Stage]->Queue.GetMaxDepth();
+}
+
+// ****************************************************************************
+
+void TofPipeline::GetMetrics(TofPipelineMetrics* pMetrics)
+{
+    std::lock_guard<std::mutex> Lock(mMetricsLock);
+
+
+    *pMetrics = mMetrics;
+}
+
+// ****************************************************************************
+
+TofDecodeStage::TofDecodeStage()
+    : mDetector(eTOF_DETECTOR_FUSED)
+{
+}
+
+TofDecodeStage::TofDecodeStage(TofDetectorE Detector)
+    : mDetector(Detector)
+{
+}
+
+PICOP_RC TofDecodeStage::Start(const TofFrameGeometry* pGeometry)
+{
+    return mDecoder.Create(pGeometry, mDetector);
+}
+
+PICOP_RC TofDecodeStage::Process(TofPipelineFrame* pFrame)
+{
+    return mDecoder.Decode(pFrame->pRaw, pFrame->FrameWords, pFrame->pPlanes);
+}
+
+// ****************************************************************************
+
+TofProjectStage::TofProjectStage(const TofScanGeometry* pGeometry, UINT32 Threads)
+    : mThreads(Threads)
+{
+    TofDefaultScanGeometry(&mScanGeometry);
+
+    if (pGeometry != NULL)
+    {
+        mScanGeometry = *pGeometry;
+    }
+}
+
+PICOP_RC TofProjectStage::Start(const TofFrameGeometry* pGeometry)
+{
+    return mProjector.Create(&mScanGeometry, pGeometry->NumPulses, pGeometry->NumLines, mThreads);
+}
+
+PICOP_RC TofProjectStage::Process(TofPipelineFrame* pFrame)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+    TofFrameView View;
+
+
+    pFrame->pPlanes->GetView(&View);
+
+    if (pFrame->Masked)
+    {
+        return mProjector.ProjectIndices(&View, pFrame->pValid, pFrame->NumValid,
+                                         pFrame->pPoints, View.NumPulses * View.NumLines, &pFrame->NumPoints);
+    }
+
+    return mProjector.Project(&View, pFrame->pPoints, View.NumPulses * View.NumLines, &pFrame->NumPoints);
+}
+
+// ****************************************************************************
+
+TofSinkStage::TofSinkStage(TofPipelineCallback pfnCallback, void* pContext)
+    : mCallback(pfnCallback),
+      mContext(pContext)
+{
+}
+
+PICOP_RC TofSinkStage::Process(TofPipelineFrame* pFrame)
+{
+    if (mCallback != NULL)
+    {
+        mCallback(mContext, pFrame);
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
@@ -0,0 +1,216 @@
+// ****************************************************************************
+//  TofPipeline.h
+//
+// Staged, multi-threaded frame processing
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofAcquisition.h"
+#include "TofBoundedQueue.h"
+#include "TofFrame.h"
+#include "TofFrameDecoder.h"
+#include "TofFramePool.h"
+#include "TofFrameRing.h"
+#include "TofGeometry.h"
+#include "TofProjector.h"
+
+// ****************************************************************************
+// Frames enter the pipeline through Submit() (typically straight from the
+// TofAcquisition callback) and pass through the stages in the order they
+// were added, e.g. decode -> filter -> project -> sink. Each stage has its
+// own bounded input queue and one or more worker threads. When a stage's
+// queue is full the stage before it either waits (eTOF_QUEUE_BLOCK, so the
+// pressure reaches Submit() and the acquisition thread) or the oldest queued
+// frame is dropped (eTOF_QUEUE_DROP_OLDEST, so the newest data always gets
+// through). A stage with more than one thread may finish frames out of order.
+//
+// Every frame is preallocated in Start(): enough for every queue to be full
+// and every worker busy, so Submit() only waits when a blocking stage is
+// backed up, and nothing is allocated while frames flow. SubmitFrame() takes
+// a reference to a pooled frame instead of copying it.
+// ****************************************************************************
+
+typedef struct
+{
+    const UINT32* pRaw;                 // Frame words as returned by PicoP_TLC_AcquireTofFrame
+    UINT32 FrameWords;
+    TofPooledFrame* pSource;            // Holds pRaw, released when the frame leaves the pipeline
+    TofFrame* pPlanes;                  // Time and amplitude, after a TofDecodeStage
+    UINT32* pValid;                     // Valid pixel indices, after a TofValidMaskStage
+    UINT32 NumValid;
+    BOOL Masked;                        // pValid is filled in; projection skips the other pixels
+    PicoP_Pcd_Data* pPoints;            // After a TofProjectStage
+    UINT32 NumPoints;
+    UINT32 SequenceNumber;
+    TofClock::time_point AcquireTime;
+    TofClock::time_point QueueTime;     // When it entered its current queue
+} TofPipelineFrame;
+
+typedef struct
+{
+    const char* pName;
+    uint64_t FramesProcessed;
+    uint64_t FramesDropped;             // Evicted from the stage's input queue
+    uint64_t FramesRejected;            // Process() failed, the frame went no further
+    UINT32 QueueDepth;
+    UINT32 MaxQueueDepth;
+    uint64_t TotalWaitUs;               // Time frames spent in the input queue
+    uint64_t TotalProcessUs;
+    uint64_t MaxProcessUs;
+} TofStageMetrics;
+
+typedef struct
+{
+    uint64_t FramesSubmitted;
+    uint64_t FramesCompleted;           // Made it through the last stage
+    uint64_t TotalLatencyUs;            // Acquire time to the end of the last stage
+    uint64_t MaxLatencyUs;
+} TofPipelineMetrics;
+
+// ****************************************************************************
+// A stage. Start() is called once from TofPipeline::Start(), before any
+// frame; Process() is called from the stage's worker threads, concurrently
+// when it has more than one. A failure drops the frame.
+// ****************************************************************************
+
+class TofPipelineStage
+{
+public:
+    virtual ~TofPipelineStage() {}
+
+    virtual const char* GetName() const = 0;
+    virtual PICOP_RC Start(const TofFrameGeometry* pGeometry) { (void)pGeometry; return eSUCCESS; }
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame) = 0;
+};
+
+// ****************************************************************************
+
+class TofPipeline
+{
+public:
+    TofPipeline();
+    ~TofPipeline();
+
+    // Stages are not owned and must outlive the pipeline
+    PICOP_RC AddStage(TofPipelineStage* pStage, UINT32 Threads, UINT32 QueueDepth, TofQueuePolicyE Policy);
+
+    PICOP_RC Start(const TofFrameGeometry* pGeometry);
+    void Stop();
+
+    PICOP_RC Submit(const UINT32* pData, UINT32 SequenceNumber, TofClock::time_point AcquireTime);
+    PICOP_RC SubmitFrame(TofPooledFrame* pFrame);
+
+    // TofFrameCallback for TofAcquisition; pContext is the pipeline. Frames
+    // from an acquisition with a frame pool are passed on without a copy.
+    static void OnAcquiredFrame(void* pContext, const TofAcquiredFrame* pFrame);
+
+    UINT32 GetStageCount() const { return (UINT32)mStages.size(); }
+    void GetStageMetrics(UINT32 Stage, TofStageMetrics* pMetrics);
+    void GetMetrics(TofPipelineMetrics* pMetrics);
+
+private:
+    TofPipeline(const TofPipeline&);
+    TofPipeline& operator=(const TofPipeline&);
+
+    typedef struct
+    {
+        TofPipelineStage* pStage;
+        UINT32 Threads;
+        UINT32 QueueDepth;
+        TofQueuePolicyE Policy;
+        TofBoundedQueue<TofPipelineFrame*> Queue;
+        std::vector<std::thread> Workers;
+        std::mutex MetricsLock;
+        TofStageMetrics Metrics;
+    } Stage;
+
+    PICOP_RC AllocateFrames(UINT32 Count);
+    void FreeFrames();
+    PICOP_RC Enter(TofPooledFrame* pSource);
+    void Forward(UINT32 Next, TofPipelineFrame* pFrame);
+    void Complete(TofPipelineFrame* pFrame);
+    void Recycle(TofPipelineFrame* pFrame);
+    void WorkerThread(UINT32 StageIndex);
+
+    std::vector<Stage*> mStages;
+    std::vector<TofPipelineFrame> mFrames;
+    TofBoundedQueue<TofPipelineFrame*> mFreeFrames;
+    TofFramePool mRawFrames;            // Copies made by Submit()
+    TofFrameGeometry mGeometry;
+    std::atomic<BOOL> mRunning;
+
+    std::mutex mMetricsLock;
+    TofPipelineMetrics mMetrics;
+};
+
+// ****************************************************************************
+// Built in stages
+// ****************************************************************************
+
+// Decodes Detector's planes from pRaw into pPlanes, in any data format (see
+// TofFrameDecoder); the default is the fused detector
+class TofDecodeStage : public TofPipelineStage
+{
+public:
+    TofDecodeStage();
+    explicit TofDecodeStage(TofDetectorE Detector);
+
+    virtual const char* GetName() const { return "decode"; }
+    virtual PICOP_RC Start(const TofFrameGeometry* pGeometry);
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+private:
+    TofDetectorE mDetector;
+    TofFrameDecoder mDecoder;
+};
+
+// Projects pPlanes into pPoints, only the pValid pixels when the frame is
+// masked. Threads split each frame, as for TofProjector; run the stage itself
+// on one pipeline thread, more would only queue on the projector.
+class TofProjectStage : public TofPipelineStage
+{
+public:
+    TofProjectStage(const TofScanGeometry* pGeometry, UINT32 Threads);
+
+    virtual const char* GetName() const { return "project"; }
+    virtual PICOP_RC Start(const TofFrameGeometry* pGeometry);
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+private:
+    TofScanGeometry mScanGeometry;
+    UINT32 mThreads;
+    TofProjector mProjector;
+    std::mutex mLock;                   // The projector converts one frame at a time
+};
+
+// Hands each frame to a callback; the frame is only valid during the call
+typedef void (*TofPipelineCallback)(void* pContext, const TofPipelineFrame* pFrame);
+
+class TofSinkStage : public TofPipelineStage
+{
+public:
+    TofSinkStage(TofPipelineCallback pfnCallback, void* pContext);
+
+    virtual const char* GetName() const { return "sink"; }
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+private:
+    TofPipelineCallback mCallback;
+    void* mContext;
+};
+
+// ****************************************************************************
@@ -0,0 +1,645 @@
+// ****************************************************************************
+//  TofPointCloud.cpp
+//
+// Conversion of ToF frames to PCD points
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include "TofPointCloud.h"
+#include "TofMemory.h"
+#include "TofRayTableCache.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+#define TOF_DEGREES_TO_RADIANS(Degrees)     ((Degrees) * 0.01745329252f)
+
+// ****************************************************************************
+
+void TofDefaultScanGeometry(TofScanGeometry* pGeometry)
+{
+    pGeometry->HorizontalFov = TOF_DEFAULT_HORIZONTAL_FOV;
+    pGeometry->VerticalFov = TOF_DEFAULT_VERTICAL_FOV;
+    pGeometry->MillimetersPerCount = TOF_DEFAULT_MM_PER_COUNT;
+    pGeometry->PulsingMode = eTOF_PULSING_EQUAL_ANGLE;
+}
+
+// ****************************************************************************
+//  Each sample sits at the centre of its bin: of angle with equal angle
+//  pulsing, of time with equal time pulsing
+// ****************************************************************************
+
+FP32 TofPulseAzimuth(const TofScanGeometry* pGeometry, UINT32 Pulse, UINT32 NumPulses)
+{
+    FP32 Position = ((Pulse + 0.5f) / NumPulses) - 0.5f;
+    FP32 HalfFov = 0.5f * TOF_DEGREES_TO_RADIANS(pGeometry->HorizontalFov);
+    FP32 Phase = TOF_DEGREES_TO_RADIANS(TOF_EQUAL_TIME_SCAN_PHASE);
+
+
+    switch (pGeometry->PulsingMode)
+    {
+    case eTOF_PULSING_EQUAL_TIME:
+        // The mirror angle follows sin(phase); the sweep reaches the edge of
+        // the field of view at +/- TOF_EQUAL_TIME_SCAN_PHASE
+        return HalfFov * sinf(2.0f * Position * Phase) / sinf(Phase);
+
+    case eTOF_PULSING_EQUAL_ANGLE:
+    case eTOF_PULSING_POLYNOMIAL:
+    default:
+        return 2.0f * Position * HalfFov;
+    }
+}
+
+FP32 TofLineElevation(const TofScanGeometry* pGeometry, UINT32 Line, UINT32 NumLines)
+{
+    return (0.5f - ((Line + 0.5f) / NumLines)) * TOF_DEGREES_TO_RADIANS(pGeometry->VerticalFov);
+}
+
+// ****************************************************************************
+
+TofRayTable::TofRayTable()
+    : mNumPulses(0),
+      mNumLines(0)
+{
+    TofDefaultScanGeometry(&mGeometry);
+}
+
+// ****************************************************************************
+
+PICOP_RC TofRayTable::Create(const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines)
+{
+    FP32 Angle;
+
+
+    if ((pGeometry == NULL) || (NumPulses == 0) || (NumLines == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    mGeometry = *pGeometry;
+    mNumPulses = NumPulses;
+    mNumLines = NumLines;
+
+    mSinAzimuth.resize(NumPulses);
+    mCosAzimuth.resize(NumPulses);
+
+    for (UINT32 Pulse = 0; Pulse < NumPulses; Pulse++)
+    {
+        Angle = TofPulseAzimuth(pGeometry, Pulse, NumPulses);
+        mSinAzimuth[Pulse] = sinf(Angle);
+        mCosAzimuth[Pulse] = cosf(Angle);
+    }
+
+    mSinElevation.resize(NumLines);
+    mCosElevation.resize(NumLines);
+
+    for (UINT32 Line = 0; Line < NumLines; Line++)
+    {
+        Angle = TofLineElevation(pGeometry, Line, NumLines);
+        mSinElevation[Line] = sinf(Angle);
+        mCosElevation[Line] = cosf(Angle);
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+TofPointCloudSoA::TofPointCloudSoA()
+    : mpX(NULL),
+      mpY(NULL),
+      mpZ(NULL),
+      mpIntensity(NULL),
+      mCapacity(0),
+      mNumPoints(0)
+{
+}
+
+TofPointCloudSoA::~TofPointCloudSoA()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  One allocation, the four arrays each starting on a cache line
+// ****************************************************************************
+
+PICOP_RC TofPointCloudSoA::Create(UINT32 Capacity)
+{
+    size_t ArrayBytes = TOF_ALIGN_UP((size_t)Capacity * sizeof(FP32), TOF_CACHE_LINE_SIZE);
+
+
+    if (Capacity == 0)
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    mpX = (FP32*)TofAlignedAlloc(ArrayBytes * 4, TOF_CACHE_LINE_SIZE);
+
+    if (mpX == NULL)
+    {
+        return eFAILURE;
+    }
+
+    mpY = (FP32*)((UINT8*)mpX + ArrayBytes);
+    mpZ = (FP32*)((UINT8*)mpY + ArrayBytes);
+    mpIntensity = (FP32*)((UINT8*)mpZ + ArrayBytes);
+    mCapacity = Capacity;
+    mNumPoints = 0;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofPointCloudSoA::Destroy()
+{
+    TofAlignedFree(mpX);
+
+    mpX = NULL;
+    mpY = NULL;
+    mpZ = NULL;
+    mpIntensity = NULL;
+    mCapacity = 0;
+    mNumPoints = 0;
+}
+
+// ****************************************************************************
+//  Checks shared by the converters; returns the point count through
+//  pNumPoints
+// ****************************************************************************
+
+static PICOP_RC TofCheckPointCloudArgs(const TofFrameView* pView, const void* pGeometry,
+                                       const void* pPoints, UINT32 MaxPoints, UINT32* pNumPoints)
+{
+    if ((pView == NULL) || (pView->pTime == NULL) || (pView->pAmplitude == NULL) ||
+        (pGeometry == NULL) || (pPoints == NULL) || (pNumPoints == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    *pNumPoints = 0;
+
+    if (MaxPoints < (pView->NumPulses * pView->NumLines))
+    {
+        return eINVALID_ARG;
+    }
+
+    *pNumPoints = pView->NumPulses * pView->NumLines;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofFrameToPointCloudScalar(const TofFrameView* pView, const TofScanGeometry* pGeometry,
+                                    PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints)
+{
+    FP32 Azimuth;
+    FP32 Elevation;
+    FP32 CosElevation;
+    FP32 Range;
+    const UINT32* pTime;
+    const UINT32* pAmplitude;
+    PicoP_Pcd_Data* pPoint;
+    UINT32 NumPoints;
+    PICOP_RC PicopRc;
+
+
+    PicopRc = TofCheckPointCloudArgs(pView, pGeometry, pPoints, MaxPoints, &NumPoints);
+
+    if (PicopRc != eSUCCESS)
+    {
+        if (pNumPoints != NULL)
+        {
+            *pNumPoints = 0;
+        }
+
+        return PicopRc;
+    }
+
+    pPoint = pPoints;
+
+    for (UINT32 Line = 0; Line < pView->NumLines; Line++)
+    {
+        pTime = TofTimeLine(pView, Line);
+        pAmplitude = TofAmplitudeLine(pView, Line);
+
+        for (UINT32 Pulse = 0; Pulse < pView->NumPulses; Pulse++, pPoint++)
+        {
+            if (pTime[Pulse] == 0)
+            {
+                pPoint->x = 0;
+                pPoint->y = 0;
+                pPoint->z = 0;
+                pPoint->intensity = 0;
+                continue;
+            }
+
+            Azimuth = TofPulseAzimuth(pGeometry, Pulse, pView->NumPulses);
+            Elevation = TofLineElevation(pGeometry, Line, pView->NumLines);
+            CosElevation = cosf(Elevation);
+
+            Range = pTime[Pulse] * pGeometry->MillimetersPerCount;
+            pPoint->x = (INT32)lrintf(Range * CosElevation * sinf(Azimuth));
+            pPoint->y = (INT32)lrintf(Range * sinf(Elevation));
+            pPoint->z = (INT32)lrintf(Range * CosElevation * cosf(Azimuth));
+            pPoint->intensity = pAmplitude[Pulse];
+        }
+    }
+
+    *pNumPoints = NumPoints;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Converts one pixel through the table, with the same operations in the same
+//  order as the reference so the rounded result is identical
+// ****************************************************************************
+
+static inline void TofProjectPoint(FP32 SinAzimuth, FP32 CosAzimuth, FP32 SinElevation, FP32 CosElevation,
+                                   FP32 MillimetersPerCount, UINT32 Time, UINT32 Amplitude,
+                                   PicoP_Pcd_Data* pPoint)
+{
+    FP32 Range;
+
+
+    if (Time == 0)
+    {
+        pPoint->x = 0;
+        pPoint->y = 0;
+        pPoint->z = 0;
+        pPoint->intensity = 0;
+        return;
+    }
+
+    Range = Time * MillimetersPerCount;
+    pPoint->x = (INT32)lrintf(Range * CosElevation * SinAzimuth);
+    pPoint->y = (INT32)lrintf(Range * SinElevation);
+    pPoint->z = (INT32)lrintf(Range * CosElevation * CosAzimuth);
+    pPoint->intensity = Amplitude;
+}
+
+// ****************************************************************************
+//  Four pulses at a time: range, the three coordinates, then a 4 x 4
+//  transpose turns the x, y, z and intensity vectors into four records.
+//  Words with the top bit set would convert as negative, so a group holding
+//  one goes through the scalar path.
+// ****************************************************************************
+
+void TofProjectLines(const TofRayTable* pTable, const TofFrameView* pView,
+                     UINT32 FirstLine, UINT32 EndLine, PicoP_Pcd_Data* pPoints)
+{
+    const FP32* pSinAzimuth = pTable->GetSinAzimuth();
+    const FP32* pCosAzimuth = pTable->GetCosAzimuth();
+    FP32 MillimetersPerCount = pTable->GetGeometry()->MillimetersPerCount;
+    UINT32 NumPulses = pView->NumPulses;
+    FP32 SinElevation;
+    FP32 CosElevation;
+    const UINT32* pTime;
+    const UINT32* pAmplitude;
+    PicoP_Pcd_Data* pPoint;
+    UINT32 Pulse;
+
+
+    for (UINT32 Line = FirstLine; Line < EndLine; Line++)
+    {
+        SinElevation = pTable->GetSinElevation()[Line];
+        CosElevation = pTable->GetCosElevation()[Line];
+        pTime = TofTimeLine(pView, Line);
+        pAmplitude = TofAmplitudeLine(pView, Line);
+        pPoint = pPoints + (size_t)Line * NumPulses;
+        Pulse = 0;
+
+#if defined(TOF_SIMD_SSE2)
+        const __m128 Scale = _mm_set1_ps(MillimetersPerCount);
+        const __m128 SinE = _mm_set1_ps(SinElevation);
+        const __m128 CosE = _mm_set1_ps(CosElevation);
+        const __m128i Zero = _mm_setzero_si128();
+
+        for (; (Pulse + 4) <= NumPulses; Pulse += 4)
+        {
+            __m128i Time = _mm_loadu_si128((const __m128i*)(pTime + Pulse));
+            __m128i Amplitude = _mm_loadu_si128((const __m128i*)(pAmplitude + Pulse));
+
+            if (_mm_movemask_ps(_mm_castsi128_ps(Time)) != 0)
+            {
+                for (UINT32 i = Pulse; i < (Pulse + 4); i++)
+                {
+                    TofProjectPoint(pSinAzimuth[i], pCosAzimuth[i], SinElevation, CosElevation,
+                                    MillimetersPerCount, pTime[i], pAmplitude[i], pPoint + i);
+                }
+
+                continue;
+            }
+
+            __m128i Empty = _mm_cmpeq_epi32(Time, Zero);
+            __m128 Range = _mm_mul_ps(_mm_cvtepi32_ps(Time), Scale);
+            __m128 RangeCosE = _mm_mul_ps(Range, CosE);
+
+            __m128i X = _mm_cvtps_epi32(_mm_mul_ps(RangeCosE, _mm_loadu_ps(pSinAzimuth + Pulse)));
+            __m128i Y = _mm_cvtps_epi32(_mm_mul_ps(Range, SinE));
+            __m128i Z = _mm_cvtps_epi32(_mm_mul_ps(RangeCosE, _mm_loadu_ps(pCosAzimuth + Pulse)));
+
+            X = _mm_andnot_si128(Empty, X);
+            Y = _mm_andnot_si128(Empty, Y);
+            Z = _mm_andnot_si128(Empty, Z);
+            Amplitude = _mm_andnot_si128(Empty, Amplitude);
+
+            __m128i XY01 = _mm_unpacklo_epi32(X, Y);
+            __m128i ZA01 = _mm_unpacklo_epi32(Z, Amplitude);
+            __m128i XY23 = _mm_unpackhi_epi32(X, Y);
+            __m128i ZA23 = _mm_unpackhi_epi32(Z, Amplitude);
+
+            _mm_storeu_si128((__m128i*)(pPoint + Pulse), _mm_unpacklo_epi64(XY01, ZA01));
+            _mm_storeu_si128((__m128i*)(pPoint + Pulse + 1), _mm_unpackhi_epi64(XY01, ZA01));
+            _mm_storeu_si128((__m128i*)(pPoint + Pulse + 2), _mm_unpacklo_epi64(XY23, ZA23));
+            _mm_storeu_si128((__m128i*)(pPoint + Pulse + 3), _mm_unpackhi_epi64(XY23, ZA23));
+        }
+#endif
+
+        for (; Pulse < NumPulses; Pulse++)
+        {
+            TofProjectPoint(pSinAzimuth[Pulse], pCosAzimuth[Pulse], SinElevation, CosElevation,
+                            MillimetersPerCount, pTime[Pulse], pAmplitude[Pulse], pPoint + Pulse);
+        }
+    }
+}
+
+// ****************************************************************************
+//  Index lists are ascending, so the line is only recomputed when an index
+//  leaves the current one, and four indices spanning three are a run on one
+//  line that loads like TofProjectLines(). Other groups are gathered lane by
+//  lane, in registers: four scalar stores read back as a vector would stall
+//  on store forwarding.
+// ****************************************************************************
+
+void TofProjectIndices(const TofRayTable* pTable, const TofFrameView* pView,
+                       const UINT32* pIndices, UINT32 Count, PicoP_Pcd_Data* pPoints)
+{
+    const FP32* pSinAzimuth = pTable->GetSinAzimuth();
+    const FP32* pCosAzimuth = pTable->GetCosAzimuth();
+    const FP32* pSinElevation = pTable->GetSinElevation();
+    const FP32* pCosElevation = pTable->GetCosElevation();
+    FP32 MillimetersPerCount = pTable->GetGeometry()->MillimetersPerCount;
+    const UINT32* pTime = pView->pTime;
+    const UINT32* pAmplitude = pView->pAmplitude;
+    UINT32 NumPulses = pView->NumPulses;
+    UINT32 LineStart = 0;
+    UINT32 Line = 0;
+    UINT32 Pulse;
+    UINT32 Index;
+    UINT32 i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128 Scale = _mm_set1_ps(MillimetersPerCount);
+    const __m128i Zero = _mm_setzero_si128();
+    UINT32 Pulses[4];
+    UINT32 Lines[4];
+    __m128i Time;
+    __m128i Amplitude;
+    __m128 SinA;
+    __m128 CosA;
+    __m128 SinE;
+    __m128 CosE;
+
+    for (; (i + 4) <= Count; i += 4)
+    {
+        Index = pIndices[i];
+
+        if ((Index - LineStart) >= NumPulses)
+        {
+            Line = Index / NumPulses;
+            LineStart = Line * NumPulses;
+        }
+
+        Pulse = Index - LineStart;
+
+        if (((pIndices[i + 3] - Index) == 3) && ((Pulse + 4) <= NumPulses))
+        {
+            Time = _mm_loadu_si128((const __m128i*)(pTime + Index));
+            Amplitude = _mm_loadu_si128((const __m128i*)(pAmplitude + Index));
+            SinA = _mm_loadu_ps(pSinAzimuth + Pulse);
+            CosA = _mm_loadu_ps(pCosAzimuth + Pulse);
+            SinE = _mm_set1_ps(pSinElevation[Line]);
+            CosE = _mm_set1_ps(pCosElevation[Line]);
+        }
+        else
+        {
+            for (UINT32 Lane = 0; Lane < 4; Lane++)
+            {
+                Index = pIndices[i + Lane];
+
+                if ((Index - LineStart) >= NumPulses)
+                {
+                    Line = Index / NumPulses;
+                    LineStart = Line * NumPulses;
+                }
+
+                Pulses[Lane] = Index - LineStart;
+                Lines[Lane] = Line;
+            }
+
+            Index = pIndices[i];
+            Time = _mm_setr_epi32((int)pTime[Index], (int)pTime[pIndices[i + 1]],
+                                  (int)pTime[pIndices[i + 2]], (int)pTime[pIndices[i + 3]]);
+            Amplitude = _mm_setr_epi32((int)pAmplitude[Index], (int)pAmplitude[pIndices[i + 1]],
+                                       (int)pAmplitude[pIndices[i + 2]],
+                                       (int)pAmplitude[pIndices[i + 3]]);
+            SinA = _mm_setr_ps(pSinAzimuth[Pulses[0]], pSinAzimuth[Pulses[1]],
+                               pSinAzimuth[Pulses[2]], pSinAzimuth[Pulses[3]]);
+            CosA = _mm_setr_ps(pCosAzimuth[Pulses[0]], pCosAzimuth[Pulses[1]],
+                               pCosAzimuth[Pulses[2]], pCosAzimuth[Pulses[3]]);
+            SinE = _mm_setr_ps(pSinElevation[Lines[0]], pSinElevation[Lines[1]],
+                               pSinElevation[Lines[2]], pSinElevation[Lines[3]]);
+            CosE = _mm_setr_ps(pCosElevation[Lines[0]], pCosElevation[Lines[1]],
+                               pCosElevation[Lines[2]], pCosElevation[Lines[3]]);
+        }
+
+        // Rare enough to locate each pixel again
+        if (_mm_movemask_ps(_mm_castsi128_ps(Time)) != 0)
+        {
+            for (UINT32 Lane = 0; Lane < 4; Lane++)
+            {
+                Index = pIndices[i + Lane];
+                TofProjectPoint(pSinAzimuth[Index % NumPulses], pCosAzimuth[Index % NumPulses],
+                                pSinElevation[Index / NumPulses], pCosElevation[Index / NumPulses],
+                                MillimetersPerCount, pTime[Index], pAmplitude[Index],
+                                pPoints + i + Lane);
+            }
+
+            continue;
+        }
+
+        __m128i Empty = _mm_cmpeq_epi32(Time, Zero);
+        __m128 Range = _mm_mul_ps(_mm_cvtepi32_ps(Time), Scale);
+        __m128 RangeCosE = _mm_mul_ps(Range, CosE);
+
+        __m128i X = _mm_cvtps_epi32(_mm_mul_ps(RangeCosE, SinA));
+        __m128i Y = _mm_cvtps_epi32(_mm_mul_ps(Range, SinE));
+        __m128i Z = _mm_cvtps_epi32(_mm_mul_ps(RangeCosE, CosA));
+
+        X = _mm_andnot_si128(Empty, X);
+        Y = _mm_andnot_si128(Empty, Y);
+        Z = _mm_andnot_si128(Empty, Z);
+        Amplitude = _mm_andnot_si128(Empty, Amplitude);
+
+        __m128i XY01 = _mm_unpacklo_epi32(X, Y);
+        __m128i ZA01 = _mm_unpacklo_epi32(Z, Amplitude);
+        __m128i XY23 = _mm_unpackhi_epi32(X, Y);
+        __m128i ZA23 = _mm_unpackhi_epi32(Z, Amplitude);
+
+        _mm_storeu_si128((__m128i*)(pPoints + i), _mm_unpacklo_epi64(XY01, ZA01));
+        _mm_storeu_si128((__m128i*)(pPoints + i + 1), _mm_unpackhi_epi64(XY01, ZA01));
+        _mm_storeu_si128((__m128i*)(pPoints + i + 2), _mm_unpacklo_epi64(XY23, ZA23));
+        _mm_storeu_si128((__m128i*)(pPoints + i + 3), _mm_unpackhi_epi64(XY23, ZA23));
+    }
+#endif
+
+    for (; i < Count; i++)
+    {
+        Index = pIndices[i];
+
+        if ((Index - LineStart) >= NumPulses)
+        {
+            Line = Index / NumPulses;
+            LineStart = Line * NumPulses;
+        }
+
+        Pulse = Index - LineStart;
+        TofProjectPoint(pSinAzimuth[Pulse], pCosAzimuth[Pulse], pSinElevation[Line], pCosElevation[Line],
+                        MillimetersPerCount, pTime[Index], pAmplitude[Index], pPoints + i);
+    }
+}
+
+// ****************************************************************************
+
+void TofProjectLinesSoA(const TofRayTable* pTable, const TofFrameView* pView,
+                        UINT32 FirstLine, UINT32 EndLine, TofPointCloudSoA* pPoints)
+{
+    const FP32* pSinAzimuth = pTable->GetSinAzimuth();
+    const FP32* pCosAzimuth = pTable->GetCosAzimuth();
+    FP32 MillimetersPerCount = pTable->GetGeometry()->MillimetersPerCount;
+    UINT32 NumPulses = pView->NumPulses;
+    FP32 SinElevation;
+    FP32 CosElevation;
+    FP32 Range;
+    const UINT32* pTime;
+    const UINT32* pAmplitude;
+    size_t First;
+    FP32* pX;
+    FP32* pY;
+    FP32* pZ;
+    FP32* pIntensity;
+    UINT32 Pulse;
+
+
+    for (UINT32 Line = FirstLine; Line < EndLine; Line++)
+    {
+        SinElevation = pTable->GetSinElevation()[Line];
+        CosElevation = pTable->GetCosElevation()[Line];
+        pTime = TofTimeLine(pView, Line);
+        pAmplitude = TofAmplitudeLine(pView, Line);
+        First = (size_t)Line * NumPulses;
+        pX = pPoints->GetX() + First;
+        pY = pPoints->GetY() + First;
+        pZ = pPoints->GetZ() + First;
+        pIntensity = pPoints->GetIntensity() + First;
+        Pulse = 0;
+
+#if defined(TOF_SIMD_SSE2)
+        const __m128 Scale = _mm_set1_ps(MillimetersPerCount);
+        const __m128 SinE = _mm_set1_ps(SinElevation);
+        const __m128 CosE = _mm_set1_ps(CosElevation);
+        const __m128i Zero = _mm_setzero_si128();
+
+        for (; (Pulse + 4) <= NumPulses; Pulse += 4)
+        {
+            __m128i Time = _mm_loadu_si128((const __m128i*)(pTime + Pulse));
+            __m128i Amplitude = _mm_loadu_si128((const __m128i*)(pAmplitude + Pulse));
+
+            if (_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(Time, Amplitude))) != 0)
+            {
+                break;
+            }
+
+            __m128 Empty = _mm_castsi128_ps(_mm_cmpeq_epi32(Time, Zero));
+            __m128 Range4 = _mm_mul_ps(_mm_cvtepi32_ps(Time), Scale);
+            __m128 RangeCosE = _mm_mul_ps(Range4, CosE);
+
+            _mm_storeu_ps(pX + Pulse, _mm_andnot_ps(Empty, _mm_mul_ps(RangeCosE, _mm_loadu_ps(pSinAzimuth + Pulse))));
+            _mm_storeu_ps(pY + Pulse, _mm_andnot_ps(Empty, _mm_mul_ps(Range4, SinE)));
+            _mm_storeu_ps(pZ + Pulse, _mm_andnot_ps(Empty, _mm_mul_ps(RangeCosE, _mm_loadu_ps(pCosAzimuth + Pulse))));
+            _mm_storeu_ps(pIntensity + Pulse, _mm_andnot_ps(Empty, _mm_cvtepi32_ps(Amplitude)));
+        }
+#endif
+
+        // Remainder, or the rest of the line after a word with the top bit set
+        for (; Pulse < NumPulses; Pulse++)
+        {
+            if (pTime[Pulse] == 0)
+            {
+                pX[Pulse] = 0.0f;
+                pY[Pulse] = 0.0f;
+                pZ[Pulse] = 0.0f;
+                pIntensity[Pulse] = 0.0f;
+                continue;
+            }
+
+            Range = pTime[Pulse] * MillimetersPerCount;
+            pX[Pulse] = Range * CosElevation * pSinAzimuth[Pulse];
+            pY[Pulse] = Range * SinElevation;
+            pZ[Pulse] = Range * CosElevation * pCosAzimuth[Pulse];
+            pIntensity[Pulse] = (FP32)pAmplitude[Pulse];
+        }
+    }
+}
+
+// ****************************************************************************
+//  Single threaded, table driven conversion through the shared table cache
+// ****************************************************************************
+
+PICOP_RC TofFrameToPointCloud(const TofFrameView* pView, const TofScanGeometry* pGeometry,
+                              PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints)
+{
+    TofRayTablePtr Table;
+    UINT32 NumPoints;
+    PICOP_RC PicopRc;
+
+
+    PicopRc = TofCheckPointCloudArgs(pView, pGeometry, pPoints, MaxPoints, &NumPoints);
+
+    if (PicopRc == eSUCCESS)
+    {
+        PicopRc = TofSharedRayTables()->Get(pGeometry, pView->NumPulses, pView->NumLines, &Table);
+    }
+
+    if (PicopRc != eSUCCESS)
+    {
+        if (pNumPoints != NULL)
+        {
+            *pNumPoints = 0;
+        }
+
+        return PicopRc;
+    }
+
+    TofProjectLines(Table.get(), pView, 0, pView->NumLines, pPoints);
+    *pNumPoints = NumPoints;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
@@ -0,0 +1,154 @@
+// ****************************************************************************
+//  TofPointCloud.h
+//
+// Conversion of ToF frames to PCD points
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <vector>
+#include "TofFrameView.h"
+
+// ****************************************************************************
+// Pixel (Pulse, Line) is looked up along a fixed ray: the pulses of a line
+// are spread over the horizontal field of view and the lines evenly over the
+// vertical one. The time word times MillimetersPerCount is the range along
+// that ray.
+//
+// How pulses spread across a line depends on the pulsing mode. With equal
+// angle pulsing they are evenly spaced in angle. With equal time pulsing they
+// are evenly spaced in time along the resonant (sinusoidal) horizontal sweep,
+// so they bunch up towards the edges. The polynomial pattern's coefficients
+// are not reported by the device; it is treated as equal angle.
+// ****************************************************************************
+
+#define TOF_DEFAULT_HORIZONTAL_FOV      45.0f       // Degrees
+#define TOF_DEFAULT_VERTICAL_FOV        20.0f       // Degrees
+#define TOF_DEFAULT_MM_PER_COUNT        1.0f
+
+// Mirror phase either side of the sweep centre that falls inside the field of
+// view with equal time pulsing
+#define TOF_EQUAL_TIME_SCAN_PHASE       60.0f       // Degrees
+
+typedef struct
+{
+    FP32 HorizontalFov;                 // Full horizontal field of view in degrees
+    FP32 VerticalFov;                   // Full vertical field of view in degrees
+    FP32 MillimetersPerCount;           // Range of one time count
+    PicoP_ToFPulsingModeE PulsingMode;
+} TofScanGeometry;
+
+// ****************************************************************************
+
+void TofDefaultScanGeometry(TofScanGeometry* pGeometry);
+
+// Ray angles in radians, pulse 0 at the left edge and line 0 at the top
+FP32 TofPulseAzimuth(const TofScanGeometry* pGeometry, UINT32 Pulse, UINT32 NumPulses);
+FP32 TofLineElevation(const TofScanGeometry* pGeometry, UINT32 Line, UINT32 NumLines);
+
+// ****************************************************************************
+// Ray directions for every pulse and line of a frame size. The direction of
+// pixel (Pulse, Line) is (CosElevation * SinAzimuth, SinElevation,
+// CosElevation * CosAzimuth), so a table per pulse and one per line replace
+// the trig per point.
+// ****************************************************************************
+
+class TofRayTable
+{
+public:
+    TofRayTable();
+
+    PICOP_RC Create(const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines);
+
+    const TofScanGeometry* GetGeometry() const { return &mGeometry; }
+    UINT32 GetNumPulses() const { return mNumPulses; }
+    UINT32 GetNumLines() const { return mNumLines; }
+
+    const FP32* GetSinAzimuth() const { return &mSinAzimuth[0]; }
+    const FP32* GetCosAzimuth() const { return &mCosAzimuth[0]; }
+    const FP32* GetSinElevation() const { return &mSinElevation[0]; }
+    const FP32* GetCosElevation() const { return &mCosElevation[0]; }
+
+private:
+    TofScanGeometry mGeometry;
+    UINT32 mNumPulses;
+    UINT32 mNumLines;
+    std::vector<FP32> mSinAzimuth;      // Per pulse
+    std::vector<FP32> mCosAzimuth;
+    std::vector<FP32> mSinElevation;    // Per line
+    std::vector<FP32> mCosElevation;
+};
+
+// ****************************************************************************
+// Structure of arrays point cloud: unrounded millimetres and the amplitude as
+// a float, each array cache line aligned, for consumers that vectorize over
+// points rather than walk PicoP_Pcd_Data records
+// ****************************************************************************
+
+class TofPointCloudSoA
+{
+public:
+    TofPointCloudSoA();
+    ~TofPointCloudSoA();
+
+    PICOP_RC Create(UINT32 Capacity);
+    void Destroy();
+
+    FP32* GetX() { return mpX; }
+    FP32* GetY() { return mpY; }
+    FP32* GetZ() { return mpZ; }
+    FP32* GetIntensity() { return mpIntensity; }
+    UINT32 GetCapacity() const { return mCapacity; }
+    UINT32 GetNumPoints() const { return mNumPoints; }
+    void SetNumPoints(UINT32 NumPoints) { mNumPoints = NumPoints; }
+
+private:
+    TofPointCloudSoA(const TofPointCloudSoA&);
+    TofPointCloudSoA& operator=(const TofPointCloudSoA&);
+
+    FP32* mpX;
+    FP32* mpY;
+    FP32* mpZ;
+    FP32* mpIntensity;
+    UINT32 mCapacity;
+    UINT32 mNumPoints;
+};
+
+// ****************************************************************************
+// Converters. All write NumPulses * NumLines points (an organized cloud, line
+// by line); pixels with no return (time 0) are written as the origin with
+// zero intensity.
+//
+// TofFrameToPointCloudScalar() does the trig per point and is the reference
+// the table driven versions are checked against. TofProjectLines() converts
+// lines FirstLine .. EndLine - 1 through a ray table, four points at a time
+// where TofSimd.h allows; the integer output matches the reference exactly.
+// ****************************************************************************
+
+PICOP_RC TofFrameToPointCloud(const TofFrameView* pView, const TofScanGeometry* pGeometry,
+                              PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints);
+
+PICOP_RC TofFrameToPointCloudScalar(const TofFrameView* pView, const TofScanGeometry* pGeometry,
+                                    PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints);
+
+// pPoints and the SoA arrays are indexed from the start of the frame
+void TofProjectLines(const TofRayTable* pTable, const TofFrameView* pView,
+                     UINT32 FirstLine, UINT32 EndLine, PicoP_Pcd_Data* pPoints);
+void TofProjectLinesSoA(const TofRayTable* pTable, const TofFrameView* pView,
+                        UINT32 FirstLine, UINT32 EndLine, TofPointCloudSoA* pPoints);
+
+// Converts only the listed pixels (Line * NumPulses + Pulse, ascending and
+// unique as TofCompactValid() lists them) into an unorganized cloud: point i
+// is pixel pIndices[i]
+void TofProjectIndices(const TofRayTable* pTable, const TofFrameView* pView,
+                       const UINT32* pIndices, UINT32 Count, PicoP_Pcd_Data* pPoints);
+
+// ****************************************************************************
@@ -0,0 +1,324 @@
+// ****************************************************************************
+//  TofProjector.cpp
+//
+// Multi-threaded conversion of frames to point clouds
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "TofProjector.h"
+
+// ****************************************************************************
+
+TofProjector::TofProjector()
+    : mBands(0),
+      mpView(NULL),
+      mpPoints(NULL),
+      mpSoA(NULL),
+      mpIndices(NULL),
+      mNumIndices(0),
+      mGeneration(0),
+      mBandsPending(0),
+      mStopRequested(FALSE)
+{
+}
+
+TofProjector::~TofProjector()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Looks up the ray table and starts Threads - 1 workers
+// ****************************************************************************
+
+PICOP_RC TofProjector::Create(const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines,
+                              UINT32 Threads)
+{
+    PICOP_RC PicopRc;
+
+
+    Destroy();
+
+    PicopRc = TofSharedRayTables()->Get(pGeometry, NumPulses, NumLines, &mTable);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if (Threads == 0)
+    {
+        Threads = std::thread::hardware_concurrency();
+    }
+
+    // A band smaller than a line is no use, more threads than lines neither
+    mBands = (Threads == 0) ? 1 : Threads;
+    mBands = (mBands > NumLines) ? NumLines : mBands;
+    mStopRequested = FALSE;
+
+    for (UINT32 Band = 1; Band < mBands; Band++)
+    {
+        mWorkers.push_back(std::thread(&TofProjector::WorkerThread, this, Band, mGeneration));
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofProjector::Destroy()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStopRequested = TRUE;
+    }
+
+    mWake.notify_all();
+
+    for (size_t i = 0; i < mWorkers.size(); i++)
+    {
+        mWorkers[i].join();
+    }
+
+    mWorkers.clear();
+    mTable.reset();
+    mBands = 0;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofProjector::CheckView(const TofFrameView* pView) const
+{
+    if ((pView == NULL) || (pView->pTime == NULL) || (pView->pAmplitude == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mBands == 0)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if ((pView->NumPulses != mTable->GetNumPulses()) || (pView->NumLines != mTable->GetNumLines()))
+    {
+        return eFRAME_ERROR;
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofProjector::Project(const TofFrameView* pView, PicoP_Pcd_Data* pPoints, UINT32 MaxPoints,
+                               UINT32* pNumPoints)
+{
+    PICOP_RC PicopRc;
+
+
+    if ((pPoints == NULL) || (pNumPoints == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    *pNumPoints = 0;
+    PicopRc = CheckView(pView);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if (MaxPoints < (pView->NumPulses * pView->NumLines))
+    {
+        return eINVALID_ARG;
+    }
+
+    mpView = pView;
+    mpPoints = pPoints;
+    mpSoA = NULL;
+    mpIndices = NULL;
+    Run();
+
+    *pNumPoints = pView->NumPulses * pView->NumLines;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofProjector::ProjectSoA(const TofFrameView* pView, TofPointCloudSoA* pPoints)
+{
+    PICOP_RC PicopRc;
+
+
+    if (pPoints == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    PicopRc = CheckView(pView);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if (pPoints->GetCapacity() < (pView->NumPulses * pView->NumLines))
+    {
+        return eINVALID_ARG;
+    }
+
+    mpView = pView;
+    mpPoints = NULL;
+    mpSoA = pPoints;
+    mpIndices = NULL;
+    Run();
+
+    pPoints->SetNumPoints(pView->NumPulses * pView->NumLines);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofProjector::ProjectIndices(const TofFrameView* pView, const UINT32* pIndices, UINT32 Count,
+                                      PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints)
+{
+    PICOP_RC PicopRc;
+
+
+    if (((pIndices == NULL) && (Count != 0)) || (pPoints == NULL) || (pNumPoints == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    *pNumPoints = 0;
+    PicopRc = CheckView(pView);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if ((MaxPoints < Count) || (Count > (pView->NumPulses * pView->NumLines)))
+    {
+        return eINVALID_ARG;
+    }
+
+    mpView = pView;
+    mpPoints = pPoints;
+    mpSoA = NULL;
+    mpIndices = pIndices;
+    mNumIndices = Count;
+    Run();
+
+    *pNumPoints = Count;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Releases the workers on the current frame, converts band 0 here and waits
+//  for the rest
+// ****************************************************************************
+
+void TofProjector::Run()
+{
+    if (mBands > 1)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(mLock);
+            mBandsPending = mBands - 1;
+            mGeneration++;
+        }
+
+        mWake.notify_all();
+    }
+
+    ProjectBand(0);
+
+    if (mBands > 1)
+    {
+        std::unique_lock<std::mutex> Lock(mLock);
+
+        while (mBandsPending != 0)
+        {
+            mDone.wait(Lock);
+        }
+    }
+
+    mpView = NULL;
+}
+
+// ****************************************************************************
+
+void TofProjector::ProjectBand(UINT32 Band)
+{
+    UINT32 NumLines = mTable->GetNumLines();
+    UINT32 FirstLine = (Band * NumLines) / mBands;
+    UINT32 EndLine = ((Band + 1) * NumLines) / mBands;
+    UINT32 First;
+    UINT32 End;
+
+
+    if (mpIndices != NULL)
+    {
+        First = (UINT32)(((uint64_t)Band * mNumIndices) / mBands);
+        End = (UINT32)(((uint64_t)(Band + 1) * mNumIndices) / mBands);
+        TofProjectIndices(mTable.get(), mpView, mpIndices + First, End - First, mpPoints + First);
+    }
+    else if (mpPoints != NULL)
+    {
+        TofProjectLines(mTable.get(), mpView, FirstLine, EndLine, mpPoints);
+    }
+    else
+    {
+        TofProjectLinesSoA(mTable.get(), mpView, FirstLine, EndLine, mpSoA);
+    }
+}
+
+// ****************************************************************************
+//  Converts band Band of every frame Run() releases. Generation is the frame
+//  count when the worker was started, so a frame released before the worker
+//  first takes the lock is not missed.
+// ****************************************************************************
+
+void TofProjector::WorkerThread(UINT32 Band, UINT32 Generation)
+{
+    std::unique_lock<std::mutex> Lock(mLock);
+
+
+    for (;;)
+    {
+        while ((mGeneration == Generation) && ( ! mStopRequested))
+        {
+            mWake.wait(Lock);
+        }
+
+        if (mStopRequested)
+        {
+            break;
+        }
+
+        Generation = mGeneration;
+        Lock.unlock();
+
+        ProjectBand(Band);
+
+        Lock.lock();
+
+        if (--mBandsPending == 0)
+        {
+            mDone.notify_one();
+        }
+    }
+}
+
+// ****************************************************************************
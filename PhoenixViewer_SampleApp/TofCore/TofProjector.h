@@ -0,0 +1,81 @@
+// ****************************************************************************
+//  TofProjector.h
+//
+// Multi-threaded conversion of frames to point clouds
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TofPointCloud.h"
+#include "TofRayTableCache.h"
+
+// ****************************************************************************
+// Converts frames of one size through a ray table from TofSharedRayTables(),
+// looked up once in Create().
+// The lines of a frame are split into one band per thread; the calling
+// thread converts the first band while the workers convert the others, and
+// Project() returns when all are done. Only one thread may call Project() at
+// a time. ProjectIndices() splits an index list the same way.
+// ****************************************************************************
+
+class TofProjector
+{
+public:
+    TofProjector();
+    ~TofProjector();
+
+    // Threads 0 uses one thread per processor
+    PICOP_RC Create(const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines, UINT32 Threads);
+    void Destroy();
+
+    PICOP_RC Project(const TofFrameView* pView, PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints);
+    PICOP_RC ProjectSoA(const TofFrameView* pView, TofPointCloudSoA* pPoints);
+
+    // Converts only the listed pixels; see TofProjectIndices()
+    PICOP_RC ProjectIndices(const TofFrameView* pView, const UINT32* pIndices, UINT32 Count,
+                            PicoP_Pcd_Data* pPoints, UINT32 MaxPoints, UINT32* pNumPoints);
+
+    const TofRayTable* GetRayTable() const { return mTable.get(); }
+    UINT32 GetThreadCount() const { return mBands; }
+
+private:
+    TofProjector(const TofProjector&);
+    TofProjector& operator=(const TofProjector&);
+
+    PICOP_RC CheckView(const TofFrameView* pView) const;
+    void Run();
+    void ProjectBand(UINT32 Band);
+    void WorkerThread(UINT32 Band, UINT32 Generation);
+
+    TofRayTablePtr mTable;
+    UINT32 mBands;
+
+    // The frame being converted
+    const TofFrameView* mpView;
+    PicoP_Pcd_Data* mpPoints;
+    TofPointCloudSoA* mpSoA;
+    const UINT32* mpIndices;            // Set for ProjectIndices()
+    UINT32 mNumIndices;
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    UINT32 mGeneration;                 // Bumped for every frame
+    UINT32 mBandsPending;
+    BOOL mStopRequested;
+};
+
+// ****************************************************************************
@@ -0,0 +1,137 @@
+// ****************************************************************************
+//  TofRayTableCache.cpp
+//
+// Ray tables shared between the users of one scan configuration
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "TofRayTableCache.h"
+
+// ****************************************************************************
+
+static BOOL TofSameScanGeometry(const TofScanGeometry* pA, const TofScanGeometry* pB)
+{
+    return (pA->HorizontalFov == pB->HorizontalFov) &&
+           (pA->VerticalFov == pB->VerticalFov) &&
+           (pA->MillimetersPerCount == pB->MillimetersPerCount) &&
+           (pA->PulsingMode == pB->PulsingMode);
+}
+
+// ****************************************************************************
+
+TofRayTableCache::TofRayTableCache()
+    : mUseCount(0),
+      mHits(0),
+      mBuilds(0)
+{
+}
+
+// ****************************************************************************
+//  Returns the cached table for the configuration, building it on a miss.
+//  A table takes microseconds to build, so it is built under the lock and
+//  two threads asking for a new configuration at once build it only once.
+// ****************************************************************************
+
+PICOP_RC TofRayTableCache::Get(const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines,
+                               TofRayTablePtr* pTable)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+    std::shared_ptr<TofRayTable> Table;
+    Entry NewEntry;
+    size_t Oldest = 0;
+    PICOP_RC PicopRc;
+
+
+    if ((pGeometry == NULL) || (pTable == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    mUseCount++;
+
+    for (size_t i = 0; i < mEntries.size(); i++)
+    {
+        if ((mEntries[i].NumPulses == NumPulses) && (mEntries[i].NumLines == NumLines) &&
+            TofSameScanGeometry(&mEntries[i].Geometry, pGeometry))
+        {
+            mEntries[i].LastUsed = mUseCount;
+            mHits++;
+            *pTable = mEntries[i].Table;
+            return eSUCCESS;
+        }
+
+        if (mEntries[i].LastUsed < mEntries[Oldest].LastUsed)
+        {
+            Oldest = i;
+        }
+    }
+
+    Table = std::make_shared<TofRayTable>();
+    PicopRc = Table->Create(pGeometry, NumPulses, NumLines);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    NewEntry.Geometry = *pGeometry;
+    NewEntry.NumPulses = NumPulses;
+    NewEntry.NumLines = NumLines;
+    NewEntry.LastUsed = mUseCount;
+    NewEntry.Table = Table;
+
+    if (mEntries.size() < TOF_RAY_TABLE_CACHE_SIZE)
+    {
+        mEntries.push_back(NewEntry);
+    }
+    else
+    {
+        mEntries[Oldest] = NewEntry;
+    }
+
+    mBuilds++;
+    *pTable = Table;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofRayTableCache::Invalidate()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    mEntries.clear();
+}
+
+// ****************************************************************************
+
+void TofRayTableCache::GetStats(TofRayTableCacheStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    pStats->Hits = mHits;
+    pStats->Builds = mBuilds;
+    pStats->Tables = (UINT32)mEntries.size();
+}
+
+// ****************************************************************************
+
+TofRayTableCache* TofSharedRayTables()
+{
+    static TofRayTableCache sCache;
+
+
+    return &sCache;
+}
+
+// ****************************************************************************
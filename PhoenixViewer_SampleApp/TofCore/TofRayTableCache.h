@@ -0,0 +1,85 @@
+// ****************************************************************************
+//  TofRayTableCache.h
+//
+// Ray tables shared between the users of one scan configuration
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "TofPointCloud.h"
+
+// ****************************************************************************
+// A ray table depends only on the pulsing mode, the pulses per line, the line
+// count and the scan angles (HorizontalFov and VerticalFov, as reported by
+// PicoP_ALC_GetHorizontalScanAngle() and PicoP_ALC_GetVerticalScanAngle()).
+// The cache builds a table the first time a configuration is asked for and
+// hands the same table to every later caller. Tables are never changed once
+// built, so any number of threads can read one; a caller keeps its table
+// alive for as long as it holds the pointer, even after the cache drops it.
+//
+// A configuration change needs no action: the new key misses and builds its
+// own table. Invalidate() is for a change the key doesn't see, such as a new
+// calibration, and makes every configuration build again.
+// ****************************************************************************
+
+#define TOF_RAY_TABLE_CACHE_SIZE        4       // Tables kept, least recently used dropped first
+
+typedef std::shared_ptr<const TofRayTable> TofRayTablePtr;
+
+typedef struct
+{
+    uint64_t Hits;
+    uint64_t Builds;
+    UINT32 Tables;                      // Tables in the cache now
+} TofRayTableCacheStats;
+
+// ****************************************************************************
+
+class TofRayTableCache
+{
+public:
+    TofRayTableCache();
+
+    PICOP_RC Get(const TofScanGeometry* pGeometry, UINT32 NumPulses, UINT32 NumLines, TofRayTablePtr* pTable);
+    void Invalidate();
+
+    void GetStats(TofRayTableCacheStats* pStats);
+
+private:
+    TofRayTableCache(const TofRayTableCache&);
+    TofRayTableCache& operator=(const TofRayTableCache&);
+
+    typedef struct
+    {
+        TofScanGeometry Geometry;
+        UINT32 NumPulses;
+        UINT32 NumLines;
+        uint64_t LastUsed;
+        TofRayTablePtr Table;
+    } Entry;
+
+    std::mutex mLock;
+    std::vector<Entry> mEntries;
+    uint64_t mUseCount;
+    uint64_t mHits;
+    uint64_t mBuilds;
+};
+
+// ****************************************************************************
+
+// The process wide cache TofProjector and TofFrameToPointCloud() use
+TofRayTableCache* TofSharedRayTables();
+
+// ****************************************************************************
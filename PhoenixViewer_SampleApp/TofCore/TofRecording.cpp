@@ -0,0 +1,1024 @@
+// ****************************************************************************
+//  TofRecording.cpp
+//
+// Recording ToF sessions to disk and playing them back
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "TofRecording.h"
+#include "TofCodec.h"
+#include "TofGeometry.h"
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+static uint64_t TofMicroseconds(TofClock::duration Duration)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Duration).count();
+}
+
+// ****************************************************************************
+
+TofRecorder::TofRecorder()
+    : mFile(NULL),
+      mFrameBytes(0),
+      mRecordBytes(0),
+      mChunkBytes(0),
+      mCompress(FALSE),
+      mLineWords(0),
+      mCurrent(-1),
+      mFrameCount(0),
+      mStarted(FALSE),
+      mOffset(0),
+      mWriteResult(eSUCCESS),
+      mStopRequested(FALSE)
+{
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+TofRecorder::~TofRecorder()
+{
+    Close();
+}
+
+// ****************************************************************************
+//  Creates the file, writes its header and starts the writer thread
+// ****************************************************************************
+
+PICOP_RC TofRecorder::Open(const char* pFileName, const PicoP_TofPulsingConfig* pPulsingConfig,
+                           PicoP_ToFDataFormatE DataFormat, UINT32 FrameBytes, BOOL Compress)
+{
+    TofRecordingHeader Header;
+    TofFrameGeometry Geometry;
+
+
+    if ((pFileName == NULL) || (pPulsingConfig == NULL) || (FrameBytes == 0) ||
+        ((FrameBytes % sizeof(UINT32)) != 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mFile != NULL)
+    {
+        return eALREADY_OPENED;
+    }
+
+    mFrameBytes = FrameBytes;
+    mRecordBytes = (UINT32)(sizeof(TofRecordingFrame) + TOF_ALIGN_UP(FrameBytes, TOF_RECORDING_ALIGN));
+    mChunkBytes = sizeof(TofRecordingChunk) + ((size_t)mRecordBytes * TOF_RECORDING_CHUNK_FRAMES);
+    mCompress = Compress;
+
+    if (Compress)
+    {
+        // Lines are the codec's prediction unit; a frame that doesn't split
+        // into whole lines still codes, just as one long line
+        mLineWords = FrameBytes / sizeof(UINT32);
+
+        if (TofMakeFrameGeometry(pPulsingConfig, DataFormat, FrameBytes, &Geometry) == eSUCCESS)
+        {
+            mLineWords = Geometry.NumPulses;
+        }
+
+        mPacked.resize(sizeof(TofRecordingChunk) + TOF_RECORDING_CHUNK_FRAMES *
+                       (sizeof(TofRecordingFrame) +
+                        TOF_ALIGN_UP(TofCodecMaxBytes(FrameBytes / sizeof(UINT32), mLineWords), TOF_RECORDING_ALIGN)));
+    }
+
+    for (UINT32 i = 0; i < TOF_RECORDING_CHUNKS; i++)
+    {
+        mChunks.push_back((UINT8*)TofAlignedAlloc(mChunkBytes, TOF_RECORDING_ALIGN));
+
+        if (mChunks.back() == NULL)
+        {
+            Close();
+            return eFAILURE;
+        }
+
+        // Padding and reserved fields stay zero
+        memset(mChunks.back(), 0, mChunkBytes);
+        mFreeChunks.push_back(i);
+    }
+
+    mFile = fopen(pFileName, "wb");
+
+    if (mFile == NULL)
+    {
+        Close();
+        return eFAILURE;
+    }
+
+    // Chunks are written whole, stdio buffering would only add a copy
+    setvbuf(mFile, NULL, _IONBF, 0);
+
+    memset(&Header, 0, sizeof(Header));
+    memcpy(Header.Magic, TOF_RECORDING_MAGIC, sizeof(Header.Magic));
+    Header.Version = TOF_RECORDING_VERSION;
+    Header.FrameBytes = FrameBytes;
+    Header.DataFormat = (UINT32)DataFormat;
+    Header.ChunkFrames = TOF_RECORDING_CHUNK_FRAMES;
+    Header.PulsingConfig = *pPulsingConfig;
+    Header.Flags = Compress ? TOF_RECORDING_FLAG_COMPRESSED : 0;
+
+    if (fwrite(&Header, sizeof(Header), 1, mFile) != 1)
+    {
+        Close();
+        return eDEVICE_ERROR;
+    }
+
+    mOffset = sizeof(Header);
+    mStats.BytesWritten = sizeof(Header);
+    mCurrent = -1;
+    mFrameCount = 0;
+    mStarted = FALSE;
+    mWriteResult = eSUCCESS;
+    mStopRequested = FALSE;
+    mThread = std::thread(&TofRecorder::WriterThread, this);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Flushes the last partial chunk, then appends the index and trailer.
+//  Returns the first error the writer ran into, if any.
+// ****************************************************************************
+
+PICOP_RC TofRecorder::Close()
+{
+    TofRecordingTrailer Trailer;
+    PICOP_RC Result;
+
+
+    if (mThread.joinable())
+    {
+        if (mCurrent >= 0)
+        {
+            QueueChunk();
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock(mLock);
+            mStopRequested = TRUE;
+        }
+
+        mWake.notify_all();
+        mThread.join();
+    }
+
+    Result = mWriteResult;
+
+    if (mFile != NULL)
+    {
+        if (Result == eSUCCESS)
+        {
+            memset(&Trailer, 0, sizeof(Trailer));
+            memcpy(Trailer.Magic, TOF_RECORDING_INDEX_MAGIC, sizeof(Trailer.Magic));
+            Trailer.IndexOffset = mOffset;
+            Trailer.FrameCount = (UINT32)mIndex.size();
+
+            if (( ! mIndex.empty() &&
+                  (fwrite(&mIndex[0], sizeof(TofRecordingIndexEntry), mIndex.size(), mFile) != mIndex.size())) ||
+                (fwrite(&Trailer, sizeof(Trailer), 1, mFile) != 1))
+            {
+                Result = eDEVICE_ERROR;
+            }
+        }
+
+        if (fclose(mFile) != 0)
+        {
+            Result = eDEVICE_ERROR;
+        }
+
+        mFile = NULL;
+    }
+
+    for (size_t i = 0; i < mChunks.size(); i++)
+    {
+        TofAlignedFree(mChunks[i]);
+    }
+
+    mChunks.clear();
+    mFreeChunks.clear();
+    mFullChunks.clear();
+    mIndex.clear();
+    mPacked.clear();
+    mCurrent = -1;
+
+    return Result;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofRecorder::Write(const TofAcquiredFrame* pFrame)
+{
+    if ((pFrame == NULL) || (pFrame->Result != eSUCCESS) || (pFrame->FrameWords * sizeof(UINT32) < mFrameBytes))
+    {
+        return eINVALID_ARG;
+    }
+
+    return Write(pFrame->pData, pFrame->SequenceNumber, pFrame->EventTime, pFrame->AcquireTime);
+}
+
+// ****************************************************************************
+//  Copies one frame into the current chunk; returns eBUSY if it had to be
+//  dropped because the writer is behind
+// ****************************************************************************
+
+PICOP_RC TofRecorder::Write(const UINT32* pData, UINT32 SequenceNumber,
+                            TofClock::time_point EventTime, TofClock::time_point AcquireTime)
+{
+    TofRecordingChunk* pChunk;
+    TofRecordingFrame* pRecord;
+
+
+    if ((mFile == NULL) || (pData == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ( ! mStarted)
+    {
+        mStartTime = (EventTime < AcquireTime) ? EventTime : AcquireTime;
+        mStarted = TRUE;
+    }
+
+    if (mCurrent < 0)
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+        if (mFreeChunks.empty())
+        {
+            mStats.FramesDropped++;
+            return eBUSY;
+        }
+
+        mCurrent = (INT32)mFreeChunks.back();
+        mFreeChunks.pop_back();
+
+        pChunk = (TofRecordingChunk*)mChunks[mCurrent];
+        pChunk->Magic = TOF_RECORDING_CHUNK_MAGIC;
+        pChunk->FrameCount = 0;
+        pChunk->FirstFrame = mFrameCount;
+    }
+
+    pChunk = (TofRecordingChunk*)mChunks[mCurrent];
+    pRecord = (TofRecordingFrame*)(mChunks[mCurrent] + sizeof(TofRecordingChunk) +
+                                   (size_t)pChunk->FrameCount * mRecordBytes);
+
+    pRecord->SequenceNumber = SequenceNumber;
+    pRecord->PayloadBytes = mFrameBytes;
+    pRecord->TimestampUs = (AcquireTime > mStartTime) ? TofMicroseconds(AcquireTime - mStartTime) : 0;
+    pRecord->EventTimeUs = (EventTime > mStartTime) ? TofMicroseconds(EventTime - mStartTime) : 0;
+    memcpy(pRecord + 1, pData, mFrameBytes);
+
+    pChunk->FrameCount++;
+    mFrameCount++;
+
+    if (pChunk->FrameCount == TOF_RECORDING_CHUNK_FRAMES)
+    {
+        QueueChunk();
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofRecorder::QueueChunk()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mFullChunks.push_back((UINT32)mCurrent);
+    }
+
+    mCurrent = -1;
+    mWake.notify_one();
+}
+
+// ****************************************************************************
+
+void TofRecorder::GetStats(TofRecorderStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pStats = mStats;
+}
+
+// ****************************************************************************
+//  Encodes a full chunk into mPacked, each frame against the one before it
+//  in the chunk so every chunk starts with a key frame. Returns the packed
+//  size.
+// ****************************************************************************
+
+size_t TofRecorder::PackChunk(const TofRecordingChunk* pChunk)
+{
+    const TofRecordingFrame* pRecord;
+    const UINT32* pReference = NULL;
+    TofRecordingFrame* pPacked;
+    size_t Position = sizeof(TofRecordingChunk);
+    size_t PayloadBytes = 0;
+    size_t PaddedBytes;
+
+
+    memcpy(&mPacked[0], pChunk, sizeof(TofRecordingChunk));
+
+    for (UINT32 i = 0; i < pChunk->FrameCount; i++)
+    {
+        pRecord = (const TofRecordingFrame*)((const UINT8*)(pChunk + 1) + (size_t)i * mRecordBytes);
+        pPacked = (TofRecordingFrame*)&mPacked[Position];
+        *pPacked = *pRecord;
+
+        // mPacked is sized for the worst case, this can't run out of room
+        TofEncodeFrame((const UINT32*)(pRecord + 1), pReference, mFrameBytes / sizeof(UINT32), mLineWords,
+                       (UINT8*)(pPacked + 1), mPacked.size() - Position - sizeof(TofRecordingFrame),
+                       &PayloadBytes);
+
+        PaddedBytes = TOF_ALIGN_UP(PayloadBytes, TOF_RECORDING_ALIGN);
+        memset((UINT8*)(pPacked + 1) + PayloadBytes, 0, PaddedBytes - PayloadBytes);
+        pPacked->PayloadBytes = (UINT32)PayloadBytes;
+
+        Position += sizeof(TofRecordingFrame) + PaddedBytes;
+        pReference = (const UINT32*)(pRecord + 1);
+    }
+
+    return Position;
+}
+
+// ****************************************************************************
+//  Writes queued chunks in order and records where each frame landed. After a
+//  write error chunks are still taken off the queue, just not written.
+// ****************************************************************************
+
+void TofRecorder::WriterThread()
+{
+    std::unique_lock<std::mutex> Lock(mLock);
+    const TofRecordingChunk* pChunk;
+    const TofRecordingFrame* pRecord;
+    const UINT8* pOut;
+    TofRecordingIndexEntry Entry;
+    uint64_t PayloadBytes = 0;
+    size_t Position;
+    size_t Bytes;
+    UINT32 Chunk;
+
+
+    for (;;)
+    {
+        while (mFullChunks.empty() && ( ! mStopRequested))
+        {
+            mWake.wait(Lock);
+        }
+
+        if (mFullChunks.empty())
+        {
+            break;
+        }
+
+        Chunk = mFullChunks.front();
+        mFullChunks.erase(mFullChunks.begin());
+        Lock.unlock();
+
+        pChunk = (const TofRecordingChunk*)mChunks[Chunk];
+        pOut = (const UINT8*)pChunk;
+        Bytes = sizeof(TofRecordingChunk) + ((size_t)pChunk->FrameCount * mRecordBytes);
+
+        if ((mWriteResult == eSUCCESS) && mCompress)
+        {
+            pOut = &mPacked[0];
+            Bytes = PackChunk(pChunk);
+        }
+
+        if (mWriteResult == eSUCCESS)
+        {
+            if (fwrite(pOut, 1, Bytes, mFile) != Bytes)
+            {
+                mWriteResult = eDEVICE_ERROR;
+            }
+            else
+            {
+                Position = sizeof(TofRecordingChunk);
+                PayloadBytes = 0;
+
+                for (UINT32 i = 0; i < pChunk->FrameCount; i++)
+                {
+                    pRecord = (const TofRecordingFrame*)(pOut + Position);
+                    Entry.Offset = mOffset + Position;
+                    Entry.TimestampUs = pRecord->TimestampUs;
+                    mIndex.push_back(Entry);
+
+                    PayloadBytes += pRecord->PayloadBytes;
+                    Position += sizeof(TofRecordingFrame) + TOF_ALIGN_UP(pRecord->PayloadBytes, TOF_RECORDING_ALIGN);
+                }
+
+                mOffset += Bytes;
+            }
+        }
+
+        Lock.lock();
+
+        if (mWriteResult == eSUCCESS)
+        {
+            mStats.FramesWritten += pChunk->FrameCount;
+            mStats.BytesWritten += Bytes;
+            mStats.PayloadBytes += PayloadBytes;
+        }
+
+        mFreeChunks.push_back(Chunk);
+    }
+}
+
+// ****************************************************************************
+
+TofRecordingReader::TofRecordingReader()
+    : mpBase(NULL),
+      mSize(0),
+#ifdef _WIN32
+      mFileHandle(INVALID_HANDLE_VALUE),
+      mMappingHandle(NULL),
+#else
+      mFileDescriptor(-1),
+#endif
+      mComplete(FALSE),
+      mDecodedIndex(TOF_RECORDING_NO_FRAME)
+{
+    memset(&mHeader, 0, sizeof(mHeader));
+}
+
+TofRecordingReader::~TofRecordingReader()
+{
+    Close();
+}
+
+// ****************************************************************************
+
+PICOP_RC TofRecordingReader::Open(const char* pFileName)
+{
+    PICOP_RC PicopRc;
+
+
+    if (pFileName == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    Close();
+    PicopRc = Map(pFileName);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if (mSize < sizeof(TofRecordingHeader))
+    {
+        Close();
+        return eFRAME_ERROR;
+    }
+
+    memcpy(&mHeader, mpBase, sizeof(mHeader));
+
+    if ((memcmp(mHeader.Magic, TOF_RECORDING_MAGIC, sizeof(mHeader.Magic)) != 0) ||
+        (mHeader.Version == 0) || (mHeader.Version > TOF_RECORDING_VERSION) ||
+        (mHeader.FrameBytes == 0) || ((mHeader.FrameBytes % sizeof(UINT32)) != 0))
+    {
+        Close();
+        return eFRAME_ERROR;
+    }
+
+    // Version 1 left Flags zero, which reads as uncompressed
+    mComplete = LoadIndex();
+
+    if ( ! mComplete)
+    {
+        RebuildIndex();
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofRecordingReader::Close()
+{
+    Unmap();
+    mIndex.clear();
+    memset(&mHeader, 0, sizeof(mHeader));
+    mComplete = FALSE;
+    mDecoded.clear();
+    mDecodeScratch.clear();
+    mDecodedIndex = TOF_RECORDING_NO_FRAME;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofRecordingReader::GetFrame(UINT32 Index, TofRecordedFrame* pFrame) const
+{
+    const TofRecordingFrame* pRecord;
+    PICOP_RC PicopRc;
+
+
+    if ((pFrame == NULL) || (Index >= mIndex.size()))
+    {
+        return eINVALID_ARG;
+    }
+
+    pRecord = (const TofRecordingFrame*)(mpBase + mIndex[Index].Offset);
+    pFrame->pData = (const UINT32*)(pRecord + 1);
+
+    if (IsCompressed())
+    {
+        PicopRc = Decode(Index);
+
+        if (PicopRc != eSUCCESS)
+        {
+            return PicopRc;
+        }
+
+        pFrame->pData = &mDecoded[0];
+    }
+
+    pFrame->FrameWords = mHeader.FrameBytes / sizeof(UINT32);
+    pFrame->SequenceNumber = pRecord->SequenceNumber;
+    pFrame->TimestampUs = pRecord->TimestampUs;
+    pFrame->EventTimeUs = pRecord->EventTimeUs;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Leaves frame Index of a compressed recording in mDecoded. Backs up to the
+//  nearest frame that decodes from what is already there: a key frame, or the
+//  frame after the one last decoded.
+// ****************************************************************************
+
+PICOP_RC TofRecordingReader::Decode(UINT32 Index) const
+{
+    const TofRecordingFrame* pRecord;
+    TofCodecHeader Codec;
+    UINT32 FrameWords = mHeader.FrameBytes / sizeof(UINT32);
+    UINT32 First = Index;
+    PICOP_RC PicopRc;
+
+
+    if (mDecodedIndex == Index)
+    {
+        return eSUCCESS;
+    }
+
+    for (;;)
+    {
+        pRecord = (const TofRecordingFrame*)(mpBase + mIndex[First].Offset);
+
+        if (pRecord->PayloadBytes < sizeof(Codec))
+        {
+            return eFRAME_ERROR;
+        }
+
+        memcpy(&Codec, pRecord + 1, sizeof(Codec));
+
+        if ( ! (Codec.Flags & TOF_CODEC_FLAG_INTER) || (First == 0) || ((First - 1) == mDecodedIndex))
+        {
+            break;
+        }
+
+        First--;
+    }
+
+    mDecoded.resize(FrameWords);
+    mDecodeScratch.resize(FrameWords);
+
+    for (UINT32 i = First; i <= Index; i++)
+    {
+        pRecord = (const TofRecordingFrame*)(mpBase + mIndex[i].Offset);
+        PicopRc = TofDecodeFrame((const UINT8*)(pRecord + 1), pRecord->PayloadBytes,
+                                 ((i != 0) && (mDecodedIndex == (i - 1))) ? &mDecoded[0] : NULL,
+                                 &mDecodeScratch[0], FrameWords);
+
+        if (PicopRc != eSUCCESS)
+        {
+            mDecodedIndex = TOF_RECORDING_NO_FRAME;
+            return PicopRc;
+        }
+
+        mDecoded.swap(mDecodeScratch);
+        mDecodedIndex = i;
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Size of the frame record at Offset including its padded payload, 0 if it
+//  doesn't fit in the file
+// ****************************************************************************
+
+uint64_t TofRecordingReader::RecordBytes(uint64_t Offset) const
+{
+    const TofRecordingFrame* pRecord;
+    uint64_t PayloadBytes;
+
+
+    if ((Offset + sizeof(TofRecordingFrame)) > mSize)
+    {
+        return 0;
+    }
+
+    pRecord = (const TofRecordingFrame*)(mpBase + Offset);
+    PayloadBytes = (pRecord->PayloadBytes == 0) ? mHeader.FrameBytes : pRecord->PayloadBytes;
+
+    if ( ! IsCompressed() && (PayloadBytes != mHeader.FrameBytes))
+    {
+        return 0;
+    }
+
+    PayloadBytes = sizeof(TofRecordingFrame) + TOF_ALIGN_UP(PayloadBytes, TOF_RECORDING_ALIGN);
+
+    return ((Offset + PayloadBytes) <= mSize) ? PayloadBytes : 0;
+}
+
+// ****************************************************************************
+
+UINT32 TofRecordingReader::FindFrame(uint64_t TimestampUs) const
+{
+    size_t Low = 0;
+    size_t High = mIndex.size();
+    size_t Middle;
+
+
+    // First frame after TimestampUs, the one before it is the answer
+    while (Low < High)
+    {
+        Middle = (Low + High) / 2;
+
+        if (mIndex[Middle].TimestampUs <= TimestampUs)
+        {
+            Low = Middle + 1;
+        }
+        else
+        {
+            High = Middle;
+        }
+    }
+
+    return (Low == 0) ? 0 : (UINT32)(Low - 1);
+}
+
+// ****************************************************************************
+//  Uses the index written on close, after checking it is sane
+// ****************************************************************************
+
+BOOL TofRecordingReader::LoadIndex()
+{
+    TofRecordingTrailer Trailer;
+    uint64_t IndexBytes;
+    uint64_t Bytes;
+
+
+    if (mSize < (sizeof(TofRecordingHeader) + sizeof(Trailer)))
+    {
+        return FALSE;
+    }
+
+    memcpy(&Trailer, mpBase + mSize - sizeof(Trailer), sizeof(Trailer));
+    IndexBytes = (uint64_t)Trailer.FrameCount * sizeof(TofRecordingIndexEntry);
+
+    if ((memcmp(Trailer.Magic, TOF_RECORDING_INDEX_MAGIC, sizeof(Trailer.Magic)) != 0) ||
+        ((Trailer.IndexOffset + IndexBytes + sizeof(Trailer)) != mSize))
+    {
+        return FALSE;
+    }
+
+    mIndex.resize(Trailer.FrameCount);
+
+    if (Trailer.FrameCount != 0)
+    {
+        memcpy(&mIndex[0], mpBase + Trailer.IndexOffset, (size_t)IndexBytes);
+    }
+
+    for (size_t i = 0; i < mIndex.size(); i++)
+    {
+        Bytes = RecordBytes(mIndex[i].Offset);
+
+        if ((Bytes == 0) || ((mIndex[i].Offset + Bytes) > Trailer.IndexOffset))
+        {
+            mIndex.clear();
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+// ****************************************************************************
+//  Walks the chunks of a recording that was not closed, keeping every frame
+//  that was written completely
+// ****************************************************************************
+
+void TofRecordingReader::RebuildIndex()
+{
+    const TofRecordingChunk* pChunk;
+    const TofRecordingFrame* pRecord;
+    TofRecordingIndexEntry Entry;
+    uint64_t Offset = sizeof(TofRecordingHeader);
+    uint64_t Bytes;
+
+
+    mIndex.clear();
+
+    while ((Offset + sizeof(TofRecordingChunk)) <= mSize)
+    {
+        pChunk = (const TofRecordingChunk*)(mpBase + Offset);
+
+        if ((pChunk->Magic != TOF_RECORDING_CHUNK_MAGIC) || (pChunk->FrameCount == 0))
+        {
+            break;
+        }
+
+        Offset += sizeof(TofRecordingChunk);
+
+        for (UINT32 i = 0; i < pChunk->FrameCount; i++)
+        {
+            Bytes = RecordBytes(Offset);
+
+            if (Bytes == 0)
+            {
+                return;
+            }
+
+            pRecord = (const TofRecordingFrame*)(mpBase + Offset);
+            Entry.Offset = Offset;
+            Entry.TimestampUs = pRecord->TimestampUs;
+            mIndex.push_back(Entry);
+            Offset += Bytes;
+        }
+    }
+}
+
+// ****************************************************************************
+
+#ifdef _WIN32
+
+PICOP_RC TofRecordingReader::Map(const char* pFileName)
+{
+    LARGE_INTEGER Size;
+
+
+    mFileHandle = CreateFileA(pFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+    {
+        return eFAILURE;
+    }
+
+    if (( ! GetFileSizeEx(mFileHandle, &Size)) || (Size.QuadPart == 0) ||
+        ((uint64_t)Size.QuadPart > (uint64_t)(SIZE_T)-1))
+    {
+        Unmap();
+        return eFAILURE;
+    }
+
+    mMappingHandle = CreateFileMappingA(mFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mMappingHandle == NULL)
+    {
+        Unmap();
+        return eFAILURE;
+    }
+
+    mpBase = (const UINT8*)MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if (mpBase == NULL)
+    {
+        Unmap();
+        return eFAILURE;
+    }
+
+    mSize = (uint64_t)Size.QuadPart;
+
+    return eSUCCESS;
+}
+
+void TofRecordingReader::Unmap()
+{
+    if (mpBase != NULL)
+    {
+        UnmapViewOfFile(mpBase);
+        mpBase = NULL;
+    }
+
+    if (mMappingHandle != NULL)
+    {
+        CloseHandle(mMappingHandle);
+        mMappingHandle = NULL;
+    }
+
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+
+    mSize = 0;
+}
+
+#else
+
+PICOP_RC TofRecordingReader::Map(const char* pFileName)
+{
+    struct stat Status;
+    void* pMapping;
+
+
+    mFileDescriptor = open(pFileName, O_RDONLY);
+
+    if (mFileDescriptor < 0)
+    {
+        return eFAILURE;
+    }
+
+    if ((fstat(mFileDescriptor, &Status) != 0) || (Status.st_size == 0))
+    {
+        Unmap();
+        return eFAILURE;
+    }
+
+    pMapping = mmap(NULL, (size_t)Status.st_size, PROT_READ, MAP_SHARED, mFileDescriptor, 0);
+
+    if (pMapping == MAP_FAILED)
+    {
+        Unmap();
+        return eFAILURE;
+    }
+
+    // Playback mostly walks forward
+    madvise(pMapping, (size_t)Status.st_size, MADV_SEQUENTIAL);
+
+    mpBase = (const UINT8*)pMapping;
+    mSize = (uint64_t)Status.st_size;
+
+    return eSUCCESS;
+}
+
+void TofRecordingReader::Unmap()
+{
+    if (mpBase != NULL)
+    {
+        munmap((void*)mpBase, (size_t)mSize);
+        mpBase = NULL;
+    }
+
+    if (mFileDescriptor >= 0)
+    {
+        close(mFileDescriptor);
+        mFileDescriptor = -1;
+    }
+
+    mSize = 0;
+}
+
+#endif
+
+// ****************************************************************************
+
+TofPlayer::TofPlayer()
+    : mReader(NULL),
+      mSpeed(1.0f),
+      mFirstFrame(0),
+      mCallback(NULL),
+      mContext(NULL),
+      mStopRequested(FALSE),
+      mRunning(FALSE),
+      mFramesPlayed(0)
+{
+}
+
+TofPlayer::~TofPlayer()
+{
+    Stop();
+}
+
+// ****************************************************************************
+
+PICOP_RC TofPlayer::Start(const TofRecordingReader* pReader, FP32 Speed, UINT32 FirstFrame,
+                          TofFrameCallback pfnCallback, void* pContext)
+{
+    if ((pReader == NULL) || (pfnCallback == NULL) || (Speed < 0.0f) ||
+        (FirstFrame >= pReader->GetFrameCount()))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mThread.joinable())
+    {
+        return eBUSY;
+    }
+
+    mReader = pReader;
+    mSpeed = Speed;
+    mFirstFrame = FirstFrame;
+    mCallback = pfnCallback;
+    mContext = pContext;
+    mStopRequested = FALSE;
+    mFramesPlayed = 0;
+    mRunning = TRUE;
+    mThread = std::thread(&TofPlayer::PlayerThread, this);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofPlayer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStopRequested = TRUE;
+    }
+
+    mWake.notify_all();
+
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+// ****************************************************************************
+//  Frame i is due (Timestamp(i) - Timestamp(FirstFrame)) / Speed after the
+//  start, so a slow consumer delays frames but does not change the pace
+// ****************************************************************************
+
+void TofPlayer::PlayerThread()
+{
+    TofClock::time_point StartTime = TofClock::now();
+    TofClock::time_point DueTime;
+    TofRecordedFrame Recorded;
+    TofAcquiredFrame Frame;
+    uint64_t FirstTimestampUs;
+    BOOL Stop = FALSE;
+
+
+    if (mReader->GetFrame(mFirstFrame, &Recorded) != eSUCCESS)
+    {
+        mRunning = FALSE;
+        return;
+    }
+
+    FirstTimestampUs = Recorded.TimestampUs;
+
+    for (UINT32 Index = mFirstFrame; ( ! Stop) && (mReader->GetFrame(Index, &Recorded) == eSUCCESS); Index++)
+    {
+        if (mSpeed > 0.0f)
+        {
+            DueTime = StartTime + std::chrono::duration_cast<TofClock::duration>(
+                std::chrono::duration<double, std::micro>((Recorded.TimestampUs - FirstTimestampUs) / mSpeed));
+
+            std::unique_lock<std::mutex> Lock(mLock);
+            mWake.wait_until(Lock, DueTime, [this] { return mStopRequested != FALSE; });
+            Stop = mStopRequested;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> Lock(mLock);
+            Stop = mStopRequested;
+        }
+
+        if (Stop)
+        {
+            break;
+        }
+
+        Frame.Result = eSUCCESS;
+        Frame.pData = Recorded.pData;
+        Frame.FrameWords = Recorded.FrameWords;
+        Frame.SequenceNumber = Recorded.SequenceNumber;
+        Frame.DeviceFrame = Recorded.SequenceNumber;
+        Frame.AcquireTime = TofClock::now();
+        Frame.EventTime = Frame.AcquireTime;
+        Frame.pPooled = NULL;
+
+        mCallback(mContext, &Frame);
+        mFramesPlayed++;
+    }
+
+    mRunning = FALSE;
+}
+
+// ****************************************************************************
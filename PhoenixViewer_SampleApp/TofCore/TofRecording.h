@@ -0,0 +1,284 @@
+// ****************************************************************************
+//  TofRecording.h
+//
+// Recording ToF sessions to disk and playing them back
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofAcquisition.h"
+#include "TofFrameRing.h"
+
+// ****************************************************************************
+// File layout, all little endian and 64 byte aligned:
+//
+//   TofRecordingHeader
+//   chunk 0: TofRecordingChunk, then FrameCount x (TofRecordingFrame, payload)
+//   chunk 1: ...
+//   TofRecordingIndexEntry per frame
+//   TofRecordingTrailer
+//
+// Every payload is FrameBytes as returned by PicoP_TLC_AcquireTofFrame, or
+// with TOF_RECORDING_FLAG_COMPRESSED that frame run through TofEncodeFrame()
+// (the first frame of each chunk a key frame, the rest coded against the
+// frame before them), padded to TOF_RECORDING_ALIGN. The index and trailer
+// are written when the recording is closed; a recording that was cut short
+// has neither, and the reader rebuilds the index from the chunks that made
+// it to disk.
+// ****************************************************************************
+
+#define TOF_RECORDING_MAGIC             "MVTOFREC"
+#define TOF_RECORDING_INDEX_MAGIC       "MVTOFIDX"
+#define TOF_RECORDING_CHUNK_MAGIC       0x4b4e4843      // "CHNK"
+#define TOF_RECORDING_VERSION           2       // 1 had no Flags or PayloadBytes
+#define TOF_RECORDING_ALIGN             64
+
+// Frames per chunk, and chunks the recorder can have queued for the disk
+#define TOF_RECORDING_CHUNK_FRAMES      8
+#define TOF_RECORDING_CHUNKS            4
+
+#define TOF_RECORDING_FLAG_COMPRESSED   0x00000001
+#define TOF_RECORDING_NO_FRAME          0xffffffff
+
+typedef struct
+{
+    char Magic[8];                          // TOF_RECORDING_MAGIC
+    UINT32 Version;
+    UINT32 FrameBytes;
+    UINT32 DataFormat;                      // PicoP_ToFDataFormatE
+    UINT32 ChunkFrames;                     // Most frames in one chunk
+    PicoP_TofPulsingConfig PulsingConfig;
+    UINT32 Flags;                           // TOF_RECORDING_FLAG_xxx
+    UINT32 Reserved[3];
+} TofRecordingHeader;
+
+typedef struct
+{
+    UINT32 Magic;                           // TOF_RECORDING_CHUNK_MAGIC
+    UINT32 FrameCount;
+    UINT32 FirstFrame;                      // Index of the chunk's first frame
+    UINT32 Reserved[13];
+} TofRecordingChunk;
+
+typedef struct
+{
+    UINT32 SequenceNumber;
+    UINT32 PayloadBytes;                    // Payload before padding, 0 for FrameBytes
+    uint64_t TimestampUs;                   // Acquire time since the first frame
+    uint64_t EventTimeUs;                   // Event time since the first frame
+    UINT32 Reserved[10];
+} TofRecordingFrame;
+
+typedef struct
+{
+    uint64_t Offset;                        // File offset of the frame's TofRecordingFrame
+    uint64_t TimestampUs;
+} TofRecordingIndexEntry;
+
+typedef struct
+{
+    char Magic[8];                          // TOF_RECORDING_INDEX_MAGIC
+    uint64_t IndexOffset;
+    UINT32 FrameCount;
+    UINT32 Reserved[11];
+} TofRecordingTrailer;
+
+typedef struct
+{
+    UINT32 FramesWritten;
+    UINT32 FramesDropped;                   // No chunk free, the disk fell behind
+    uint64_t BytesWritten;
+    uint64_t PayloadBytes;                  // Frame payloads as written, for the compression ratio
+} TofRecorderStats;
+
+// ****************************************************************************
+// Writes frames from the acquisition path. Write() only copies the frame into
+// the current chunk; full chunks go to a writer thread, so the caller never
+// waits on the disk. If every chunk is still queued the frame is dropped and
+// counted. Write() must always be called from the same thread.
+//
+// With Compress set the writer thread encodes each chunk before writing it,
+// so compression costs the acquisition thread nothing; a recorder that cannot
+// keep up drops frames the same way a slow disk does.
+// ****************************************************************************
+
+class TofRecorder
+{
+public:
+    TofRecorder();
+    ~TofRecorder();
+
+    PICOP_RC Open(const char* pFileName, const PicoP_TofPulsingConfig* pPulsingConfig,
+                  PicoP_ToFDataFormatE DataFormat, UINT32 FrameBytes, BOOL Compress = FALSE);
+    PICOP_RC Close();
+
+    PICOP_RC Write(const TofAcquiredFrame* pFrame);
+    PICOP_RC Write(const UINT32* pData, UINT32 SequenceNumber,
+                   TofClock::time_point EventTime, TofClock::time_point AcquireTime);
+
+    BOOL IsOpen() const { return mFile != NULL; }
+    void GetStats(TofRecorderStats* pStats);
+
+private:
+    TofRecorder(const TofRecorder&);
+    TofRecorder& operator=(const TofRecorder&);
+
+    void QueueChunk();
+    void WriterThread();
+    size_t PackChunk(const TofRecordingChunk* pChunk);
+
+    FILE* mFile;
+    UINT32 mFrameBytes;
+    UINT32 mRecordBytes;                    // Frame header plus padded payload
+    size_t mChunkBytes;
+    BOOL mCompress;
+    UINT32 mLineWords;                      // Codec line length, the pulses per line
+    std::vector<UINT8> mPacked;             // Compressed chunk, writer thread only
+
+    std::vector<UINT8*> mChunks;            // TOF_RECORDING_CHUNKS chunk buffers
+    std::vector<UINT32> mFreeChunks;
+    std::vector<UINT32> mFullChunks;        // Oldest first
+    INT32 mCurrent;                         // Chunk being filled, -1 for none
+    UINT32 mFrameCount;
+    BOOL mStarted;
+    TofClock::time_point mStartTime;
+
+    std::vector<TofRecordingIndexEntry> mIndex;
+    uint64_t mOffset;                       // Where the next chunk lands in the file
+    PICOP_RC mWriteResult;                  // First write failure
+
+    std::thread mThread;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    BOOL mStopRequested;
+    TofRecorderStats mStats;
+};
+
+// ****************************************************************************
+// A frame inside a mapped recording. pData points into the mapping and stays
+// valid until the reader is closed; for a compressed recording it points at
+// the reader's decode buffer and stays valid until the next GetFrame().
+// ****************************************************************************
+
+typedef struct
+{
+    const UINT32* pData;
+    UINT32 FrameWords;
+    UINT32 SequenceNumber;
+    uint64_t TimestampUs;
+    uint64_t EventTimeUs;
+} TofRecordedFrame;
+
+// ****************************************************************************
+// Maps a recording read-only, so reading a frame is a pointer lookup. Frames
+// of a compressed recording are decoded on demand: reading them in order
+// decodes each once, seeking decodes forward from the nearest key frame.
+// GetFrame() on a compressed recording must not be called from two threads
+// at once.
+// ****************************************************************************
+
+class TofRecordingReader
+{
+public:
+    TofRecordingReader();
+    ~TofRecordingReader();
+
+    PICOP_RC Open(const char* pFileName);
+    void Close();
+
+    UINT32 GetFrameCount() const { return (UINT32)mIndex.size(); }
+    UINT32 GetFrameBytes() const { return mHeader.FrameBytes; }
+    PicoP_ToFDataFormatE GetDataFormat() const { return (PicoP_ToFDataFormatE)mHeader.DataFormat; }
+    const PicoP_TofPulsingConfig* GetPulsingConfig() const { return &mHeader.PulsingConfig; }
+    BOOL WasComplete() const { return mComplete; }
+    BOOL IsCompressed() const { return (mHeader.Flags & TOF_RECORDING_FLAG_COMPRESSED) != 0; }
+
+    PICOP_RC GetFrame(UINT32 Index, TofRecordedFrame* pFrame) const;
+
+    // Index of the last frame recorded at or before TimestampUs
+    UINT32 FindFrame(uint64_t TimestampUs) const;
+
+private:
+    TofRecordingReader(const TofRecordingReader&);
+    TofRecordingReader& operator=(const TofRecordingReader&);
+
+    PICOP_RC Map(const char* pFileName);
+    void Unmap();
+    BOOL LoadIndex();
+    void RebuildIndex();
+    uint64_t RecordBytes(uint64_t Offset) const;
+    PICOP_RC Decode(UINT32 Index) const;
+
+    const UINT8* mpBase;
+    uint64_t mSize;
+#ifdef _WIN32
+    void* mFileHandle;
+    void* mMappingHandle;
+#else
+    int mFileDescriptor;
+#endif
+
+    TofRecordingHeader mHeader;
+    BOOL mComplete;                         // Index and trailer were found
+    std::vector<TofRecordingIndexEntry> mIndex;
+
+    mutable std::vector<UINT32> mDecoded;   // Frame mDecodedIndex of a compressed recording
+    mutable std::vector<UINT32> mDecodeScratch;
+    mutable UINT32 mDecodedIndex;           // TOF_RECORDING_NO_FRAME when mDecoded is empty
+};
+
+// ****************************************************************************
+// Plays a recording back through the same callback the live acquisition uses.
+// Speed 1 keeps the recorded timing, 2 plays twice as fast and so on; 0
+// delivers frames as fast as the consumer takes them.
+// ****************************************************************************
+
+class TofPlayer
+{
+public:
+    TofPlayer();
+    ~TofPlayer();
+
+    PICOP_RC Start(const TofRecordingReader* pReader, FP32 Speed, UINT32 FirstFrame,
+                   TofFrameCallback pfnCallback, void* pContext);
+    void Stop();
+
+    BOOL IsRunning() const { return mRunning; }
+    UINT32 GetFramesPlayed() const { return mFramesPlayed; }
+
+private:
+    TofPlayer(const TofPlayer&);
+    TofPlayer& operator=(const TofPlayer&);
+
+    void PlayerThread();
+
+    const TofRecordingReader* mReader;
+    FP32 mSpeed;
+    UINT32 mFirstFrame;
+    TofFrameCallback mCallback;
+    void* mContext;
+
+    std::thread mThread;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    BOOL mStopRequested;
+    std::atomic<BOOL> mRunning;
+    std::atomic<UINT32> mFramesPlayed;
+};
+
+// ****************************************************************************
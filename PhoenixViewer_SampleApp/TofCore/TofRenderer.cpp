@@ -0,0 +1,134 @@
+// ****************************************************************************
+//  TofRenderer.cpp
+//
+// Persistent 24 bit back buffers that frames are drawn into
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "TofRenderer.h"
+#include "TofMemory.h"
+
+// ****************************************************************************
+
+TofRenderer::TofRenderer()
+{
+    memset(&mSurface, 0, sizeof(mSurface));
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+// ****************************************************************************
+
+TofMemoryRenderer::~TofMemoryRenderer()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+
+PICOP_RC TofMemoryRenderer::Create(UINT32 Width, UINT32 Height)
+{
+    UINT32 Stride = TOF_SURFACE_STRIDE(Width);
+
+
+    if ((Width == 0) || (Height == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    mSurface.pPixels = (UINT8*)TofAlignedAlloc((size_t)Stride * Height, TOF_CACHE_LINE_SIZE);
+
+    if (mSurface.pPixels == NULL)
+    {
+        return eFAILURE;
+    }
+
+    memset(mSurface.pPixels, 0, (size_t)Stride * Height);
+    mSurface.Width = Width;
+    mSurface.Height = Height;
+    mSurface.Stride = Stride;
+    mStats.Allocations++;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofMemoryRenderer::Destroy()
+{
+    if (mSurface.pPixels != NULL)
+    {
+        TofAlignedFree(mSurface.pPixels);
+    }
+
+    memset(&mSurface, 0, sizeof(mSurface));
+}
+
+// ****************************************************************************
+
+void TofMemoryRenderer::Present()
+{
+    mStats.FramesPresented++;
+}
+
+// ****************************************************************************
+//  Writes the surface as a binary (P6) PPM, top row first and red first
+// ****************************************************************************
+
+PICOP_RC TofMemoryRenderer::WritePpm(const char* pFileName) const
+{
+    FILE* pFile;
+    std::vector<UINT8> Row(mSurface.Width * 3);
+    const UINT8* pSource;
+    PICOP_RC PicopRc = eSUCCESS;
+
+
+    if (mSurface.pPixels == NULL)
+    {
+        return eUNINITIALIZED;
+    }
+
+    pFile = fopen(pFileName, "wb");
+
+    if (pFile == NULL)
+    {
+        return eFAILURE;
+    }
+
+    fprintf(pFile, "P6\n%u %u\n255\n", mSurface.Width, mSurface.Height);
+
+    for (UINT32 y = mSurface.Height; y-- > 0; )
+    {
+        pSource = mSurface.pPixels + (size_t)y * mSurface.Stride;
+
+        for (UINT32 x = 0; x < mSurface.Width; x++)
+        {
+            Row[x * 3 + 0] = pSource[x * 3 + 2];
+            Row[x * 3 + 1] = pSource[x * 3 + 1];
+            Row[x * 3 + 2] = pSource[x * 3 + 0];
+        }
+
+        if (fwrite(&Row[0], 1, Row.size(), pFile) != Row.size())
+        {
+            PicopRc = eDEVICE_ERROR;
+            break;
+        }
+    }
+
+    fclose(pFile);
+
+    return PicopRc;
+}
+
+// ****************************************************************************
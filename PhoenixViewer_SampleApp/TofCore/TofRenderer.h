@@ -0,0 +1,80 @@
+// ****************************************************************************
+//  TofRenderer.h
+//
+// Persistent 24 bit back buffers that frames are drawn into
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+// A bottom-up 24 bit (blue, green, red) surface, the layout of a Windows DIB:
+// row 0 is the bottom of the image and rows are Stride bytes apart.
+// ****************************************************************************
+
+typedef struct
+{
+    UINT8* pPixels;
+    UINT32 Width;
+    UINT32 Height;
+    UINT32 Stride;
+} TofSurface;
+
+typedef struct
+{
+    UINT32 Allocations;                 // Back buffer / device objects allocated so far
+    UINT32 FramesPresented;
+} TofRendererStats;
+
+// DIB rows are padded to a multiple of four bytes
+#define TOF_SURFACE_STRIDE(Width)   ((((Width) * 3) + 3) & ~3U)
+
+// ****************************************************************************
+// The back buffer is allocated once in Create() and reused for every frame,
+// so the colorizer writes straight into it. How a frame is shown is up to
+// the backend.
+// ****************************************************************************
+
+class TofRenderer
+{
+public:
+    TofRenderer();
+    virtual ~TofRenderer() {}
+
+    virtual PICOP_RC Create(UINT32 Width, UINT32 Height) = 0;
+    virtual void Destroy() = 0;
+
+    const TofSurface* GetSurface() const { return &mSurface; }
+    void GetStats(TofRendererStats* pStats) const { *pStats = mStats; }
+
+protected:
+    TofSurface mSurface;
+    TofRendererStats mStats;
+};
+
+// ****************************************************************************
+// Headless backend: a plain memory surface that can be dumped as a PPM file
+// ****************************************************************************
+
+class TofMemoryRenderer : public TofRenderer
+{
+public:
+    virtual ~TofMemoryRenderer();
+
+    virtual PICOP_RC Create(UINT32 Width, UINT32 Height);
+    virtual void Destroy();
+
+    void Present();
+    PICOP_RC WritePpm(const char* pFileName) const;
+};
+
+// ****************************************************************************
@@ -0,0 +1,37 @@
+// ****************************************************************************
+//  TofSimd.h
+//
+// Selects the vector instruction set used by the frame processing kernels
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+// ****************************************************************************
+// SSE2 is always present on x64. AVX2 is used when the compiler targets it
+// (/arch:AVX2 or -mavx2). Define TOF_SIMD_DISABLE to build the scalar code
+// paths only.
+// ****************************************************************************
+
+#ifndef TOF_SIMD_DISABLE
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TOF_SIMD_SSE2   1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define TOF_SIMD_AVX2   1
+#include <immintrin.h>
+#endif
+
+#endif // TOF_SIMD_DISABLE
+
+// ****************************************************************************
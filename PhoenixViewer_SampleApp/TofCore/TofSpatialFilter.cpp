@@ -0,0 +1,625 @@
+// ****************************************************************************
+//  TofSpatialFilter.cpp
+//
+// Edge preserving median and bilateral filters for the time plane
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include <string.h>
+#include "TofSpatialFilter.h"
+#include "TofMemory.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+#define TOF_SPATIAL_BIAS            0x80000000u     // Maps UINT32 order onto INT32 order
+
+// ****************************************************************************
+// Median selection networks (Paeth, Devillard). Each pair leaves the smaller
+// value in the first element; after the last pair the median is in the
+// middle element.
+// ****************************************************************************
+
+static const UINT8 sMedian9[][2] =
+{
+    {1, 2}, {4, 5}, {7, 8}, {0, 1}, {3, 4}, {6, 7}, {1, 2}, {4, 5}, {7, 8}, {0, 3},
+    {5, 8}, {4, 7}, {3, 6}, {1, 4}, {2, 5}, {4, 7}, {4, 2}, {6, 4}, {4, 2}
+};
+
+static const UINT8 sMedian25[][2] =
+{
+    {0, 1}, {3, 4}, {2, 4}, {2, 3}, {6, 7}, {5, 7}, {5, 6}, {9, 10}, {8, 10}, {8, 9},
+    {12, 13}, {11, 13}, {11, 12}, {15, 16}, {14, 16}, {14, 15}, {18, 19}, {17, 19}, {17, 18}, {21, 22},
+    {20, 22}, {20, 21}, {23, 24}, {2, 5}, {3, 6}, {0, 6}, {0, 3}, {4, 7}, {1, 7}, {1, 4},
+    {11, 14}, {8, 14}, {8, 11}, {12, 15}, {9, 15}, {9, 12}, {13, 16}, {10, 16}, {10, 13}, {20, 23},
+    {17, 23}, {17, 20}, {21, 24}, {18, 24}, {18, 21}, {19, 22}, {8, 17}, {9, 18}, {0, 18}, {0, 9},
+    {10, 19}, {1, 19}, {1, 10}, {11, 20}, {2, 20}, {2, 11}, {12, 21}, {3, 21}, {3, 12}, {13, 22},
+    {4, 22}, {4, 13}, {14, 23}, {5, 23}, {5, 14}, {15, 24}, {6, 24}, {6, 15}, {7, 16}, {7, 19},
+    {13, 21}, {15, 23}, {7, 13}, {7, 15}, {1, 9}, {3, 11}, {5, 17}, {11, 17}, {9, 17}, {4, 10},
+    {6, 12}, {7, 14}, {4, 6}, {4, 7}, {12, 14}, {10, 14}, {6, 7}, {10, 12}, {6, 10}, {6, 17},
+    {12, 17}, {7, 17}, {7, 10}, {12, 18}, {7, 12}, {10, 18}, {12, 20}, {10, 20}, {10, 12}
+};
+
+// ****************************************************************************
+
+#if defined(TOF_SIMD_AVX2)
+
+// AVX2 compares UINT32 directly, no bias needed
+static inline void CompareExchange(__m256i* pA, __m256i* pB)
+{
+    __m256i Low = _mm256_min_epu32(*pA, *pB);
+
+    *pB = _mm256_max_epu32(*pA, *pB);
+    *pA = Low;
+}
+
+#endif
+
+#if defined(TOF_SIMD_SSE2)
+
+// UINT32 to float without going through a signed conversion of the full word
+static inline __m128 LoadAsFloat(const UINT32* pSource)
+{
+    __m128i Value = _mm_loadu_si128((const __m128i*)pSource);
+    __m128 High = _mm_cvtepi32_ps(_mm_srli_epi32(Value, 16));
+    __m128 Low = _mm_cvtepi32_ps(_mm_and_si128(Value, _mm_set1_epi32(0xffff)));
+
+    return _mm_add_ps(_mm_mul_ps(High, _mm_set1_ps(65536.0f)), Low);
+}
+
+// Leaves the smaller of two biased values in A and the larger in B
+static inline void CompareExchange(__m128i* pA, __m128i* pB)
+{
+    __m128i Swap = _mm_and_si128(_mm_xor_si128(*pA, *pB), _mm_cmpgt_epi32(*pA, *pB));
+
+    *pA = _mm_xor_si128(*pA, Swap);
+    *pB = _mm_xor_si128(*pB, Swap);
+}
+
+#endif
+
+static inline void CompareExchange(INT32* pA, INT32* pB)
+{
+    INT32 Low = (*pA < *pB) ? *pA : *pB;
+
+    *pB = (*pA < *pB) ? *pB : *pA;
+    *pA = Low;
+}
+
+template <typename T, size_t Pairs>
+static inline void TofSelect(T* pValues, const UINT8 (&Network)[Pairs][2])
+{
+    for (size_t i = 0; i < Pairs; i++)
+    {
+        CompareExchange(&pValues[Network[i][0]], &pValues[Network[i][1]]);
+    }
+}
+
+static inline UINT32 TofClampIndex(INT32 Index, UINT32 Count)
+{
+    return (Index < 0) ? 0 : (((UINT32)Index >= Count) ? (Count - 1) : (UINT32)Index);
+}
+
+template <UINT32 Radius>
+struct TofMedianNetwork;
+
+template <>
+struct TofMedianNetwork<1>
+{
+    template <typename T>
+    static void Select(T* pValues) { TofSelect(pValues, sMedian9); }
+};
+
+template <>
+struct TofMedianNetwork<2>
+{
+    template <typename T>
+    static void Select(T* pValues) { TofSelect(pValues, sMedian25); }
+};
+
+// Median of the window around x, repeating the edge pixels
+template <UINT32 Radius>
+static inline UINT32 TofMedianPixel(const UINT32* const* pRows, UINT32 Width, UINT32 x)
+{
+    const UINT32 Size = (2 * Radius) + 1;
+    INT32 Values[Size * Size];
+    UINT32 Tap = 0;
+
+
+    for (UINT32 dy = 0; dy < Size; dy++)
+    {
+        for (UINT32 dx = 0; dx < Size; dx++)
+        {
+            Values[Tap++] = (INT32)(pRows[dy][TofClampIndex((INT32)(x + dx) - (INT32)Radius, Width)] ^ TOF_SPATIAL_BIAS);
+        }
+    }
+
+    TofMedianNetwork<Radius>::Select(Values);
+
+    return (UINT32)Values[(Size * Size) / 2] ^ TOF_SPATIAL_BIAS;
+}
+
+// ****************************************************************************
+
+void TofDefaultSpatialParams(TofSpatialParams* pParams)
+{
+    pParams->Filter = eTOF_SPATIAL_MEDIAN_3X3;
+    pParams->Radius = 2;
+    pParams->SpatialSigma = 1.5f;
+    pParams->RangeSigma = 30.0f;
+    pParams->MinAmplitude = 16;
+    pParams->FullAmplitude = 1024;
+}
+
+// ****************************************************************************
+
+TofSpatialFilter::TofSpatialFilter()
+    : mWidth(0),
+      mHeight(0),
+      mRadius(0),
+      mpInput(NULL),
+      mBands(0),
+      mpTime(NULL),
+      mpAmplitude(NULL),
+      mGeneration(0),
+      mBandsPending(0),
+      mStopRequested(FALSE)
+{
+    TofDefaultSpatialParams(&mParams);
+    memset(mSpatialWeights, 0, sizeof(mSpatialWeights));
+}
+
+TofSpatialFilter::~TofSpatialFilter()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Allocates the input copy, works out the bilateral spatial weights and
+//  starts Threads - 1 workers
+// ****************************************************************************
+
+PICOP_RC TofSpatialFilter::Create(UINT32 Width, UINT32 Height, const TofSpatialParams* pParams, UINT32 Threads)
+{
+    INT32 Radius;
+    UINT32 Tap = 0;
+
+
+    if ((pParams == NULL) || (Width == 0) || (Height == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((pParams->Filter == eTOF_SPATIAL_BILATERAL) &&
+        ((pParams->Radius == 0) || (pParams->Radius > TOF_SPATIAL_MAX_RADIUS) ||
+         ( ! (pParams->SpatialSigma > 0.0f)) || ( ! (pParams->RangeSigma > 0.0f))))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    mpInput = (UINT32*)TofAlignedAlloc((size_t)Width * Height * sizeof(UINT32), TOF_CACHE_LINE_SIZE);
+
+    if (mpInput == NULL)
+    {
+        return eFAILURE;
+    }
+
+    mParams = *pParams;
+    mWidth = Width;
+    mHeight = Height;
+
+    switch (mParams.Filter)
+    {
+    case eTOF_SPATIAL_MEDIAN_3X3:
+        mRadius = 1;
+        break;
+
+    case eTOF_SPATIAL_MEDIAN_5X5:
+        mRadius = 2;
+        break;
+
+    default:
+        mRadius = mParams.Radius;
+        break;
+    }
+
+    Radius = (INT32)mRadius;
+
+    for (INT32 dy = -Radius; dy <= Radius; dy++)
+    {
+        for (INT32 dx = -Radius; dx <= Radius; dx++)
+        {
+            mSpatialWeights[Tap++] = expf(-(FP32)((dx * dx) + (dy * dy)) /
+                                          (2.0f * mParams.SpatialSigma * mParams.SpatialSigma));
+        }
+    }
+
+    if (Threads == 0)
+    {
+        Threads = std::thread::hardware_concurrency();
+    }
+
+    mBands = (Threads == 0) ? 1 : Threads;
+    mBands = (mBands > Height) ? Height : mBands;
+    mStopRequested = FALSE;
+
+    for (UINT32 Band = 1; Band < mBands; Band++)
+    {
+        mWorkers.push_back(std::thread(&TofSpatialFilter::WorkerThread, this, Band, mGeneration));
+    }
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofSpatialFilter::Destroy()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStopRequested = TRUE;
+    }
+
+    mWake.notify_all();
+
+    for (size_t i = 0; i < mWorkers.size(); i++)
+    {
+        mWorkers[i].join();
+    }
+
+    mWorkers.clear();
+    TofAlignedFree(mpInput);
+    mpInput = NULL;
+    mWidth = 0;
+    mHeight = 0;
+    mBands = 0;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofSpatialFilter::Filter(UINT32* pTime, const UINT32* pAmplitude)
+{
+    if (mBands == 0)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if ((pTime == NULL) || (pAmplitude == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    memcpy(mpInput, pTime, (size_t)mWidth * mHeight * sizeof(UINT32));
+
+    mpTime = pTime;
+    mpAmplitude = pAmplitude;
+    Run();
+
+    return eSUCCESS;
+}
+
+PICOP_RC TofSpatialFilter::Filter(TofFrame* pFrame)
+{
+    if ((pFrame->GetNumPulses() != mWidth) || (pFrame->GetNumLines() != mHeight))
+    {
+        return eFRAME_ERROR;
+    }
+
+    return Filter(pFrame->GetTime(), pFrame->GetAmplitude());
+}
+
+// ****************************************************************************
+//  Releases the workers on the current frame, filters band 0 here and waits
+//  for the rest
+// ****************************************************************************
+
+void TofSpatialFilter::Run()
+{
+    if (mBands > 1)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(mLock);
+            mBandsPending = mBands - 1;
+            mGeneration++;
+        }
+
+        mWake.notify_all();
+    }
+
+    FilterBand(0);
+
+    if (mBands > 1)
+    {
+        std::unique_lock<std::mutex> Lock(mLock);
+
+        while (mBandsPending != 0)
+        {
+            mDone.wait(Lock);
+        }
+    }
+
+    mpTime = NULL;
+    mpAmplitude = NULL;
+}
+
+// ****************************************************************************
+
+void TofSpatialFilter::FilterBand(UINT32 Band)
+{
+    UINT32 FirstLine = (Band * mHeight) / mBands;
+    UINT32 EndLine = ((Band + 1) * mHeight) / mBands;
+    const UINT32* TimeRows[2 * TOF_SPATIAL_MAX_RADIUS + 1];
+    const UINT32* AmplitudeRows[2 * TOF_SPATIAL_MAX_RADIUS + 1];
+    UINT32 Row;
+
+
+    for (UINT32 Line = FirstLine; Line < EndLine; Line++)
+    {
+        for (UINT32 k = 0; k < ((2 * mRadius) + 1); k++)
+        {
+            Row = TofClampIndex((INT32)(Line + k) - (INT32)mRadius, mHeight);
+            TimeRows[k] = mpInput + (size_t)Row * mWidth;
+            AmplitudeRows[k] = mpAmplitude + (size_t)Row * mWidth;
+        }
+
+        switch (mParams.Filter)
+        {
+        case eTOF_SPATIAL_MEDIAN_3X3:
+            MedianLine<1>(TimeRows, mpTime + (size_t)Line * mWidth);
+            break;
+
+        case eTOF_SPATIAL_MEDIAN_5X5:
+            MedianLine<2>(TimeRows, mpTime + (size_t)Line * mWidth);
+            break;
+
+        default:
+            BilateralLine(TimeRows, AmplitudeRows, mpTime + (size_t)Line * mWidth);
+            break;
+        }
+    }
+}
+
+// ****************************************************************************
+//  Filters band Band of every frame Run() releases. Generation is the frame
+//  count when the worker was started, so a frame released before the worker
+//  first takes the lock is not missed.
+// ****************************************************************************
+
+void TofSpatialFilter::WorkerThread(UINT32 Band, UINT32 Generation)
+{
+    std::unique_lock<std::mutex> Lock(mLock);
+
+
+    for (;;)
+    {
+        while ((mGeneration == Generation) && ( ! mStopRequested))
+        {
+            mWake.wait(Lock);
+        }
+
+        if (mStopRequested)
+        {
+            break;
+        }
+
+        Generation = mGeneration;
+        Lock.unlock();
+
+        FilterBand(Band);
+
+        Lock.lock();
+
+        if (--mBandsPending == 0)
+        {
+            mDone.notify_one();
+        }
+    }
+}
+
+// ****************************************************************************
+//  One output line of the (2 * Radius + 1)^2 median. Eight (AVX2) or four
+//  pixels at a time where the whole window is inside the line, one at a
+//  time near the ends.
+// ****************************************************************************
+
+template <UINT32 Radius>
+void TofSpatialFilter::MedianLine(const UINT32* const* pRows, UINT32* pOutput) const
+{
+    UINT32 x = 0;
+
+
+    for (; (x < Radius) && (x < mWidth); x++)
+    {
+        pOutput[x] = TofMedianPixel<Radius>(pRows, mWidth, x);
+    }
+
+#if defined(TOF_SIMD_SSE2) || defined(TOF_SIMD_AVX2)
+    const UINT32 Size = (2 * Radius) + 1;
+#endif
+
+#if defined(TOF_SIMD_AVX2)
+    __m256i Values256[Size * Size];
+
+    for (; (x + 8 + Radius) <= mWidth; x += 8)
+    {
+        for (UINT32 dy = 0; dy < Size; dy++)
+        {
+            for (UINT32 dx = 0; dx < Size; dx++)
+            {
+                Values256[(dy * Size) + dx] = _mm256_loadu_si256((const __m256i*)(pRows[dy] + x + dx - Radius));
+            }
+        }
+
+        TofMedianNetwork<Radius>::Select(Values256);
+        _mm256_storeu_si256((__m256i*)(pOutput + x), Values256[(Size * Size) / 2]);
+    }
+#endif
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i vBias = _mm_set1_epi32((int)TOF_SPATIAL_BIAS);
+    __m128i Values[Size * Size];
+    UINT32 Tap;
+
+    for (; (x + 4 + Radius) <= mWidth; x += 4)
+    {
+        Tap = 0;
+
+        for (UINT32 dy = 0; dy < Size; dy++)
+        {
+            for (UINT32 dx = 0; dx < Size; dx++)
+            {
+                Values[Tap++] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(pRows[dy] + x + dx - Radius)), vBias);
+            }
+        }
+
+        TofMedianNetwork<Radius>::Select(Values);
+        _mm_storeu_si128((__m128i*)(pOutput + x), _mm_xor_si128(Values[(Size * Size) / 2], vBias));
+    }
+#endif
+
+    for (; x < mWidth; x++)
+    {
+        pOutput[x] = TofMedianPixel<Radius>(pRows, mWidth, x);
+    }
+}
+
+// ****************************************************************************
+//  One output line of the bilateral filter. For each tap:
+//      Weight = Spatial * Confidence(Amplitude) / (1 + (Difference / RangeSigma)^2)
+//  and the output is the weighted mean of the taps. The vector and scalar
+//  paths do the same float operations in the same order, so they agree
+//  exactly.
+// ****************************************************************************
+
+void TofSpatialFilter::BilateralLine(const UINT32* const* pTimeRows, const UINT32* const* pAmplitudeRows,
+                                     UINT32* pOutput) const
+{
+    const INT32 Radius = (INT32)mRadius;
+    const UINT32 Size = (2 * mRadius) + 1;
+    const UINT32* pCenter = pTimeRows[mRadius];
+    const FP32 InvFull = 1.0f / (FP32)((mParams.FullAmplitude != 0) ? mParams.FullAmplitude : 1);
+    const FP32 InvRange2 = 1.0f / (mParams.RangeSigma * mParams.RangeSigma);
+    const FP32 MinAmplitude = (FP32)mParams.MinAmplitude;
+    FP32 Center;
+    FP32 Time;
+    FP32 Amplitude;
+    FP32 Confidence;
+    FP32 Difference;
+    FP32 Weight;
+    FP32 Sum;
+    FP32 WeightSum;
+    UINT32 Column;
+    UINT32 Tap;
+    UINT32 x = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vInvFull = _mm_set1_ps(InvFull);
+    const __m128 vInvRange2 = _mm_set1_ps(InvRange2);
+    const __m128 vMinAmplitude = _mm_set1_ps(MinAmplitude);
+#endif
+
+    while (x < mWidth)
+    {
+#if defined(TOF_SIMD_SSE2)
+        if ((x >= mRadius) && ((x + 4 + mRadius) <= mWidth))
+        {
+            __m128 C = LoadAsFloat(pCenter + x);
+            __m128 vSum = vZero;
+            __m128 vWeightSum = vZero;
+            __m128i Keep;
+
+            Tap = 0;
+
+            for (UINT32 dy = 0; dy < Size; dy++)
+            {
+                for (UINT32 dx = 0; dx < Size; dx++)
+                {
+                    __m128 T = LoadAsFloat(pTimeRows[dy] + x + dx - mRadius);
+                    __m128 A = LoadAsFloat(pAmplitudeRows[dy] + x + dx - mRadius);
+                    __m128 Conf = _mm_and_ps(_mm_cmpge_ps(A, vMinAmplitude), _mm_min_ps(_mm_mul_ps(A, vInvFull), vOne));
+                    __m128 D = _mm_sub_ps(T, C);
+                    __m128 W = _mm_mul_ps(_mm_set1_ps(mSpatialWeights[Tap++]), Conf);
+
+                    W = _mm_div_ps(W, _mm_add_ps(vOne, _mm_mul_ps(_mm_mul_ps(D, D), vInvRange2)));
+                    vSum = _mm_add_ps(vSum, _mm_mul_ps(W, T));
+                    vWeightSum = _mm_add_ps(vWeightSum, W);
+                }
+            }
+
+            // No usable neighbour: keep the pixel
+            Keep = _mm_castps_si128(_mm_cmple_ps(vWeightSum, vZero));
+            vSum = _mm_div_ps(vSum, _mm_max_ps(vWeightSum, _mm_set1_ps(1.0e-30f)));
+            _mm_storeu_si128((__m128i*)(pOutput + x),
+                             _mm_or_si128(_mm_and_si128(Keep, _mm_loadu_si128((const __m128i*)(pCenter + x))),
+                                          _mm_andnot_si128(Keep, _mm_cvtps_epi32(vSum))));
+            x += 4;
+            continue;
+        }
+#endif
+
+        Center = (FP32)pCenter[x];
+        Sum = 0.0f;
+        WeightSum = 0.0f;
+        Tap = 0;
+
+        for (UINT32 dy = 0; dy < Size; dy++)
+        {
+            for (UINT32 dx = 0; dx < Size; dx++)
+            {
+                Column = TofClampIndex((INT32)(x + dx) - Radius, mWidth);
+                Time = (FP32)pTimeRows[dy][Column];
+                Amplitude = (FP32)pAmplitudeRows[dy][Column];
+                Confidence = (Amplitude >= MinAmplitude) ? (((Amplitude * InvFull) < 1.0f) ? (Amplitude * InvFull) : 1.0f) : 0.0f;
+                Difference = Time - Center;
+                Weight = mSpatialWeights[Tap++] * Confidence;
+                Weight = Weight / (1.0f + ((Difference * Difference) * InvRange2));
+                Sum += Weight * Time;
+                WeightSum += Weight;
+            }
+        }
+
+        pOutput[x] = (WeightSum > 0.0f) ? (UINT32)lrintf(Sum / WeightSum) : pCenter[x];
+        x++;
+    }
+}
+
+// ****************************************************************************
+
+TofSpatialFilterStage::TofSpatialFilterStage(const TofSpatialParams* pParams, UINT32 Threads)
+    : mThreads(Threads)
+{
+    TofDefaultSpatialParams(&mParams);
+
+    if (pParams != NULL)
+    {
+        mParams = *pParams;
+    }
+}
+
+PICOP_RC TofSpatialFilterStage::Start(const TofFrameGeometry* pGeometry)
+{
+    return mFilter.Create(pGeometry->NumPulses, pGeometry->NumLines, &mParams, mThreads);
+}
+
+PICOP_RC TofSpatialFilterStage::Process(TofPipelineFrame* pFrame)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mFilter.Filter(pFrame->pPlanes);
+}
+
+// ****************************************************************************
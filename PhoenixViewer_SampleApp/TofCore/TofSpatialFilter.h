@@ -0,0 +1,136 @@
+// ****************************************************************************
+//  TofSpatialFilter.h
+//
+// Edge preserving median and bilateral filters for the time plane
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFrame.h"
+#include "TofPipeline.h"
+
+// ****************************************************************************
+
+#define TOF_SPATIAL_MAX_RADIUS      2
+
+typedef enum
+{
+    eTOF_SPATIAL_MEDIAN_3X3 = 0,
+    eTOF_SPATIAL_MEDIAN_5X5,
+    eTOF_SPATIAL_BILATERAL              // Weighted by distance, time difference and amplitude
+} TofSpatialFilterE;
+
+typedef struct
+{
+    TofSpatialFilterE Filter;
+    UINT32 Radius;                      // Bilateral window is 2 * Radius + 1 square, 1 .. TOF_SPATIAL_MAX_RADIUS
+    FP32 SpatialSigma;                  // Bilateral, in pixels
+    FP32 RangeSigma;                    // Bilateral, in time counts
+    UINT32 MinAmplitude;                // Bilateral neighbours below this are ignored
+    UINT32 FullAmplitude;               // Bilateral neighbours at or above this get full weight
+} TofSpatialParams;
+
+void TofDefaultSpatialParams(TofSpatialParams* pParams);
+
+// ****************************************************************************
+// Filters the time plane of a Width x Height frame in place; pixels past the
+// edges repeat the edge pixels.
+//
+// The medians drop the isolated flying pixels at object edges without
+// moving the edges. The bilateral filter smooths each pixel with the
+// neighbours at about the same range, so edges stay sharp: a neighbour's
+// weight falls off with its distance (SpatialSigma), with its time
+// difference from the pixel (RangeSigma, a Cauchy falloff so it needs no
+// exp), and with its amplitude below FullAmplitude. A pixel with no usable
+// neighbours is left as it is.
+//
+// The plane is copied once, then the lines are split into one band per
+// thread as in TofProjector. Each output line only reads its 2 * Radius + 1
+// input lines, so a band works through the plane a few lines at a time out
+// of L1. Only one thread may call Filter() at a time.
+// ****************************************************************************
+
+class TofSpatialFilter
+{
+public:
+    TofSpatialFilter();
+    ~TofSpatialFilter();
+
+    // Threads 0 uses one thread per processor
+    PICOP_RC Create(UINT32 Width, UINT32 Height, const TofSpatialParams* pParams, UINT32 Threads);
+    void Destroy();
+
+    PICOP_RC Filter(UINT32* pTime, const UINT32* pAmplitude);
+    PICOP_RC Filter(TofFrame* pFrame);
+
+    UINT32 GetThreadCount() const { return mBands; }
+
+private:
+    TofSpatialFilter(const TofSpatialFilter&);
+    TofSpatialFilter& operator=(const TofSpatialFilter&);
+
+    void Run();
+    void FilterBand(UINT32 Band);
+    void WorkerThread(UINT32 Band, UINT32 Generation);
+
+    template <UINT32 Radius>
+    void MedianLine(const UINT32* const* pRows, UINT32* pOutput) const;
+    void BilateralLine(const UINT32* const* pTimeRows, const UINT32* const* pAmplitudeRows, UINT32* pOutput) const;
+
+    TofSpatialParams mParams;
+    UINT32 mWidth;
+    UINT32 mHeight;
+    UINT32 mRadius;
+    FP32 mSpatialWeights[(2 * TOF_SPATIAL_MAX_RADIUS + 1) * (2 * TOF_SPATIAL_MAX_RADIUS + 1)];
+    UINT32* mpInput;                    // Copy of the time plane being filtered
+    UINT32 mBands;
+
+    // The frame being filtered
+    UINT32* mpTime;
+    const UINT32* mpAmplitude;
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    UINT32 mGeneration;                 // Bumped for every frame
+    UINT32 mBandsPending;
+    BOOL mStopRequested;
+};
+
+// ****************************************************************************
+// Pipeline stage running a TofSpatialFilter on pPlanes, NumPulses x NumLines;
+// place it after a TofDecodeStage. Threads split each frame, as for
+// TofProjectStage.
+// ****************************************************************************
+
+class TofSpatialFilterStage : public TofPipelineStage
+{
+public:
+    TofSpatialFilterStage(const TofSpatialParams* pParams, UINT32 Threads);
+
+    virtual const char* GetName() const { return "spatial"; }
+    virtual PICOP_RC Start(const TofFrameGeometry* pGeometry);
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+private:
+    TofSpatialParams mParams;
+    UINT32 mThreads;
+    TofSpatialFilter mFilter;
+    std::mutex mLock;                   // The filter takes one frame at a time
+};
+
+// ****************************************************************************
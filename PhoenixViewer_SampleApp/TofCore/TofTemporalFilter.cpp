@@ -0,0 +1,431 @@
+// ****************************************************************************
+//  TofTemporalFilter.cpp
+//
+// Temporal denoising of the time plane over consecutive frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <float.h>
+#include <math.h>
+#include "TofTemporalFilter.h"
+#include "TofMemory.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+#define TOF_TEMPORAL_BIAS           0x80000000u     // Maps UINT32 order onto INT32 order
+
+// ****************************************************************************
+
+#if defined(TOF_SIMD_SSE2)
+
+// UINT32 to float without going through a signed conversion of the full word
+static inline __m128 LoadAsFloat(const UINT32* pSource)
+{
+    __m128i Value = _mm_loadu_si128((const __m128i*)pSource);
+    __m128 High = _mm_cvtepi32_ps(_mm_srli_epi32(Value, 16));
+    __m128 Low = _mm_cvtepi32_ps(_mm_and_si128(Value, _mm_set1_epi32(0xffff)));
+
+    return _mm_add_ps(_mm_mul_ps(High, _mm_set1_ps(65536.0f)), Low);
+}
+
+static inline __m128 Select(__m128 Mask, __m128 A, __m128 B)
+{
+    return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B));
+}
+
+static inline __m128i Select(__m128i Mask, __m128i A, __m128i B)
+{
+    return _mm_or_si128(_mm_and_si128(Mask, A), _mm_andnot_si128(Mask, B));
+}
+
+// Leaves the smaller of two biased samples in A and the larger in B
+static inline void CompareExchange(__m128i* pA, __m128i* pB)
+{
+    __m128i Swap = _mm_and_si128(_mm_xor_si128(*pA, *pB), _mm_cmpgt_epi32(*pA, *pB));
+
+    *pA = _mm_xor_si128(*pA, Swap);
+    *pB = _mm_xor_si128(*pB, Swap);
+}
+
+#endif
+
+static inline void CompareExchange(INT32* pA, INT32* pB)
+{
+    INT32 Low = (*pA < *pB) ? *pA : *pB;
+
+    *pB = (*pA < *pB) ? *pB : *pA;
+    *pA = Low;
+}
+
+// ****************************************************************************
+
+void TofDefaultTemporalParams(TofTemporalParams* pParams)
+{
+    pParams->Mode = eTOF_TEMPORAL_EMA;
+    pParams->Alpha = 0.25f;
+    pParams->MedianLength = 5;
+    pParams->MinAmplitude = 16;
+    pParams->FullAmplitude = 1024;
+    pParams->MotionThreshold = 200;
+}
+
+// ****************************************************************************
+
+TofTemporalFilter::TofTemporalFilter()
+    : mPlaneWords(0),
+      mPlaneStride(0),
+      mpAverage(NULL),
+      mpHistory(NULL),
+      mNewest(0),
+      mPrimed(FALSE)
+{
+    TofDefaultTemporalParams(&mParams);
+}
+
+TofTemporalFilter::~TofTemporalFilter()
+{
+    Destroy();
+}
+
+// ****************************************************************************
+//  Allocates the state for one plane of NumPulses x NumLines; only the
+//  state the chosen mode needs is allocated
+// ****************************************************************************
+
+PICOP_RC TofTemporalFilter::Create(UINT32 NumPulses, UINT32 NumLines, const TofTemporalParams* pParams)
+{
+    size_t PlaneBytes;
+
+
+    if ((pParams == NULL) || (NumPulses == 0) || (NumLines == 0) ||
+        ( ! (pParams->Alpha > 0.0f) || (pParams->Alpha > 1.0f)))
+    {
+        return eINVALID_ARG;
+    }
+
+    if ((pParams->Mode == eTOF_TEMPORAL_MEDIAN) &&
+        ((pParams->MedianLength < 3) || (pParams->MedianLength > TOF_TEMPORAL_MAX_MEDIAN) ||
+         ((pParams->MedianLength & 1) == 0)))
+    {
+        return eINVALID_ARG;
+    }
+
+    Destroy();
+
+    mParams = *pParams;
+    mPlaneWords = NumPulses * NumLines;
+    PlaneBytes = TOF_ALIGN_UP((size_t)mPlaneWords * sizeof(UINT32), TOF_CACHE_LINE_SIZE);
+    mPlaneStride = (UINT32)(PlaneBytes / sizeof(UINT32));
+
+    if (mParams.Mode == eTOF_TEMPORAL_EMA)
+    {
+        mpAverage = (FP32*)TofAlignedAlloc(PlaneBytes, TOF_CACHE_LINE_SIZE);
+    }
+    else
+    {
+        mpHistory = (UINT32*)TofAlignedAlloc(PlaneBytes * mParams.MedianLength, TOF_CACHE_LINE_SIZE);
+    }
+
+    if ((mpAverage == NULL) && (mpHistory == NULL))
+    {
+        Destroy();
+        return eFAILURE;
+    }
+
+    Reset();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofTemporalFilter::Destroy()
+{
+    TofAlignedFree(mpAverage);
+    TofAlignedFree(mpHistory);
+    mpAverage = NULL;
+    mpHistory = NULL;
+    mPlaneWords = 0;
+    mPlaneStride = 0;
+    mPrimed = FALSE;
+}
+
+// ****************************************************************************
+
+void TofTemporalFilter::Reset()
+{
+    if (mpAverage != NULL)
+    {
+        for (UINT32 i = 0; i < mPlaneWords; i++)
+        {
+            mpAverage[i] = -1.0f;
+        }
+    }
+
+    mNewest = 0;
+    mPrimed = FALSE;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofTemporalFilter::Filter(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count)
+{
+    if (mPlaneWords == 0)
+    {
+        return eUNINITIALIZED;
+    }
+
+    if ((pTime == NULL) || (pAmplitude == NULL) || (Count > mPlaneWords))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (mpAverage != NULL)
+    {
+        FilterEma(pTime, pAmplitude, Count);
+    }
+    else
+    {
+        FilterMedian(pTime, pAmplitude, Count);
+    }
+
+    return eSUCCESS;
+}
+
+PICOP_RC TofTemporalFilter::Filter(TofFrame* pFrame)
+{
+    return Filter(pFrame->GetTime(), pFrame->GetAmplitude(), pFrame->GetNumPulses() * pFrame->GetNumLines());
+}
+
+// ****************************************************************************
+//  Average += Weight * (Sample - Average), with Weight = Alpha scaled by the
+//  amplitude and capped at Alpha. An empty (negative) average or a sample
+//  past the motion threshold restarts the average at the sample.
+// ****************************************************************************
+
+void TofTemporalFilter::FilterEma(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count)
+{
+    const FP32 Alpha = mParams.Alpha;
+    const FP32 AlphaPerCount = Alpha / (FP32)((mParams.FullAmplitude != 0) ? mParams.FullAmplitude : 1);
+    const FP32 MinAmplitude = (FP32)mParams.MinAmplitude;
+    const FP32 Threshold = (mParams.MotionThreshold != 0) ? (FP32)mParams.MotionThreshold : FLT_MAX;
+    FP32* pAverage = mpAverage;
+    FP32 Sample;
+    FP32 Amplitude;
+    FP32 Average;
+    FP32 Difference;
+    FP32 Weight;
+    UINT32 i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128 vAlpha = _mm_set1_ps(Alpha);
+    const __m128 vAlphaPerCount = _mm_set1_ps(AlphaPerCount);
+    const __m128 vMinAmplitude = _mm_set1_ps(MinAmplitude);
+    const __m128 vThreshold = _mm_set1_ps(Threshold);
+    const __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 vZero = _mm_setzero_ps();
+
+    for (; (i + 4) <= Count; i += 4)
+    {
+        __m128 X = LoadAsFloat(pTime + i);
+        __m128 A = LoadAsFloat(pAmplitude + i);
+        __m128 S = _mm_load_ps(pAverage + i);
+        __m128 D = _mm_sub_ps(X, S);
+        __m128 W = _mm_min_ps(_mm_mul_ps(A, vAlphaPerCount), vAlpha);
+        __m128 Restart = _mm_or_ps(_mm_cmplt_ps(S, vZero), _mm_cmpgt_ps(_mm_and_ps(D, vAbs), vThreshold));
+        __m128 Next = Select(Restart, X, _mm_add_ps(S, _mm_mul_ps(W, D)));
+        __m128i Empty;
+
+        S = Select(_mm_cmpge_ps(A, vMinAmplitude), Next, S);
+        _mm_store_ps(pAverage + i, S);
+
+        // Pixels that never had a usable sample pass through
+        Empty = _mm_castps_si128(_mm_cmplt_ps(S, vZero));
+        _mm_storeu_si128((__m128i*)(pTime + i),
+                         Select(Empty, _mm_loadu_si128((const __m128i*)(pTime + i)), _mm_cvtps_epi32(S)));
+    }
+#endif
+
+    for (; i < Count; i++)
+    {
+        Sample = (FP32)pTime[i];
+        Amplitude = (FP32)pAmplitude[i];
+        Average = pAverage[i];
+
+        if (Amplitude >= MinAmplitude)
+        {
+            Difference = Sample - Average;
+            Weight = Amplitude * AlphaPerCount;
+            Weight = (Weight < Alpha) ? Weight : Alpha;
+
+            if ((Average < 0.0f) || (fabsf(Difference) > Threshold))
+            {
+                Average = Sample;
+            }
+            else
+            {
+                Average += Weight * Difference;
+            }
+
+            pAverage[i] = Average;
+        }
+
+        if (Average >= 0.0f)
+        {
+            pTime[i] = (UINT32)lrintf(Average);
+        }
+    }
+
+    mPrimed = TRUE;
+}
+
+// ****************************************************************************
+//  Stores the new samples over the oldest history plane and replaces each
+//  time with the median of its history. The first frame fills every plane.
+// ****************************************************************************
+
+void TofTemporalFilter::FilterMedian(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count)
+{
+    const UINT32 Length = mParams.MedianLength;
+    const UINT32* pPrevious;
+    UINT32* pNext;
+
+
+    if ( ! mPrimed)
+    {
+        for (UINT32 Plane = 0; Plane < Length; Plane++)
+        {
+            pNext = mpHistory + (size_t)Plane * mPlaneStride;
+
+            for (UINT32 k = 0; k < Count; k++)
+            {
+                pNext[k] = pTime[k] ^ TOF_TEMPORAL_BIAS;
+            }
+        }
+
+        mPrimed = TRUE;
+    }
+
+    pPrevious = mpHistory + (size_t)mNewest * mPlaneStride;
+    mNewest = (mNewest + 1) % Length;
+    pNext = mpHistory + (size_t)mNewest * mPlaneStride;
+
+    // Fixed lengths so the sorting network unrolls into registers
+    switch (Length)
+    {
+    case 3:
+        MedianOf<3>(pTime, pAmplitude, Count, pPrevious, pNext);
+        break;
+
+    case 5:
+        MedianOf<5>(pTime, pAmplitude, Count, pPrevious, pNext);
+        break;
+
+    default:
+        MedianOf<7>(pTime, pAmplitude, Count, pPrevious, pNext);
+        break;
+    }
+}
+
+// ****************************************************************************
+//  Replaces weak samples with the previous ones, stores them in pNext and
+//  sorts each pixel's Length samples with an odd-even transposition network
+// ****************************************************************************
+
+template <UINT32 Length>
+void TofTemporalFilter::MedianOf(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count,
+                                 const UINT32* pPrevious, UINT32* pNext)
+{
+    const UINT32 MinAmplitude = mParams.MinAmplitude ^ TOF_TEMPORAL_BIAS;
+    INT32 Sorted[Length];
+    UINT32 Sample;
+    UINT32 i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i vBias = _mm_set1_epi32((int)TOF_TEMPORAL_BIAS);
+    const __m128i vMinAmplitude = _mm_set1_epi32((int)MinAmplitude);
+    __m128i Values[Length];
+
+    for (; (i + 4) <= Count; i += 4)
+    {
+        __m128i T = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(pTime + i)), vBias);
+        __m128i A = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(pAmplitude + i)), vBias);
+        __m128i Weak = _mm_cmplt_epi32(A, vMinAmplitude);
+
+        _mm_store_si128((__m128i*)(pNext + i), Select(Weak, _mm_load_si128((const __m128i*)(pPrevious + i)), T));
+
+        for (UINT32 Plane = 0; Plane < Length; Plane++)
+        {
+            Values[Plane] = _mm_load_si128((const __m128i*)(mpHistory + (size_t)Plane * mPlaneStride + i));
+        }
+
+        for (UINT32 Round = 0; Round < Length; Round++)
+        {
+            for (UINT32 k = Round & 1; (k + 1) < Length; k += 2)
+            {
+                CompareExchange(&Values[k], &Values[k + 1]);
+            }
+        }
+
+        _mm_storeu_si128((__m128i*)(pTime + i), _mm_xor_si128(Values[Length / 2], vBias));
+    }
+#endif
+
+    for (; i < Count; i++)
+    {
+        Sample = pTime[i] ^ TOF_TEMPORAL_BIAS;
+        pNext[i] = ((INT32)(pAmplitude[i] ^ TOF_TEMPORAL_BIAS) < (INT32)MinAmplitude) ? pPrevious[i] : Sample;
+
+        for (UINT32 Plane = 0; Plane < Length; Plane++)
+        {
+            Sorted[Plane] = (INT32)mpHistory[(size_t)Plane * mPlaneStride + i];
+        }
+
+        for (UINT32 Round = 0; Round < Length; Round++)
+        {
+            for (UINT32 k = Round & 1; (k + 1) < Length; k += 2)
+            {
+                CompareExchange(&Sorted[k], &Sorted[k + 1]);
+            }
+        }
+
+        pTime[i] = (UINT32)Sorted[Length / 2] ^ TOF_TEMPORAL_BIAS;
+    }
+}
+
+// ****************************************************************************
+
+TofTemporalFilterStage::TofTemporalFilterStage(const TofTemporalParams* pParams)
+{
+    TofDefaultTemporalParams(&mParams);
+
+    if (pParams != NULL)
+    {
+        mParams = *pParams;
+    }
+}
+
+PICOP_RC TofTemporalFilterStage::Start(const TofFrameGeometry* pGeometry)
+{
+    return mFilter.Create(pGeometry->NumPulses, pGeometry->NumLines, &mParams);
+}
+
+PICOP_RC TofTemporalFilterStage::Process(TofPipelineFrame* pFrame)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mFilter.Filter(pFrame->pPlanes);
+}
+
+// ****************************************************************************
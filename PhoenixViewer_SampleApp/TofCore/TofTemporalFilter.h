@@ -0,0 +1,118 @@
+// ****************************************************************************
+//  TofTemporalFilter.h
+//
+// Temporal denoising of the time plane over consecutive frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <mutex>
+#include "PicoP_TLC_Api.h"
+#include "TofFrame.h"
+#include "TofPipeline.h"
+
+// ****************************************************************************
+
+#define TOF_TEMPORAL_MAX_MEDIAN     7
+
+typedef enum
+{
+    eTOF_TEMPORAL_EMA = 0,              // Exponential moving average weighted by amplitude
+    eTOF_TEMPORAL_MEDIAN                // Median of the last MedianLength samples
+} TofTemporalModeE;
+
+typedef struct
+{
+    TofTemporalModeE Mode;
+    FP32 Alpha;                         // EMA weight of a sample at full amplitude, 0 < Alpha <= 1
+    UINT32 MedianLength;                // Odd, 3 .. TOF_TEMPORAL_MAX_MEDIAN
+    UINT32 MinAmplitude;                // Samples below this are ignored
+    UINT32 FullAmplitude;               // EMA samples at or above this get the full Alpha
+    UINT32 MotionThreshold;             // EMA restarts from a sample this many counts away; 0 never
+} TofTemporalParams;
+
+void TofDefaultTemporalParams(TofTemporalParams* pParams);
+
+// ****************************************************************************
+// Filters the time plane of each frame in place using the frames before it;
+// the amplitude plane says how far each sample can be trusted.
+//
+// EMA: each pixel keeps a running average that moves towards a new sample
+// by Alpha scaled by the sample's amplitude relative to FullAmplitude, so
+// weak returns barely move it. A sample further than MotionThreshold from
+// the average replaces it outright, so moving edges don't smear.
+//
+// Median: each pixel keeps its last MedianLength samples and outputs their
+// median. A sample below MinAmplitude repeats the pixel's previous sample
+// instead of being stored, so dropouts never win the vote.
+//
+// Either way a sample below MinAmplitude leaves the pixel's history alone.
+// Time values above 2^24 lose precision in EMA mode.
+// ****************************************************************************
+
+class TofTemporalFilter
+{
+public:
+    TofTemporalFilter();
+    ~TofTemporalFilter();
+
+    PICOP_RC Create(UINT32 NumPulses, UINT32 NumLines, const TofTemporalParams* pParams);
+    void Destroy();
+
+    // Forgets the history, e.g. after the scan configuration changed
+    void Reset();
+
+    PICOP_RC Filter(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count);
+    PICOP_RC Filter(TofFrame* pFrame);
+
+    void GetParams(TofTemporalParams* pParams) const { *pParams = mParams; }
+
+private:
+    TofTemporalFilter(const TofTemporalFilter&);
+    TofTemporalFilter& operator=(const TofTemporalFilter&);
+
+    void FilterEma(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count);
+    void FilterMedian(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count);
+
+    template <UINT32 Length>
+    void MedianOf(UINT32* pTime, const UINT32* pAmplitude, UINT32 Count, const UINT32* pPrevious, UINT32* pNext);
+
+    TofTemporalParams mParams;
+    UINT32 mPlaneWords;
+    UINT32 mPlaneStride;                // Words from one history plane to the next
+    FP32* mpAverage;                    // EMA state, negative until a pixel has a sample
+    UINT32* mpHistory;                  // MedianLength planes of samples, biased by 0x80000000
+    UINT32 mNewest;                     // History plane written last
+    BOOL mPrimed;                       // The history holds at least one frame
+};
+
+// ****************************************************************************
+// Pipeline stage running a TofTemporalFilter on pPlanes; place it after a
+// TofDecodeStage. The filter depends on frame order, so give the stage one
+// thread.
+// ****************************************************************************
+
+class TofTemporalFilterStage : public TofPipelineStage
+{
+public:
+    TofTemporalFilterStage(const TofTemporalParams* pParams);
+
+    virtual const char* GetName() const { return "temporal"; }
+    virtual PICOP_RC Start(const TofFrameGeometry* pGeometry);
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+private:
+    TofTemporalParams mParams;
+    TofTemporalFilter mFilter;
+    std::mutex mLock;
+};
+
+// ****************************************************************************
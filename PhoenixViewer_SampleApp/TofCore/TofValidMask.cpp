@@ -0,0 +1,220 @@
+// ****************************************************************************
+//  TofValidMask.cpp
+//
+// Amplitude thresholding and compaction of the valid pixels of a frame
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "TofValidMask.h"
+#include "TofSimd.h"
+
+// ****************************************************************************
+
+#define TOF_MASK_BIAS               0x80000000u     // Maps UINT32 order onto INT32 order
+
+// Valid pixels per 4 bit group, and their lanes packed to the front. Adding
+// the index of lane 0 to a row gives the indices to store; storing all four
+// words and advancing by the count needs no shuffle.
+static const UINT8 sBitCount[16] =
+{
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+};
+
+alignas(16) static const UINT32 sCompactLanes[16][4] =
+{
+    {0, 0, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0},
+    {2, 0, 0, 0}, {0, 2, 0, 0}, {1, 2, 0, 0}, {0, 1, 2, 0},
+    {3, 0, 0, 0}, {0, 3, 0, 0}, {1, 3, 0, 0}, {0, 1, 3, 0},
+    {2, 3, 0, 0}, {0, 2, 3, 0}, {1, 2, 3, 0}, {0, 1, 2, 3}
+};
+
+// ****************************************************************************
+
+static inline BOOL TofIsValid(UINT32 Time, UINT32 Amplitude, UINT32 MinAmplitude)
+{
+    return ((Time != 0) && (Amplitude >= MinAmplitude)) ? TRUE : FALSE;
+}
+
+#if defined(TOF_SIMD_SSE2)
+
+// One bit per lane of the four pixels at pTime / pAmplitude
+static inline UINT32 TofValidBits(const UINT32* pTime, const UINT32* pAmplitude, __m128i vMinAmplitude)
+{
+    __m128i Time = _mm_loadu_si128((const __m128i*)pTime);
+    __m128i Amplitude = _mm_xor_si128(_mm_loadu_si128((const __m128i*)pAmplitude), _mm_set1_epi32((int)TOF_MASK_BIAS));
+    __m128i Invalid = _mm_or_si128(_mm_cmpeq_epi32(Time, _mm_setzero_si128()), _mm_cmplt_epi32(Amplitude, vMinAmplitude));
+
+    return (UINT32)(~_mm_movemask_ps(_mm_castsi128_ps(Invalid)) & 0xf);
+}
+
+// Stores the indices of the set bits of Bits, lane 0 being pixel First
+static inline UINT32* TofStoreLanes(UINT32* pIndices, UINT32 Bits, UINT32 First)
+{
+    _mm_storeu_si128((__m128i*)pIndices,
+                     _mm_add_epi32(_mm_set1_epi32((int)First), _mm_load_si128((const __m128i*)sCompactLanes[Bits])));
+
+    return pIndices + sBitCount[Bits];
+}
+
+#endif
+
+// ****************************************************************************
+//  Sixteen groups of four pixels make one mask word
+// ****************************************************************************
+
+UINT32 TofBuildValidMask(const UINT32* pTime, const UINT32* pAmplitude, UINT32 Count, UINT32 MinAmplitude,
+                         uint64_t* pMask)
+{
+    UINT32 NumValid = 0;
+    uint64_t Word;
+    UINT32 Bit;
+    UINT32 i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i vMinAmplitude = _mm_set1_epi32((int)(MinAmplitude ^ TOF_MASK_BIAS));
+    UINT32 Bits;
+
+    for (; (i + 64) <= Count; i += 64)
+    {
+        Word = 0;
+
+        for (UINT32 Group = 0; Group < 16; Group++)
+        {
+            Bits = TofValidBits(pTime + i + (Group * 4), pAmplitude + i + (Group * 4), vMinAmplitude);
+            Word |= (uint64_t)Bits << (Group * 4);
+            NumValid += sBitCount[Bits];
+        }
+
+        pMask[i / 64] = Word;
+    }
+#endif
+
+    for (; i < Count; i += 64)
+    {
+        Word = 0;
+
+        for (Bit = 0; (Bit < 64) && ((i + Bit) < Count); Bit++)
+        {
+            if (TofIsValid(pTime[i + Bit], pAmplitude[i + Bit], MinAmplitude))
+            {
+                Word |= (uint64_t)1 << Bit;
+                NumValid++;
+            }
+        }
+
+        pMask[i / 64] = Word;
+    }
+
+    return NumValid;
+}
+
+// ****************************************************************************
+//  Empty words are skipped and full ones written as a run, so sparse and
+//  dense masks are both cheap
+// ****************************************************************************
+
+UINT32 TofMaskToIndices(const uint64_t* pMask, UINT32 Count, UINT32* pIndices)
+{
+    UINT32* pNext = pIndices;
+    uint64_t Word;
+    UINT32 First;
+
+
+    for (UINT32 i = 0; i < TOF_MASK_WORDS(Count); i++)
+    {
+        Word = pMask[i];
+        First = i * 64;
+
+        if (Word == 0)
+        {
+            continue;
+        }
+
+        if ((Word == ~(uint64_t)0) && ((First + 64) <= Count))
+        {
+            for (UINT32 Bit = 0; Bit < 64; Bit++)
+            {
+                *pNext++ = First + Bit;
+            }
+
+            continue;
+        }
+
+#if defined(TOF_SIMD_SSE2)
+        // A group's four word store must stay inside the list
+        for (; (Word != 0) && ((First + 4) <= Count); Word >>= 4, First += 4)
+        {
+            pNext = TofStoreLanes(pNext, (UINT32)(Word & 0xf), First);
+        }
+#endif
+
+        for (; Word != 0; Word >>= 1, First++)
+        {
+            if (Word & 1)
+            {
+                *pNext++ = First;
+            }
+        }
+    }
+
+    return (UINT32)(pNext - pIndices);
+}
+
+// ****************************************************************************
+
+UINT32 TofCompactValid(const UINT32* pTime, const UINT32* pAmplitude, UINT32 Count, UINT32 MinAmplitude,
+                       UINT32* pIndices)
+{
+    UINT32* pNext = pIndices;
+    UINT32 i = 0;
+
+
+#if defined(TOF_SIMD_SSE2)
+    const __m128i vMinAmplitude = _mm_set1_epi32((int)(MinAmplitude ^ TOF_MASK_BIAS));
+
+    // Fewer indices than pixels have been stored, so the store stays inside the list
+    for (; (i + 4) <= Count; i += 4)
+    {
+        pNext = TofStoreLanes(pNext, TofValidBits(pTime + i, pAmplitude + i, vMinAmplitude), i);
+    }
+#endif
+
+    // Branch free: always store, only advance past valid pixels
+    for (; i < Count; i++)
+    {
+        *pNext = i;
+        pNext += TofIsValid(pTime[i], pAmplitude[i], MinAmplitude);
+    }
+
+    return (UINT32)(pNext - pIndices);
+}
+
+// ****************************************************************************
+
+TofValidMaskStage::TofValidMaskStage(UINT32 MinAmplitude)
+    : mMinAmplitude(MinAmplitude)
+{
+}
+
+PICOP_RC TofValidMaskStage::Process(TofPipelineFrame* pFrame)
+{
+    TofFrame* pPlanes = pFrame->pPlanes;
+
+
+    pFrame->NumValid = TofCompactValid(pPlanes->GetTime(), pPlanes->GetAmplitude(),
+                                       pPlanes->GetNumPulses() * pPlanes->GetNumLines(), mMinAmplitude,
+                                       pFrame->pValid);
+    pFrame->Masked = TRUE;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
@@ -0,0 +1,61 @@
+// ****************************************************************************
+//  TofValidMask.h
+//
+// Amplitude thresholding and compaction of the valid pixels of a frame
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <stdint.h>
+#include "PicoP_TLC_Api.h"
+#include "TofPipeline.h"
+
+// ****************************************************************************
+// A pixel is valid when it has a return (time not 0) and its amplitude is at
+// least MinAmplitude. Weak returns give garbage ranges, so dropping them here
+// saves every later consumer (projection, export) from touching them.
+//
+// The bitmask holds pixel i in bit i % 64 of word i / 64; bits past Count are
+// clear. Index lists hold the valid pixel indices (Line * NumPulses + Pulse)
+// in ascending order and must have room for Count entries. All three return
+// the number of valid pixels.
+// ****************************************************************************
+
+#define TOF_MASK_WORDS(Count)       (((Count) + 63) / 64)
+
+UINT32 TofBuildValidMask(const UINT32* pTime, const UINT32* pAmplitude, UINT32 Count, UINT32 MinAmplitude,
+                         uint64_t* pMask);
+
+UINT32 TofMaskToIndices(const uint64_t* pMask, UINT32 Count, UINT32* pIndices);
+
+// Thresholds and compacts in one pass, without a mask
+UINT32 TofCompactValid(const UINT32* pTime, const UINT32* pAmplitude, UINT32 Count, UINT32 MinAmplitude,
+                       UINT32* pIndices);
+
+// ****************************************************************************
+// Pipeline stage listing the valid pixels of pPlanes in pValid; place it
+// after a TofDecodeStage (and any filters). A TofProjectStage after it only
+// converts the valid pixels.
+// ****************************************************************************
+
+class TofValidMaskStage : public TofPipelineStage
+{
+public:
+    TofValidMaskStage(UINT32 MinAmplitude);
+
+    virtual const char* GetName() const { return "mask"; }
+    virtual PICOP_RC Process(TofPipelineFrame* pFrame);
+
+private:
+    UINT32 mMinAmplitude;
+};
+
+// ****************************************************************************
@@ -0,0 +1,177 @@
+// ****************************************************************************
+//  TofSimTest.cpp
+//
+// Tests of the simulated TLC library
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofSim.h"
+#include "TofTest.h"
+#include "TofTestFrames.h"
+
+// ****************************************************************************
+
+// Little latency and no jitter, so frames arrive on time
+static TofSimConfig TofTestSimConfig(UINT32 FrameRate, UINT32 QueueDepth)
+{
+    TofSimConfig Config;
+
+
+    TofSimDefaultConfig(&Config);
+    Config.FrameRate = FrameRate;
+    Config.LatencyUs = 1000;
+    Config.JitterUs = 0;
+    Config.QueueDepth = QueueDepth;
+
+    return Config;
+}
+
+// ****************************************************************************
+
+TOF_TEST(SimAllowsOneConnection)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(30, 8);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    PicoP_HANDLE Second = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    UINT32 Count = 0;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    TOF_CHECK_EQ(eALREADY_OPENED, PicoP_TLC_OpenConnectionUsb(Library, Usb, &Second));
+    TOF_CHECK_EQ(eNOT_CONNECTED, PicoP_TLC_CloseConnection((PicoP_HANDLE)&Count));
+
+    TOF_CHECK_EQ(eSUCCESS, PicoP_TLC_CloseConnection(Connection));
+    TOF_CHECK_EQ(eNOT_CONNECTED, PicoP_TLC_CloseConnection(Connection));
+    TOF_CHECK_EQ(eNOT_CONNECTED, PicoP_TLC_GetTofFrameCount(Connection, &Count));
+
+    // Closing the library closes the connection too
+    TOF_REQUIRE(PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) == eSUCCESS);
+    TOF_CHECK_EQ(eSUCCESS, PicoP_TLC_CloseLibrary(Library));
+    TOF_CHECK_EQ(eNOT_CONNECTED, PicoP_TLC_GetTofFrameCount(Connection, &Count));
+}
+
+// ****************************************************************************
+//  Waits for the first overrun rather than a fixed time, which a loaded
+//  machine running the tests in parallel can overrun
+// ****************************************************************************
+
+TOF_TEST(SimDropsOldestBeyondQueueDepth)
+{
+    PicoP_HANDLE Library = NULL;
+    TofSimConfig Config = TofTestSimConfig(500, 4);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    TofSimStats Stats;
+    UINT32 Count = 0;
+
+
+    TOF_REQUIRE(Connection != NULL);
+
+    do
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        TofSimGetStats(&Stats);
+    }
+    while ((Stats.FramesOverrun == 0) && (std::chrono::steady_clock::now() < Deadline));
+
+    TOF_CHECK_EQ(eSUCCESS, PicoP_TLC_GetTofFrameCount(Connection, &Count));
+    TOF_CHECK_EQ(4u, Count);
+
+    TofTestDisconnect(Library, Connection);
+}
+
+// ****************************************************************************
+//  Worker threads keep calling the API with whatever handle they were given
+//  while the main thread opens and closes the connection under them. Every
+//  call must either use a live device or report eNOT_CONNECTED; a call
+//  reaching a deleted device shows up as a crash, or under AddressSanitizer.
+// ****************************************************************************
+
+TOF_TEST(SimCloseWhileCallsInProgress)
+{
+    const UINT32 Workers = 3;
+    PicoP_HANDLE Library = NULL;
+    PicoP_USBInfo Usb = { 4, "1234" };
+    std::atomic<PicoP_HANDLE> Handle(NULL);
+    std::atomic<BOOL> Done(FALSE);
+    std::atomic<UINT32> Unexpected(0);
+    std::atomic<UINT32> Calls(0);
+    std::vector<std::thread> Threads;
+    TofSimConfig Config = TofTestSimConfig(1000, 8);
+    PicoP_HANDLE Connection = TofTestConnect(&Library, &Config);
+    UINT32 FrameBytes = 0;
+
+
+    TOF_REQUIRE(Connection != NULL);
+    PicoP_TLC_GetTofFrameDimensions(Connection, &FrameBytes);
+    Handle = Connection;
+
+    for (UINT32 t = 0; t < Workers; t++)
+    {
+        Threads.push_back(std::thread([&, t]()
+        {
+            std::vector<UINT32> Frame(FrameBytes / sizeof(UINT32));
+            PicoP_ToFDataFormatE Format;
+            UINT32 Count = 0;
+            UINT32 RetFrames = 0;
+            PICOP_RC PicopRc;
+
+            while ( ! Done)
+            {
+                switch ((Calls++ + t) % 3)
+                {
+                case 0:
+                    PicopRc = PicoP_TLC_GetTofFrameCount(Handle, &Count);
+                    break;
+
+                case 1:
+                    PicopRc = PicoP_TLC_GetTofDataFormat(Handle, &Format, eCURRENT_VALUE);
+                    break;
+
+                default:
+                    PicopRc = PicoP_TLC_AcquireTofFrame(Handle, 1, &Frame[0], &RetFrames);
+                    break;
+                }
+
+                Unexpected += ((PicopRc != eSUCCESS) && (PicopRc != eNOT_CONNECTED)) ? 1 : 0;
+            }
+        }));
+    }
+
+    for (UINT32 i = 0; i < 50; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1 + (i % 3)));
+        TOF_CHECK_EQ(eSUCCESS, PicoP_TLC_CloseConnection(Connection));
+        std::this_thread::sleep_for(std::chrono::milliseconds(i % 2));
+        TOF_REQUIRE(PicoP_TLC_OpenConnectionUsb(Library, Usb, &Connection) == eSUCCESS);
+        Handle = Connection;
+    }
+
+    Done = TRUE;
+
+    for (size_t t = 0; t < Threads.size(); t++)
+    {
+        Threads[t].join();
+    }
+
+    TOF_CHECK_EQ(0u, Unexpected.load());
+    TOF_CHECK(Calls > 100);
+
+    PicoP_TLC_CloseLibrary(Library);
+}
+
+// ****************************************************************************
@@ -0,0 +1,79 @@
+// ****************************************************************************
+//  TofSim.h
+//
+// Settings and statistics of the simulated TLC device
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "PicoP_TLC_Api.h"
+
+// ****************************************************************************
+// TofSim implements the PicoP_TLC_* functions in software, so anything built
+// against PicoP_TLC_Api.h can run without the device or the DLL by linking
+// TofSim instead of the TLC import library. Frames are rendered from a
+// synthetic scene at FrameRate, and each becomes readable Latency +/- Jitter
+// after it was captured, the way frames trickle in over USB. With a
+// LinkBytesPerSecond limit frames also go over the link one at a time, each
+// taking TofLinkBytesPerFrame() bytes, and frames captured while QueueDepth
+// are still waiting for it are dropped, as on a loaded bus. With a
+// TdcBytesPerSecond limit reading the detectors out takes time: all of TDC A
+// and TofTdcBReadBytes() of TDC B, so the DOutBScale sets how fast frames
+// can be captured, but not how many bytes they take on the link. The settings
+// below are read when a connection is opened and by the running generator,
+// so they can be changed at any time.
+// ****************************************************************************
+
+#define TOF_SIM_DEFAULT_FRAME_RATE      30          // Frames per second
+#define TOF_SIM_DEFAULT_LATENCY_US      8000
+#define TOF_SIM_DEFAULT_JITTER_US       2000
+#define TOF_SIM_DEFAULT_QUEUE_DEPTH     8           // Frames the device holds before dropping
+#define TOF_SIM_DEFAULT_LINK_BYTES      0           // Per second, 0 is unlimited
+#define TOF_SIM_DEFAULT_TDC_BYTES       0           // Per second, 0 is unlimited
+#define TOF_SIM_DEFAULT_PULSES          120
+#define TOF_SIM_LINES                   720
+
+typedef enum
+{
+    eTOF_SIM_SCENE_ROOM = 0,            // Wall, floor and a ball moving across the view
+    eTOF_SIM_SCENE_RAMP,                // Range increases left to right, no noise
+    eTOF_SIM_SCENE_CONSTANT             // Every pixel at the same range, no noise
+} TofSimSceneE;
+
+typedef struct
+{
+    UINT32 FrameRate;                   // Frames per second, 0 stops frame generation
+    UINT32 LatencyUs;                   // Capture to readable delay
+    UINT32 JitterUs;                    // Latency varies by up to +/- this
+    UINT32 QueueDepth;                  // Unread frames kept, the oldest is dropped beyond this
+    UINT32 LinkBytesPerSecond;          // 0 is unlimited
+    UINT32 TdcBytesPerSecond;           // Detector readout, 0 is unlimited
+    TofSimSceneE Scene;
+    UINT32 Seed;                        // Noise and jitter seed, runs repeat for the same seed
+} TofSimConfig;
+
+typedef struct
+{
+    UINT32 FramesGenerated;
+    UINT32 FramesRead;                  // Returned by PicoP_TLC_AcquireTofFrame
+    UINT32 FramesOverrun;               // Dropped because nobody read them in time
+    UINT32 FramesLinkDropped;           // Captured while the link was backed up
+    UINT32 EventsSent;                  // eEVENT_TOF_DATA_FRAMES_RECEIVED callbacks
+} TofSimStats;
+
+// ****************************************************************************
+
+void TofSimDefaultConfig(TofSimConfig* pConfig);
+PICOP_RC TofSimSetConfig(const TofSimConfig* pConfig);
+void TofSimGetConfig(TofSimConfig* pConfig);
+void TofSimGetStats(TofSimStats* pStats);
+
+// ****************************************************************************
@@ -0,0 +1,823 @@
+// ****************************************************************************
+//  TofSimApi.cpp
+//
+// PicoP_TLC_* entry points backed by the simulated device
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFrameView.h"
+#include "TofPointCloud.h"
+#include "TofSim.h"
+#include "TofSimDevice.h"
+
+// ****************************************************************************
+
+#define TOF_SIM_VERSION_MAJOR   1
+#define TOF_SIM_VERSION_MINOR   0
+#define TOF_SIM_VERSION_PATCH   0
+
+// ****************************************************************************
+// Like the real library a single device can be connected. The library handle
+// is the address of sLibraryToken, the connection handle the device itself.
+// Every API call holds a TofSimDeviceRef on the device for as long as it uses
+// it; closing takes the device out of sDevice so no new call can reach it,
+// then waits for the calls in progress before deleting it.
+// ****************************************************************************
+
+static std::mutex sApiLock;
+static std::condition_variable sDeviceIdle;
+static UINT32 sLibraryToken;
+static BOOL sLibraryOpen = FALSE;
+static TofSimDevice* sDevice = NULL;
+static UINT32 sDeviceUsers = 0;
+static TofSimConfig sConfig = { TOF_SIM_DEFAULT_FRAME_RATE, TOF_SIM_DEFAULT_LATENCY_US, TOF_SIM_DEFAULT_JITTER_US,
+                                TOF_SIM_DEFAULT_QUEUE_DEPTH, TOF_SIM_DEFAULT_LINK_BYTES, TOF_SIM_DEFAULT_TDC_BYTES,
+                                eTOF_SIM_SCENE_ROOM, 1 };
+
+// ****************************************************************************
+
+class TofSimDeviceRef
+{
+public:
+    // The open connection's device, if there is one
+    TofSimDeviceRef()
+        : mDevice(NULL)
+    {
+        std::lock_guard<std::mutex> Lock(sApiLock);
+
+        Attach(sDevice);
+    }
+
+    // No device unless ConnectionHandle is the open connection
+    explicit TofSimDeviceRef(PicoP_HANDLE ConnectionHandle)
+        : mDevice(NULL)
+    {
+        std::lock_guard<std::mutex> Lock(sApiLock);
+
+        if (ConnectionHandle == (PicoP_HANDLE)sDevice)
+        {
+            Attach(sDevice);
+        }
+    }
+
+    ~TofSimDeviceRef()
+    {
+        if (mDevice != NULL)
+        {
+            std::lock_guard<std::mutex> Lock(sApiLock);
+
+            if (--sDeviceUsers == 0)
+            {
+                sDeviceIdle.notify_all();
+            }
+        }
+    }
+
+    TofSimDevice* Get() const { return mDevice; }
+
+private:
+    TofSimDeviceRef(const TofSimDeviceRef&);
+    TofSimDeviceRef& operator=(const TofSimDeviceRef&);
+
+    // Called with sApiLock held
+    void Attach(TofSimDevice* pDevice)
+    {
+        if (pDevice != NULL)
+        {
+            mDevice = pDevice;
+            sDeviceUsers++;
+        }
+    }
+
+    TofSimDevice* mDevice;
+};
+
+// ****************************************************************************
+//  Takes the device out of sDevice and waits until no call is using it; the
+//  caller then owns it. Called with sApiLock held.
+// ****************************************************************************
+
+static TofSimDevice* TofSimDetachDevice(std::unique_lock<std::mutex>* pLock)
+{
+    TofSimDevice* pDevice = sDevice;
+
+
+    sDevice = NULL;
+    sDeviceIdle.wait(*pLock, []() { return (sDeviceUsers == 0); });
+
+    return pDevice;
+}
+
+// ****************************************************************************
+
+void TofSimDefaultConfig(TofSimConfig* pConfig)
+{
+    pConfig->FrameRate = TOF_SIM_DEFAULT_FRAME_RATE;
+    pConfig->LatencyUs = TOF_SIM_DEFAULT_LATENCY_US;
+    pConfig->JitterUs = TOF_SIM_DEFAULT_JITTER_US;
+    pConfig->QueueDepth = TOF_SIM_DEFAULT_QUEUE_DEPTH;
+    pConfig->LinkBytesPerSecond = TOF_SIM_DEFAULT_LINK_BYTES;
+    pConfig->TdcBytesPerSecond = TOF_SIM_DEFAULT_TDC_BYTES;
+    pConfig->Scene = eTOF_SIM_SCENE_ROOM;
+    pConfig->Seed = 1;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofSimSetConfig(const TofSimConfig* pConfig)
+{
+    std::lock_guard<std::mutex> Lock(sApiLock);
+
+
+    if ((pConfig == NULL) || (pConfig->QueueDepth == 0) || (pConfig->FrameRate > 1000000))
+    {
+        return eINVALID_ARG;
+    }
+
+    sConfig = *pConfig;
+
+    if (sDevice != NULL)
+    {
+        sDevice->SetConfig(pConfig);
+    }
+
+    return eSUCCESS;
+}
+
+void TofSimGetConfig(TofSimConfig* pConfig)
+{
+    std::lock_guard<std::mutex> Lock(sApiLock);
+
+
+    *pConfig = sConfig;
+}
+
+// ****************************************************************************
+
+void TofSimGetStats(TofSimStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(sApiLock);
+
+
+    if (sDevice != NULL)
+    {
+        sDevice->GetStats(pStats);
+    }
+    else
+    {
+        memset(pStats, 0, sizeof(TofSimStats));
+    }
+}
+
+// ****************************************************************************
+//  Library and connections
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_OpenLibrary(PicoP_HANDLE* library_handle)
+{
+    std::lock_guard<std::mutex> Lock(sApiLock);
+
+
+    if (library_handle == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    sLibraryOpen = TRUE;
+    *library_handle = &sLibraryToken;
+
+    return eSUCCESS;
+}
+
+PICOP_RC PicoP_TLC_CloseLibrary(const PicoP_HANDLE library_handle)
+{
+    TofSimDevice* pDevice;
+
+
+    {
+        std::unique_lock<std::mutex> Lock(sApiLock);
+
+        if ((library_handle != &sLibraryToken) || ( ! sLibraryOpen))
+        {
+            return eINVALID_ARG;
+        }
+
+        sLibraryOpen = FALSE;
+        pDevice = TofSimDetachDevice(&Lock);
+    }
+
+    delete pDevice;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+static PICOP_RC TofSimConnect(const PicoP_HANDLE library_handle, PicoP_HANDLE* connection_handle)
+{
+    std::lock_guard<std::mutex> Lock(sApiLock);
+    TofSimDevice* pDevice;
+    PICOP_RC PicopRc;
+
+
+    if ((library_handle != &sLibraryToken) || ( ! sLibraryOpen) || (connection_handle == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    if (sDevice != NULL)
+    {
+        return eALREADY_OPENED;
+    }
+
+    pDevice = new TofSimDevice();
+    PicopRc = pDevice->Open(&sConfig);
+
+    if (PicopRc != eSUCCESS)
+    {
+        delete pDevice;
+        return PicopRc;
+    }
+
+    sDevice = pDevice;
+    *connection_handle = (PicoP_HANDLE)pDevice;
+
+    return eSUCCESS;
+}
+
+PICOP_RC PicoP_TLC_OpenConnection(const PicoP_HANDLE library_handle,
+                                  const PicoP_ConnectionTypeE connection_type,
+                                  const PicoP_ConnectionInfo connection_info,
+                                  PicoP_HANDLE* connection_handle)
+{
+    (void)connection_type;
+    (void)connection_info;
+
+    return TofSimConnect(library_handle, connection_handle);
+}
+
+PICOP_RC PicoP_TLC_OpenConnectionUsb(const PicoP_HANDLE library_handle,
+                                     const PicoP_USBInfo connection_info,
+                                     PicoP_HANDLE* connection_handle)
+{
+    (void)connection_info;
+
+    return TofSimConnect(library_handle, connection_handle);
+}
+
+PICOP_RC PicoP_TLC_OpenConnectionRs232(const PicoP_HANDLE library_handle,
+                                       const PicoP_RS232Info connection_info,
+                                       PicoP_HANDLE* connection_handle)
+{
+    (void)connection_info;
+
+    return TofSimConnect(library_handle, connection_handle);
+}
+
+PICOP_RC PicoP_TLC_CloseConnection(const PicoP_HANDLE connection_handle)
+{
+    TofSimDevice* pDevice;
+
+
+    {
+        std::unique_lock<std::mutex> Lock(sApiLock);
+
+        if ((connection_handle == NULL) || (connection_handle != (PicoP_HANDLE)sDevice))
+        {
+            return eNOT_CONNECTED;
+        }
+
+        pDevice = TofSimDetachDevice(&Lock);
+    }
+
+    delete pDevice;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Settings
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetCalData(const PicoP_HANDLE connection_handle,
+                              const UINT32 cal_data_size,
+                              const UINT8 cal_data_block[MAX_CAL_DATA_SIZE])
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if ((cal_data_block == NULL) && (cal_data_size != 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    return pDevice->SetCalData(cal_data_size, cal_data_block);
+}
+
+PICOP_RC PicoP_TLC_GetCalData(const PicoP_HANDLE connection_handle,
+                              UINT32* cal_data_size,
+                              UINT8 cal_data_block[MAX_CAL_DATA_SIZE])
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if ((cal_data_size == NULL) || (cal_data_block == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    pDevice->GetCalData(cal_data_size, cal_data_block);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetSensingState(const PicoP_HANDLE connection_handle,
+                                   const PicoP_SensingStateE state,
+                                   const BOOL commit)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)commit;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    return pDevice->SetSensingState(state);
+}
+
+PICOP_RC PicoP_TLC_GetSensingState(const PicoP_HANDLE connection_handle,
+                                   PicoP_SensingStateE* const pState,
+                                   const PicoP_ValueStorageTypeE storageType)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)storageType;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pState == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    *pState = pDevice->GetSensingState();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetSensingDataInterface(const PicoP_HANDLE connection_handle,
+                                           const PicoP_SensingDataInterfaceE dataIf,
+                                           const BOOL commit)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)commit;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    pDevice->SetDataInterface(dataIf);
+
+    return eSUCCESS;
+}
+
+PICOP_RC PicoP_TLC_GetSensingDataInterface(const PicoP_HANDLE connection_handle,
+                                           PicoP_SensingDataInterfaceE* const pDataIf,
+                                           const PicoP_ValueStorageTypeE storageType)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)storageType;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pDataIf == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    *pDataIf = pDevice->GetDataInterface();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetTofPulsingConfig(const PicoP_HANDLE connection_handle,
+                                       const PicoP_TofPulsingConfig* pTofPulsingConfig,
+                                       const BOOL commit)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)commit;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pTofPulsingConfig == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    return pDevice->SetPulsingConfig(pTofPulsingConfig);
+}
+
+PICOP_RC PicoP_TLC_GetTofPulsingConfig(const PicoP_HANDLE connection_handle,
+                                       PicoP_TofPulsingConfig* const pTofPulsingConfig,
+                                       const PicoP_ValueStorageTypeE storageType)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)storageType;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pTofPulsingConfig == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    pDevice->GetPulsingConfig(pTofPulsingConfig);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetTofDataFormat(const PicoP_HANDLE connection_handle,
+                                    const PicoP_ToFDataFormatE dataFormat,
+                                    const BOOL commit)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)commit;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    return pDevice->SetDataFormat(dataFormat);
+}
+
+PICOP_RC PicoP_TLC_GetTofDataFormat(const PicoP_HANDLE connection_handle,
+                                    PicoP_ToFDataFormatE* const pDataFormat,
+                                    const PicoP_ValueStorageTypeE storageType)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)storageType;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pDataFormat == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    *pDataFormat = pDevice->GetDataFormat();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetTxFallRise(const PicoP_HANDLE connection_handle,
+                                 UINT32 const tx_fall,
+                                 UINT32 const tx_rise,
+                                 const BOOL commit)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)commit;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    return pDevice->SetTxFallRise(tx_fall, tx_rise);
+}
+
+PICOP_RC PicoP_TLC_GetTxFallRise(const PicoP_HANDLE connection_handle,
+                                 UINT32* const ptx_fall,
+                                 UINT32* const ptx_rise,
+                                 const PicoP_ValueStorageTypeE storageType)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)storageType;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if ((ptx_fall == NULL) || (ptx_rise == NULL))
+    {
+        return eINVALID_ARG;
+    }
+
+    pDevice->GetTxFallRise(ptx_fall, ptx_rise);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetDOutBScale(const PicoP_HANDLE connection_handle,
+                                 UINT32 const dout_b_scale,
+                                 const BOOL commit)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)commit;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    return pDevice->SetDOutBScale(dout_b_scale);
+}
+
+PICOP_RC PicoP_TLC_GetDOutBScale(const PicoP_HANDLE connection_handle,
+                                 UINT32* const pdout_b_scale,
+                                 const PicoP_ValueStorageTypeE storageType)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)storageType;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pdout_b_scale == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    *pdout_b_scale = pDevice->GetDOutBScale();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Frames
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_SetEventCallbackFunction(const PicoP_HANDLE connection_handle,
+                                            const PICOP_EVENT_CALLBACK pfnEventCallback,
+                                            const UINT32 dwFlags)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    (void)dwFlags;
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    pDevice->SetEventCallback(pfnEventCallback);
+
+    return eSUCCESS;
+}
+
+PICOP_RC PicoP_TLC_GetTofFrameCount(const PicoP_HANDLE connection_handle, UINT32* const pCount)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pCount == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    *pCount = pDevice->GetFrameCount();
+
+    return eSUCCESS;
+}
+
+PICOP_RC PicoP_TLC_GetTofFrameDimensions(const PicoP_HANDLE connection_handle, UINT32* const pFrameDimensions)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+    TofFrameGeometry Geometry;
+
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pFrameDimensions == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    pDevice->GetGeometry(&Geometry);
+    *pFrameDimensions = Geometry.FrameBytes;
+
+    return eSUCCESS;
+}
+
+PICOP_RC PicoP_TLC_AcquireTofFrame(const PicoP_HANDLE connection_handle,
+                                   const UINT32 frameCount,
+                                   UINT32* const pData,
+                                   UINT32* const pRetFrameCount)
+{
+    TofSimDeviceRef Device(connection_handle);
+    TofSimDevice* pDevice = Device.Get();
+
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if ((pData == NULL) || (pRetFrameCount == NULL) || (frameCount == 0))
+    {
+        return eINVALID_ARG;
+    }
+
+    return pDevice->AcquireFrames(frameCount, pData, pRetFrameCount);
+}
+
+// ****************************************************************************
+//  Reads the oldest frame of the open connection and writes it as a PCD header
+//  followed by one PicoP_Pcd_Data per pixel
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_AcquireTofFramePcd(UINT32* const pData)
+{
+    TofSimDeviceRef Device;
+    TofSimDevice* pDevice = Device.Get();
+    TofFrameGeometry Geometry;
+    TofScanGeometry ScanGeometry;
+    PicoP_TofPulsingConfig PulsingConfig;
+    TofFrameView View;
+    std::vector<UINT32> Frame;
+    PicoP_Pcd_Hdr* pHeader = (PicoP_Pcd_Hdr*)pData;
+    UINT32 RetFrames = 0;
+    UINT32 NumPoints = 0;
+    PICOP_RC PicopRc;
+
+
+    if (pDevice == NULL)
+    {
+        return eNOT_CONNECTED;
+    }
+
+    if (pData == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    pDevice->GetGeometry(&Geometry);
+    Frame.resize(Geometry.FrameWords);
+    PicopRc = pDevice->AcquireFrames(1, &Frame[0], &RetFrames);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    if (RetFrames == 0)
+    {
+        return eFRAME_ERROR;
+    }
+
+    PicopRc = TofMakeFrameView(&Frame[0], Geometry.FrameWords, Geometry.NumPulses, Geometry.NumLines,
+                               Geometry.Format, &View);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    pDevice->GetPulsingConfig(&PulsingConfig);
+    TofDefaultScanGeometry(&ScanGeometry);
+    ScanGeometry.PulsingMode = PulsingConfig.pulsingMode;
+    PicopRc = TofFrameToPointCloud(&View, &ScanGeometry, (PicoP_Pcd_Data*)(pHeader + 1),
+                                   Geometry.PlaneWords, &NumPoints);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    memset(pHeader, 0, sizeof(PicoP_Pcd_Hdr));
+    snprintf(pHeader->version, N_PCD_HDR_CHARS, "VERSION .7");
+    snprintf(pHeader->fields, N_PCD_HDR_CHARS, "FIELDS x y z intensity");
+    snprintf(pHeader->size, N_PCD_HDR_CHARS, "SIZE 4 4 4 4");
+    snprintf(pHeader->type, N_PCD_HDR_CHARS, "TYPE I I I U");
+    snprintf(pHeader->count, N_PCD_HDR_CHARS, "COUNT 1 1 1 1");
+    snprintf(pHeader->width, N_PCD_HDR_CHARS, "WIDTH %u", View.NumPulses);
+    snprintf(pHeader->height, N_PCD_HDR_CHARS, "HEIGHT %u", View.NumLines);
+    snprintf(pHeader->viewpoint, N_PCD_HDR_CHARS, "VIEWPOINT 0 0 0 1 0 0 0");
+    snprintf(pHeader->point, N_PCD_HDR_CHARS, "POINTS %u", NumPoints);
+    snprintf(pHeader->dataType, N_PCD_HDR_CHARS, "DATA binary");
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+PICOP_RC PicoP_TLC_GetLibraryInfo(PicoP_LibraryInfo* const libraryInfo)
+{
+    if (libraryInfo == NULL)
+    {
+        return eINVALID_ARG;
+    }
+
+    libraryInfo->majorVersion = TOF_SIM_VERSION_MAJOR;
+    libraryInfo->minorVersion = TOF_SIM_VERSION_MINOR;
+    libraryInfo->patchVersion = TOF_SIM_VERSION_PATCH;
+    libraryInfo->capabilityFlags = 0;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
@@ -0,0 +1,633 @@
+// ****************************************************************************
+//  TofSimDevice.cpp
+//
+// State and frame generator of one simulated TLC connection
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <string.h>
+#include "TofSimDevice.h"
+
+// ****************************************************************************
+
+TofSimDevice::TofSimDevice()
+    : mStop(FALSE),
+      mSensingState(eSENSING_ENABLED),
+      mDataInterface(eSENSING_DATA_INTERFACE_USB),
+      mDataFormat(eTOF_DATA_FUSED),
+      mGeometryVersion(0),
+      mTxFall(0),
+      mTxRise(0),
+      mDOutBScale(DOUTB_SCALE_MAX),
+      mSceneChanged(FALSE),
+      mFrameNumber(0),
+      mCallback(NULL)
+{
+    TofSimDefaultConfig(&mConfig);
+    memset(&mStats, 0, sizeof(mStats));
+    memset(&mGeometry, 0, sizeof(mGeometry));
+
+    mPulsingConfig.pulsingMode = eTOF_PULSING_EQUAL_ANGLE;
+    mPulsingConfig.nrPulsesPerLine = TOF_SIM_DEFAULT_PULSES;
+    mPulsingConfig.nrLinePhases = 0;
+    mPulsingConfig.nrFramePhases = 0;
+    mPulsingConfig.params0 = 0;
+    mPulsingConfig.params1 = 0;
+}
+
+TofSimDevice::~TofSimDevice()
+{
+    Close();
+}
+
+// ****************************************************************************
+//  Powers the simulated device up with its default settings and starts
+//  generating frames
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::Open(const TofSimConfig* pConfig)
+{
+    PICOP_RC PicopRc;
+
+
+    if (mThread.joinable())
+    {
+        return eALREADY_OPENED;
+    }
+
+    mConfig = *pConfig;
+    mScene.SetScene(mConfig.Scene, mConfig.Seed);
+    mJitter.seed(mConfig.Seed);
+
+    PicopRc = UpdateGeometry(&mPulsingConfig, mDataFormat);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    mStop = FALSE;
+    mStartTime = TofClock::now();
+    mNextCapture = mStartTime;
+    mThread = std::thread(&TofSimDevice::GeneratorThread, this);
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofSimDevice::Close()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+        mStop = TRUE;
+    }
+
+    mWake.notify_all();
+
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+
+    FlushFrames();
+}
+
+// ****************************************************************************
+
+void TofSimDevice::SetConfig(const TofSimConfig* pConfig)
+{
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+        // The scene is only touched by the generator thread once it runs
+        if ((pConfig->Scene != mConfig.Scene) || (pConfig->Seed != mConfig.Seed))
+        {
+            mSceneChanged = TRUE;
+            mJitter.seed(pConfig->Seed);
+        }
+
+        mConfig = *pConfig;
+    }
+
+    mWake.notify_all();
+}
+
+// ****************************************************************************
+
+void TofSimDevice::GetStats(TofSimStats* pStats)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pStats = mStats;
+}
+
+// ****************************************************************************
+//  Frames already captured are still delivered after sensing is disabled,
+//  nothing new is captured until it is enabled again
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::SetSensingState(PicoP_SensingStateE State)
+{
+    if ((State != eSENSING_DISABLED) && (State != eSENSING_ENABLED))
+    {
+        return eINVALID_ARG;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(mLock);
+
+        if ((State == eSENSING_ENABLED) && (mSensingState != eSENSING_ENABLED))
+        {
+            mNextCapture = TofClock::now();
+        }
+
+        mSensingState = State;
+    }
+
+    mWake.notify_all();
+
+    return eSUCCESS;
+}
+
+PicoP_SensingStateE TofSimDevice::GetSensingState()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mSensingState;
+}
+
+// ****************************************************************************
+
+void TofSimDevice::SetDataInterface(PicoP_SensingDataInterfaceE DataInterface)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    mDataInterface = DataInterface;
+}
+
+PicoP_SensingDataInterfaceE TofSimDevice::GetDataInterface()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mDataInterface;
+}
+
+// ****************************************************************************
+//  The frame layout can only change while sensing is disabled
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::SetPulsingConfig(const PicoP_TofPulsingConfig* pConfig)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if (mSensingState == eSENSING_ENABLED)
+    {
+        return eINVALID_STATE;
+    }
+
+    return UpdateGeometry(pConfig, mDataFormat);
+}
+
+void TofSimDevice::GetPulsingConfig(PicoP_TofPulsingConfig* pConfig)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pConfig = mPulsingConfig;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::SetDataFormat(PicoP_ToFDataFormatE Format)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if (mSensingState == eSENSING_ENABLED)
+    {
+        return eINVALID_STATE;
+    }
+
+    return UpdateGeometry(&mPulsingConfig, Format);
+}
+
+PicoP_ToFDataFormatE TofSimDevice::GetDataFormat()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mDataFormat;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::SetCalData(UINT32 Size, const UINT8* pData)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if (Size > MAX_CAL_DATA_SIZE)
+    {
+        return eINVALID_ARG;
+    }
+
+    mCalData.assign(pData, pData + Size);
+
+    return eSUCCESS;
+}
+
+void TofSimDevice::GetCalData(UINT32* pSize, UINT8* pData)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pSize = (UINT32)mCalData.size();
+
+    if ( ! mCalData.empty())
+    {
+        memcpy(pData, &mCalData[0], mCalData.size());
+    }
+}
+
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::SetTxFallRise(UINT32 TxFall, UINT32 TxRise)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if ((TxFall > TX_FALL_MAX) || (TxRise > TX_RISE_MAX))
+    {
+        return eINVALID_ARG;
+    }
+
+    mTxFall = TxFall;
+    mTxRise = TxRise;
+
+    return eSUCCESS;
+}
+
+void TofSimDevice::GetTxFallRise(UINT32* pTxFall, UINT32* pTxRise)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pTxFall = mTxFall;
+    *pTxRise = mTxRise;
+}
+
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::SetDOutBScale(UINT32 Scale)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    if (Scale > DOUTB_SCALE_MAX)
+    {
+        return eINVALID_ARG;
+    }
+
+    mDOutBScale = Scale;
+
+    return eSUCCESS;
+}
+
+UINT32 TofSimDevice::GetDOutBScale()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return mDOutBScale;
+}
+
+// ****************************************************************************
+//  Once this returns the previous callback is not running and will not be
+//  called again
+// ****************************************************************************
+
+void TofSimDevice::SetEventCallback(PICOP_EVENT_CALLBACK pfnCallback)
+{
+    std::lock_guard<std::mutex> Lock(mCallbackLock);
+
+
+    mCallback = pfnCallback;
+}
+
+// ****************************************************************************
+
+UINT32 TofSimDevice::GetFrameCount()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    return (UINT32)mReady.size();
+}
+
+void TofSimDevice::GetGeometry(TofFrameGeometry* pGeometry)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    *pGeometry = mGeometry;
+}
+
+// ****************************************************************************
+//  Copies up to Count of the oldest readable frames back to back into pData
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::AcquireFrames(UINT32 Count, UINT32* pData, UINT32* pRetCount)
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+    UINT32 Frames = 0;
+
+
+    while ((Frames < Count) && ( ! mReady.empty()))
+    {
+        memcpy(pData + (size_t)Frames * mGeometry.FrameWords, &mReady.front().Data[0], mGeometry.FrameBytes);
+        mFreeFrames.splice(mFreeFrames.end(), mReady, mReady.begin());
+        Frames++;
+    }
+
+    mStats.FramesRead += Frames;
+    *pRetCount = Frames;
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+//  Called with mLock held. Frames of the old layout are thrown away.
+// ****************************************************************************
+
+PICOP_RC TofSimDevice::UpdateGeometry(const PicoP_TofPulsingConfig* pConfig, PicoP_ToFDataFormatE Format)
+{
+    TofFrameGeometry Geometry;
+    UINT32 Planes = TofPlanesPerFrame(Format);
+    UINT32 FrameBytes;
+    PICOP_RC PicopRc;
+
+
+    if (Planes == 0)
+    {
+        return eNOT_SUPPORTED_DATA_FORMAT;
+    }
+
+    FrameBytes = pConfig->nrPulsesPerLine * TOF_SIM_LINES * Planes * sizeof(UINT32);
+    PicopRc = TofMakeFrameGeometry(pConfig, Format, FrameBytes, &Geometry);
+
+    if (PicopRc != eSUCCESS)
+    {
+        return PicopRc;
+    }
+
+    mPulsingConfig = *pConfig;
+    mDataFormat = Format;
+    mGeometry = Geometry;
+    mGeometryVersion++;
+    mLinkFreeTime = TofClock::time_point();
+    mInFlight.clear();
+    mReady.clear();
+    mFreeFrames.clear();
+
+    return eSUCCESS;
+}
+
+// ****************************************************************************
+
+void TofSimDevice::FlushFrames()
+{
+    std::lock_guard<std::mutex> Lock(mLock);
+
+
+    mLinkFreeTime = TofClock::time_point();
+    mInFlight.clear();
+    mReady.clear();
+    mFreeFrames.clear();
+}
+
+// ****************************************************************************
+
+BOOL TofSimDevice::SendEvent(UINT32 FrameCount)
+{
+    std::lock_guard<std::mutex> Lock(mCallbackLock);
+
+
+    if (mCallback == NULL)
+    {
+        return FALSE;
+    }
+
+    mCallback(this, eEVENT_TOF_DATA_FRAMES_RECEIVED, &FrameCount);
+
+    return TRUE;
+}
+
+// ****************************************************************************
+//  Sleeps until the next capture or the next frame coming off the wire,
+//  whichever is first
+// ****************************************************************************
+
+void TofSimDevice::GeneratorThread()
+{
+    std::unique_lock<std::mutex> Lock(mLock);
+    std::list<SimFrame> Capture;        // The frame being rendered, off every list
+    TofFrameGeometry Geometry;
+    TofClock::time_point Now;
+    TofClock::time_point WakeTime;
+    TofClock::time_point CaptureTime;
+    TofClock::duration Period;
+    TofClock::time_point SentTime;
+    TofClock::time_point ReadoutDone;
+    UINT32 Version;
+    UINT32 FrameNumber;
+    UINT32 Published;
+    UINT32 LinkBytes;
+    UINT32 ReadoutBytes;
+    UINT32 Sending;
+    INT32 LatencyUs;
+    BOOL Capturing;
+    BOOL Waiting;
+
+
+    while ( ! mStop)
+    {
+        Capturing = (mSensingState == eSENSING_ENABLED) && (mConfig.FrameRate != 0);
+        Waiting = Capturing || ( ! mInFlight.empty());
+
+        if (Capturing)
+        {
+            WakeTime = mNextCapture;
+        }
+
+        if (( ! mInFlight.empty()) && (( ! Capturing) || (mInFlight.front().ReadyTime < WakeTime)))
+        {
+            WakeTime = mInFlight.front().ReadyTime;
+        }
+
+        if ( ! Waiting)
+        {
+            mWake.wait(Lock);
+        }
+        else
+        {
+            mWake.wait_until(Lock, WakeTime);
+        }
+
+        if (mStop)
+        {
+            break;
+        }
+
+        Now = TofClock::now();
+
+        if ((mSensingState == eSENSING_ENABLED) && (mConfig.FrameRate != 0) && (Now >= mNextCapture))
+        {
+            Period = std::chrono::duration_cast<TofClock::duration>(std::chrono::microseconds(1000000 / mConfig.FrameRate));
+            CaptureTime = mNextCapture;
+            Geometry = mGeometry;
+            Version = mGeometryVersion;
+            FrameNumber = mFrameNumber++;
+
+            // Never try to catch up on frames missed while stalled
+            mNextCapture += Period;
+
+            if (mNextCapture < Now)
+            {
+                mNextCapture = Now + Period;
+            }
+
+            if (mFreeFrames.empty())
+            {
+                Capture.push_back(SimFrame());
+            }
+            else
+            {
+                Capture.splice(Capture.end(), mFreeFrames, mFreeFrames.begin());
+            }
+
+            Capture.front().Data.resize(Geometry.FrameWords);
+
+            if (mSceneChanged)
+            {
+                mScene.SetScene(mConfig.Scene, mConfig.Seed);
+                mSceneChanged = FALSE;
+            }
+
+            mScene.SetDOutBScale(mDOutBScale);
+            LinkBytes = TofLinkBytesPerFrame(Geometry.Format, Geometry.PlaneWords);
+
+            // TDC A is read in full, as much as TDC B at full scale. The next
+            // capture waits for the readout.
+            if (mConfig.TdcBytesPerSecond != 0)
+            {
+                ReadoutBytes = TofTdcBReadBytes(Geometry.PlaneWords, DOUTB_SCALE_MAX) +
+                               TofTdcBReadBytes(Geometry.PlaneWords, mDOutBScale);
+                ReadoutDone = CaptureTime + std::chrono::microseconds(((uint64_t)ReadoutBytes * 1000000) /
+                                                                      mConfig.TdcBytesPerSecond);
+                mNextCapture = (ReadoutDone > mNextCapture) ? ReadoutDone : mNextCapture;
+            }
+
+            // Rendering takes a while, don't hold up the API meanwhile
+            Lock.unlock();
+            mScene.Render(&Geometry, FrameNumber,
+                          std::chrono::duration<FP32>(CaptureTime - mStartTime).count(), &Capture.front().Data[0]);
+            Lock.lock();
+
+            Sending = 0;
+
+            for (std::list<SimFrame>::const_iterator It = mInFlight.begin(); It != mInFlight.end(); ++It)
+            {
+                Sending += (It->SentTime > CaptureTime) ? 1 : 0;
+            }
+
+            if ((Version == mGeometryVersion) && (mSensingState == eSENSING_ENABLED) &&
+                (mConfig.LinkBytesPerSecond != 0) && (Sending >= mConfig.QueueDepth))
+            {
+                // The device has nowhere to keep it until the link catches up
+                mFreeFrames.splice(mFreeFrames.end(), Capture);
+                mStats.FramesLinkDropped++;
+            }
+            else if ((Version == mGeometryVersion) && (mSensingState == eSENSING_ENABLED))
+            {
+                SentTime = CaptureTime;
+
+                if (mConfig.LinkBytesPerSecond != 0)
+                {
+                    SentTime = (mLinkFreeTime > CaptureTime) ? mLinkFreeTime : CaptureTime;
+                    SentTime += std::chrono::microseconds(((uint64_t)LinkBytes * 1000000) / mConfig.LinkBytesPerSecond);
+                    mLinkFreeTime = SentTime;
+                }
+
+                LatencyUs = (INT32)mConfig.LatencyUs;
+
+                if (mConfig.JitterUs != 0)
+                {
+                    LatencyUs += (INT32)(mJitter() % ((2 * mConfig.JitterUs) + 1)) - (INT32)mConfig.JitterUs;
+                }
+
+                Capture.front().SentTime = SentTime;
+                Capture.front().ReadyTime = SentTime + std::chrono::microseconds((LatencyUs > 0) ? LatencyUs : 0);
+
+                // Frames arrive in the order they were captured
+                if (( ! mInFlight.empty()) && (Capture.front().ReadyTime < mInFlight.back().ReadyTime))
+                {
+                    Capture.front().ReadyTime = mInFlight.back().ReadyTime;
+                }
+
+                mInFlight.splice(mInFlight.end(), Capture);
+
+                mStats.FramesGenerated++;
+            }
+            else
+            {
+                // The layout changed or sensing stopped while rendering
+                mFreeFrames.splice(mFreeFrames.end(), Capture);
+            }
+        }
+
+        Published = 0;
+
+        while (( ! mInFlight.empty()) && (mInFlight.front().ReadyTime <= Now))
+        {
+            mReady.splice(mReady.end(), mInFlight, mInFlight.begin());
+            Published++;
+
+            if (mReady.size() > mConfig.QueueDepth)
+            {
+                mFreeFrames.splice(mFreeFrames.end(), mReady, mReady.begin());
+                mStats.FramesOverrun++;
+            }
+        }
+
+        if (Published != 0)
+        {
+            Published = (UINT32)mReady.size();
+            Lock.unlock();
+
+            if (SendEvent(Published))
+            {
+                Lock.lock();
+                mStats.EventsSent++;
+            }
+            else
+            {
+                Lock.lock();
+            }
+        }
+    }
+}
+
+// ****************************************************************************
@@ -0,0 +1,119 @@
+// ****************************************************************************
+//  TofSimDevice.h
+//
+// State and frame generator of one simulated TLC connection
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "PicoP_TLC_Api.h"
+#include "TofFrameRing.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+#include "TofSimScene.h"
+
+// ****************************************************************************
+// A generator thread renders a frame every 1 / FrameRate seconds while
+// sensing is enabled, or less often when the detector readout of the last
+// frame takes longer than that. The frame is "on the wire" until its ready time, then
+// joins the queue PicoP_TLC_GetTofFrameCount reports and the event callback
+// is told about it. When more than QueueDepth frames are waiting the oldest
+// is dropped, as the device would. On a limited link a frame is first sent
+// after the ones before it, and only then starts its latency. Frames move
+// between the lists by splicing, so once enough have been made for the
+// queue depth the device stops allocating.
+// ****************************************************************************
+
+class TofSimDevice
+{
+public:
+    TofSimDevice();
+    ~TofSimDevice();
+
+    PICOP_RC Open(const TofSimConfig* pConfig);
+    void Close();
+
+    void SetConfig(const TofSimConfig* pConfig);
+    void GetStats(TofSimStats* pStats);
+
+    PICOP_RC SetSensingState(PicoP_SensingStateE State);
+    PicoP_SensingStateE GetSensingState();
+    void SetDataInterface(PicoP_SensingDataInterfaceE DataInterface);
+    PicoP_SensingDataInterfaceE GetDataInterface();
+    PICOP_RC SetPulsingConfig(const PicoP_TofPulsingConfig* pConfig);
+    void GetPulsingConfig(PicoP_TofPulsingConfig* pConfig);
+    PICOP_RC SetDataFormat(PicoP_ToFDataFormatE Format);
+    PicoP_ToFDataFormatE GetDataFormat();
+    PICOP_RC SetCalData(UINT32 Size, const UINT8* pData);
+    void GetCalData(UINT32* pSize, UINT8* pData);
+    PICOP_RC SetTxFallRise(UINT32 TxFall, UINT32 TxRise);
+    void GetTxFallRise(UINT32* pTxFall, UINT32* pTxRise);
+    PICOP_RC SetDOutBScale(UINT32 Scale);
+    UINT32 GetDOutBScale();
+
+    void SetEventCallback(PICOP_EVENT_CALLBACK pfnCallback);
+    UINT32 GetFrameCount();
+    void GetGeometry(TofFrameGeometry* pGeometry);
+    PICOP_RC AcquireFrames(UINT32 Count, UINT32* pData, UINT32* pRetCount);
+
+private:
+    typedef struct
+    {
+        std::vector<UINT32> Data;
+        TofClock::time_point SentTime;      // Off the link
+        TofClock::time_point ReadyTime;
+    } SimFrame;
+
+    PICOP_RC UpdateGeometry(const PicoP_TofPulsingConfig* pConfig, PicoP_ToFDataFormatE Format);
+    void FlushFrames();
+    void GeneratorThread();
+    BOOL SendEvent(UINT32 FrameCount);
+
+    std::mutex mLock;                       // Everything below except the callback
+    std::condition_variable mWake;
+    std::thread mThread;
+    BOOL mStop;
+
+    TofSimConfig mConfig;
+    TofSimStats mStats;
+    PicoP_SensingStateE mSensingState;
+    PicoP_SensingDataInterfaceE mDataInterface;
+    PicoP_TofPulsingConfig mPulsingConfig;
+    PicoP_ToFDataFormatE mDataFormat;
+    TofFrameGeometry mGeometry;
+    UINT32 mGeometryVersion;                // Bumped whenever the frame layout changes
+    std::vector<UINT8> mCalData;
+    UINT32 mTxFall;
+    UINT32 mTxRise;
+    UINT32 mDOutBScale;
+
+    TofSimScene mScene;
+    BOOL mSceneChanged;
+    std::mt19937 mJitter;
+    UINT32 mFrameNumber;
+    TofClock::time_point mStartTime;
+    TofClock::time_point mNextCapture;
+    TofClock::time_point mLinkFreeTime;     // When the link has sent every frame given to it
+    std::list<SimFrame> mInFlight;          // Captured, not yet readable
+    std::list<SimFrame> mReady;             // Readable, oldest first
+    std::list<SimFrame> mFreeFrames;        // Read or dropped, buffers kept for reuse
+
+    std::mutex mCallbackLock;               // Held while the callback runs
+    PICOP_EVENT_CALLBACK mCallback;
+};
+
+// ****************************************************************************
@@ -0,0 +1,216 @@
+// ****************************************************************************
+//  TofSimScene.cpp
+//
+// Synthetic scenes rendered into simulated ToF frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include <math.h>
+#include "TofSimScene.h"
+#include "TofPointCloud.h"
+
+// ****************************************************************************
+
+#define TOF_SIM_AMPLITUDE_GAIN      4.0e9f      // Amplitude of a white target at 1 mm
+#define TOF_SIM_AMPLITUDE_MAX       4095
+#define TOF_SIM_RANGE_NOISE         8           // Counts, +/-
+#define TOF_SIM_DROPOUT_MASK        0x1ff       // One pixel in 512 returns nothing
+
+#define TOF_SIM_PI                  3.14159265f
+
+// ****************************************************************************
+
+TofSimScene::TofSimScene()
+    : mScene(eTOF_SIM_SCENE_ROOM),
+      mNoiseState(1),
+      mDOutBScale(DOUTB_SCALE_MAX)
+{
+}
+
+// ****************************************************************************
+
+void TofSimScene::SetScene(TofSimSceneE Scene, UINT32 Seed)
+{
+    mScene = Scene;
+    mNoiseState = (Seed == 0) ? 1 : Seed;   // xorshift never leaves 0
+}
+
+// ****************************************************************************
+//  xorshift32
+// ****************************************************************************
+
+inline UINT32 TofSimScene::Noise()
+{
+    mNoiseState ^= mNoiseState << 13;
+    mNoiseState ^= mNoiseState >> 17;
+    mNoiseState ^= mNoiseState << 5;
+
+    return mNoiseState;
+}
+
+// ****************************************************************************
+//  X runs 0..1 left to right and Y 0..1 top to bottom across the field of view
+// ****************************************************************************
+
+void TofSimScene::Sample(FP32 X, FP32 Y, FP32 Seconds, FP32* pRange, FP32* pReflectivity) const
+{
+    FP32 BallX;
+    FP32 DX;
+    FP32 DY;
+    FP32 Distance2;
+    const FP32 BallRadius = 5.0f;           // Degrees
+
+
+    switch (mScene)
+    {
+    case eTOF_SIM_SCENE_RAMP:
+        *pRange = 500.0f + (X * 4000.0f);
+        *pReflectivity = 0.5f;
+        break;
+
+    case eTOF_SIM_SCENE_CONSTANT:
+        *pRange = 2000.0f;
+        *pReflectivity = 0.5f;
+        break;
+
+    case eTOF_SIM_SCENE_ROOM:
+    default:
+        // Back wall, with the floor coming closer towards the bottom
+        *pRange = 3000.0f;
+        *pReflectivity = 0.5f;
+
+        if (Y > 0.6f)
+        {
+            *pRange = 3000.0f - ((Y - 0.6f) * 4000.0f);
+            *pReflectivity = 0.3f;
+        }
+
+        // A ball swinging left and right every four seconds
+        BallX = 0.5f + (0.35f * sinf((2.0f * TOF_SIM_PI * Seconds) / 4.0f));
+        DX = (X - BallX) * TOF_DEFAULT_HORIZONTAL_FOV;
+        DY = (Y - 0.45f) * TOF_DEFAULT_VERTICAL_FOV;
+        Distance2 = (DX * DX) + (DY * DY);
+
+        if (Distance2 < (BallRadius * BallRadius))
+        {
+            *pRange = 1500.0f - (300.0f * sqrtf(1.0f - (Distance2 / (BallRadius * BallRadius))));
+            *pReflectivity = 0.9f;
+        }
+
+        break;
+    }
+}
+
+// ****************************************************************************
+
+void TofSimScene::Render(const TofFrameGeometry* pGeometry, UINT32 FrameNumber, FP32 Seconds, UINT32* pFrame)
+{
+    UINT32* pPlane[4];
+    UINT32 FramePhase = FrameNumber % pGeometry->FramePhases;
+    UINT32 ScanLine;
+    UINT32 LinePhase;
+    UINT32 Index;
+    UINT32 Time[2];
+    UINT32 Amplitude[2];
+    FP32 X;
+    FP32 Y;
+    FP32 Range;
+    FP32 Reflectivity;
+    FP32 Level;
+    BOOL Noisy = (mScene == eTOF_SIM_SCENE_ROOM);
+    BOOL ReadB;
+
+
+    for (UINT32 Plane = 0; Plane < pGeometry->NumPlanes; Plane++)
+    {
+        pPlane[Plane] = pFrame + (size_t)Plane * pGeometry->PlaneWords;
+    }
+
+    for (UINT32 Line = 0; Line < pGeometry->NumLines; Line++)
+    {
+        ScanLine = Line / pGeometry->LinePhases;
+        LinePhase = Line % pGeometry->LinePhases;
+        Y = (ScanLine + ((FramePhase + 0.5f) / pGeometry->FramePhases)) / pGeometry->ImageLines;
+
+        for (UINT32 Pulse = 0; Pulse < pGeometry->NumPulses; Pulse++)
+        {
+            X = (Pulse + ((LinePhase + 0.5f) / pGeometry->LinePhases)) / pGeometry->NumPulses;
+            Sample(X, Y, Seconds, &Range, &Reflectivity);
+            Level = Reflectivity * TOF_SIM_AMPLITUDE_GAIN / (Range * Range);
+
+            // Both detectors see the same scene with their own noise
+            for (UINT32 Detector = 0; Detector < 2; Detector++)
+            {
+                Time[Detector] = (UINT32)(Range / TOF_DEFAULT_MM_PER_COUNT);
+                Amplitude[Detector] = (Level < TOF_SIM_AMPLITUDE_MAX) ? (UINT32)Level : TOF_SIM_AMPLITUDE_MAX;
+
+                if (Noisy)
+                {
+                    if ((Noise() & TOF_SIM_DROPOUT_MASK) == 0)
+                    {
+                        Time[Detector] = 0;
+                        Amplitude[Detector] = 0;
+                    }
+                    else
+                    {
+                        Time[Detector] += (Noise() % ((2 * TOF_SIM_RANGE_NOISE) + 1)) - TOF_SIM_RANGE_NOISE;
+                    }
+                }
+            }
+
+            Index = (Line * pGeometry->NumPulses) + Pulse;
+            ReadB = (((Index % DOUTB_SCALE_MAX) * mDOutBScale) % DOUTB_SCALE_MAX) < mDOutBScale;
+
+            if ( ! ReadB)
+            {
+                Time[1] = 0;
+                Amplitude[1] = 0;
+            }
+
+            switch (pGeometry->Format)
+            {
+            case eTOF_DATA_FUSED:
+                pPlane[0][Index] = ReadB ? ((Time[0] + Time[1]) / 2) : Time[0];
+                pPlane[1][Index] = ReadB ? ((Amplitude[0] + Amplitude[1]) / 2) : Amplitude[0];
+                break;
+
+            case eTOF_DATA_LEFT_SENSOR_ONLY:
+                pPlane[0][Index] = Time[0];
+                pPlane[1][Index] = Amplitude[0];
+                break;
+
+            case eTOF_DATA_RIGHT_SENSOR_ONLY:
+                pPlane[0][Index] = Time[1];
+                pPlane[1][Index] = Amplitude[1];
+                break;
+
+            case eTOF_DATA_DEPTH_ONLY:
+                pPlane[0][Index] = Time[0];
+                pPlane[1][Index] = Time[1];
+                break;
+
+            case eTOF_DATA_AMPLITUDE_ONLY:
+                pPlane[0][Index] = Amplitude[0];
+                pPlane[1][Index] = Amplitude[1];
+                break;
+
+            case eTOF_DATA_ALL:
+            default:
+                pPlane[0][Index] = Time[0];
+                pPlane[1][Index] = Amplitude[0];
+                pPlane[2][Index] = Time[1];
+                pPlane[3][Index] = Amplitude[1];
+                break;
+            }
+        }
+    }
+}
+
+// ****************************************************************************
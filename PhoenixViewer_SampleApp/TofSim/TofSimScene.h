@@ -0,0 +1,51 @@
+// ****************************************************************************
+//  TofSimScene.h
+//
+// Synthetic scenes rendered into simulated ToF frames
+//
+// Copyright : (c)2018 Microvision
+// This source code is subject to the Microvision Source Code License.
+//
+// THIS CODE IS FOR GUIDANCE ONLY. IT IS INTENDED AS AN EDUCATIONAL SAMPLE DEMONSTRATING
+// SIMPLIFIED USE OF THE MICROVISION PRODUCT. THE CODE AND INFORMATION ARE PROVIDED "AS IS"
+// WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#pragma once
+
+#include "PicoP_TLC_Api.h"
+#include "TofGeometry.h"
+#include "TofSim.h"
+
+// ****************************************************************************
+// Renders one frame in the layout PicoP_TLC_AcquireTofFrame returns for the
+// given geometry: NumPlanes planes of NumLines x NumPulses words. With line
+// phasing consecutive lines sample the same scan line at positions offset by
+// a fraction of a pulse; with frame phasing successive frames offset the scan
+// lines by a fraction of a line. Depth is in time counts of
+// TOF_DEFAULT_MM_PER_COUNT, amplitude falls off with the square of range.
+// TDC B (the right detector) is only read for DOutBScale / DOUTB_SCALE_MAX of
+// the pixels, spread evenly; the others have no right return, and the fused
+// planes hold the left detector's alone.
+// ****************************************************************************
+
+class TofSimScene
+{
+public:
+    TofSimScene();
+
+    void SetScene(TofSimSceneE Scene, UINT32 Seed);
+    void SetDOutBScale(UINT32 Scale) { mDOutBScale = Scale; }
+    void Render(const TofFrameGeometry* pGeometry, UINT32 FrameNumber, FP32 Seconds, UINT32* pFrame);
+
+private:
+    void Sample(FP32 X, FP32 Y, FP32 Seconds, FP32* pRange, FP32* pReflectivity) const;
+    UINT32 Noise();
+
+    TofSimSceneE mScene;
+    UINT32 mNoiseState;
+    UINT32 mDOutBScale;
+};
+
+// ****************************************************************************